@@ -0,0 +1,477 @@
+#include "AssetManager.h"
+#include "VulkanContext.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+uint64_t meshBytes(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
+    return vertices.size() * sizeof(Vertex) + indices.size() * sizeof(uint32_t);
+}
+
+VkCommandBuffer beginCommands(VkDevice device, VkCommandPool commandPool) {
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = commandPool;
+    allocInfo.commandBufferCount = 1;
+    VkCommandBuffer commandBuffer;
+    if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("AssetManager: failed to allocate upload command buffer");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    return commandBuffer;
+}
+
+VkFence createFence(VkDevice device) {
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+        throw std::runtime_error("AssetManager: failed to create upload fence");
+    }
+    return fence;
+}
+
+} // namespace
+
+AssetManager::AssetManager(VulkanContext& context, ThreadPool& pool, const AssetSettings& settings)
+    : context(context), pool(pool), settings(settings), jobs(pool) {
+    if (this->settings.maxBatchesInFlight == 0) {
+        this->settings.maxBatchesInFlight = 1;
+    }
+}
+
+AssetManager::~AssetManager() {
+    stopping.store(true, std::memory_order_relaxed);
+    jobs.wait();
+    VkDevice device = context.getDevice();
+    for (UploadBatch& batch : batches) {
+        if (batch.fence != VK_NULL_HANDLE) {
+            vkWaitForFences(device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+        }
+        if (batch.acquireFence != VK_NULL_HANDLE) {
+            vkWaitForFences(device, 1, &batch.acquireFence, VK_TRUE, UINT64_MAX);
+        }
+        destroyBatch(batch);
+    }
+    for (Asset& asset : assets) {
+        if (!asset.model) {
+            vkDestroyBuffer(device, asset.vertexBuffer, nullptr);
+            vkFreeMemory(device, asset.vertexBufferMemory, nullptr);
+            vkDestroyBuffer(device, asset.indexBuffer, nullptr);
+            vkFreeMemory(device, asset.indexBufferMemory, nullptr);
+        }
+    }
+}
+
+AssetHandle AssetManager::addAsset(bool keepCpuData) {
+    if (!loadingWave) {
+        loadStart = Clock::now();
+        loadingWave = true;
+    }
+    AssetHandle handle;
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    } else {
+        handle = static_cast<AssetHandle>(assets.size());
+        assets.emplace_back();
+    }
+    assets[handle].keepCpuData = keepCpuData;
+    stats.requested++;
+    return handle;
+}
+
+void AssetManager::freeAsset(AssetHandle handle) {
+    assets[handle] = Asset();
+    freeHandles.push_back(handle);
+}
+
+void AssetManager::release(AssetHandle handle) {
+    Asset& asset = assets[handle];
+    if (asset.state != AssetState::Ready) {
+        // Dropped by whichever of collectLoaded, submitBatch and
+        // finishUploads sees it next.
+        asset.released = true;
+        return;
+    }
+    retired.push_back({std::move(asset.model), frame});
+    stats.ready--;
+    freeAsset(handle);
+}
+
+template <typename Fn>
+void AssetManager::startJob(AssetHandle handle, Fn&& load) {
+    stats.loading++;
+    jobs.run([this, handle, load = std::forward<Fn>(load)]() {
+        if (stopping.load(std::memory_order_relaxed)) {
+            return;
+        }
+        try {
+            Loaded result{handle, {}, {}};
+            load(result.vertices, result.indices);
+            if (result.vertices.empty()) {
+                throw std::runtime_error("AssetManager: asset has no vertices");
+            }
+            std::lock_guard<std::mutex> lock(loadedMutex);
+            loaded.push_back(std::move(result));
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(loadedMutex);
+            if (!jobError) {
+                jobError = std::current_exception();
+            }
+        }
+    });
+}
+
+AssetHandle AssetManager::loadModel(const std::string& objPath) {
+    AssetHandle handle = addAsset(true);
+    startJob(handle, [objPath](std::vector<Vertex>& vertices, std::vector<uint32_t>&) {
+        vertices = Model::loadObj(objPath);
+    });
+    return handle;
+}
+
+AssetHandle AssetManager::loadMesh(const Vertex* vertices, size_t vertexCount, const uint32_t* indices,
+                                   size_t indexCount) {
+    if (vertexCount == 0) {
+        throw std::runtime_error("AssetManager: no vertices");
+    }
+    AssetHandle handle = addAsset(false);
+    startJob(handle, [=](std::vector<Vertex>& vertexCopy, std::vector<uint32_t>& indexCopy) {
+        vertexCopy.assign(vertices, vertices + vertexCount);
+        indexCopy.assign(indices, indices + indexCount);
+        if (!indexCopy.empty() && *std::max_element(indexCopy.begin(), indexCopy.end()) >= vertexCount) {
+            throw std::runtime_error("AssetManager: mesh index out of range");
+        }
+    });
+    return handle;
+}
+
+AssetHandle AssetManager::loadMesh(std::vector<Vertex> vertices, std::vector<uint32_t> indices, bool keepCpuData) {
+    if (vertices.empty()) {
+        throw std::runtime_error("AssetManager: no vertices");
+    }
+    AssetHandle handle = addAsset(keepCpuData);
+    queueUpload(handle, std::move(vertices), std::move(indices));
+    return handle;
+}
+
+void AssetManager::queueUpload(AssetHandle handle, std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices) {
+    Asset& asset = assets[handle];
+    asset.state = AssetState::Uploading;
+    asset.vertices = std::move(vertices);
+    asset.indices = std::move(indices);
+    uploadQueue.push_back(handle);
+    stats.uploading++;
+}
+
+const std::vector<Vertex>& AssetManager::getVertices(AssetHandle handle) const {
+    const Asset& asset = assets[handle];
+    return asset.model ? asset.model->GetVertices() : asset.vertices;
+}
+
+const std::vector<uint32_t>& AssetManager::getIndices(AssetHandle handle) const {
+    const Asset& asset = assets[handle];
+    return asset.model ? asset.model->GetIndices() : asset.indices;
+}
+
+void AssetManager::collectLoaded() {
+    std::vector<Loaded> results;
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(loadedMutex);
+        results.swap(loaded);
+        error = jobError;
+        jobError = nullptr;
+    }
+    for (Loaded& result : results) {
+        stats.loading--;
+        if (assets[result.handle].released) {
+            freeAsset(result.handle);
+            continue;
+        }
+        queueUpload(result.handle, std::move(result.vertices), std::move(result.indices));
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void AssetManager::destroyBatch(UploadBatch& batch) {
+    VkDevice device = context.getDevice();
+    vkDestroyBuffer(device, batch.stagingBuffer, nullptr);
+    vkFreeMemory(device, batch.stagingBufferMemory, nullptr);
+    if (batch.commandBuffer != VK_NULL_HANDLE) {
+        vkFreeCommandBuffers(device, context.getTransferCommandPool(), 1, &batch.commandBuffer);
+    }
+    vkDestroyFence(device, batch.fence, nullptr);
+    vkDestroySemaphore(device, batch.semaphore, nullptr);
+    if (batch.acquireCommandBuffer != VK_NULL_HANDLE) {
+        vkFreeCommandBuffers(device, context.getCommandPool(), 1, &batch.acquireCommandBuffer);
+    }
+    vkDestroyFence(device, batch.acquireFence, nullptr);
+}
+
+void AssetManager::finishUploads(const UploadBatch& batch) {
+    VkDevice device = context.getDevice();
+    for (AssetHandle handle : batch.handles) {
+        Asset& asset = assets[handle];
+        uint32_t vertexCount = static_cast<uint32_t>(asset.vertices.size());
+        uint32_t indexCount = static_cast<uint32_t>(asset.indices.size());
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        if (asset.keepCpuData) {
+            vertices = std::move(asset.vertices);
+            indices = std::move(asset.indices);
+        }
+        asset.model = std::make_unique<Model>(device, asset.vertexBuffer, asset.vertexBufferMemory, vertexCount,
+                                              asset.indexBuffer, asset.indexBufferMemory, indexCount,
+                                              std::move(vertices), std::move(indices));
+        stats.uploading--;
+        if (asset.released) {
+            // The acquire barriers may still be running on the graphics
+            // queue; frames submitted after them retire the model.
+            retired.push_back({std::move(asset.model), frame});
+            freeAsset(handle);
+            continue;
+        }
+        asset.vertices = std::vector<Vertex>();
+        asset.indices = std::vector<uint32_t>();
+        asset.state = AssetState::Ready;
+        stats.ready++;
+    }
+}
+
+// Runs once the copies are done, so the semaphore is already signaled and
+// the graphics queue does not stall on it. Frames recorded afterwards are
+// submitted after these barriers and see the buffers owned by the graphics
+// family.
+void AssetManager::submitAcquire(UploadBatch& batch) {
+    VkDevice device = context.getDevice();
+    vkDestroyBuffer(device, batch.stagingBuffer, nullptr);
+    vkFreeMemory(device, batch.stagingBufferMemory, nullptr);
+    vkFreeCommandBuffers(device, context.getTransferCommandPool(), 1, &batch.commandBuffer);
+    vkDestroyFence(device, batch.fence, nullptr);
+    batch.stagingBuffer = VK_NULL_HANDLE;
+    batch.stagingBufferMemory = VK_NULL_HANDLE;
+    batch.commandBuffer = VK_NULL_HANDLE;
+    batch.fence = VK_NULL_HANDLE;
+
+    batch.acquireCommandBuffer = beginCommands(device, context.getCommandPool());
+    vkCmdPipelineBarrier(batch.acquireCommandBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 0, nullptr,
+                         static_cast<uint32_t>(batch.acquireBarriers.size()), batch.acquireBarriers.data(), 0,
+                         nullptr);
+    vkEndCommandBuffer(batch.acquireCommandBuffer);
+
+    batch.acquireFence = createFence(device);
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &batch.semaphore;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.acquireCommandBuffer;
+    if (vkQueueSubmit(context.getGraphicsQueue(), 1, &submitInfo, batch.acquireFence) != VK_SUCCESS) {
+        throw std::runtime_error("AssetManager: failed to submit upload acquire");
+    }
+}
+
+void AssetManager::retireBatches() {
+    VkDevice device = context.getDevice();
+    for (size_t i = 0; i < batches.size();) {
+        UploadBatch& batch = batches[i];
+        bool done = false;
+        if (batch.acquireFence != VK_NULL_HANDLE) {
+            done = vkGetFenceStatus(device, batch.acquireFence) == VK_SUCCESS;
+        } else if (vkGetFenceStatus(device, batch.fence) == VK_SUCCESS) {
+            if (batch.semaphore != VK_NULL_HANDLE) {
+                submitAcquire(batch);
+            } else {
+                done = true;
+            }
+            finishUploads(batch);
+        }
+        if (done) {
+            destroyBatch(batch);
+            batches.erase(batches.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void AssetManager::submitBatch() {
+    UploadBatch batch;
+    uint64_t totalBytes = 0;
+    while (!uploadQueue.empty()) {
+        AssetHandle handle = uploadQueue.front();
+        const Asset& asset = assets[handle];
+        if (asset.released) {
+            uploadQueue.pop_front();
+            stats.uploading--;
+            freeAsset(handle);
+            continue;
+        }
+        uint64_t bytes = meshBytes(asset.vertices, asset.indices);
+        if (!batch.handles.empty() && totalBytes + bytes > settings.uploadBudgetBytes) {
+            break;
+        }
+        batch.handles.push_back(handle);
+        uploadQueue.pop_front();
+        totalBytes += bytes;
+    }
+    if (batch.handles.empty()) {
+        return;
+    }
+
+    VkDevice device = context.getDevice();
+    context.createBuffer(totalBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         batch.stagingBuffer, batch.stagingBufferMemory);
+    void* mapped;
+    vkMapMemory(device, batch.stagingBufferMemory, 0, totalBytes, 0, &mapped);
+    batch.commandBuffer = beginCommands(device, context.getTransferCommandPool());
+
+    // Every asset's vertices and indices are packed into the one staging
+    // buffer and copied out of it into the asset's own buffers, each with
+    // the barrier that makes the copy visible to vertex input.
+    std::vector<VkBufferMemoryBarrier> barriers;
+    VkDeviceSize offset = 0;
+    auto stage = [&](const void* source, VkDeviceSize size, VkBufferUsageFlags usage, VkAccessFlags access,
+                     VkBuffer& buffer, VkDeviceMemory& memory) {
+        std::memcpy(static_cast<uint8_t*>(mapped) + offset, source, static_cast<size_t>(size));
+        context.createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                             buffer, memory);
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = offset;
+        copyRegion.size = size;
+        vkCmdCopyBuffer(batch.commandBuffer, batch.stagingBuffer, buffer, 1, &copyRegion);
+        offset += size;
+
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = access;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = buffer;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        barriers.push_back(barrier);
+    };
+    for (AssetHandle handle : batch.handles) {
+        Asset& asset = assets[handle];
+        stage(asset.vertices.data(), asset.vertices.size() * sizeof(Vertex), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+              VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, asset.vertexBuffer, asset.vertexBufferMemory);
+        if (!asset.indices.empty()) {
+            stage(asset.indices.data(), asset.indices.size() * sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                  VK_ACCESS_INDEX_READ_BIT, asset.indexBuffer, asset.indexBufferMemory);
+        }
+    }
+    vkUnmapMemory(device, batch.stagingBufferMemory);
+
+    if (context.getTransferQueue() == context.getGraphicsQueue()) {
+        // One queue: later frames are ordered after the barrier.
+        vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                             0, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
+    } else {
+        // The semaphore carries the copies' writes to the graphics queue.
+        // Buffers are exclusive to one family, so across families the copy
+        // side releases them and the graphics side acquires them with
+        // matching barriers.
+        batch.acquireBarriers = barriers;
+        for (VkBufferMemoryBarrier& barrier : batch.acquireBarriers) {
+            barrier.srcAccessMask = 0;
+        }
+        uint32_t transferFamily = context.getTransferQueueFamily();
+        uint32_t graphicsFamily = context.getGraphicsQueueFamily();
+        if (transferFamily != graphicsFamily) {
+            for (size_t i = 0; i < barriers.size(); i++) {
+                barriers[i].dstAccessMask = 0;
+                barriers[i].srcQueueFamilyIndex = transferFamily;
+                barriers[i].dstQueueFamilyIndex = graphicsFamily;
+                batch.acquireBarriers[i].srcQueueFamilyIndex = transferFamily;
+                batch.acquireBarriers[i].dstQueueFamilyIndex = graphicsFamily;
+            }
+            vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr,
+                                 static_cast<uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
+        }
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &batch.semaphore) != VK_SUCCESS) {
+            throw std::runtime_error("AssetManager: failed to create upload semaphore");
+        }
+    }
+    vkEndCommandBuffer(batch.commandBuffer);
+
+    batch.fence = createFence(device);
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.commandBuffer;
+    if (batch.semaphore != VK_NULL_HANDLE) {
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &batch.semaphore;
+    }
+    if (vkQueueSubmit(context.getTransferQueue(), 1, &submitInfo, batch.fence) != VK_SUCCESS) {
+        throw std::runtime_error("AssetManager: failed to submit upload batch");
+    }
+    stats.batches++;
+    stats.uploadedBytes += totalBytes;
+    batches.push_back(std::move(batch));
+}
+
+void AssetManager::update() {
+    auto start = Clock::now();
+    frame++;
+    uint64_t framesInFlight = static_cast<uint64_t>(context.getMaxFramesInFlight());
+    retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                 [&](const RetiredModel& entry) { return entry.frame + framesInFlight < frame; }),
+                  retired.end());
+    collectLoaded();
+    retireBatches();
+    if (!uploadQueue.empty() && batches.size() < settings.maxBatchesInFlight) {
+        submitBatch();
+    }
+    if (loadingWave && isIdle()) {
+        stats.loadMs = std::chrono::duration<double, std::milli>(Clock::now() - loadStart).count();
+        loadingWave = false;
+    }
+    stats.updateMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    stats.maxUpdateMs = std::max(stats.maxUpdateMs, stats.updateMs);
+}
+
+bool AssetManager::draw(VkCommandBuffer commandBuffer, AssetHandle handle, AssetHandle fallback) const {
+    Model* model = get(handle);
+    if (!model && fallback != NoAsset) {
+        model = get(fallback);
+    }
+    if (!model) {
+        return false;
+    }
+    model->draw(commandBuffer);
+    return true;
+}
+
+bool AssetManager::drawInstanced(VkCommandBuffer commandBuffer, AssetHandle handle, uint32_t instanceCount,
+                                 uint32_t firstInstance, AssetHandle fallback) const {
+    Model* model = get(handle);
+    if (!model && fallback != NoAsset) {
+        model = get(fallback);
+    }
+    if (!model) {
+        return false;
+    }
+    model->drawInstanced(commandBuffer, instanceCount, firstInstance);
+    return true;
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "model.h"
+#include "core/thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class VulkanContext;
+
+using AssetHandle = uint32_t;
+constexpr AssetHandle NoAsset = UINT32_MAX;
+
+enum class AssetState : uint8_t {
+    // Parsing or decoding on the pool.
+    Loading,
+    // CPU data available, waiting for or in an upload batch.
+    Uploading,
+    Ready,
+};
+
+struct AssetSettings {
+    // Vertex and index bytes copied into each upload batch, at most one
+    // batch per update. The oldest waiting asset always goes in, so an
+    // asset bigger than the budget still uploads.
+    size_t uploadBudgetBytes = 16u << 20;
+    // Batches submitted to the GPU and not finished yet; update starts no
+    // new batch beyond this.
+    uint32_t maxBatchesInFlight = 2;
+};
+
+struct AssetStats {
+    // Requests so far, including released ones.
+    uint32_t requested = 0;
+    uint32_t loading = 0;
+    uint32_t uploading = 0;
+    uint32_t ready = 0;
+    uint32_t batches = 0;
+    uint64_t uploadedBytes = 0;
+    // From the first request after the manager was idle until it was idle
+    // again, for the last such wave; 0 before the first one completes.
+    double loadMs = 0.0;
+    double updateMs = 0.0;
+    double maxUpdateMs = 0.0;
+};
+
+// Loads models without blocking the frame loop. Requests return a handle
+// at once; OBJ parsing and copies out of caller memory run on the pool, and
+// update collects the results and uploads them in batches: one staging
+// buffer and one command buffer per batch, submitted to the context's
+// transfer queue with a fence that a later update polls instead of waiting
+// for the queue. When the transfer queue is not the graphics queue, the
+// batch releases its buffers to the graphics family and signals a
+// semaphore; the acquiring half goes to the graphics queue only once the
+// copies are done, so frames never wait on an upload. Until a handle is
+// ready, draw uses the given fallback or draws nothing. Everything but the
+// jobs runs on the thread that calls update, which must be the one
+// recording frames. Give the manager its own pool: a parse job can take
+// longer than a frame, and threads waiting on a shared pool run queued
+// jobs while they wait.
+class AssetManager {
+public:
+    AssetManager(VulkanContext& context, ThreadPool& pool, const AssetSettings& settings = AssetSettings());
+    // Waits for running jobs and batches; queued jobs are skipped. The
+    // caller makes sure no frame in flight still draws the models.
+    ~AssetManager();
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    // The OBJ model's vertices stay available through getVertices.
+    AssetHandle loadModel(const std::string& objPath);
+    // Copies from caller memory (e.g. a mapped level file) on the pool; the
+    // memory must stay valid until the handle is past Loading. No CPU copy
+    // is kept. Indices are checked against vertexCount, so corrupt files
+    // fail in update instead of drawing out of range.
+    AssetHandle loadMesh(const Vertex* vertices, size_t vertexCount, const uint32_t* indices = nullptr,
+                         size_t indexCount = 0);
+    // Generated geometry, queued for upload directly. Kept as the CPU copy
+    // unless keepCpuData is false.
+    AssetHandle loadMesh(std::vector<Vertex> vertices, std::vector<uint32_t> indices = {},
+                         bool keepCpuData = true);
+    // The handle must not be used afterwards; it may be handed out again.
+    // A ready model is destroyed once no frame in flight can draw it, one
+    // still loading or uploading as soon as its job or batch finishes.
+    void release(AssetHandle handle);
+
+    // Once per frame, before recording it. Rethrows errors raised by the
+    // jobs.
+    void update();
+
+    AssetState getState(AssetHandle handle) const { return assets[handle].state; }
+    bool isReady(AssetHandle handle) const { return assets[handle].state == AssetState::Ready; }
+    // Nothing is loading or uploading.
+    bool isIdle() const { return stats.loading == 0 && stats.uploading == 0; }
+    // Null until ready.
+    Model* get(AssetHandle handle) const { return assets[handle].model.get(); }
+    // The kept CPU copy once past Loading; empty before and for meshes
+    // loaded from caller memory.
+    const std::vector<Vertex>& getVertices(AssetHandle handle) const;
+    const std::vector<uint32_t>& getIndices(AssetHandle handle) const;
+
+    // Draw the asset, or the fallback if it is not ready yet and the
+    // fallback is; return false if neither was drawn.
+    bool draw(VkCommandBuffer commandBuffer, AssetHandle handle, AssetHandle fallback = NoAsset) const;
+    bool drawInstanced(VkCommandBuffer commandBuffer, AssetHandle handle, uint32_t instanceCount,
+                       uint32_t firstInstance, AssetHandle fallback = NoAsset) const;
+
+    const AssetStats& getStats() const { return stats; }
+
+private:
+    struct Asset {
+        AssetState state = AssetState::Loading;
+        bool keepCpuData = false;
+        bool released = false;
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        // Filled by an upload batch in flight, adopted by the model.
+        VkBuffer vertexBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
+        VkBuffer indexBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
+        std::unique_ptr<Model> model;
+    };
+
+    struct Loaded {
+        AssetHandle handle;
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    struct UploadBatch {
+        std::vector<AssetHandle> handles;
+        VkBuffer stagingBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+        // The copies, on the transfer queue.
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        // With a separate transfer queue: signaled by the copies and waited
+        // on by the acquire barriers, submitted to the graphics queue.
+        VkSemaphore semaphore = VK_NULL_HANDLE;
+        std::vector<VkBufferMemoryBarrier> acquireBarriers;
+        VkCommandBuffer acquireCommandBuffer = VK_NULL_HANDLE;
+        VkFence acquireFence = VK_NULL_HANDLE;
+    };
+
+    struct RetiredModel {
+        std::unique_ptr<Model> model;
+        uint64_t frame;
+    };
+
+    using Clock = std::chrono::high_resolution_clock;
+
+    AssetHandle addAsset(bool keepCpuData);
+    void freeAsset(AssetHandle handle);
+    template <typename Fn>
+    void startJob(AssetHandle handle, Fn&& load);
+    void collectLoaded();
+    void queueUpload(AssetHandle handle, std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices);
+    void retireBatches();
+    void finishUploads(const UploadBatch& batch);
+    void submitAcquire(UploadBatch& batch);
+    void submitBatch();
+    void destroyBatch(UploadBatch& batch);
+
+    VulkanContext& context;
+    ThreadPool& pool;
+    AssetSettings settings;
+    AssetStats stats;
+
+    // Touched by the calling thread only.
+    std::vector<Asset> assets;
+    std::vector<AssetHandle> freeHandles;
+    std::deque<AssetHandle> uploadQueue;
+    std::vector<UploadBatch> batches;
+    std::vector<RetiredModel> retired;
+    uint64_t frame = 0;
+    bool loadingWave = false;
+    Clock::time_point loadStart;
+
+    // Filled by the jobs.
+    std::mutex loadedMutex;
+    std::vector<Loaded> loaded;
+    std::exception_ptr jobError;
+    std::atomic<bool> stopping{false};
+
+    // Last, so in-flight jobs finish before anything they use is destroyed.
+    TaskGroup jobs;
+};
@@ -9,6 +9,7 @@ public:
     void handleInput(int key, int action);
     glm::mat4 getViewMatrix() const;
     glm::mat4 getProjectionMatrix() const;
+    glm::vec3 getPosition() const { return position; }
 
 private:
     glm::vec3 position;
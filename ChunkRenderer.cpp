@@ -0,0 +1,23 @@
+#include "ChunkRenderer.h"
+#include <algorithm>
+
+ChunkRenderer::ChunkRenderer(AssetManager& assets) : assets(assets) {}
+
+uint32_t ChunkRenderer::upload(MazeMeshChunk&& mesh) {
+    AssetHandle handle = assets.loadMesh(std::move(mesh.vertices), std::move(mesh.indices), false);
+    chunks.push_back(handle);
+    return handle;
+}
+
+void ChunkRenderer::release(uint32_t handle) {
+    auto it = std::find(chunks.begin(), chunks.end(), handle);
+    *it = chunks.back();
+    chunks.pop_back();
+    assets.release(handle);
+}
+
+void ChunkRenderer::draw(VkCommandBuffer commandBuffer) {
+    for (AssetHandle handle : chunks) {
+        assets.draw(commandBuffer, handle);
+    }
+}
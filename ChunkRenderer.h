@@ -0,0 +1,23 @@
+#pragma once
+
+#include "AssetManager.h"
+#include "world/chunk_streamer.h"
+#include <vector>
+
+// Streamed maze chunks as assets: uploads go through the asset manager's
+// batches on the transfer queue, so streaming takes no graphics queue time,
+// and chunks appear once their batch is done. The manager keeps released
+// chunks alive until no frame in flight can draw them.
+class ChunkRenderer : public ChunkUploader {
+public:
+    explicit ChunkRenderer(AssetManager& assets);
+
+    uint32_t upload(MazeMeshChunk&& mesh) override;
+    void release(uint32_t handle) override;
+
+    void draw(VkCommandBuffer commandBuffer);
+
+private:
+    AssetManager& assets;
+    std::vector<AssetHandle> chunks;
+};
@@ -39,12 +39,41 @@ struct Vertex {
     }
 };
 
+// Per-instance model matrix, read from vertex binding 1 at instance rate.
+// The mat4 takes four consecutive attribute locations, one per column.
+struct InstanceData {
+    glm::mat4 model;
+
+    static VkVertexInputBindingDescription getBindingDescription() {
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding = 1;
+        bindingDescription.stride = sizeof(InstanceData);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+        return bindingDescription;
+    }
+
+    static std::array<VkVertexInputAttributeDescription, 4> getAttributeDescriptions() {
+        std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{};
+        for (uint32_t column = 0; column < 4; column++) {
+            attributeDescriptions[column].binding = 1;
+            attributeDescriptions[column].location = 3 + column;
+            attributeDescriptions[column].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+            attributeDescriptions[column].offset = offsetof(InstanceData, model) + sizeof(glm::vec4) * column;
+        }
+        return attributeDescriptions;
+    }
+};
+
 struct UniformBufferObject {
     glm::mat4 model;
     glm::mat4 view;
     glm::mat4 proj;
 };
 
+struct ModelPushConstants {
+    glm::mat4 model;
+};
+
 struct LightUniformBufferObject {
     glm::vec3 lightPos;
     glm::vec3 lightColor;
@@ -69,6 +69,10 @@ void VulkanContext::initVulkan() {
         createUniformBuffers();
         std::cout << "Uniform buffers created successfully" << std::endl;
 
+        std::cout << "Creating instance buffers..." << std::endl;
+        createInstanceBuffers();
+        std::cout << "Instance buffers created successfully" << std::endl;
+
         std::cout << "Creating descriptor pool..." << std::endl;
         createDescriptorPool();
         std::cout << "Descriptor pool created successfully" << std::endl;
@@ -103,6 +107,10 @@ void VulkanContext::initVulkan() {
 }
 
 void VulkanContext::cleanup() {
+    for (size_t i = 0; i < instanceBuffers.size(); i++) {
+        vkDestroyBuffer(device, instanceBuffers[i], nullptr);
+        vkFreeMemory(device, instanceBuffersMemory[i], nullptr);
+    }
     vkDestroyDescriptorPool(device, descriptorPool, nullptr);
     vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
     vkDestroyPipeline(device, graphicsPipeline, nullptr);
@@ -118,6 +126,8 @@ void VulkanContext::cleanup() {
     }
     
     vkDestroySwapchainKHR(device, swapChain, nullptr);
+    vkDestroyCommandPool(device, transferCommandPool, nullptr);
+    vkDestroyCommandPool(device, commandPool, nullptr);
     vkDestroyDevice(device, nullptr);
     vkDestroySurfaceKHR(instance, surface, nullptr);
     vkDestroyInstance(instance, nullptr);
@@ -264,14 +274,34 @@ void VulkanContext::pickPhysicalDevice() {
 }
 
 void VulkanContext::createLogicalDevice() {
-    uint32_t queueFamilyIndex = findQueueFamily(physicalDevice);
-    float queuePriority = 1.0f;
+    graphicsQueueFamily = findQueueFamily(physicalDevice);
+    transferQueueFamily = findTransferQueueFamily(physicalDevice, graphicsQueueFamily);
 
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    // Rendering gets the higher priority. Uploads share the graphics family
+    // only through a second queue, or the graphics queue when the family
+    // has just one.
+    const float queuePriorities[] = {1.0f, 0.5f};
+    uint32_t transferQueueIndex = 0;
+    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     VkDeviceQueueCreateInfo queueCreateInfo{};  
     queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    queueCreateInfo.queueFamilyIndex = queueFamilyIndex;
+    queueCreateInfo.queueFamilyIndex = graphicsQueueFamily;
     queueCreateInfo.queueCount = 1;
-    queueCreateInfo.pQueuePriorities = &queuePriority;
+    queueCreateInfo.pQueuePriorities = queuePriorities;
+    if (transferQueueFamily != graphicsQueueFamily) {
+        queueCreateInfos.push_back(queueCreateInfo);
+        queueCreateInfo.queueFamilyIndex = transferQueueFamily;
+        queueCreateInfo.pQueuePriorities = &queuePriorities[1];
+    } else if (queueFamilies[graphicsQueueFamily].queueCount > 1) {
+        queueCreateInfo.queueCount = 2;
+        transferQueueIndex = 1;
+    }
+    queueCreateInfos.push_back(queueCreateInfo);
 
     const std::vector<const char*> validationLayers = {
         "VK_LAYER_KHRONOS_validation"
@@ -305,8 +335,8 @@ void VulkanContext::createLogicalDevice() {
 
     VkDeviceCreateInfo createInfo{};  
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    createInfo.pQueueCreateInfos = &queueCreateInfo;
-    createInfo.queueCreateInfoCount = 1;
+    createInfo.pQueueCreateInfos = queueCreateInfos.data();
+    createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pEnabledFeatures = &deviceFeatures;
     createInfo.enabledExtensionCount = 1;
     createInfo.ppEnabledExtensionNames = deviceExtensions;
@@ -322,7 +352,14 @@ void VulkanContext::createLogicalDevice() {
         throw std::runtime_error("Failed to create logical device!");
     }
 
-    vkGetDeviceQueue(device, queueFamilyIndex, 0, &graphicsQueue);
+    vkGetDeviceQueue(device, graphicsQueueFamily, 0, &graphicsQueue);
+    vkGetDeviceQueue(device, transferQueueFamily, transferQueueIndex, &transferQueue);
+    if (transferQueue == graphicsQueue) {
+        std::cout << "No separate transfer queue; uploads share the graphics queue" << std::endl;
+    } else {
+        std::cout << "Uploads use queue family " << transferQueueFamily << ", queue " << transferQueueIndex
+                  << " (graphics family " << graphicsQueueFamily << ")" << std::endl;
+    }
 }
 
 void VulkanContext::createSwapChain() {
@@ -594,11 +631,16 @@ void VulkanContext::createGraphicsPipeline() {
     VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
+    std::array<VkVertexInputBindingDescription, 2> bindingDescriptions = {
+        Vertex::getBindingDescription(), InstanceData::getBindingDescription()
+    };
+    auto vertexAttributes = Vertex::getAttributeDescriptions();
+    auto instanceAttributes = InstanceData::getAttributeDescriptions();
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(vertexAttributes.begin(), vertexAttributes.end());
+    attributeDescriptions.insert(attributeDescriptions.end(), instanceAttributes.begin(), instanceAttributes.end());
 
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
     vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
     vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
@@ -661,8 +703,13 @@ void VulkanContext::createGraphicsPipeline() {
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutInfo.setLayoutCount = 1;
     pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-    pipelineLayoutInfo.pPushConstantRanges = nullptr;
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(ModelPushConstants);
+
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
     if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create pipeline layout!");
@@ -706,6 +753,36 @@ uint32_t VulkanContext::findQueueFamily(VkPhysicalDevice device) {
     throw std::runtime_error("Failed to find suitable queue family!");
 }
 
+uint32_t VulkanContext::findTransferQueueFamily(VkPhysicalDevice device, uint32_t graphicsFamily) {
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
+
+    // Transfer-only families are the copy engines of discrete GPUs; then
+    // compute-only families, then any other. Graphics and compute families
+    // can always transfer, whether or not they report it.
+    auto rank = [&](uint32_t family) {
+        VkQueueFlags flags = queueFamilies[family].queueFlags;
+        if (flags & VK_QUEUE_GRAPHICS_BIT) {
+            return 1;
+        }
+        if (flags & VK_QUEUE_COMPUTE_BIT) {
+            return 2;
+        }
+        return (flags & VK_QUEUE_TRANSFER_BIT) ? 3 : 0;
+    };
+    uint32_t best = graphicsFamily;
+    int bestRank = 0;
+    for (uint32_t i = 0; i < queueFamilyCount; i++) {
+        if (i != graphicsFamily && queueFamilies[i].queueCount > 0 && rank(i) > bestRank) {
+            best = i;
+            bestRank = rank(i);
+        }
+    }
+    return best;
+}
+
 void VulkanContext::createSyncObjects() {
     imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
     renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
@@ -770,6 +847,12 @@ VkCommandBuffer VulkanContext::beginRenderPass() {
     vkCmdBindDescriptorSets(commandBuffers[currentFrame], VK_PIPELINE_BIND_POINT_GRAPHICS, 
                           pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
 
+    // Instance 0 is the identity, so plain draws only use the push constant.
+    static_cast<InstanceData*>(instanceBuffersMapped[currentFrame])[0].model = glm::mat4(1.0f);
+    instanceCount = 1;
+    VkDeviceSize instanceOffset = 0;
+    vkCmdBindVertexBuffers(commandBuffers[currentFrame], 1, 1, &instanceBuffers[currentFrame], &instanceOffset);
+
     return commandBuffers[currentFrame];
 }
 
@@ -843,16 +926,20 @@ void VulkanContext::createFramebuffers() {
 }
 
 void VulkanContext::createCommandPool() {
-    uint32_t queueFamilyIndex = findQueueFamily(physicalDevice);
-
     VkCommandPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    poolInfo.queueFamilyIndex = queueFamilyIndex;
+    poolInfo.queueFamilyIndex = graphicsQueueFamily;
     poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
     if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create command pool!");
     }
+
+    poolInfo.queueFamilyIndex = transferQueueFamily;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &transferCommandPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create transfer command pool!");
+    }
 }
 
 void VulkanContext::createCommandBuffers() {
@@ -885,6 +972,22 @@ void VulkanContext::createUniformBuffers() {
     }
 }
 
+void VulkanContext::createInstanceBuffers() {
+    VkDeviceSize bufferSize = sizeof(InstanceData) * MAX_INSTANCES;
+
+    instanceBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    instanceBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+    instanceBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                   instanceBuffers[i], instanceBuffersMemory[i]);
+
+        vkMapMemory(device, instanceBuffersMemory[i], 0, bufferSize, 0, &instanceBuffersMapped[i]);
+    }
+}
+
 void VulkanContext::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, 
                                VkMemoryPropertyFlags properties, VkBuffer& buffer, 
                                VkDeviceMemory& bufferMemory) {
@@ -966,3 +1069,20 @@ void VulkanContext::updateUniformBuffer(const UniformBufferObject& ubo) {
     memcpy(uniformBuffersMapped[currentFrame], &ubo, sizeof(ubo));
 }
 
+void VulkanContext::pushModelMatrix(VkCommandBuffer commandBuffer, const glm::mat4& model) {
+    ModelPushConstants constants{model};
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+}
+
+uint32_t VulkanContext::pushInstances(const std::vector<glm::mat4>& transforms) {
+    if (transforms.size() > MAX_INSTANCES - instanceCount) {
+        throw std::runtime_error("VulkanContext: too many instances this frame");
+    }
+    uint32_t firstInstance = instanceCount;
+    auto* instances = static_cast<InstanceData*>(instanceBuffersMapped[currentFrame]) + firstInstance;
+    for (size_t i = 0; i < transforms.size(); i++) {
+        instances[i].model = transforms[i];
+    }
+    instanceCount += static_cast<uint32_t>(transforms.size());
+    return firstInstance;
+}
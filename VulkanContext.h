@@ -32,16 +32,32 @@ public:
     VkPipeline getGraphicsPipeline() const { return graphicsPipeline; }
     VkQueue getGraphicsQueue() const { return graphicsQueue; }
     VkCommandPool getCommandPool() const { return commandPool; }
+    // Uploads run on the transfer queue so they overlap rendering: a
+    // transfer-only family where the device has one, else another family
+    // or a second graphics queue. With a single queue (e.g. lavapipe) it is
+    // the graphics queue itself. Buffers filled on a different family must
+    // change ownership before the graphics queue reads them.
+    VkQueue getTransferQueue() const { return transferQueue; }
+    VkCommandPool getTransferCommandPool() const { return transferCommandPool; }
+    uint32_t getGraphicsQueueFamily() const { return graphicsQueueFamily; }
+    uint32_t getTransferQueueFamily() const { return transferQueueFamily; }
     VkPhysicalDevice getPhysicalDevice() const { return physicalDevice; }
     VkDescriptorSetLayout getDescriptorSetLayout() const { return descriptorSetLayout; }
     VkDescriptorPool getDescriptorPool() const { return descriptorPool; }
     GLFWwindow* getWindow() const { return window; }
+    int getMaxFramesInFlight() const { return MAX_FRAMES_IN_FLIGHT; }
 
     void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, 
                      VkBuffer& buffer, VkDeviceMemory& bufferMemory);
     void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
 
     void updateUniformBuffer(const UniformBufferObject& ubo);
+    // Per-draw model matrix; the view and projection stay in the UBO.
+    void pushModelMatrix(VkCommandBuffer commandBuffer, const glm::mat4& model);
+    // Copies per-instance model matrices into this frame's instance buffer
+    // and returns the first instance index to draw them with. Valid until
+    // the next beginRenderPass; instance 0 is always the identity.
+    uint32_t pushInstances(const std::vector<glm::mat4>& transforms);
 
 private:
     void createInstance();
@@ -60,7 +76,9 @@ private:
     void createDescriptorPool();
     void createDescriptorSets();
     void createUniformBuffers();
+    void createInstanceBuffers();
     uint32_t findQueueFamily(VkPhysicalDevice device);
+    uint32_t findTransferQueueFamily(VkPhysicalDevice device, uint32_t graphicsFamily);
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
     GLFWwindow* window = nullptr;
@@ -81,6 +99,10 @@ private:
     std::vector<VkFence> inFlightFences;
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
     VkQueue graphicsQueue;
+    VkQueue transferQueue = VK_NULL_HANDLE;
+    uint32_t graphicsQueueFamily = 0;
+    uint32_t transferQueueFamily = 0;
+    VkCommandPool transferCommandPool = VK_NULL_HANDLE;
 
     VkPipeline graphicsPipeline = VK_NULL_HANDLE;
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
@@ -98,4 +120,10 @@ private:
     std::vector<VkBuffer> lightUniformBuffers;
     std::vector<VkDeviceMemory> lightUniformBuffersMemory;
     std::vector<void*> lightUniformBuffersMapped;
+
+    static const uint32_t MAX_INSTANCES = 65536;
+    std::vector<VkBuffer> instanceBuffers;
+    std::vector<VkDeviceMemory> instanceBuffersMemory;
+    std::vector<void*> instanceBuffersMapped;
+    uint32_t instanceCount = 0;
 };
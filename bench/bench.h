@@ -0,0 +1,25 @@
+#pragma once
+
+// Each benchmark receives the arguments following its name on the command line
+// and returns non-zero if one of its correctness checks failed.
+int runBvhBenchmark(int argc, char** argv);
+int runTraversalBenchmark(int argc, char** argv);
+int runPathTracerBenchmark(int argc, char** argv);
+int runPacketBenchmark(int argc, char** argv);
+int runSceneBenchmark(int argc, char** argv);
+int runPhysicsBenchmark(int argc, char** argv);
+int runBroadphaseBenchmark(int argc, char** argv);
+int runNarrowphaseBenchmark(int argc, char** argv);
+int runBallsBenchmark(int argc, char** argv);
+int runHandoffBenchmark(int argc, char** argv);
+int runRollbackBenchmark(int argc, char** argv);
+int runWindBenchmark(int argc, char** argv);
+int runTriggersBenchmark(int argc, char** argv);
+int runMazeBenchmark(int argc, char** argv);
+int runMazeMeshBenchmark(int argc, char** argv);
+int runStreamingBenchmark(int argc, char** argv);
+int runPathfindingBenchmark(int argc, char** argv);
+int runFlowFieldBenchmark(int argc, char** argv);
+int runHierarchyBenchmark(int argc, char** argv);
+int runLevelBenchmark(int argc, char** argv);
+int runCompressionBenchmark(int argc, char** argv);
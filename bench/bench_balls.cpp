@@ -0,0 +1,218 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "core/thread_pool.h"
+#include "physics/physics_world.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr float BallRadius = 0.2f;
+
+struct Scenario {
+    const char* name;
+    TriangleMesh level;
+    std::vector<BodyDesc> balls;
+};
+
+// Two balls per maze cell rolling in random directions: many small islands
+// that merge briefly when balls meet.
+Scenario makeMazeScenario(int ballCount, uint32_t seed) {
+    int cells = std::max(2, static_cast<int>(std::ceil(std::sqrt(ballCount / 2.0))));
+    Scenario scenario{"maze", bench::makeSyntheticMaze(cells, cells, seed), {}};
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < ballCount; i++) {
+        int cell = i / 2;
+        float offset = i % 2 ? 0.7f : 0.3f;
+        BodyDesc desc;
+        desc.radius = BallRadius;
+        desc.position = glm::vec3(cell % cells + offset, BallRadius + 0.01f, cell / cells + offset);
+        float angle = unit(rng) * 6.2831853f;
+        desc.velocity = glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * (unit(rng) * 3.0f);
+        scenario.balls.push_back(desc);
+    }
+    return scenario;
+}
+
+// Balls poured into a walled pit, settling into a few large piles.
+Scenario makePitScenario(int ballCount, uint32_t seed) {
+    int perRow = std::max(2, static_cast<int>(std::ceil(std::sqrt(ballCount / 4.0))));
+    float spacing = BallRadius * 2.5f;
+    float side = perRow * spacing;
+    Scenario scenario{"pit", TriangleMesh(), {}};
+    bench::appendBox(scenario.level, glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(side + 1.0f, 0.0f, side + 1.0f));
+    bench::appendBox(scenario.level, glm::vec3(-1.0f, 0.0f, -1.0f), glm::vec3(0.0f, 4.0f, side + 1.0f));
+    bench::appendBox(scenario.level, glm::vec3(side, 0.0f, -1.0f), glm::vec3(side + 1.0f, 4.0f, side + 1.0f));
+    bench::appendBox(scenario.level, glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(side, 4.0f, 0.0f));
+    bench::appendBox(scenario.level, glm::vec3(0.0f, 0.0f, side), glm::vec3(side, 4.0f, side + 1.0f));
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> jitter(-0.02f, 0.02f);
+    for (int i = 0; i < ballCount; i++) {
+        int layer = i / (perRow * perRow);
+        int slot = i % (perRow * perRow);
+        BodyDesc desc;
+        desc.radius = BallRadius;
+        desc.position = glm::vec3((slot % perRow + 0.5f) * spacing + jitter(rng), 0.5f + layer * spacing,
+                                  (slot / perRow + 0.5f) * spacing + jitter(rng));
+        scenario.balls.push_back(desc);
+    }
+    return scenario;
+}
+
+struct RunResult {
+    double stepsPerSecond = 0.0;
+    double contactsPerStep = 0.0;
+    double ballContactsPerStep = 0.0;
+    double islandsPerStep = 0.0;
+    uint32_t largestIsland = 0;
+    std::vector<RigidBody> finalState;
+};
+
+RunResult simulate(const Scenario& scenario, ThreadPool& pool, int settleSteps, int steps,
+                   const PhysicsSettings& settings = PhysicsSettings()) {
+    PhysicsWorld world(settings, pool);
+    world.setStaticGeometry(scenario.level);
+    for (const auto& desc : scenario.balls) {
+        world.addBody(desc);
+    }
+    for (int i = 0; i < settleSteps; i++) {
+        world.step();
+    }
+
+    RunResult result;
+    uint64_t contacts = 0;
+    uint64_t ballContacts = 0;
+    uint64_t islands = 0;
+    bench::Timer timer;
+    for (int i = 0; i < steps; i++) {
+        world.step();
+        const PhysicsStats& stats = world.getStats();
+        contacts += stats.contactCount;
+        ballContacts += stats.bodyContactCount;
+        islands += stats.islandCount;
+        result.largestIsland = std::max(result.largestIsland, stats.largestIsland);
+    }
+    result.stepsPerSecond = steps / (timer.elapsedMs() / 1000.0);
+    result.contactsPerStep = static_cast<double>(contacts) / steps;
+    result.ballContactsPerStep = static_cast<double>(ballContacts) / steps;
+    result.islandsPerStep = static_cast<double>(islands) / steps;
+    for (uint32_t i = 0; i < world.getBodyCount(); i++) {
+        result.finalState.push_back(world.getBody(i));
+    }
+    return result;
+}
+
+// Deepest overlap between any two balls, relative to the radius.
+float maxOverlap(const std::vector<RigidBody>& bodies) {
+    float deepest = 0.0f;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        for (size_t j = i + 1; j < bodies.size(); j++) {
+            float gap = glm::length(bodies[i].position - bodies[j].position) - bodies[i].radius - bodies[j].radius;
+            deepest = std::max(deepest, -gap / bodies[i].radius);
+        }
+    }
+    return deepest;
+}
+
+bool report(const Scenario& scenario, ThreadPool& serialPool, ThreadPool& parallelPool, int steps) {
+    const int settleSteps = 60;
+    RunResult serial = simulate(scenario, serialPool, settleSteps, steps);
+    RunResult parallel = simulate(scenario, parallelPool, settleSteps, steps);
+    bool identical = std::memcmp(serial.finalState.data(), parallel.finalState.data(),
+                                 serial.finalState.size() * sizeof(RigidBody)) == 0;
+    std::printf("%-6s %6zu %8zu %10.0f %10.0f %7.2f %9.0f %9.0f %8.0f %8u %8.3f %10s\n", scenario.name,
+                scenario.balls.size(), scenario.level.size(), serial.stepsPerSecond, parallel.stepsPerSecond,
+                parallel.stepsPerSecond / serial.stepsPerSecond, parallel.contactsPerStep,
+                parallel.ballContactsPerStep, parallel.islandsPerStep, parallel.largestIsland,
+                maxOverlap(parallel.finalState), identical ? "yes" : "NO");
+    return identical;
+}
+
+// Lets the balls come to rest, then compares stepping with and without
+// sleeping and checks that an impulse wakes a sleeping ball's island.
+bool reportSleep(const Scenario& scenario, ThreadPool& pool, int settleSteps, int steps) {
+    PhysicsSettings awake;
+    awake.allowSleeping = false;
+    RunResult always = simulate(scenario, pool, settleSteps, steps, awake);
+
+    PhysicsWorld world(PhysicsSettings(), pool);
+    world.setStaticGeometry(scenario.level);
+    for (const auto& desc : scenario.balls) {
+        world.addBody(desc);
+    }
+    for (int i = 0; i < settleSteps; i++) {
+        world.step();
+    }
+    double ms = 0.0;
+    double savedMs = 0.0;
+    for (int i = 0; i < steps; i++) {
+        world.step();
+        ms += world.getStats().stepMs;
+        savedMs += world.getStats().sleepSavedMs;
+    }
+    PhysicsStats rest = world.getStats();
+
+    // Wake the last ball with an upward kick; everything that fell asleep
+    // with it (its pile, in the pit) wakes too.
+    uint32_t kicked = world.getBodyCount() - 1;
+    bool wasSleeping = world.isSleeping(kicked);
+    world.applyImpulse(kicked, glm::vec3(0.0f, 2.0f, 0.0f));
+    world.step();
+    uint32_t woken = world.getStats().activeBodyCount - rest.activeBodyCount;
+
+    std::printf("%-6s %6zu %8u %9u %10.0f %10.0f %10.3f %10.3f %7s %7u\n", scenario.name, scenario.balls.size(),
+                rest.activeBodyCount, rest.sleepingBodyCount, always.stepsPerSecond, steps / (ms / 1000.0),
+                ms / steps, savedMs / steps, wasSleeping ? "yes" : "no", woken);
+    return !wasSleeping || woken > 0;
+}
+
+} // namespace
+
+// Usage: MazeBench balls [maxBalls] [steps]
+// Steps per second against ball count on one thread and on the global
+// pool, with ball-ball contacts and island sizes per step. Runs on both
+// pools must match bit for bit, or the benchmark fails. Overlap is the deepest ball-ball
+// penetration at the end, as a fraction of the radius. The sleep table
+// runs after the balls have had time to settle (10 seconds in the maze, 30
+// in the pit, whose piles take longest): steps/s without and with sleeping,
+// the measured step time and the estimated time saved by sleeping bodies,
+// and how many bodies one impulse on a sleeping ball wakes (failing if
+// none).
+int runBallsBenchmark(int argc, char** argv) {
+    int maxBalls = bench::intArg(argc, argv, 0, 8000);
+    int steps = bench::intArg(argc, argv, 1, 120);
+
+    ThreadPool serialPool(1);
+    ThreadPool& parallelPool = ThreadPool::global();
+    bool passed = true;
+    std::printf("%u threads\n\n", parallelPool.getThreadCount());
+    std::printf("%-6s %6s %8s %10s %10s %7s %9s %9s %8s %8s %8s %10s\n", "level", "balls", "tris", "1 thread",
+                "pool", "speedup", "contacts", "ball-ball", "islands", "largest", "overlap", "identical");
+    for (int balls : {100, 250, 500, 1000, 2000, 4000, 8000, 16000}) {
+        if (balls <= maxBalls) {
+            passed = report(makeMazeScenario(balls, 11u), serialPool, parallelPool, steps) && passed;
+        }
+    }
+    for (int balls : {100, 500, 2000, 8000}) {
+        if (balls <= maxBalls) {
+            passed = report(makePitScenario(balls, 11u), serialPool, parallelPool, steps) && passed;
+        }
+    }
+
+    std::printf("\n%-6s %6s %8s %9s %10s %10s %10s %10s %7s %7s\n", "level", "balls", "active", "sleeping",
+                "no sleep", "sleep", "step ms", "saved ms", "asleep", "woken");
+    for (int balls : {500, 2000}) {
+        if (balls <= maxBalls) {
+            passed = reportSleep(makeMazeScenario(balls, 11u), parallelPool, 1200, steps) && passed;
+        }
+    }
+    if (500 <= maxBalls) {
+        passed = reportSleep(makePitScenario(500, 11u), parallelPool, 3600, steps) && passed;
+    }
+    return passed ? 0 : 1;
+}
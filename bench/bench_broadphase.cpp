@@ -0,0 +1,141 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "physics/physics_world.h"
+#include "physics/uniform_grid.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr float BallRadius = 0.25f;
+constexpr float TimeStep = 1.0f / 120.0f;
+
+struct Sweep {
+    glm::vec3 from;
+    glm::vec3 to;
+};
+
+// Balls resting on the floor at random spots, moving up to 8 m/s.
+std::vector<Sweep> makeSweeps(const Aabb& level, size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<Sweep> sweeps(count);
+    for (auto& sweep : sweeps) {
+        sweep.from = glm::vec3(level.min.x + unit(rng) * level.extent().x, BallRadius,
+                               level.min.z + unit(rng) * level.extent().z);
+        float angle = unit(rng) * 6.2831853f;
+        float speed = unit(rng) * 8.0f;
+        sweep.to = sweep.from + glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * (speed * TimeStep);
+    }
+    return sweeps;
+}
+
+void reportGrid(int cells, int queries) {
+    TriangleMesh level = bench::makeSyntheticMaze(cells, cells, 5u);
+    const std::vector<Triangle>& triangles = level.getTriangles();
+    UniformGrid grid;
+    grid.build(triangles, UniformGrid::suggestCellSize(triangles, BallRadius));
+    const UniformGridStats& stats = grid.getStats();
+
+    std::vector<Sweep> sweeps = makeSweeps(level.bounds(), queries, 7u);
+    std::vector<uint32_t> candidates;
+    uint64_t total = 0;
+    bench::Timer timer;
+    for (const auto& sweep : sweeps) {
+        grid.querySweptSphere(sweep.from, sweep.to, BallRadius, candidates);
+        total += candidates.size();
+    }
+    double sweptNs = timer.elapsedMs() * 1e6 / queries;
+
+    timer.reset();
+    for (const auto& sweep : sweeps) {
+        Aabb box;
+        box.grow(sweep.from - glm::vec3(BallRadius));
+        box.grow(sweep.to + glm::vec3(BallRadius));
+        grid.query(box, candidates);
+        total += candidates.size();
+    }
+    double boxNs = timer.elapsedMs() * 1e6 / queries;
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "%dx%d", cells, cells);
+    std::printf("%-10s %10zu %5.2f %11u %11llu %8.1f %9.1f %9.1f %9.1f %11.1f\n", name, level.size(),
+                grid.getCellSize(), stats.cellsX * stats.cellsZ, static_cast<unsigned long long>(stats.references),
+                stats.memoryBytes / (1024.0 * 1024.0), stats.buildMs, sweptNs, boxNs,
+                static_cast<double>(total) / (2.0 * queries));
+}
+
+struct PhysicsRun {
+    double stepsPerSecond;
+    std::vector<RigidBody> finalState;
+};
+
+PhysicsRun simulate(const TriangleMesh& level, bool broadphase, int balls, int steps) {
+    PhysicsSettings settings;
+    settings.staticBroadphase = broadphase;
+    PhysicsWorld world(settings);
+    world.setStaticGeometry(level);
+    Aabb bounds = level.bounds();
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(balls))));
+    for (int i = 0; i < balls; i++) {
+        BodyDesc desc;
+        desc.radius = BallRadius;
+        desc.position = glm::vec3(bounds.min.x + (i % side + 0.5f) / side * bounds.extent().x, BallRadius * 2.0f,
+                                  bounds.min.z + (i / side + 0.5f) / side * bounds.extent().z);
+        float angle = i * 2.39996323f;
+        desc.velocity = glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * 2.0f;
+        world.addBody(desc);
+    }
+
+    bench::Timer timer;
+    for (int i = 0; i < steps; i++) {
+        world.step();
+    }
+    PhysicsRun run;
+    run.stepsPerSecond = steps / (timer.elapsedMs() / 1000.0);
+    for (uint32_t i = 0; i < world.getBodyCount(); i++) {
+        run.finalState.push_back(world.getBody(i));
+    }
+    return run;
+}
+
+} // namespace
+
+// Usage: MazeBench broadphase [maxCells] [queries]
+// Grid query cost should stay flat while the maze grows by four orders of
+// magnitude; the physics table checks the grid gives the same simulation as
+// testing every triangle.
+int runBroadphaseBenchmark(int argc, char** argv) {
+    int maxCells = bench::intArg(argc, argv, 0, 1000);
+    int queries = bench::intArg(argc, argv, 1, 200000);
+
+    std::printf("%-10s %10s %5s %11s %11s %8s %9s %9s %9s %11s\n", "maze", "tris", "cell", "grid cells",
+                "references", "MB", "build ms", "swept ns", "box ns", "candidates");
+    for (int cells : {10, 30, 100, 300, 1000}) {
+        if (cells <= maxCells) {
+            reportGrid(cells, queries);
+        }
+    }
+
+    const int balls = 16;
+    const int steps = 600;
+    std::printf("\n%-10s %6s %13s %13s %10s\n", "maze", "balls", "brute steps/s", "grid steps/s", "identical");
+    for (int cells : {10, 30, 100}) {
+        if (cells > maxCells) {
+            continue;
+        }
+        TriangleMesh level = bench::makeSyntheticMaze(cells, cells, 5u);
+        PhysicsRun brute = simulate(level, false, balls, steps);
+        PhysicsRun grid = simulate(level, true, balls, steps);
+        bool identical = std::memcmp(brute.finalState.data(), grid.finalState.data(),
+                                     brute.finalState.size() * sizeof(RigidBody)) == 0;
+        char name[64];
+        std::snprintf(name, sizeof(name), "%dx%d", cells, cells);
+        std::printf("%-10s %6d %13.0f %13.0f %10s\n", name, balls, brute.stepsPerSecond, grid.stepsPerSecond,
+                    identical ? "yes" : "NO");
+    }
+    return 0;
+}
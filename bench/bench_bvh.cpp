@@ -0,0 +1,56 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "bvh/bvh.h"
+#include "core/thread_pool.h"
+#include <cstdio>
+#include <thread>
+
+namespace {
+
+void reportBuild(const char* label, const TriangleMesh& mesh, ThreadPool& pool, int repeats) {
+    Bvh bvh;
+    double bestMs = 0.0;
+    for (int i = 0; i < repeats; i++) {
+        bvh.build(mesh, pool);
+        if (i == 0 || bvh.getStats().buildMs < bestMs) {
+            bestMs = bvh.getStats().buildMs;
+        }
+    }
+
+    const BvhBuildStats& stats = bvh.getStats();
+    std::printf("%-22s %10zu %8u %9.2f %8.2f %9u %8u %9.2f\n",
+                label, mesh.size(), pool.getThreadCount(), bestMs,
+                mesh.size() / (bestMs * 1000.0), stats.nodeCount, stats.maxDepth, stats.sahCost);
+}
+
+} // namespace
+
+// Usage: MazeBench bvh [maxCells] [repeats]
+int runBvhBenchmark(int argc, char** argv) {
+    int maxCells = bench::intArg(argc, argv, 0, 420);
+    int repeats = bench::intArg(argc, argv, 1, 3);
+
+    unsigned hardwareThreads = std::thread::hardware_concurrency();
+    ThreadPool serialPool(1);
+    ThreadPool& parallelPool = ThreadPool::global();
+
+    std::printf("%-22s %10s %8s %9s %8s %9s %8s %9s\n",
+                "mesh", "tris", "threads", "build ms", "Mtris/s", "nodes", "depth", "sah");
+
+    TriangleMesh maze = TriangleMesh::loadObj(bench::assetPath("models/maze.obj"));
+    reportBuild("maze.obj", maze, serialPool, repeats);
+
+    for (int cells : {32, 100, 300, 420, 1000}) {
+        if (cells > maxCells) {
+            break;
+        }
+        TriangleMesh mesh = bench::makeSyntheticMaze(cells, cells, 1234u);
+        char label[64];
+        std::snprintf(label, sizeof(label), "synthetic %dx%d", cells, cells);
+        reportBuild(label, mesh, serialPool, repeats);
+        if (hardwareThreads > 1) {
+            reportBuild(label, mesh, parallelPool, repeats);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "bench_common.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+std::string assetPath(const std::string& relativePath) {
+    const char* assetDir = std::getenv("MAZE_ASSET_DIR");
+    std::string root = assetDir ? assetDir : MAZE_SOURCE_DIR;
+    return root + "/" + relativePath;
+}
+
+void appendBox(TriangleMesh& mesh, const glm::vec3& a, const glm::vec3& b) {
+    glm::vec3 c[8] = {
+        {a.x, a.y, a.z}, {b.x, a.y, a.z}, {b.x, b.y, a.z}, {a.x, b.y, a.z},
+        {a.x, a.y, b.z}, {b.x, a.y, b.z}, {b.x, b.y, b.z}, {a.x, b.y, b.z},
+    };
+    static const int faces[6][4] = {
+        {0, 3, 2, 1}, {4, 5, 6, 7}, {0, 4, 7, 3}, {1, 2, 6, 5}, {0, 1, 5, 4}, {3, 7, 6, 2},
+    };
+    for (const auto& f : faces) {
+        mesh.append(Triangle{c[f[0]], c[f[1]], c[f[2]]});
+        mesh.append(Triangle{c[f[0]], c[f[2]], c[f[3]]});
+    }
+}
+
+TriangleMesh makeSyntheticMaze(int cellsX, int cellsZ, uint32_t seed,
+                               float cellSize, float wallHeight, float wallThickness) {
+    uint32_t state = seed ? seed : 1u;
+    auto nextRandom = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    };
+
+    TriangleMesh mesh;
+    mesh.reserve(static_cast<size_t>(cellsX) * cellsZ * 12 + 2);
+
+    float width = cellsX * cellSize;
+    float depth = cellsZ * cellSize;
+    appendBox(mesh, {0.0f, -0.1f, 0.0f}, {width, 0.0f, depth});
+
+    float half = wallThickness * 0.5f;
+    for (int z = 0; z <= cellsZ; z++) {
+        for (int x = 0; x <= cellsX; x++) {
+            bool border = x == cellsX || z == cellsZ || x == 0 || z == 0;
+            float px = x * cellSize;
+            float pz = z * cellSize;
+            // Wall along +x from this grid corner.
+            if (x < cellsX && (z == 0 || z == cellsZ || (nextRandom() & 1))) {
+                appendBox(mesh, {px - half, 0.0f, pz - half}, {px + cellSize + half, wallHeight, pz + half});
+            }
+            // Wall along +z from this grid corner.
+            if (z < cellsZ && (x == 0 || x == cellsX || (!border && (nextRandom() & 1)))) {
+                appendBox(mesh, {px - half, 0.0f, pz - half}, {px + half, wallHeight, pz + cellSize + half});
+            }
+        }
+    }
+    return mesh;
+}
+
+std::vector<Ray> makeCoherentRays(const Aabb& bounds, int width, int height) {
+    glm::vec3 center = bounds.center();
+    glm::vec3 extent = bounds.extent();
+    glm::vec3 eye = center + glm::vec3(0.0f, std::max(extent.x, extent.z) * 0.6f, extent.z * 0.6f);
+    glm::vec3 forward = glm::normalize(center - eye);
+    glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3(0.0f, 1.0f, 0.0f)));
+    glm::vec3 up = glm::cross(right, forward);
+
+    std::vector<Ray> rays;
+    rays.reserve(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            float sx = (2.0f * (x + 0.5f) / width - 1.0f) * 0.8f;
+            float sy = (2.0f * (y + 0.5f) / height - 1.0f) * 0.6f;
+            Ray ray;
+            ray.origin = eye;
+            ray.direction = glm::normalize(forward + right * sx + up * sy);
+            rays.push_back(ray);
+        }
+    }
+    return rays;
+}
+
+std::vector<Ray> makeIncoherentRays(const Aabb& bounds, size_t count, uint32_t seed) {
+    uint32_t state = seed;
+    auto uniform = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) * (1.0f / 16777216.0f);
+    };
+
+    std::vector<Ray> rays;
+    rays.reserve(count);
+    glm::vec3 extent = bounds.extent();
+    while (rays.size() < count) {
+        glm::vec3 d(uniform() * 2.0f - 1.0f, uniform() * 2.0f - 1.0f, uniform() * 2.0f - 1.0f);
+        float lengthSquared = glm::dot(d, d);
+        if (lengthSquared < 1e-4f || lengthSquared > 1.0f) {
+            continue;
+        }
+        Ray ray;
+        ray.origin = bounds.min + glm::vec3(uniform(), 0.5f + uniform() * 0.5f, uniform()) * extent;
+        ray.direction = d / std::sqrt(lengthSquared);
+        rays.push_back(ray);
+    }
+    return rays;
+}
+
+int intArg(int argc, char** argv, int index, int fallback) {
+    if (index < argc) {
+        return std::atoi(argv[index]);
+    }
+    return fallback;
+}
+
+uint64_t pageFaults() {
+#if defined(_WIN32)
+    return 0;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<uint64_t>(usage.ru_minflt) + static_cast<uint64_t>(usage.ru_majflt);
+#endif
+}
+
+bool evictFromPageCache(const std::string& path) {
+#if defined(_WIN32)
+    return false;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool evicted = fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return evicted;
+#endif
+}
+
+} // namespace bench
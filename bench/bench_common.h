@@ -0,0 +1,51 @@
+#pragma once
+
+#include "bvh/ray.h"
+#include "bvh/triangle_mesh.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+class Timer {
+public:
+    Timer() : start(std::chrono::high_resolution_clock::now()) {}
+
+    void reset() { start = std::chrono::high_resolution_clock::now(); }
+
+    double elapsedMs() const {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::high_resolution_clock::time_point start;
+};
+
+// Path of models/maze.obj relative to the source tree, overridable with
+// the MAZE_ASSET_DIR environment variable.
+std::string assetPath(const std::string& relativePath);
+
+// Random grid maze made of box walls (12 triangles each), used to stress
+// the spatial structures with arbitrarily large levels.
+TriangleMesh makeSyntheticMaze(int cellsX, int cellsZ, uint32_t seed,
+                               float cellSize = 1.0f, float wallHeight = 1.0f, float wallThickness = 0.1f);
+
+void appendBox(TriangleMesh& mesh, const glm::vec3& minCorner, const glm::vec3& maxCorner);
+
+// Pinhole camera over the level: neighbouring rays share most of their path.
+std::vector<Ray> makeCoherentRays(const Aabb& bounds, int width, int height);
+// Random origins inside the level with random directions, like diffuse bounces.
+std::vector<Ray> makeIncoherentRays(const Aabb& bounds, size_t count, uint32_t seed);
+
+int intArg(int argc, char** argv, int index, int fallback);
+
+// Minor plus major page faults of the process so far; 0 where unsupported.
+uint64_t pageFaults();
+// Drops the file from the page cache where the OS allows it, so the next
+// read comes from disk like on a first launch. Returns false otherwise.
+bool evictFromPageCache(const std::string& path);
+
+} // namespace bench
@@ -0,0 +1,181 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "core/thread_pool.h"
+#include "level/level_file.h"
+#include "maze/maze_generator.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Variant {
+    const char* name;
+    LevelCompression compression;
+    int level;
+};
+
+struct SectionGroup {
+    const char* name;
+    std::vector<LevelSection> sections;
+};
+
+uint64_t hashBytes(const std::vector<uint8_t>& bytes) {
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i + 8 <= bytes.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes.data() + i, 8);
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    return hash;
+}
+
+struct ReadReport {
+    double ms = 0.0;
+    uint64_t hash = 0;
+};
+
+// Opens the file deferring every section it can and reads all of them into
+// one staging buffer: page faults for stored sections, decompression
+// straight into place for compressed ones.
+ReadReport readAll(const std::string& path, ThreadPool& pool, std::vector<uint8_t>& staging) {
+    bench::Timer timer;
+    LevelFile level(path, pool, ~0u);
+    size_t offset = 0;
+    for (uint32_t type = 0; type < static_cast<uint32_t>(LevelSection::Count); type++) {
+        uint64_t bytes = level.getSectionBytes(static_cast<LevelSection>(type));
+        staging.resize(std::max(staging.size(), offset + bytes));
+        level.readSection(static_cast<LevelSection>(type), staging.data() + offset, pool);
+        offset += bytes;
+    }
+    ReadReport report;
+    report.ms = timer.elapsedMs();
+    report.hash = hashBytes(staging);
+    return report;
+}
+
+} // namespace
+
+// Usage: MazeBench compression [size] [blockKB]
+// Compressed level sections: the level of a size^2 maze (meshes, collision
+// data, broadphase grid and BVH) is written stored as is, with fast LZ4
+// and with high-compression LZ4, in blocks of blockKB. First the ratio per
+// kind of data; then the time to get every section into a staging buffer
+// from a cold page cache (where the OS allows evicting it) and a warm
+// one, on one thread and on the pool. Stored sections are read through
+// the mapping, compressed ones decompressed block by block straight into
+// the buffer. GB/s is of decompressed bytes. Every variant must produce
+// the same bytes, or the benchmark fails.
+int runCompressionBenchmark(int argc, char** argv) {
+    uint32_t size = static_cast<uint32_t>(bench::intArg(argc, argv, 0, 512));
+    uint32_t blockSize = static_cast<uint32_t>(bench::intArg(argc, argv, 1, 256)) * 1024;
+
+    ThreadPool serialPool(1);
+    ThreadPool& pool = ThreadPool::global();
+    MazeGrid maze = generateMaze(size, size, MazeAlgorithm::Eller, 21u);
+    MazeMeshSettings meshSettings;
+    meshSettings.origin = glm::vec3(-0.5f * size, 0.0f, -0.5f * size);
+    LevelContent content = buildLevelContent(maze, meshSettings, 0.2f, pool);
+
+    const Variant variants[] = {
+        {"stored (mmap)", LevelCompression::None, 0},
+        {"LZ4 fast", LevelCompression::Lz4, 0},
+        {"LZ4 high", LevelCompression::Lz4, 9},
+    };
+    const size_t variantCount = sizeof(variants) / sizeof(variants[0]);
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::vector<std::string> paths;
+    std::vector<double> writeMs;
+    for (const Variant& variant : variants) {
+        LevelWriteSettings settings;
+        settings.compression = variant.compression;
+        settings.compressionLevel = variant.level;
+        settings.blockSize = blockSize;
+        paths.push_back((directory / ("mazebench_" + std::to_string(paths.size()) + ".mzlevel")).string());
+        bench::Timer timer;
+        writeLevelFile(paths.back(), content, settings, pool);
+        writeMs.push_back(timer.elapsedMs());
+    }
+
+    std::printf("%ux%u maze level, %u KB blocks, %u threads\n\n", size, size, blockSize / 1024,
+                pool.getThreadCount());
+    const SectionGroup groups[] = {
+        {"maze walls", {LevelSection::MazeEastWalls, LevelSection::MazeSouthWalls}},
+        {"mesh vertices", {LevelSection::MeshVertices}},
+        {"mesh indices", {LevelSection::MeshIndices}},
+        {"collision", {LevelSection::CollisionTriangles}},
+        {"broadphase", {LevelSection::BroadphaseCellStart, LevelSection::BroadphaseCellTriangles}},
+        {"BVH nodes", {LevelSection::BvhNodes}},
+        {"BVH triangles", {LevelSection::BvhTriangles, LevelSection::BvhPrimitiveIds}},
+    };
+    std::vector<LevelFile> files;
+    for (const std::string& path : paths) {
+        files.emplace_back(path, serialPool, ~0u);
+    }
+    std::printf("%-16s %10s", "section", "MB");
+    for (size_t v = 1; v < variantCount; v++) {
+        std::printf(" %12s", variants[v].name);
+    }
+    std::printf("\n");
+    for (const SectionGroup& group : groups) {
+        uint64_t raw = 0;
+        std::vector<uint64_t> stored(variantCount, 0);
+        for (LevelSection section : group.sections) {
+            raw += files[0].getSectionBytes(section);
+            for (size_t v = 0; v < variantCount; v++) {
+                stored[v] += files[v].getStoredBytes(section);
+            }
+        }
+        std::printf("%-16s %10.1f", group.name, raw / (1024.0 * 1024.0));
+        for (size_t v = 1; v < variantCount; v++) {
+            std::printf(" %11.2fx", stored[v] ? static_cast<double>(raw) / stored[v] : 0.0);
+        }
+        std::printf("\n");
+    }
+    std::printf("%-16s %10.1f", "whole file", files[0].getFileSize() / (1024.0 * 1024.0));
+    for (size_t v = 1; v < variantCount; v++) {
+        std::printf(" %11.2fx", static_cast<double>(files[0].getFileSize()) / files[v].getFileSize());
+    }
+    std::printf("\n\n");
+
+    uint64_t rawBytes = 0;
+    for (uint32_t type = 0; type < static_cast<uint32_t>(LevelSection::Count); type++) {
+        rawBytes += files[0].getSectionBytes(static_cast<LevelSection>(type));
+    }
+    size_t fileSizes[variantCount];
+    for (size_t v = 0; v < variantCount; v++) {
+        fileSizes[v] = files[v].getFileSize();
+    }
+    files.clear();
+
+    std::printf("%-14s %9s %9s %10s %7s %10s %7s %10s %7s\n", "variant", "file MB", "write ms", "cold ms", "GB/s",
+                "warm 1T ms", "GB/s", "warm ms", "GB/s");
+    std::vector<uint8_t> staging;
+    uint64_t expectedHash = 0;
+    bool matches = true;
+    bool cold = true;
+    auto gbps = [&](double ms) { return rawBytes / (ms * 1e6); };
+    for (size_t v = 0; v < variantCount; v++) {
+        cold = bench::evictFromPageCache(paths[v]) && cold;
+        ReadReport coldRead = readAll(paths[v], serialPool, staging);
+        ReadReport serialRead = readAll(paths[v], serialPool, staging);
+        ReadReport poolRead = readAll(paths[v], pool, staging);
+        if (v == 0) {
+            expectedHash = coldRead.hash;
+        }
+        matches = matches && coldRead.hash == expectedHash && serialRead.hash == expectedHash &&
+                  poolRead.hash == expectedHash;
+        std::printf("%-14s %9.1f %9.1f %10.1f %7.2f %10.1f %7.2f %10.1f %7.2f\n", variants[v].name,
+                    fileSizes[v] / (1024.0 * 1024.0), writeMs[v], coldRead.ms, gbps(coldRead.ms), serialRead.ms,
+                    gbps(serialRead.ms), poolRead.ms, gbps(poolRead.ms));
+    }
+    std::printf("\n%s; decompressed sections %s\n", cold ? "cold reads from disk" : "page cache could not be evicted",
+                matches ? "match" : "DIFFER");
+
+    for (const std::string& path : paths) {
+        std::filesystem::remove(path);
+    }
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,254 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "core/thread_pool.h"
+#include "maze/maze_generator.h"
+#include "maze/maze_mesher.h"
+#include "nav/flow_steering.h"
+#include "nav/maze_pathfinder.h"
+#include "physics/physics_world.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+uint32_t randomOpenNeighbour(const MazeGrid& grid, uint32_t cell, std::mt19937& rng) {
+    uint32_t width = grid.getWidth();
+    uint32_t x = cell % width;
+    uint32_t z = cell / width;
+    uint32_t options[4];
+    int count = 0;
+    if (!grid.hasEastWall(x, z)) {
+        options[count++] = cell + 1;
+    }
+    if (!grid.hasSouthWall(x, z)) {
+        options[count++] = cell + width;
+    }
+    if (!grid.hasWestWall(x, z)) {
+        options[count++] = cell - 1;
+    }
+    if (!grid.hasNorthWall(x, z)) {
+        options[count++] = cell - width;
+    }
+    return count ? options[rng() % count] : cell;
+}
+
+bool sameDirections(const FlowField& a, const FlowField& b, uint64_t cellCount) {
+    for (uint64_t cell = 0; cell < cellCount; cell++) {
+        if (a.getDirection(static_cast<uint32_t>(cell)) != b.getDirection(static_cast<uint32_t>(cell))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Field maintenance on a large maze: full builds, the target walking cell
+// to cell, and what per-agent A* would cost instead.
+bool reportField(const char* name, const MazeGrid& grid, int agentCount, ThreadPool& serialPool,
+                 ThreadPool& parallelPool) {
+    std::mt19937 rng(21u);
+    uint32_t target = static_cast<uint32_t>(grid.getCellCount() / 2 + grid.getWidth() / 2);
+
+    FlowField field;
+    bench::Timer timer;
+    field.build(grid, target, serialPool);
+    double serialMs = timer.elapsedMs();
+    timer.reset();
+    field.build(grid, target, parallelPool);
+    double poolMs = timer.elapsedMs();
+
+    const int moves = field.isTree() ? 10000 : 20;
+    double moveMs = 0.0;
+    double maxMoveMs = 0.0;
+    for (int i = 0; i < moves; i++) {
+        target = randomOpenNeighbour(grid, target, rng);
+        field.setTarget(grid, target, parallelPool);
+        moveMs += field.getStats().updateMs;
+        maxMoveMs = std::max(maxMoveMs, field.getStats().updateMs);
+    }
+
+    // A far jump re-roots along the whole path between the two targets.
+    uint32_t far = static_cast<uint32_t>(rng() % grid.getCellCount());
+    field.setTarget(grid, far, parallelPool);
+    double jumpMs = field.getStats().updateMs;
+    uint64_t jumpCells = field.getStats().changedCells;
+
+    FlowField fresh;
+    fresh.build(grid, far, parallelPool);
+    bool matches = sameDirections(field, fresh, grid.getCellCount());
+
+    // Agents spread over the maze: one A* each per target move, against one
+    // target step and a lookup each.
+    std::uniform_int_distribution<uint32_t> anyCell(0, static_cast<uint32_t>(grid.getCellCount() - 1));
+    MazePathfinder pathfinder(grid);
+    std::vector<uint32_t> path;
+    const int sampledQueries = 10;
+    timer.reset();
+    for (int i = 0; i < sampledQueries; i++) {
+        pathfinder.findPathAStar(anyCell(rng), far, path);
+    }
+    double aStarMs = timer.elapsedMs() / sampledQueries * agentCount;
+    uint64_t checksum = 0;
+    timer.reset();
+    for (int i = 0; i < agentCount; i++) {
+        checksum += field.nextCell(anyCell(rng));
+    }
+    double lookupMs = timer.elapsedMs();
+
+    std::printf("%-12s build %.1f ms (1 thread) / %.1f ms (pool), %.1f MB, %s\n", name, serialMs, poolMs,
+                field.memoryBytes() / (1024.0 * 1024.0), field.isTree() ? "re-rooted" : "rebuilt on every move");
+    std::printf("%-12s target step: %.4f ms mean, %.4f ms max over %d moves; jump: %.3f ms, %llu cells; "
+                "matches a fresh build: %s\n",
+                "", moveMs / moves, maxMoveMs, moves, jumpMs, static_cast<unsigned long long>(jumpCells),
+                matches ? "yes" : "NO");
+    std::printf("%-12s %d agents per target move: A* %.1f ms (estimated from %d queries) vs field %.3f ms "
+                "(checksum %llu)\n",
+                "", agentCount, aStarMs, sampledQueries, moveMs / moves + lookupMs,
+                static_cast<unsigned long long>(checksum));
+    return matches;
+}
+
+// Moves the target cell by cell along shortest paths to random cells.
+class TargetWalker {
+public:
+    TargetWalker(const MazeGrid& grid, uint32_t start, uint32_t seed)
+        : grid(grid), pathfinder(grid), rng(seed), cell(start) {}
+
+    glm::vec3 advance(float distance, float cellSize) {
+        progress += distance / cellSize;
+        while (progress >= 1.0f) {
+            progress -= 1.0f;
+            if (next + 1 >= path.size()) {
+                std::uniform_int_distribution<uint32_t> anyCell(0, static_cast<uint32_t>(grid.getCellCount() - 1));
+                pathfinder.findPathAStar(cell, anyCell(rng), path);
+                next = 0;
+            }
+            if (next + 1 < path.size()) {
+                cell = path[++next];
+            }
+        }
+        float x = (cell % grid.getWidth() + 0.5f) * cellSize;
+        float z = (cell / grid.getWidth() + 0.5f) * cellSize;
+        return glm::vec3(x, 0.25f, z);
+    }
+
+private:
+    const MazeGrid& grid;
+    MazePathfinder pathfinder;
+    std::mt19937 rng;
+    std::vector<uint32_t> path;
+    size_t next = 0;
+    uint32_t cell;
+    float progress = 0.0f;
+};
+
+// Cells between each agent and the target along the field.
+double meanCellsToTarget(const PhysicsWorld& world, const FlowSteering& steering, const std::vector<uint32_t>& agents,
+                         uint32_t& nearCount) {
+    double sum = 0.0;
+    nearCount = 0;
+    for (uint32_t agent : agents) {
+        uint32_t cell = steering.cellAt(world.getBody(agent).position);
+        uint32_t cells = 0;
+        while (cell != NoMazeCell && cell != steering.getField().getTarget()) {
+            cell = steering.getField().nextCell(cell);
+            cells++;
+        }
+        sum += cells;
+        nearCount += cells <= 3 ? 1 : 0;
+    }
+    return agents.empty() ? 0.0 : sum / agents.size();
+}
+
+// Balls chasing a walking target through a meshed maze under physics.
+void reportChase(const MazeGrid& grid, int agentCount, float seconds, ThreadPool& pool) {
+    MazeMeshSettings meshSettings;
+    TriangleMesh level;
+    for (const MazeMeshChunk& chunk : buildMazeMeshes(grid, meshSettings, pool)) {
+        level.append(chunk.vertices, chunk.indices);
+    }
+    PhysicsWorld world(PhysicsSettings(), pool);
+    world.setStaticGeometry(level);
+
+    std::mt19937 rng(5u);
+    std::uniform_int_distribution<uint32_t> anyCell(0, static_cast<uint32_t>(grid.getCellCount() - 1));
+    FlowSteering steering(grid);
+    std::vector<uint32_t> agents;
+    for (int i = 0; i < agentCount; i++) {
+        BodyDesc desc;
+        desc.radius = 0.2f;
+        desc.position = steering.cellCenter(anyCell(rng)) + glm::vec3(0.0f, 0.21f, 0.0f);
+        agents.push_back(world.addBody(desc));
+    }
+
+    TargetWalker walker(grid, static_cast<uint32_t>(grid.getCellCount() / 2 + grid.getWidth() / 2), 8u);
+    const float walkSpeed = 1.5f;
+    float dt = world.getSettings().timeStep;
+    int steps = static_cast<int>(seconds / dt);
+    glm::vec3 targetPosition = walker.advance(0.0f, meshSettings.cellSize);
+    steering.update(world, agents, targetPosition, pool);
+    uint32_t nearStart;
+    double startCells = meanCellsToTarget(world, steering, agents, nearStart);
+
+    double fieldMs = 0.0;
+    double steerMs = 0.0;
+    double physicsMs = 0.0;
+    for (int i = 0; i < steps; i++) {
+        targetPosition = walker.advance(walkSpeed * dt, meshSettings.cellSize);
+        steering.update(world, agents, targetPosition, pool);
+        fieldMs += steering.getStats().fieldMs;
+        steerMs += steering.getStats().steerMs;
+        world.step();
+        physicsMs += world.getStats().stepMs;
+    }
+    uint32_t nearEnd;
+    double endCells = meanCellsToTarget(world, steering, agents, nearEnd);
+    std::printf("%8d %10.4f %10.4f %10.3f %12.1f %12.1f %10u %8u\n", agentCount, fieldMs / steps, steerMs / steps,
+                physicsMs / steps, startCells, endCells, nearEnd, steering.getStats().lostAgents);
+}
+
+} // namespace
+
+// Usage: MazeBench flowfield [size] [agents] [seconds]
+// Flow fields on size^2 mazes: build time on one thread and on the pool,
+// the cost of moving the target one cell (a re-root on perfect mazes, a
+// rebuild on a braided one with loops), re-rooted fields checked against a
+// fresh build (failing the benchmark if they differ), and per-agent A*
+// against one shared field. Then balls
+// chasing a target that walks through a 32x32 meshed maze under physics:
+// field update, steering and physics time per step, and the mean number of
+// cells between agent and target at the start and the end.
+int runFlowFieldBenchmark(int argc, char** argv) {
+    uint32_t size = static_cast<uint32_t>(bench::intArg(argc, argv, 0, 1000));
+    int agentCount = bench::intArg(argc, argv, 1, 500);
+    float seconds = static_cast<float>(bench::intArg(argc, argv, 2, 10));
+
+    ThreadPool serialPool(1);
+    ThreadPool& pool = ThreadPool::global();
+    std::printf("%ux%u mazes, %u threads\n\n", size, size, pool.getThreadCount());
+    MazeGrid perfect = generateMaze(size, size, MazeAlgorithm::Backtracker, 4u);
+    bool passed = reportField("perfect", perfect, agentCount, serialPool, pool);
+    // Knock out 5% of the remaining walls to make loops.
+    MazeGrid braided = perfect;
+    std::mt19937 rng(6u);
+    for (uint64_t i = 0; i < perfect.getCellCount() / 20; i++) {
+        uint32_t x = static_cast<uint32_t>(rng() % size);
+        uint32_t z = static_cast<uint32_t>(rng() % size);
+        if (rng() & 1u) {
+            braided.openEast(x, z);
+        } else {
+            braided.openSouth(x, z);
+        }
+    }
+    passed = reportField("braided", braided, agentCount, serialPool, pool) && passed;
+
+    std::printf("\n32x32 maze, target walking at 1.5 m/s, agents at up to 3 m/s, %.0f s\n\n", seconds);
+    std::printf("%8s %10s %10s %10s %12s %12s %10s %8s\n", "agents", "field ms", "steer ms", "physics ms",
+                "cells start", "cells end", "within 3", "lost");
+    MazeGrid arena = generateMaze(32, 32, MazeAlgorithm::Wilson, 12u);
+    for (int count : {agentCount / 5, agentCount}) {
+        reportChase(arena, count, seconds, pool);
+    }
+    return passed ? 0 : 1;
+}
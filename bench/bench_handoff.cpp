@@ -0,0 +1,188 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "core/spsc_queue.h"
+#include "physics/physics_thread.h"
+#include "physics/physics_world.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Producer and consumer threads passing a counter; the consumer checks the
+// order. Returns items per second.
+double queueThroughput(uint64_t count, bool& inOrder) {
+    SpscQueue<uint64_t> queue(1024);
+    inOrder = true;
+    bench::Timer timer;
+    std::thread producer([&]() {
+        for (uint64_t i = 0; i < count; i++) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (uint64_t expected = 0; expected < count;) {
+        uint64_t value;
+        if (!queue.pop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        inOrder = inOrder && value == expected;
+        expected++;
+    }
+    producer.join();
+    return count / (timer.elapsedMs() / 1000.0);
+}
+
+// The same handoff through a mutex-protected deque.
+double lockedThroughput(uint64_t count) {
+    std::deque<uint64_t> queue;
+    std::mutex mutex;
+    bench::Timer timer;
+    std::thread producer([&]() {
+        for (uint64_t i = 0; i < count; i++) {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(i);
+        }
+    });
+    for (uint64_t received = 0; received < count;) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!queue.empty()) {
+            queue.pop_front();
+            received++;
+        }
+    }
+    producer.join();
+    return count / (timer.elapsedMs() / 1000.0);
+}
+
+void setUpWorld(PhysicsWorld& world, int ballCount) {
+    int cells = std::max(2, static_cast<int>(std::ceil(std::sqrt(ballCount / 2.0))));
+    world.setStaticGeometry(bench::makeSyntheticMaze(cells, cells, 11u));
+    std::mt19937 rng(11u);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < ballCount; i++) {
+        BodyDesc desc;
+        desc.radius = 0.2f;
+        desc.position = glm::vec3(i / 2 % cells + (i % 2 ? 0.7f : 0.3f), 0.21f, i / 2 / cells + (i % 2 ? 0.7f : 0.3f));
+        float angle = unit(rng) * 6.2831853f;
+        desc.velocity = glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * (unit(rng) * 3.0f);
+        // Keep the balls moving so every step does real work.
+        desc.sleepSpeed = 0.0f;
+        world.addBody(desc);
+    }
+}
+
+struct FrameStats {
+    int frames = 0;
+    double averageMs = 0.0;
+    double worstMs = 0.0;
+    uint64_t steps = 0;
+    uint64_t commands = 0;
+    uint64_t commandsApplied = 0;
+    bool monotonic = true;
+    bool complete = true;
+};
+
+// A 60 Hz render loop that only measures its own CPU work per frame:
+// stepping physics inline with advance(), or reading the physics thread's
+// snapshot. One command per frame goes to the physics thread.
+FrameStats runFrames(int ballCount, double seconds, bool threaded) {
+    using Clock = PhysicsSnapshot::Clock;
+    PhysicsSettings settings;
+    settings.timeStep = 1.0f / 240.0f;
+    PhysicsWorld world(settings);
+    setUpWorld(world, ballCount);
+    PhysicsThread physicsThread(world);
+    std::vector<glm::mat4> transforms(world.getBodyCount());
+
+    FrameStats stats;
+    uint64_t lastStep = 0;
+    auto frameTime = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / 60.0));
+    auto start = Clock::now();
+    auto nextFrame = start;
+    auto previousFrame = start;
+    if (threaded) {
+        physicsThread.start();
+    }
+    while (Clock::now() - start < std::chrono::duration<double>(seconds)) {
+        auto frameStart = Clock::now();
+        if (threaded) {
+            PhysicsCommand command;
+            command.type = PhysicsCommand::Type::WakeBody;
+            stats.commands += physicsThread.submit(command) ? 1 : 0;
+            const PhysicsSnapshot& snapshot = physicsThread.acquireSnapshot();
+            float alpha = snapshot.interpolationAlpha(Clock::now());
+            stats.complete = stats.complete && snapshot.current.size() == transforms.size() &&
+                             snapshot.previous.size() == transforms.size();
+            for (uint32_t i = 0; i < transforms.size(); i++) {
+                transforms[i] = snapshot.getBodyTransform(i, alpha);
+            }
+            stats.monotonic = stats.monotonic && snapshot.stepCount >= lastStep;
+            lastStep = snapshot.stepCount;
+        } else {
+            world.advance(std::chrono::duration<float>(frameStart - previousFrame).count());
+            for (uint32_t i = 0; i < transforms.size(); i++) {
+                transforms[i] = world.getBodyTransform(i);
+            }
+        }
+        previousFrame = frameStart;
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+        stats.averageMs += ms;
+        stats.worstMs = std::max(stats.worstMs, ms);
+        stats.frames++;
+        nextFrame += frameTime;
+        std::this_thread::sleep_until(nextFrame);
+    }
+    if (threaded) {
+        physicsThread.stop();
+        stats.commandsApplied = physicsThread.acquireSnapshot().commandCount;
+    }
+    stats.steps = world.getStats().stepCount;
+    stats.averageMs /= std::max(stats.frames, 1);
+    return stats;
+}
+
+} // namespace
+
+// Usage: MazeBench handoff [balls] [seconds]
+// Items per second through the SPSC command queue against a locked deque,
+// then a 60 Hz render loop over a 240 Hz simulation: per-frame CPU time
+// when stepping inline against reading the physics thread's snapshots,
+// physics steps per second actually reached, and checks that snapshots
+// arrive complete and in order and that every submitted command is applied.
+int runHandoffBenchmark(int argc, char** argv) {
+    int ballCount = bench::intArg(argc, argv, 0, 2000);
+    int seconds = bench::intArg(argc, argv, 1, 3);
+
+    const uint64_t items = 4000000;
+    bool inOrder = false;
+    double spsc = queueThroughput(items, inOrder);
+    double locked = lockedThroughput(items);
+    std::printf("%-12s %12s %10s\n", "queue", "Mitems/s", "in order");
+    std::printf("%-12s %12.1f %10s\n", "spsc", spsc / 1e6, inOrder ? "yes" : "NO");
+    std::printf("%-12s %12.1f %10s\n\n", "mutex", locked / 1e6, "-");
+
+    std::printf("%-10s %6s %7s %10s %10s %10s %10s %10s %10s\n", "physics", "balls", "frames", "avg ms",
+                "worst ms", "steps/s", "in order", "complete", "commands");
+    for (bool threaded : {false, true}) {
+        FrameStats stats = runFrames(ballCount, seconds, threaded);
+        char commands[32] = "-";
+        if (threaded) {
+            std::snprintf(commands, sizeof(commands), "%llu/%llu", static_cast<unsigned long long>(stats.commandsApplied),
+                          static_cast<unsigned long long>(stats.commands));
+        }
+        std::printf("%-10s %6d %7d %10.3f %10.3f %10.0f %10s %10s %10s\n", threaded ? "thread" : "inline", ballCount,
+                    stats.frames, stats.averageMs, stats.worstMs, stats.steps / static_cast<double>(seconds),
+                    threaded ? (stats.monotonic ? "yes" : "NO") : "-", threaded ? (stats.complete ? "yes" : "NO") : "-",
+                    commands);
+    }
+    return 0;
+}
@@ -0,0 +1,197 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "core/thread_pool.h"
+#include "maze/maze_generator.h"
+#include "nav/maze_hierarchy.h"
+#include "nav/maze_pathfinder.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Every step moves to a neighbour through an open wall.
+bool isValidPath(const MazeGrid& grid, const std::vector<uint32_t>& cells, uint32_t start, uint32_t goal) {
+    if (cells.empty() || cells.front() != start || cells.back() != goal) {
+        return false;
+    }
+    uint32_t width = grid.getWidth();
+    for (size_t i = 1; i < cells.size(); i++) {
+        uint32_t a = cells[i - 1];
+        uint32_t b = cells[i];
+        uint32_t x = a % width;
+        uint32_t z = a / width;
+        bool open = (b == a + 1 && !grid.hasEastWall(x, z)) || (b == a + width && !grid.hasSouthWall(x, z)) ||
+                    (b + 1 == a && !grid.hasWestWall(x, z)) || (b + width == a && !grid.hasNorthWall(x, z));
+        if (!open) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct QueryReport {
+    double hierarchyMs = 0.0;
+    double firstSegmentMs = 0.0;
+    double refineMs = 0.0;
+    double aStarMs = 0.0;
+    double jpsMs = 0.0;
+    double meanLength = 0.0;
+    double meanWaypoints = 0.0;
+    double meanExpanded = 0.0;
+    bool valid = true;
+    bool matches = true;
+};
+
+// Hierarchical queries on every pair; the first compareCount also run A*
+// and JPS, whose lengths and reachability must agree.
+QueryReport runQueries(const MazeGrid& grid, MazeHierarchy& hierarchy, MazePathfinder& pathfinder,
+                       const std::vector<std::pair<uint32_t, uint32_t>>& queries, size_t compareCount) {
+    QueryReport report;
+    HierarchicalPath path;
+    std::vector<uint32_t> cells;
+    std::vector<uint32_t> reference;
+    std::vector<uint32_t> lengths(queries.size(), 0);
+    std::vector<uint8_t> found(queries.size(), 0);
+    bench::Timer timer;
+    for (size_t i = 0; i < queries.size(); i++) {
+        timer.reset();
+        found[i] = hierarchy.findPath(queries[i].first, queries[i].second, path);
+        report.hierarchyMs += timer.elapsedMs();
+        report.meanExpanded += hierarchy.getStats().expandedNodes;
+        if (!found[i]) {
+            continue;
+        }
+        lengths[i] = path.length;
+        report.meanLength += path.length;
+        report.meanWaypoints += static_cast<double>(path.waypoints.size());
+
+        // A walker refines its next segment only.
+        timer.reset();
+        cells.assign(1, path.waypoints[0]);
+        if (path.waypoints.size() > 1) {
+            hierarchy.refineSegment(path, 0, cells);
+        }
+        report.firstSegmentMs += timer.elapsedMs();
+
+        timer.reset();
+        hierarchy.refinePath(path, cells);
+        report.refineMs += timer.elapsedMs();
+        report.valid = report.valid && isValidPath(grid, cells, queries[i].first, queries[i].second) &&
+                       cells.size() == path.length + 1;
+    }
+    for (size_t i = 0; i < compareCount && i < queries.size(); i++) {
+        timer.reset();
+        bool aStarFound = pathfinder.findPathAStar(queries[i].first, queries[i].second, reference);
+        report.aStarMs += timer.elapsedMs();
+        report.matches = report.matches && aStarFound == static_cast<bool>(found[i]) &&
+                         (!aStarFound || reference.size() == lengths[i] + 1);
+        timer.reset();
+        bool jpsFound = pathfinder.findPathJps(queries[i].first, queries[i].second, reference);
+        report.jpsMs += timer.elapsedMs();
+        report.matches = report.matches && jpsFound == aStarFound && (!jpsFound || reference.size() == lengths[i] + 1);
+    }
+    double count = static_cast<double>(queries.size());
+    report.hierarchyMs /= count;
+    report.firstSegmentMs /= count;
+    report.refineMs /= count;
+    report.meanLength /= count;
+    report.meanWaypoints /= count;
+    report.meanExpanded /= count;
+    if (compareCount) {
+        report.aStarMs /= static_cast<double>(compareCount);
+        report.jpsMs /= static_cast<double>(compareCount);
+    }
+    return report;
+}
+
+bool printReport(const char* name, const QueryReport& report, size_t compareCount) {
+    std::printf("%-8s %10.0f %10.0f %10.0f %10.3f %10.3f %10.3f %10.1f %10.1f %8s %8s\n", name, report.meanLength,
+                report.meanWaypoints, report.meanExpanded, report.hierarchyMs, report.firstSegmentMs,
+                report.refineMs, compareCount ? report.aStarMs : 0.0, compareCount ? report.jpsMs : 0.0,
+                report.valid ? "yes" : "NO", compareCount ? (report.matches ? "yes" : "NO") : "-");
+    return report.valid && report.matches;
+}
+
+} // namespace
+
+// Usage: MazeBench hierarchy [size] [clusterSize] [queries]
+// Hierarchical pathfinding on a size^2 Eller maze: cluster graph build time
+// on one thread and on the pool, nodes, edges and memory; then random
+// long-range queries: abstract search time and nodes expanded, the cost of
+// refining the first segment (what a walker needs to start moving) and
+// the whole path, against A* and JPS on the first few queries, whose
+// lengths must match. Finally doors: walls are toggled one at a time,
+// each followed by an incremental update of the clusters it touches, and
+// the queries run again on the changed maze; the updated hierarchy must
+// match one built from scratch. Fails if any path is invalid or disagrees.
+int runHierarchyBenchmark(int argc, char** argv) {
+    uint32_t size = static_cast<uint32_t>(bench::intArg(argc, argv, 0, 10000));
+    uint32_t clusterSize = static_cast<uint32_t>(bench::intArg(argc, argv, 1, 64));
+    int queryCount = bench::intArg(argc, argv, 2, 20);
+    const size_t compareCount = 3;
+
+    ThreadPool serialPool(1);
+    ThreadPool& pool = ThreadPool::global();
+    bench::Timer timer;
+    MazeGrid grid = generateMaze(size, size, MazeAlgorithm::Eller, 9u);
+    std::printf("%ux%u Eller maze (%.1f s to generate), clusters of %u, %u threads\n\n", size, size,
+                timer.elapsedMs() / 1000.0, clusterSize, pool.getThreadCount());
+
+    double serialMs;
+    {
+        MazeHierarchy serialHierarchy(grid, clusterSize, serialPool);
+        serialMs = serialHierarchy.getStats().buildMs;
+    }
+    MazeHierarchy hierarchy(grid, clusterSize, pool);
+    const MazeHierarchyStats& stats = hierarchy.getStats();
+    std::printf("build %.1f ms (1 thread) / %.1f ms (pool): %u clusters, %llu nodes (%.3f per cell), %llu edges, "
+                "%.1f MB (grid %.1f MB)\n\n",
+                serialMs, stats.buildMs, stats.clusterCount, static_cast<unsigned long long>(stats.nodeCount),
+                static_cast<double>(stats.nodeCount) / grid.getCellCount(),
+                static_cast<unsigned long long>(stats.edgeCount), hierarchy.memoryBytes() / (1024.0 * 1024.0),
+                grid.memoryBytes() / (1024.0 * 1024.0));
+
+    std::mt19937 rng(13u);
+    std::uniform_int_distribution<uint32_t> anyCell(0, static_cast<uint32_t>(grid.getCellCount() - 1));
+    std::vector<std::pair<uint32_t, uint32_t>> queries(queryCount);
+    for (auto& query : queries) {
+        query = {anyCell(rng), anyCell(rng)};
+    }
+    MazePathfinder pathfinder(grid);
+    std::printf("%-8s %10s %10s %10s %10s %10s %10s %10s %10s %8s %8s\n", "maze", "length", "waypoints", "expanded",
+                "query ms", "first ms", "refine ms", "A* ms", "JPS ms", "valid", "match");
+    bool passed = printReport("perfect", runQueries(grid, hierarchy, pathfinder, queries, compareCount), compareCount);
+
+    // Doors: toggle random inner walls, updating after each.
+    const int doorCount = 200;
+    double updateMs = 0.0;
+    double maxUpdateMs = 0.0;
+    uint32_t rebuilt = 0;
+    for (int i = 0; i < doorCount; i++) {
+        uint32_t x = static_cast<uint32_t>(rng() % (size - 1));
+        uint32_t z = static_cast<uint32_t>(rng() % (size - 1));
+        if (i % 2) {
+            grid.hasEastWall(x, z) ? grid.openEast(x, z) : grid.closeEast(x, z);
+        } else {
+            grid.hasSouthWall(x, z) ? grid.openSouth(x, z) : grid.closeSouth(x, z);
+        }
+        rebuilt += hierarchy.wallsChanged({x, z, x + 1, z + 1}, pool);
+        updateMs += stats.updateMs;
+        maxUpdateMs = std::max(maxUpdateMs, stats.updateMs);
+    }
+    QueryReport doors = runQueries(grid, hierarchy, pathfinder, queries, compareCount);
+    passed = printReport("doors", doors, compareCount) && passed;
+
+    MazeHierarchy fresh(grid, clusterSize, pool);
+    QueryReport freshReport = runQueries(grid, fresh, pathfinder, queries, 0);
+    bool sameAsFresh = fresh.getStats().nodeCount == stats.nodeCount &&
+                       fresh.getStats().edgeCount == stats.edgeCount && freshReport.meanLength == doors.meanLength;
+    std::printf("\n%d doors toggled: %.3f ms mean, %.3f ms max per update, %.1f clusters rebuilt per door; "
+                "matches a fresh build: %s\n",
+                doorCount, updateMs / doorCount, maxUpdateMs, static_cast<double>(rebuilt) / doorCount,
+                sameAsFresh ? "yes" : "NO");
+    return passed && freshReport.valid && sameAsFresh ? 0 : 1;
+}
@@ -0,0 +1,244 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "core/thread_pool.h"
+#include "level/level_file.h"
+#include "maze/maze_generator.h"
+#include "physics/physics_world.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename T>
+bool sameBytes(const T* a, const T* b, size_t count) {
+    return count == 0 || std::memcmp(a, b, count * sizeof(T)) == 0;
+}
+
+template <typename T>
+bool sameArray(LevelArray<T> stored, const std::vector<T>& expected) {
+    return stored.size() == expected.size() && sameBytes(stored.data, expected.data(), expected.size());
+}
+
+void addEntities(LevelContent& content, uint32_t size) {
+    std::mt19937 rng(5u);
+    std::uniform_real_distribution<float> position(0.0f, static_cast<float>(size) * content.meshSettings.cellSize);
+    glm::vec3 origin = content.meshSettings.origin;
+    for (int i = 0; i < 256; i++) {
+        TriggerDesc pad;
+        pad.a = origin + glm::vec3(position(rng), 0.0f, position(rng));
+        pad.b = pad.a + glm::vec3(0.8f, 0.1f, 0.8f);
+        pad.bounceImpulse = glm::vec3(0.0f, 4.0f, 0.0f);
+        pad.tag = static_cast<uint32_t>(i);
+        content.bouncePads.push_back(pad);
+    }
+    for (int i = 0; i < 256; i++) {
+        WindZone zone;
+        zone.a = origin + glm::vec3(position(rng), 0.0f, position(rng));
+        zone.b = zone.a + glm::vec3(4.0f, 2.0f, 4.0f);
+        zone.strength = 2.0f;
+        zone.turbulence = 0.5f;
+        content.windZones.push_back(zone);
+    }
+    for (int i = 0; i < 64; i++) {
+        LevelMirror mirror{};
+        mirror.corner = origin + glm::vec3(position(rng), 0.0f, position(rng));
+        mirror.reflectivity = 0.9f;
+        mirror.edgeU = glm::vec3(1.0f, 0.0f, 0.0f);
+        mirror.edgeV = glm::vec3(0.0f, 1.0f, 0.0f);
+        content.mirrors.push_back(mirror);
+    }
+}
+
+struct LoadReport {
+    double restoreMs = 0.0;
+    double meshMs = 0.0;
+    uint64_t restoreFaults = 0;
+    uint64_t meshFaults = 0;
+};
+
+// What the game does with an open level: physics from the stored collision
+// data and broadphase grid, the BVH for ray queries, entities, and every
+// chunk mesh copied out as for a GPU upload.
+LoadReport useLevel(const LevelFile& level, PhysicsWorld& physics, Bvh& bvh, std::vector<uint8_t>& staging) {
+    LoadReport report;
+    bench::Timer timer;
+    uint64_t faults = bench::pageFaults();
+    UniformGrid grid;
+    level.loadBroadphase(grid);
+    LevelArray<Triangle> triangles = level.getCollisionTriangles();
+    physics.setStaticGeometry(triangles.data, triangles.size(), &grid);
+    level.loadBvh(bvh);
+    physics.setWindZones(level.loadWindZones());
+    for (const LevelBouncePad& pad : level.getBouncePads()) {
+        physics.addTrigger(LevelFile::toTrigger(pad));
+    }
+    report.restoreMs = timer.elapsedMs();
+    report.restoreFaults = bench::pageFaults() - faults;
+
+    timer.reset();
+    faults = bench::pageFaults();
+    LevelArray<Vertex> vertices = level.getVertices();
+    LevelArray<uint32_t> indices = level.getIndices();
+    for (const LevelChunk& chunk : level.getChunks()) {
+        size_t vertexBytes = chunk.vertexCount * sizeof(Vertex);
+        size_t indexBytes = chunk.indexCount * sizeof(uint32_t);
+        staging.resize(std::max(staging.size(), vertexBytes + indexBytes));
+        std::memcpy(staging.data(), vertices.data + chunk.firstVertex, vertexBytes);
+        std::memcpy(staging.data() + vertexBytes, indices.data + chunk.firstIndex, indexBytes);
+    }
+    report.meshMs = timer.elapsedMs();
+    report.meshFaults = bench::pageFaults() - faults;
+    return report;
+}
+
+// Balls dropped over the maze; the final positions of two worlds must match.
+std::vector<glm::vec3> simulate(PhysicsWorld& physics, const MazeMeshSettings& settings) {
+    for (uint32_t i = 0; i < 16; i++) {
+        BodyDesc desc;
+        desc.radius = 0.2f;
+        desc.position = settings.origin + glm::vec3((i % 4 + 0.5f) * settings.cellSize, 2.0f,
+                                                    (i / 4 + 0.5f) * settings.cellSize);
+        physics.addBody(desc);
+    }
+    for (int step = 0; step < 240; step++) {
+        physics.step();
+    }
+    std::vector<glm::vec3> positions;
+    for (uint32_t i = 0; i < physics.getBodyCount(); i++) {
+        positions.push_back(physics.getBody(i).position);
+    }
+    return positions;
+}
+
+} // namespace
+
+// Usage: MazeBench level [size] [path]
+// Binary level files: a size^2 maze with its chunk meshes, collision
+// triangles, broadphase grid, BVH and a few hundred entities is built from
+// scratch (the cost of loading without a level file), written, evicted
+// from the page cache where possible and opened again. Opening maps and
+// validates the file; using it restores physics, the BVH and entities,
+// which copies the collision triangles, broadphase grid and BVH out of the
+// mapping (the bytes copied are printed), and copies every chunk mesh out
+// as for a GPU upload. Using the same mapping
+// a second time, with its pages resident, gives the cost without page
+// faults, so the difference is what the faults cost. Every section must
+// match what was written and a short simulation must give the same
+// result on the loaded level as on the built one; the benchmark fails if
+// either does not.
+int runLevelBenchmark(int argc, char** argv) {
+    uint32_t size = static_cast<uint32_t>(bench::intArg(argc, argv, 0, 1024));
+    bool defaultPath = argc < 2;
+    std::string path = defaultPath ? (std::filesystem::temp_directory_path() / "mazebench.mzlevel").string()
+                                   : std::string(argv[1]);
+
+    ThreadPool& pool = ThreadPool::global();
+    MazeGrid maze = generateMaze(size, size, MazeAlgorithm::Eller, 21u);
+    MazeMeshSettings settings;
+    settings.origin = glm::vec3(-0.5f * size, 0.0f, -0.5f * size);
+    const float ballRadius = 0.2f;
+
+    bench::Timer timer;
+    LevelContent content = buildLevelContent(maze, settings, ballRadius, pool);
+    addEntities(content, size);
+    PhysicsWorld built;
+    built.setStaticGeometry(content.collision);
+    built.setWindZones(content.windZones);
+    for (const TriggerDesc& pad : content.bouncePads) {
+        built.addTrigger(pad);
+    }
+    double buildMs = timer.elapsedMs();
+
+    timer.reset();
+    writeLevelFile(path, content);
+    double writeMs = timer.elapsedMs();
+    bool cold = bench::evictFromPageCache(path);
+
+    timer.reset();
+    uint64_t faults = bench::pageFaults();
+    LevelFile level(path);
+    double openMs = timer.elapsedMs();
+    uint64_t openFaults = bench::pageFaults() - faults;
+
+    PhysicsWorld loaded;
+    Bvh bvh;
+    std::vector<uint8_t> staging;
+    LoadReport first = useLevel(level, loaded, bvh, staging);
+    PhysicsWorld again;
+    Bvh bvhAgain;
+    LoadReport second = useLevel(level, again, bvhAgain, staging);
+
+    std::printf("%ux%u maze, %zu chunks, %zu triangles, %zu BVH nodes, %zu entities: %.1f MB file, "
+                "written in %.1f ms\n\n", size, size, content.chunks.size(), content.collision.size(),
+                content.bvh.getNodes().size(),
+                content.bouncePads.size() + content.windZones.size() + content.mirrors.size(),
+                level.getFileSize() / (1024.0 * 1024.0), writeMs);
+    std::printf("%-28s %10s %10s\n", "", "ms", "faults");
+    std::printf("%-28s %10.1f %10s\n", "build from scratch", buildMs, "-");
+    std::printf("%-28s %10.3f %10llu\n", "open + validate", openMs, static_cast<unsigned long long>(openFaults));
+    std::printf("%-28s %10.2f %10llu\n", cold ? "restore (cold)" : "restore (first touch)", first.restoreMs,
+                static_cast<unsigned long long>(first.restoreFaults));
+    std::printf("%-28s %10.2f %10llu\n", cold ? "meshes (cold)" : "meshes (first touch)", first.meshMs,
+                static_cast<unsigned long long>(first.meshFaults));
+    std::printf("%-28s %10.2f %10llu\n", "restore (resident)", second.restoreMs,
+                static_cast<unsigned long long>(second.restoreFaults));
+    std::printf("%-28s %10.2f %10llu\n", "meshes (resident)", second.meshMs,
+                static_cast<unsigned long long>(second.meshFaults));
+
+    // loadBroadphase copies the grid once and setStaticGeometry again.
+    uint64_t copiedBytes = level.getSectionBytes(LevelSection::CollisionTriangles) +
+                           2 * (level.getSectionBytes(LevelSection::BroadphaseCellStart) +
+                                level.getSectionBytes(LevelSection::BroadphaseCellTriangles)) +
+                           level.getSectionBytes(LevelSection::BvhNodes) +
+                           level.getSectionBytes(LevelSection::BvhTriangles) +
+                           level.getSectionBytes(LevelSection::BvhPrimitiveIds);
+    std::printf("\nrestore copies %.1f MB out of the mapping (collision triangles, broadphase grid twice, BVH)\n",
+                copiedBytes / (1024.0 * 1024.0));
+
+    double loadMs = openMs + first.restoreMs + first.meshMs;
+    double residentMs = second.restoreMs + second.meshMs;
+    std::printf("load %.1f ms (%.1fx faster than building), %.0f%% of it page faults\n", loadMs,
+                buildMs / loadMs, 100.0 * std::max(loadMs - openMs - residentMs, 0.0) / loadMs);
+
+    const MazeGrid view = level.getMaze();
+    bool mazeMatches = view.isView() && view.getWidth() == maze.getWidth() && view.getHeight() == maze.getHeight() &&
+                       sameBytes(view.eastRow(0), maze.eastRow(0), maze.getWordCount()) &&
+                       sameBytes(view.southRow(0), maze.southRow(0), maze.getWordCount()) &&
+                       view.countPassages() == maze.countPassages();
+    bool meshesMatch = level.getChunks().size() == content.chunks.size();
+    for (size_t i = 0; meshesMatch && i < content.chunks.size(); i++) {
+        const LevelChunk& chunk = level.getChunks()[i];
+        const MazeMeshChunk& expected = content.chunks[i];
+        meshesMatch = chunk.chunkX == expected.chunkX && chunk.chunkZ == expected.chunkZ &&
+                      chunk.vertexCount == expected.vertices.size() && chunk.indexCount == expected.indices.size() &&
+                      sameBytes(level.getVertices().data + chunk.firstVertex, expected.vertices.data(),
+                                expected.vertices.size()) &&
+                      sameBytes(level.getIndices().data + chunk.firstIndex, expected.indices.data(),
+                                expected.indices.size());
+    }
+    const UniformGrid& grid = loaded.getStaticGrid();
+    bool physicsMatches = sameArray(level.getCollisionTriangles(), content.collision.getTriangles()) &&
+                          grid.getCellStart() == content.broadphase.getCellStart() &&
+                          grid.getCellTriangles() == content.broadphase.getCellTriangles() &&
+                          bvh.getPrimitiveIds() == content.bvh.getPrimitiveIds() &&
+                          sameBytes(bvh.getNodes().data(), content.bvh.getNodes().data(), bvh.getNodes().size()) &&
+                          bvh.getStats().sahCost == content.bvh.getStats().sahCost;
+    bool entitiesMatch = level.getBouncePads().size() == content.bouncePads.size() &&
+                         loaded.getWindField().getZones().size() == content.windZones.size() &&
+                         sameArray(level.getMirrors(), content.mirrors);
+    // The built world picks its grid on the first step, with the balls in it.
+    bool simulationMatches = simulate(loaded, settings) == simulate(built, settings);
+    std::printf("maze %s, meshes %s, collision %s, entities %s, simulation %s\n", mazeMatches ? "match" : "DIFFER",
+                meshesMatch ? "match" : "DIFFER", physicsMatches ? "match" : "DIFFER",
+                entitiesMatch ? "match" : "DIFFER", simulationMatches ? "matches" : "DIFFERS");
+
+    if (defaultPath) {
+        std::filesystem::remove(path);
+    }
+    return mazeMatches && meshesMatch && physicsMatches && entitiesMatch && simulationMatches ? 0 : 1;
+}
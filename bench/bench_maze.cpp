@@ -0,0 +1,120 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "core/thread_pool.h"
+#include "maze/maze_generator.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+const char* algorithmName(MazeAlgorithm algorithm) {
+    switch (algorithm) {
+    case MazeAlgorithm::Backtracker: return "backtracker";
+    case MazeAlgorithm::Wilson: return "wilson";
+    default: return "eller";
+    }
+}
+
+uint64_t hashWords(uint64_t hash, const uint64_t* words, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        hash = (hash ^ words[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// FNV-1a over the wall bits, to compare mazes generated separately.
+uint64_t hashMaze(const MazeGrid& grid) {
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t z = 0; z < grid.getHeight(); z++) {
+        hash = hashWords(hash, grid.eastRow(z), grid.getRowWords());
+        hash = hashWords(hash, grid.southRow(z), grid.getRowWords());
+    }
+    return hash;
+}
+
+// Returns false if the maze is not perfect or not reproducible.
+bool printRow(const char* label, uint32_t size, double ms, const MazeGrid& grid, bool reproducible) {
+    double cells = static_cast<double>(grid.getCellCount());
+    bool perfect = grid.isPerfect();
+    std::printf("%-16s %6u %10.1f %10.2f %10.3f %10.2f %8s %8s\n", label, size, ms, ms * 1e6 / cells,
+                grid.memoryBytes() * 8.0 / cells, grid.memoryBytes() / (1024.0 * 1024.0),
+                perfect ? "yes" : "NO", reproducible ? "yes" : "NO");
+    return perfect && reproducible;
+}
+
+bool reportSerial(MazeAlgorithm algorithm, uint32_t size) {
+    bench::Timer timer;
+    MazeGrid grid = generateMaze(size, size, algorithm, 42u);
+    double ms = timer.elapsedMs();
+    bool reproducible = hashMaze(grid) == hashMaze(generateMaze(size, size, algorithm, 42u)) &&
+                        hashMaze(grid) != hashMaze(generateMaze(size, size, algorithm, 43u));
+    return printRow(algorithmName(algorithm), size, ms, grid, reproducible);
+}
+
+// The pool result must match a single-threaded run of the same seed.
+bool reportParallel(MazeAlgorithm algorithm, uint32_t size, ThreadPool& serialPool, ThreadPool& parallelPool) {
+    bench::Timer timer;
+    MazeGrid grid = generateMazeParallel(size, size, algorithm, 42u, parallelPool);
+    double ms = timer.elapsedMs();
+    bool reproducible = hashMaze(grid) == hashMaze(generateMazeParallel(size, size, algorithm, 42u, serialPool));
+    char label[32];
+    std::snprintf(label, sizeof(label), "%s/par", algorithmName(algorithm));
+    return printRow(label, size, ms, grid, reproducible);
+}
+
+// Eller's rows streamed into two reused buffers: memory stays O(width)
+// however many rows are generated.
+void reportStreaming(uint32_t width, uint32_t rows) {
+    uint32_t words = (width + 63) / 64;
+    std::vector<uint64_t> east(words);
+    std::vector<uint64_t> south(words);
+    EllerGenerator generator(width, 42u);
+    uint64_t hash = 14695981039346656037ull;
+    bench::Timer timer;
+    for (uint32_t z = 0; z < rows; z++) {
+        std::fill(east.begin(), east.end(), ~uint64_t(0));
+        std::fill(south.begin(), south.end(), ~uint64_t(0));
+        generator.nextRow(z + 1 == rows, east.data(), south.data());
+        hash = hashWords(hash, east.data(), words);
+    }
+    double ms = timer.elapsedMs();
+    std::printf("eller streaming %u x %u: %.1f ms, %.2f ns/cell, %.1f KB of row buffers (hash %016llx)\n", width,
+                rows, ms, ms * 1e6 / (static_cast<double>(width) * rows), 2.0 * words * sizeof(uint64_t) / 1024.0,
+                static_cast<unsigned long long>(hash));
+}
+
+} // namespace
+
+// Usage: MazeBench maze [maxSize]
+// Generation time and memory per cell for each algorithm on square grids
+// up to maxSize (the backtracker and Wilson's stop at 2000, where their
+// per-cell scratch and Wilson's first walks dominate), then the parallel
+// region generator and Eller's row streaming. Every maze must be perfect,
+// the same seed must give the same maze, and the parallel result must not
+// depend on the thread count; otherwise the benchmark fails.
+int runMazeBenchmark(int argc, char** argv) {
+    uint32_t maxSize = static_cast<uint32_t>(bench::intArg(argc, argv, 0, 10000));
+
+    ThreadPool serialPool(1);
+    ThreadPool& parallelPool = ThreadPool::global();
+    std::printf("%u threads\n\n", parallelPool.getThreadCount());
+    std::printf("%-16s %6s %10s %10s %10s %10s %8s %8s\n", "algorithm", "size", "ms", "ns/cell", "bits/cell", "MB",
+                "perfect", "repro");
+    bool passed = true;
+    for (uint32_t size : {250u, 1000u, 2000u, 5000u, 10000u}) {
+        if (size > maxSize) {
+            break;
+        }
+        if (size <= 2000) {
+            passed = reportSerial(MazeAlgorithm::Backtracker, size) && passed;
+            passed = reportSerial(MazeAlgorithm::Wilson, size) && passed;
+        }
+        passed = reportSerial(MazeAlgorithm::Eller, size) && passed;
+        passed = reportParallel(MazeAlgorithm::Backtracker, size, serialPool, parallelPool) && passed;
+        passed = reportParallel(MazeAlgorithm::Eller, size, serialPool, parallelPool) && passed;
+        std::printf("\n");
+    }
+    reportStreaming(maxSize, maxSize);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "core/thread_pool.h"
+#include "maze/maze_generator.h"
+#include "maze/maze_mesher.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct WallBox {
+    glm::vec2 min;
+    glm::vec2 max;
+};
+
+// One box per wall segment, stretched by half the thickness at both ends
+// so corners close: the per-cell boxes the greedy mesher replaces.
+std::vector<WallBox> naiveWalls(const MazeGrid& grid, const MazeMeshSettings& settings) {
+    float cell = settings.cellSize;
+    float half = settings.wallThickness * 0.5f;
+    std::vector<WallBox> walls;
+    for (uint32_t z = 0; z < grid.getHeight(); z++) {
+        for (uint32_t x = 0; x < grid.getWidth(); x++) {
+            if (x == 0) {
+                walls.push_back({{-half, z * cell - half}, {half, (z + 1) * cell + half}});
+            }
+            if (z == 0) {
+                walls.push_back({{x * cell - half, -half}, {(x + 1) * cell + half, half}});
+            }
+            if (grid.hasEastWall(x, z)) {
+                float lineX = (x + 1) * cell;
+                walls.push_back({{lineX - half, z * cell - half}, {lineX + half, (z + 1) * cell + half}});
+            }
+            if (grid.hasSouthWall(x, z)) {
+                float lineZ = (z + 1) * cell;
+                walls.push_back({{x * cell - half, lineZ - half}, {(x + 1) * cell + half, lineZ + half}});
+            }
+        }
+    }
+    return walls;
+}
+
+bool insideNaive(const MazeGrid& grid, const MazeMeshSettings& settings, const glm::vec2& p) {
+    float cell = settings.cellSize;
+    float half = settings.wallThickness * 0.5f;
+    auto inside = [&](const glm::vec2& min, const glm::vec2& max) {
+        return p.x > min.x && p.x < max.x && p.y > min.y && p.y < max.y;
+    };
+    int lineX = static_cast<int>(std::lround(p.x / cell));
+    int lineZ = static_cast<int>(std::lround(p.y / cell));
+    int w = static_cast<int>(grid.getWidth());
+    int h = static_cast<int>(grid.getHeight());
+    for (int z = lineZ - 1; z <= lineZ; z++) {
+        if (z < 0 || z >= h || lineX < 0 || lineX > w) {
+            continue;
+        }
+        bool wall = lineX == 0 || lineX == w || grid.hasEastWall(lineX - 1, z);
+        if (wall && inside({lineX * cell - half, z * cell - half}, {lineX * cell + half, (z + 1) * cell + half})) {
+            return true;
+        }
+    }
+    for (int x = lineX - 1; x <= lineX; x++) {
+        if (x < 0 || x >= w || lineZ < 0 || lineZ > h) {
+            continue;
+        }
+        bool wall = lineZ == 0 || lineZ == h || grid.hasSouthWall(x, lineZ - 1);
+        if (wall && inside({x * cell - half, lineZ * cell - half}, {(x + 1) * cell + half, lineZ * cell + half})) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool insideTops(const std::vector<MazeMeshChunk>& chunks, const MazeMeshSettings& settings, const glm::vec2& p) {
+    for (const MazeMeshChunk& chunk : chunks) {
+        if (p.x < chunk.bounds.min.x || p.x > chunk.bounds.max.x || p.y < chunk.bounds.min.z ||
+            p.y > chunk.bounds.max.z) {
+            continue;
+        }
+        for (size_t q = 0; q < chunk.vertices.size(); q += 4) {
+            const Vertex& corner = chunk.vertices[q];
+            if (corner.normal.y <= 0.0f || corner.position.y != settings.wallHeight) {
+                continue;
+            }
+            glm::vec3 min = corner.position;
+            glm::vec3 max = corner.position;
+            for (size_t k = 1; k < 4; k++) {
+                min = glm::min(min, chunk.vertices[q + k].position);
+                max = glm::max(max, chunk.vertices[q + k].position);
+            }
+            if (p.x > min.x && p.x < max.x && p.y > min.z && p.y < max.z) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool report(uint32_t size, const MazeMeshSettings& settings, ThreadPool& serialPool, ThreadPool& parallelPool) {
+    MazeGrid grid = generateMaze(size, size, MazeAlgorithm::Backtracker, 7u);
+
+    bench::Timer timer;
+    TriangleMesh naive;
+    for (const WallBox& wall : naiveWalls(grid, settings)) {
+        bench::appendBox(naive, glm::vec3(wall.min.x, 0.0f, wall.min.y),
+                         glm::vec3(wall.max.x, settings.wallHeight, wall.max.y));
+    }
+    double naiveMs = timer.elapsedMs();
+
+    timer.reset();
+    std::vector<MazeMeshChunk> chunks = buildMazeMeshes(grid, settings, serialPool);
+    double serialMs = timer.elapsedMs();
+    timer.reset();
+    chunks = buildMazeMeshes(grid, settings, parallelPool);
+    double parallelMs = timer.elapsedMs();
+
+    // Every triangle must face along its vertex normal.
+    int mismatches = 0;
+    size_t triangles = 0;
+    size_t vertices = 0;
+    size_t bytes = 0;
+    for (const MazeMeshChunk& chunk : chunks) {
+        for (size_t i = 0; i + 2 < chunk.indices.size(); i += 3) {
+            const Vertex& a = chunk.vertices[chunk.indices[i]];
+            const Vertex& b = chunk.vertices[chunk.indices[i + 1]];
+            const Vertex& c = chunk.vertices[chunk.indices[i + 2]];
+            mismatches += glm::dot(glm::cross(b.position - a.position, c.position - a.position), a.normal) <= 0.0f;
+        }
+        triangles += chunk.indices.size() / 3;
+        vertices += chunk.vertices.size();
+        bytes += chunk.vertices.size() * sizeof(Vertex) + chunk.indices.size() * sizeof(uint32_t);
+    }
+    // Floors are not part of the naive walls.
+    size_t wallTriangles = triangles - (settings.floor ? 2 * chunks.size() : 0);
+
+    // The merged tops must cover exactly the area of the naive walls.
+    std::mt19937 rng(3u);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    int samples = size <= 256 ? 20000 : 2000;
+    for (int i = 0; i < samples; i++) {
+        glm::vec2 p(unit(rng) * size * settings.cellSize, unit(rng) * size * settings.cellSize);
+        mismatches += insideNaive(grid, settings, p) != insideTops(chunks, settings, p);
+    }
+
+    std::printf("%6u %8zu %10zu %10zu %7.1fx %10.1f %10.1f %10.1f %8zu %10zu %8.2f %8d\n", size, chunks.size(),
+                naive.size(), wallTriangles, static_cast<double>(naive.size()) / wallTriangles, naiveMs, serialMs,
+                parallelMs, vertices, triangles, bytes / (1024.0 * 1024.0), mismatches);
+    return mismatches == 0;
+}
+
+} // namespace
+
+// Usage: MazeBench mazemesh [maxSize] [chunkSize]
+// Greedy-meshed maze chunks against one box per wall segment: triangle
+// counts, build time (naive, mesher on one thread and on the pool), and
+// the chunks' vertex and index memory. Every triangle must face along its
+// normal, and random points on the floor plane must be inside a merged top
+// face exactly when they are inside a naive wall box; any mismatch fails
+// the benchmark.
+int runMazeMeshBenchmark(int argc, char** argv) {
+    uint32_t maxSize = static_cast<uint32_t>(bench::intArg(argc, argv, 0, 1024));
+    MazeMeshSettings settings;
+    settings.chunkSize = static_cast<uint32_t>(bench::intArg(argc, argv, 1, 32));
+
+    ThreadPool serialPool(1);
+    ThreadPool& parallelPool = ThreadPool::global();
+    std::printf("chunk %u cells, %u threads\n\n", settings.chunkSize, parallelPool.getThreadCount());
+    std::printf("%6s %8s %10s %10s %8s %10s %10s %10s %8s %10s %8s %8s\n", "size", "chunks", "naive tri",
+                "greedy tri", "ratio", "naive ms", "mesh ms", "pool ms", "verts", "total tri", "MB", "mismatch");
+    bool passed = true;
+    for (uint32_t size : {64u, 256u, 1024u}) {
+        if (size <= maxSize) {
+            passed = report(size, settings, serialPool, parallelPool) && passed;
+        }
+    }
+    return passed ? 0 : 1;
+}
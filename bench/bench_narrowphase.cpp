@@ -0,0 +1,253 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "core/simd.h"
+#include "physics/collision.h"
+#include "physics/narrowphase.h"
+#include "physics/physics_world.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Query {
+    glm::vec3 center;
+    std::vector<uint32_t> candidates;
+};
+
+// Sphere positions scattered over the maze with the candidate lists the
+// grid broadphase would return for them.
+std::vector<Query> makeQueries(const TriangleMesh& level, const UniformGrid& grid, int count, float reach, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    Aabb bounds = level.bounds();
+    std::vector<Query> queries(count);
+    for (auto& query : queries) {
+        query.center = bounds.min + glm::vec3(unit(rng), unit(rng), unit(rng)) * bounds.extent();
+        Aabb box;
+        box.min = query.center - glm::vec3(reach);
+        box.max = query.center + glm::vec3(reach);
+        grid.query(box, query.candidates);
+    }
+    return queries;
+}
+
+struct IndexedContact {
+    uint32_t triangle;
+    SphereContact contact;
+};
+
+struct Result {
+    double testsPerSecond = 0.0;
+    uint64_t hits = 0;
+};
+
+Result runScalar(const std::vector<Triangle>& triangles, const std::vector<Query>& queries, float radius, float margin,
+                 std::vector<std::vector<IndexedContact>>& contacts) {
+    Result result;
+    uint64_t tests = 0;
+    bench::Timer timer;
+    for (size_t q = 0; q < queries.size(); q++) {
+        contacts[q].clear();
+        for (uint32_t index : queries[q].candidates) {
+            const Triangle& tri = triangles[index];
+            SphereContact hit;
+            if (sphereTriangleContact(queries[q].center, radius, margin, tri.v0, tri.v1, tri.v2, hit)) {
+                contacts[q].push_back({index, hit});
+            }
+        }
+        tests += queries[q].candidates.size();
+    }
+    result.testsPerSecond = tests / (timer.elapsedMs() / 1000.0);
+    for (const auto& list : contacts) {
+        result.hits += list.size();
+    }
+    return result;
+}
+
+template <int N>
+Result runBatched(const std::vector<Triangle>& triangles, const std::vector<PackedTriangle>& packed,
+                  const std::vector<Query>& queries, float radius, float margin,
+                  std::vector<std::vector<IndexedContact>>& contacts) {
+    Result result;
+    uint64_t tests = 0;
+    bench::Timer timer;
+    for (size_t q = 0; q < queries.size(); q++) {
+        const Query& query = queries[q];
+        contacts[q].clear();
+        for (size_t first = 0; first < query.candidates.size(); first += N) {
+            int count = static_cast<int>(std::min<size_t>(N, query.candidates.size() - first));
+            const uint32_t* indices = query.candidates.data() + first;
+            glm::vec3 closest[N];
+            int mask = static_cast<int>(
+                sphereTriangleBatch<N>(packed.data(), indices, count, query.center, radius + margin, closest));
+            while (mask) {
+                int lane = simd::popLowestLane(mask);
+                const Triangle& tri = triangles[indices[lane]];
+                SphereContact hit;
+                sphereContactFromClosest(query.center, radius, closest[lane], tri.v0, tri.v1, tri.v2, hit);
+                contacts[q].push_back({indices[lane], hit});
+            }
+        }
+        tests += query.candidates.size();
+    }
+    result.testsPerSecond = tests / (timer.elapsedMs() / 1000.0);
+    for (const auto& list : contacts) {
+        result.hits += list.size();
+    }
+    return result;
+}
+
+volatile uint64_t kernelSink = 0;
+
+// Kernel throughput alone: closest points and the reach test, no contacts.
+double scalarKernel(const std::vector<Triangle>& triangles, const std::vector<Query>& queries, float reach,
+                    uint64_t& hits) {
+    uint64_t tests = 0;
+    hits = 0;
+    bench::Timer timer;
+    for (const auto& query : queries) {
+        for (uint32_t index : query.candidates) {
+            const Triangle& tri = triangles[index];
+            glm::vec3 delta = query.center - closestPointOnTriangle(query.center, tri.v0, tri.v1, tri.v2);
+            hits += glm::dot(delta, delta) <= reach * reach;
+        }
+        tests += query.candidates.size();
+    }
+    // Publish the result before stopping the clock so the loop cannot be
+    // moved past it.
+    kernelSink = hits;
+    return tests / (timer.elapsedMs() / 1000.0);
+}
+
+template <int N>
+double batchedKernel(const std::vector<PackedTriangle>& packed, const std::vector<Query>& queries, float reach,
+                     uint64_t& hits) {
+    uint64_t tests = 0;
+    hits = 0;
+    bench::Timer timer;
+    for (const auto& query : queries) {
+        for (size_t first = 0; first < query.candidates.size(); first += N) {
+            int count = static_cast<int>(std::min<size_t>(N, query.candidates.size() - first));
+            glm::vec3 closest[N];
+            uint32_t mask = sphereTriangleBatch<N>(packed.data(), query.candidates.data() + first, count,
+                                                   query.center, reach, closest);
+            hits += __builtin_popcount(mask);
+        }
+        tests += query.candidates.size();
+    }
+    // Publish the result before stopping the clock so the loop cannot be
+    // moved past it.
+    kernelSink = hits;
+    return tests / (timer.elapsedMs() / 1000.0);
+}
+
+// Compares against the scalar contacts triangle by triangle. Contacts may
+// only be missing on either side when the sphere grazes the reach limit;
+// near edges and vertices the two closest points can differ along a
+// (near-)tie while the distance agrees. Returns false on any other
+// missing contact or a separation off by more than 1e-4.
+bool compare(const char* name, const std::vector<std::vector<IndexedContact>>& reference,
+             const std::vector<std::vector<IndexedContact>>& batched, float margin) {
+    uint64_t mismatched = 0;
+    float maxPointError = 0.0f;
+    float maxSeparationError = 0.0f;
+    for (size_t q = 0; q < reference.size(); q++) {
+        size_t j = 0;
+        for (const auto& expected : reference[q]) {
+            while (j < batched[q].size() && batched[q][j].triangle < expected.triangle) {
+                mismatched += std::abs(batched[q][j].contact.separation - margin) < 1e-4f ? 0 : 1;
+                j++;
+            }
+            if (j == batched[q].size() || batched[q][j].triangle != expected.triangle) {
+                mismatched += std::abs(expected.contact.separation - margin) < 1e-4f ? 0 : 1;
+                continue;
+            }
+            const SphereContact& actual = batched[q][j].contact;
+            maxPointError = std::max(maxPointError, glm::length(actual.point - expected.contact.point));
+            maxSeparationError = std::max(maxSeparationError, std::abs(actual.separation - expected.contact.separation));
+            j++;
+        }
+        for (; j < batched[q].size(); j++) {
+            mismatched += std::abs(batched[q][j].contact.separation - margin) < 1e-4f ? 0 : 1;
+        }
+    }
+    bool passed = mismatched == 0 && maxSeparationError <= 1e-4f;
+    std::printf("%-8s vs scalar: %llu mismatched, max point error %.2e, max separation error %.2e%s\n", name,
+                static_cast<unsigned long long>(mismatched), maxPointError, maxSeparationError,
+                passed ? "" : " FAILED");
+    return passed;
+}
+
+} // namespace
+
+// Usage: MazeBench narrowphase [queries] [repeats]
+// Sphere-vs-triangle tests per second for the scalar routine and the 4/8
+// lane batched kernel, over broadphase candidate lists from a synthetic
+// maze, plus a check of the batched contacts against the scalar ones that
+// makes it exit non-zero when they disagree; CTest runs it as
+// narrowphase_checks.
+int runNarrowphaseBenchmark(int argc, char** argv) {
+    int queryCount = bench::intArg(argc, argv, 0, 20000);
+    int repeats = bench::intArg(argc, argv, 1, 5);
+    const float radius = 0.25f;
+    const float margin = 0.05f;
+
+    // Small enough to stay in cache, so the kernels rather than memory are
+    // measured.
+    TriangleMesh level = bench::makeSyntheticMaze(10, 10, 5u);
+    const std::vector<Triangle>& triangles = level.getTriangles();
+    UniformGrid grid;
+    grid.build(triangles, UniformGrid::suggestCellSize(triangles, radius));
+    std::vector<PackedTriangle> packed = packTriangles(triangles);
+
+    // All triangles whose bounds overlap the reach box, as in PhysicsWorld.
+    std::vector<Query> queries = makeQueries(level, grid, queryCount, radius + margin, 9u);
+    uint64_t totalCandidates = 0;
+    for (auto& query : queries) {
+        Aabb box;
+        box.min = query.center - glm::vec3(radius + margin);
+        box.max = query.center + glm::vec3(radius + margin);
+        query.candidates.erase(std::remove_if(query.candidates.begin(), query.candidates.end(),
+                                              [&](uint32_t i) { return !triangles[i].bounds().overlaps(box); }),
+                               query.candidates.end());
+        totalCandidates += query.candidates.size();
+    }
+    std::printf("%d queries, %.1f triangles each after the bounds test\n\n", queryCount,
+                static_cast<double>(totalCandidates) / queryCount);
+
+    std::vector<std::vector<IndexedContact>> scalarContacts(queries.size());
+    std::vector<std::vector<IndexedContact>> batch4Contacts(queries.size());
+    std::vector<std::vector<IndexedContact>> batch8Contacts(queries.size());
+    double kernel[3] = {0.0, 0.0, 0.0};
+    Result full[3];
+    uint64_t kernelHits[3] = {0, 0, 0};
+    for (int r = 0; r < repeats; r++) {
+        kernel[0] = std::max(kernel[0], scalarKernel(triangles, queries, radius + margin, kernelHits[0]));
+        kernel[1] = std::max(kernel[1], batchedKernel<4>(packed, queries, radius + margin, kernelHits[1]));
+        kernel[2] = std::max(kernel[2], batchedKernel<8>(packed, queries, radius + margin, kernelHits[2]));
+        Result runs[3] = {runScalar(triangles, queries, radius, margin, scalarContacts),
+                          runBatched<4>(triangles, packed, queries, radius, margin, batch4Contacts),
+                          runBatched<8>(triangles, packed, queries, radius, margin, batch8Contacts)};
+        for (int k = 0; k < 3; k++) {
+            if (runs[k].testsPerSecond > full[k].testsPerSecond) {
+                full[k] = runs[k];
+            }
+        }
+    }
+
+    const char* names[3] = {"scalar", "batch4", "batch8"};
+    std::printf("%-8s %16s %8s %20s %8s %10s\n", "kernel", "kernel Mtests/s", "speedup", "with contacts Mtests/s",
+                "speedup", "contacts");
+    for (int k = 0; k < 3; k++) {
+        std::printf("%-8s %16.1f %8.2f %20.1f %8.2f %10llu\n", names[k], kernel[k] / 1e6, kernel[k] / kernel[0],
+                    full[k].testsPerSecond / 1e6, full[k].testsPerSecond / full[0].testsPerSecond,
+                    static_cast<unsigned long long>(full[k].hits));
+    }
+    std::printf("\n");
+    bool passed = compare("batch4", scalarContacts, batch4Contacts, margin);
+    passed = compare("batch8", scalarContacts, batch8Contacts, margin) && passed;
+    return passed ? 0 : 1;
+}
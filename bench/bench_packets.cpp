@@ -0,0 +1,198 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "bvh/bvh.h"
+#include "bvh/ray_packet.h"
+#include "bvh/wide_bvh.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+// Reorders a row-major image of rays into tileW x tileH blocks so that
+// consecutive groups of tileW * tileH rays form screen-space packets.
+std::vector<Ray> tileRays(const std::vector<Ray>& rays, int width, int height, int tileW, int tileH) {
+    std::vector<Ray> tiled;
+    tiled.reserve(rays.size());
+    for (int ty = 0; ty < height; ty += tileH) {
+        for (int tx = 0; tx < width; tx += tileW) {
+            for (int y = ty; y < std::min(ty + tileH, height); y++) {
+                for (int x = tx; x < std::min(tx + tileW, width); x++) {
+                    tiled.push_back(rays[static_cast<size_t>(y) * width + x]);
+                }
+            }
+        }
+    }
+    return tiled;
+}
+
+// Shadow rays from every primary hit towards a point light above the level.
+std::vector<Ray> makeShadowRays(const Bvh& bvh, const std::vector<Ray>& primary) {
+    Aabb bounds = bvh.bounds();
+    glm::vec3 light = bounds.center() + glm::vec3(0.0f, bounds.extent().y * 4.0f + 2.0f, 0.0f);
+
+    std::vector<Ray> rays;
+    rays.reserve(primary.size());
+    for (const auto& ray : primary) {
+        RayHit hit;
+        if (!bvh.intersect(ray, hit)) {
+            continue;
+        }
+        glm::vec3 position = ray.origin + ray.direction * (hit.t * 0.999f);
+        glm::vec3 toLight = light - position;
+        float distance = glm::length(toLight);
+        Ray shadow;
+        shadow.origin = position;
+        shadow.direction = toLight / distance;
+        shadow.tMin = 1e-4f;
+        shadow.tMax = distance;
+        rays.push_back(shadow);
+    }
+    return rays;
+}
+
+bool sameHit(const RayHit& a, const RayHit& b) {
+    return a.valid() == b.valid() && (!a.valid() || std::fabs(a.t - b.t) <= 1e-3f * (1.0f + b.t));
+}
+
+void printRow(const char* kernel, const char* pattern, size_t rayCount, double closestMs, double anyMs,
+              size_t mismatches, double baselineMs, const PacketTraversalStats* stats) {
+    double culled = stats && stats->nodesVisited ? 100.0 * stats->nodesCulled / stats->nodesVisited : 0.0;
+    std::printf("%-9s %-10s %9.2f %9.2f %7.2fx %8zu %7.1f%%\n", kernel, pattern,
+                rayCount / (closestMs * 1000.0), rayCount / (anyMs * 1000.0),
+                baselineMs / closestMs, mismatches, culled);
+}
+
+template <int N>
+bool tracePackets(const char* kernel, const char* pattern, const Bvh& bvh, const std::vector<Ray>& rays,
+                  const std::vector<RayHit>& reference, const std::vector<uint8_t>& referenceOccluded,
+                  double baselineMs) {
+    PacketTraversalStats stats;
+    std::vector<RayHit> hits(rays.size());
+    PacketHit<N> packetHit;
+    RayPacket<N> packet;
+
+    bench::Timer timer;
+    for (size_t first = 0; first < rays.size(); first += N) {
+        int count = static_cast<int>(std::min<size_t>(N, rays.size() - first));
+        packet.load(rays.data() + first, count);
+        intersectPacket(bvh, packet, packetHit, &stats);
+        for (int lane = 0; lane < count; lane++) {
+            hits[first + lane] = packetHit.get(lane);
+        }
+    }
+    double closestMs = timer.elapsedMs();
+
+    std::vector<uint8_t> occluded(rays.size());
+    timer.reset();
+    for (size_t first = 0; first < rays.size(); first += N) {
+        int count = static_cast<int>(std::min<size_t>(N, rays.size() - first));
+        packet.load(rays.data() + first, count);
+        uint32_t mask = occludedPacket(bvh, packet);
+        for (int lane = 0; lane < count; lane++) {
+            occluded[first + lane] = (mask >> lane) & 1;
+        }
+    }
+    double anyMs = timer.elapsedMs();
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < rays.size(); i++) {
+        mismatches += !sameHit(hits[i], reference[i]) || occluded[i] != referenceOccluded[i];
+    }
+    printRow(kernel, pattern, rays.size(), closestMs, anyMs, mismatches, baselineMs, &stats);
+    return mismatches == 0;
+}
+
+// Returns false if any kernel disagrees with single-ray traversal.
+bool runPattern(const char* pattern, const Bvh& bvh, const Bvh8& bvh8, const std::vector<Ray>& rays) {
+    std::vector<RayHit> reference(rays.size());
+    bench::Timer timer;
+    for (size_t i = 0; i < rays.size(); i++) {
+        bvh.intersect(rays[i], reference[i]);
+    }
+    double baselineMs = timer.elapsedMs();
+
+    std::vector<uint8_t> referenceOccluded(rays.size());
+    timer.reset();
+    for (size_t i = 0; i < rays.size(); i++) {
+        referenceOccluded[i] = bvh.occluded(rays[i]);
+    }
+    double baselineAnyMs = timer.elapsedMs();
+    printRow("single", pattern, rays.size(), baselineMs, baselineAnyMs, 0, baselineMs, nullptr);
+
+    std::vector<RayHit> hits(rays.size());
+    timer.reset();
+    for (size_t i = 0; i < rays.size(); i++) {
+        bvh8.intersect(rays[i], hits[i]);
+    }
+    double closestMs = timer.elapsedMs();
+    timer.reset();
+    size_t mismatches = 0;
+    for (size_t i = 0; i < rays.size(); i++) {
+        mismatches += bvh8.occluded(rays[i]) != (referenceOccluded[i] != 0) || !sameHit(hits[i], reference[i]);
+    }
+    printRow("bvh8", pattern, rays.size(), closestMs, timer.elapsedMs(), mismatches, baselineMs, nullptr);
+    bool passed = mismatches == 0;
+
+    passed = tracePackets<8>("packet8", pattern, bvh, rays, reference, referenceOccluded, baselineMs) && passed;
+    passed = tracePackets<16>("packet16", pattern, bvh, rays, reference, referenceOccluded, baselineMs) && passed;
+
+    PacketTraversalStats stats;
+    timer.reset();
+    intersectStream(bvh, rays, hits, &stats);
+    closestMs = timer.elapsedMs();
+    std::vector<uint8_t> occluded;
+    timer.reset();
+    occludedStream(bvh, rays, occluded);
+    double anyMs = timer.elapsedMs();
+    mismatches = 0;
+    for (size_t i = 0; i < rays.size(); i++) {
+        mismatches += !sameHit(hits[i], reference[i]) || occluded[i] != referenceOccluded[i];
+    }
+    printRow("stream16", pattern, rays.size(), closestMs, anyMs, mismatches, baselineMs, &stats);
+    return passed && mismatches == 0;
+}
+
+bool runScene(const char* name, const TriangleMesh& mesh, int rayDim) {
+    BvhBuildSettings settings;
+    settings.maxLeafSize = 4;
+    Bvh bvh;
+    bvh.build(mesh, settings);
+
+    settings.maxLeafSize = 8;
+    Bvh bvhWide;
+    bvhWide.build(mesh, settings);
+    Bvh8 bvh8;
+    bvh8.build(bvhWide);
+
+    std::printf("\n%s: %zu triangles\n", name, mesh.size());
+    std::printf("%-9s %-10s %9s %9s %8s %8s %8s\n", "kernel", "rays", "closest", "any-hit", "speedup",
+                "mismatch", "culled");
+
+    std::vector<Ray> primary = tileRays(bench::makeCoherentRays(bvh.bounds(), rayDim, rayDim),
+                                        rayDim, rayDim, 4, 4);
+    bool passed = runPattern("primary", bvh, bvh8, primary);
+    passed = runPattern("shadow", bvh, bvh8, makeShadowRays(bvh, primary)) && passed;
+    passed = runPattern("secondary", bvh, bvh8,
+                        bench::makeIncoherentRays(bvh.bounds(), static_cast<size_t>(rayDim) * rayDim, 7u)) &&
+             passed;
+    return passed;
+}
+
+} // namespace
+
+// Usage: MazeBench packets [mazeCells] [raysPerSide]
+// Primary rays are traced in 4x4 screen tiles; speedup is closest-hit
+// throughput relative to single-ray traversal of the same binary BVH. Fails
+// if any kernel's hits or occlusion differ from single-ray traversal.
+int runPacketBenchmark(int argc, char** argv) {
+    int cells = bench::intArg(argc, argv, 0, 200);
+    int rayDim = bench::intArg(argc, argv, 1, 512);
+
+    bool passed = runScene("maze.obj", TriangleMesh::loadObj(bench::assetPath("models/maze.obj")), rayDim);
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "synthetic %dx%d", cells, cells);
+    passed = runScene(name, bench::makeSyntheticMaze(cells, cells, 1234u), rayDim) && passed;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "core/thread_pool.h"
+#include "renderer/path_tracer.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Usage: MazeBench pathtracer [samplesPerPixel] [outputPng]
+// Renders the maze + sphere scene at 320x240 with 1..N threads and reports
+// paths per second and the speedup over a single thread.
+int runPathTracerBenchmark(int argc, char** argv) {
+    int samples = bench::intArg(argc, argv, 0, 8);
+    const char* outputPath = argc > 1 ? argv[1] : nullptr;
+
+    PathTracerScene scene;
+    scene.addMesh(TriangleMesh::loadObj(bench::assetPath("models/maze.obj")), PathTracerMaterial{glm::vec3(0.75f), 0.0f});
+    glm::mat4 spherePlacement = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    scene.addMesh([&]() {
+        TriangleMesh sphere;
+        TriangleMesh loaded = TriangleMesh::loadObj(bench::assetPath("models/sphere.obj"));
+        for (const auto& tri : loaded.getTriangles()) {
+            sphere.append(Triangle{glm::vec3(spherePlacement * glm::vec4(tri.v0, 1.0f)),
+                                   glm::vec3(spherePlacement * glm::vec4(tri.v1, 1.0f)),
+                                   glm::vec3(spherePlacement * glm::vec4(tri.v2, 1.0f))});
+        }
+        return sphere;
+    }(), PathTracerMaterial{glm::vec3(0.95f), 1.0f});
+    scene.build(ThreadPool::global());
+
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 9.0f, 9.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 320.0f / 240.0f, 0.1f, 100.0f);
+
+    PathTracerSettings settings;
+    settings.width = 320;
+    settings.height = 240;
+
+    // Powers of two below the core count, then the core count itself.
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    double baseline = 0.0;
+    std::printf("%8s %10s %12s %9s\n", "threads", "ms", "Mpaths/s", "speedup");
+    for (unsigned threads : threadCounts) {
+        ThreadPool pool(threads);
+        PathTracer tracer(scene, pool, settings);
+        tracer.setCamera(view, projection);
+        tracer.render(samples);
+
+        double pathsPerSecond = tracer.getPathCount() / (tracer.getRenderMs() / 1000.0);
+        if (threads == 1) {
+            baseline = pathsPerSecond;
+        }
+        std::printf("%8u %10.1f %12.3f %9.2f\n", threads, tracer.getRenderMs(),
+                    pathsPerSecond / 1e6, pathsPerSecond / baseline);
+
+        if (outputPath && threads == maxThreads) {
+            tracer.savePng(outputPath);
+        }
+    }
+    return 0;
+}
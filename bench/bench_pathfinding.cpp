@@ -0,0 +1,123 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "core/thread_pool.h"
+#include "maze/maze_generator.h"
+#include "nav/distance_field.h"
+#include "nav/maze_pathfinder.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+bool reportMaze(const char* name, const MazeGrid& grid, int queryCount, ThreadPool& serialPool,
+                ThreadPool& parallelPool) {
+    std::mt19937 rng(11u);
+    std::uniform_int_distribution<uint32_t> anyCell(0, static_cast<uint32_t>(grid.getCellCount() - 1));
+    std::vector<std::pair<uint32_t, uint32_t>> queries(queryCount);
+    for (auto& query : queries) {
+        query = {anyCell(rng), anyCell(rng)};
+    }
+
+    MazePathfinder pathfinder(grid);
+    std::vector<uint32_t> path;
+    std::vector<size_t> lengths(queryCount);
+    uint64_t aStarExpanded = 0;
+    bench::Timer timer;
+    for (int i = 0; i < queryCount; i++) {
+        pathfinder.findPathAStar(queries[i].first, queries[i].second, path);
+        lengths[i] = path.size();
+        aStarExpanded += pathfinder.getExpandedNodes();
+    }
+    double aStarMs = timer.elapsedMs();
+
+    bool jpsMatches = true;
+    uint64_t jpsExpanded = 0;
+    timer.reset();
+    for (int i = 0; i < queryCount; i++) {
+        pathfinder.findPathJps(queries[i].first, queries[i].second, path);
+        jpsMatches = jpsMatches && path.size() == lengths[i] && path.front() == queries[i].first &&
+                     path.back() == queries[i].second;
+        jpsExpanded += pathfinder.getExpandedNodes();
+    }
+    double jpsMs = timer.elapsedMs();
+
+    // One field per goal; queries then follow the field from their start.
+    uint32_t goal = queries[0].second;
+    DistanceField field;
+    timer.reset();
+    field.build(grid, goal, serialPool);
+    double buildSerialMs = timer.elapsedMs();
+    timer.reset();
+    field.build(grid, goal, parallelPool);
+    double buildPoolMs = timer.elapsedMs();
+
+    // O(1) hints: the next step from random cells.
+    const int hintCount = 1000000;
+    uint64_t checksum = 0;
+    timer.reset();
+    for (int i = 0; i < hintCount; i++) {
+        checksum += field.nextStep(grid, anyCell(rng));
+    }
+    double hintMs = timer.elapsedMs();
+
+    // Following the field must give the A* path length to the same goal.
+    bool fieldMatches = true;
+    for (int i = 0; i < queryCount; i++) {
+        if (queries[i].second != goal) {
+            continue;
+        }
+        size_t steps = 1;
+        for (uint32_t cell = queries[i].first; cell != goal; cell = field.nextStep(grid, cell)) {
+            steps++;
+        }
+        fieldMatches = fieldMatches && steps == lengths[i];
+    }
+    pathfinder.findPathAStar(queries[1].first, goal, path);
+    size_t walked = 1;
+    for (uint32_t cell = queries[1].first; cell != goal; cell = field.nextStep(grid, cell)) {
+        walked++;
+    }
+    fieldMatches = fieldMatches && walked == path.size();
+
+    double meanLength = 0.0;
+    for (size_t length : lengths) {
+        meanLength += static_cast<double>(length) / queryCount;
+    }
+    std::printf("%-12s %10.0f %10.1f %10.1f %12.0f %12.0f %8s\n", name, meanLength, queryCount / aStarMs * 1000.0,
+                queryCount / jpsMs * 1000.0, static_cast<double>(aStarExpanded) / queryCount,
+                static_cast<double>(jpsExpanded) / queryCount, jpsMatches ? "yes" : "NO");
+    std::printf("%-12s field build %.1f ms (1 thread) / %.1f ms (pool), %.1f MB, max distance %u%s; "
+                "%.1f M hints/s; path by field matches A*: %s (checksum %llu)\n",
+                "", buildSerialMs, buildPoolMs, field.memoryBytes() / (1024.0 * 1024.0), field.getMaxDistance(),
+                field.isExact() ? "" : " (wrapped)", hintCount / hintMs / 1000.0, fieldMatches ? "yes" : "NO",
+                static_cast<unsigned long long>(checksum));
+    return jpsMatches && fieldMatches;
+}
+
+} // namespace
+
+// Usage: MazeBench pathfinding [size] [queries]
+// Random start/goal queries on size^2 mazes from each generator: A* and
+// JPS queries per second and nodes expanded per query (JPS must return
+// paths of the same length), then a BFS distance field to one goal:
+// build time on one thread and on the pool, memory, next-step hints per
+// second, and paths followed through the field checked against A*. Fails
+// if JPS or the field disagree with A*.
+int runPathfindingBenchmark(int argc, char** argv) {
+    uint32_t size = static_cast<uint32_t>(bench::intArg(argc, argv, 0, 1000));
+    int queryCount = bench::intArg(argc, argv, 1, 50);
+
+    ThreadPool serialPool(1);
+    ThreadPool& parallelPool = ThreadPool::global();
+    std::printf("%ux%u mazes, %d queries, %u threads\n\n", size, size, queryCount, parallelPool.getThreadCount());
+    std::printf("%-12s %10s %10s %10s %12s %12s %8s\n", "maze", "mean path", "A* q/s", "JPS q/s", "A* expanded",
+                "JPS expanded", "match");
+    bool passed = reportMaze("backtracker", generateMaze(size, size, MazeAlgorithm::Backtracker, 3u), queryCount,
+                             serialPool, parallelPool);
+    passed = reportMaze("wilson", generateMaze(size, size, MazeAlgorithm::Wilson, 3u), queryCount, serialPool,
+                        parallelPool) && passed;
+    passed = reportMaze("eller", generateMaze(size, size, MazeAlgorithm::Eller, 3u), queryCount, serialPool,
+                        parallelPool) && passed;
+    return passed ? 0 : 1;
+}
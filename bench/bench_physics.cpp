@@ -0,0 +1,197 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "physics/physics_world.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Balls spread over the level interior, rolling in deterministic directions.
+void addBalls(PhysicsWorld& world, const Aabb& level, int count, float radius) {
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(count))));
+    for (int i = 0; i < count; i++) {
+        float fx = (i % side + 0.5f) / side;
+        float fz = (i / side + 0.5f) / side;
+        BodyDesc desc;
+        desc.radius = radius;
+        desc.position = glm::vec3(level.min.x + fx * level.extent().x, level.max.y + radius * 2.0f,
+                                  level.min.z + fz * level.extent().z);
+        float angle = i * 2.39996323f;
+        desc.velocity = glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * 2.0f;
+        world.addBody(desc);
+    }
+}
+
+struct RunResult {
+    double stepsPerSecond;
+    double contactsPerStep;
+    double testsPerStep;
+    std::vector<RigidBody> finalState;
+};
+
+RunResult simulate(const TriangleMesh& level, int ballCount, float radius, int steps) {
+    PhysicsWorld world;
+    world.setStaticGeometry(level);
+    addBalls(world, level.bounds(), ballCount, radius);
+
+    uint64_t contacts = 0;
+    bench::Timer timer;
+    for (int i = 0; i < steps; i++) {
+        world.step();
+        contacts += world.getStats().contactCount;
+    }
+    double ms = timer.elapsedMs();
+
+    RunResult result;
+    result.stepsPerSecond = steps / (ms / 1000.0);
+    result.contactsPerStep = static_cast<double>(contacts) / steps;
+    result.testsPerStep = static_cast<double>(world.getStats().triangleTests) / steps;
+    for (uint32_t i = 0; i < world.getBodyCount(); i++) {
+        result.finalState.push_back(world.getBody(i));
+    }
+    return result;
+}
+
+// Returns false if the two runs differ.
+bool report(const char* name, const TriangleMesh& level, int ballCount, float radius, int steps) {
+    RunResult first = simulate(level, ballCount, radius, steps);
+    RunResult second = simulate(level, ballCount, radius, steps);
+    bool deterministic = std::memcmp(first.finalState.data(), second.finalState.data(),
+                                     first.finalState.size() * sizeof(RigidBody)) == 0;
+    std::printf("%-18s %9zu %6d %11.0f %10.1f %10.1f %14s\n", name, level.size(), ballCount,
+                first.stepsPerSecond, first.contactsPerStep, first.testsPerStep,
+                deterministic ? "yes" : "NO");
+    return deterministic;
+}
+
+// Drops a ball onto a flat floor and reports the rebound and the rest state.
+// Returns false if the rebound is more than 25% off the restitution ideal,
+// the ball does not rest on the floor or it slips instead of rolling.
+bool reportDrop() {
+    TriangleMesh floor;
+    bench::appendBox(floor, glm::vec3(-50.0f, -1.0f, -50.0f), glm::vec3(50.0f, 0.0f, 50.0f));
+    PhysicsWorld world;
+    world.setStaticGeometry(floor);
+    BodyDesc desc;
+    desc.position = glm::vec3(0.0f, 2.0f, 0.0f);
+    desc.restitution = 0.5f;
+    uint32_t ball = world.addBody(desc);
+
+    float peak = 0.0f;
+    bool falling = true;
+    for (int i = 0; i < 240; i++) {
+        world.step();
+        const RigidBody& body = world.getBody(ball);
+        if (falling && body.velocity.y > 0.0f) {
+            falling = false;
+        }
+        if (!falling) {
+            peak = std::max(peak, body.position.y - body.radius);
+        }
+    }
+    // Roll along the floor and let friction and rolling resistance stop it.
+    world.getBody(ball).velocity = glm::vec3(3.0f, 0.0f, 0.0f);
+    for (int i = 0; i < 1200; i++) {
+        world.step();
+    }
+    const RigidBody& body = world.getBody(ball);
+    float ideal = 1.5f * 0.25f;
+    float restHeight = body.position.y - body.radius;
+    float speed = glm::length(body.velocity);
+    float spin = glm::length(body.angularVelocity) * body.radius;
+    bool bounced = std::abs(peak - ideal) <= 0.25f * ideal;
+    bool rolled = std::abs(restHeight) < 0.01f && speed < 3.0f && std::abs(spin - speed) <= 0.02f * speed + 1e-3f;
+    std::printf("drop from 1.5 with e=0.5: rebound %.3f (ideal %.3f)%s\n", peak, ideal, bounced ? "" : " FAILED");
+    std::printf("roll at 3 m/s: rest height %.4f, after 10 s speed %.3f, spin * radius %.3f%s\n", restHeight, speed,
+                spin, rolled ? "" : " FAILED");
+    return bounced && rolled;
+}
+
+const char* modeName(bool speculative, bool ccd) {
+    if (speculative) {
+        return ccd ? "speculative+ccd" : "speculative";
+    }
+    return ccd ? "ccd" : "discrete";
+}
+
+// Fires a ball at a 0.1-thick wall (thinner than the 0.36 slab in maze.obj)
+// and checks whether it ever passes through it. Returns false if it does
+// with speculative contacts or CCD on; discrete steps are expected to
+// tunnel at speed.
+bool reportTunneling() {
+    TriangleMesh level;
+    bench::appendBox(level, glm::vec3(-50.0f, -1.0f, -50.0f), glm::vec3(50.0f, 0.0f, 50.0f));
+    bench::appendBox(level, glm::vec3(5.0f, 0.0f, -50.0f), glm::vec3(5.1f, 2.0f, 50.0f));
+
+    std::printf("\n%-16s %7s %9s %11s %10s %10s %10s\n", "mode", "speed", "tunneled", "ccd iters", "ccd hits",
+                "contact us", "ccd us");
+    bool passed = true;
+    for (bool speculative : {false, true}) {
+        for (bool ccd : {false, true}) {
+            for (float speed : {10.0f, 60.0f, 200.0f, 3000.0f}) {
+                PhysicsSettings settings;
+                settings.speculativeContacts = speculative;
+                settings.continuousCollision = ccd;
+                PhysicsWorld world(settings);
+                world.setStaticGeometry(level);
+                BodyDesc desc;
+                desc.radius = 0.25f;
+                desc.position = glm::vec3(0.3f, 0.25f, 0.0f);
+                desc.velocity = glm::vec3(speed, 0.0f, 0.0f);
+                uint32_t ball = world.addBody(desc);
+
+                const int steps = 120;
+                uint64_t iterations = 0;
+                uint64_t hits = 0;
+                double contactMs = 0.0;
+                double ccdMs = 0.0;
+                bool tunneled = false;
+                for (int i = 0; i < steps; i++) {
+                    glm::vec3 before = world.getBody(ball).position;
+                    world.step();
+                    glm::vec3 after = world.getBody(ball).position;
+                    const PhysicsStats& stats = world.getStats();
+                    iterations += stats.ccdIterations;
+                    hits += stats.ccdHits;
+                    contactMs += stats.contactMs;
+                    ccdMs += stats.ccdMs;
+                    // Crossing the wall's plane below its top; going over it is fine.
+                    tunneled = tunneled || (before.x < 5.0f && after.x > 5.1f && std::max(before.y, after.y) < 2.0f);
+                }
+                std::printf("%-16s %7.0f %9s %11.2f %10.2f %10.2f %10.2f\n", modeName(speculative, ccd), speed,
+                            tunneled ? "YES" : "no", static_cast<double>(iterations) / steps,
+                            static_cast<double>(hits) / steps, contactMs * 1000.0 / steps, ccdMs * 1000.0 / steps);
+                passed = passed && !(tunneled && (speculative || ccd));
+            }
+        }
+    }
+    return passed;
+}
+
+} // namespace
+
+// Usage: MazeBench physics [balls] [steps]
+// Triangles come from the static grid broadphase (see the broadphase
+// benchmark); both runs must match bit for bit. The tunneling table gives
+// CCD iterations and hits per step and the per-step cost (us) of discrete
+// contact search versus sweeps. Exits non-zero if the drop, roll,
+// tunneling or determinism checks fail; CTest runs it as physics_checks.
+int runPhysicsBenchmark(int argc, char** argv) {
+    int balls = bench::intArg(argc, argv, 0, 16);
+    int steps = bench::intArg(argc, argv, 1, 1200);
+
+    bool passed = reportDrop();
+    passed = reportTunneling() && passed;
+    std::printf("\n%-18s %9s %6s %11s %10s %10s %14s\n", "level", "tris", "balls", "steps/s",
+                "contacts", "tri tests", "deterministic");
+    passed = report("maze.obj", TriangleMesh::loadObj(bench::assetPath("models/maze.obj")), 1, 1.0f, steps) && passed;
+    for (int cells : {10, 30, 100}) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "synthetic %dx%d", cells, cells);
+        passed = report(name, bench::makeSyntheticMaze(cells, cells, 5u), balls, 0.25f, steps) && passed;
+    }
+    return passed ? 0 : 1;
+}
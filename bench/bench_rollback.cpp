@@ -0,0 +1,129 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "physics/physics_world.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+// FNV-1a over the saved state, to compare runs and processes.
+uint64_t hashState(const PhysicsState& state) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&](const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    mix(&state.stepCount, sizeof(state.stepCount));
+    mix(&state.accumulator, sizeof(state.accumulator));
+    mix(state.bodies.data(), state.bodies.size() * sizeof(BodyState));
+    return hash;
+}
+
+// Balls rolling in random directions, spread over the whole level so some
+// islands fall asleep while others are still moving.
+void setUpWorld(PhysicsWorld& world, const TriangleMesh& level, int cells, int ballCount) {
+    world.setStaticGeometry(level);
+    std::mt19937 rng(3u);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < ballCount; i++) {
+        int cell = static_cast<int>(static_cast<int64_t>(i) * cells * cells / ballCount);
+        BodyDesc desc;
+        desc.radius = 0.2f;
+        desc.position = glm::vec3(cell % cells + 0.3f + unit(rng) * 0.4f, 0.21f, cell / cells + 0.3f + unit(rng) * 0.4f);
+        float angle = unit(rng) * 6.2831853f;
+        desc.velocity = glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * (unit(rng) * 2.0f);
+        world.addBody(desc);
+    }
+}
+
+} // namespace
+
+// Usage: MazeBench rollback [balls] [steps]
+// Saves and restores the world state of a large level: snapshot size, the
+// cost of a save and of a restore, and of resimulating `steps` steps from
+// the restored state. The resimulation, and a rewind part way through it,
+// must end bit for bit where the original run did, or the benchmark
+// fails; the final state hash must also match between runs of the same
+// binary.
+int runRollbackBenchmark(int argc, char** argv) {
+    int ballCount = bench::intArg(argc, argv, 0, 4000);
+    int steps = bench::intArg(argc, argv, 1, 60);
+    const int cells = 100;
+    const int warmupSteps = 120;
+    const int repeats = 200;
+
+    TriangleMesh level = bench::makeSyntheticMaze(cells, cells, 5u);
+    PhysicsWorld world;
+    setUpWorld(world, level, cells, ballCount);
+    for (int i = 0; i < warmupSteps; i++) {
+        world.step();
+    }
+
+    PhysicsState saved;
+    world.saveState(saved);
+    bench::Timer timer;
+    for (int i = 0; i < repeats; i++) {
+        world.saveState(saved);
+    }
+    double saveUs = timer.elapsedMs() * 1000.0 / repeats;
+    timer.reset();
+    for (int i = 0; i < repeats; i++) {
+        world.restoreState(saved);
+    }
+    double restoreUs = timer.elapsedMs() * 1000.0 / repeats;
+
+    // Original run, with a checkpoint half way.
+    PhysicsState halfway;
+    PhysicsState original;
+    timer.reset();
+    for (int i = 0; i < steps; i++) {
+        if (i == steps / 2) {
+            world.saveState(halfway);
+        }
+        world.step();
+    }
+    double originalMs = timer.elapsedMs();
+    world.saveState(original);
+    uint32_t sleeping = world.getStats().sleepingBodyCount;
+
+    // Rewind to the start and resimulate everything.
+    PhysicsState replayed;
+    timer.reset();
+    world.restoreState(saved);
+    for (int i = 0; i < steps; i++) {
+        world.step();
+    }
+    double resimMs = timer.elapsedMs();
+    world.saveState(replayed);
+    bool resimMatches = hashState(replayed) == hashState(original) &&
+                        std::memcmp(replayed.bodies.data(), original.bodies.data(),
+                                    original.bodies.size() * sizeof(BodyState)) == 0;
+
+    // Rewind to the checkpoint and finish from there.
+    world.restoreState(halfway);
+    for (int i = steps / 2; i < steps; i++) {
+        world.step();
+    }
+    world.saveState(replayed);
+    bool rewindMatches = std::memcmp(replayed.bodies.data(), original.bodies.data(),
+                                     original.bodies.size() * sizeof(BodyState)) == 0;
+
+    std::printf("%d balls (%u asleep at the end), %zu triangles, %d steps\n\n", ballCount, sleeping, level.size(),
+                steps);
+    std::printf("%-24s %12zu bytes (%zu per body, %zu for a full RigidBody)\n", "snapshot", saved.byteSize(),
+                sizeof(BodyState), sizeof(RigidBody));
+    std::printf("%-24s %12.1f us\n", "save", saveUs);
+    std::printf("%-24s %12.1f us\n", "restore", restoreUs);
+    std::printf("%-24s %12.2f ms (%.0f steps/s)\n", "original run", originalMs, steps / (originalMs / 1000.0));
+    std::printf("%-24s %12.2f ms (%.0f steps/s)\n", "restore + resimulate", resimMs, steps / (resimMs / 1000.0));
+    std::printf("%-24s %12s\n", "resimulation identical", resimMatches ? "yes" : "NO");
+    std::printf("%-24s %12s\n", "halfway rewind identical", rewindMatches ? "yes" : "NO");
+    std::printf("%-24s %016llx\n", "final state hash", static_cast<unsigned long long>(hashState(original)));
+    return resimMatches && rewindMatches ? 0 : 1;
+}
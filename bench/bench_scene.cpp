@@ -0,0 +1,159 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "bvh/scene_bvh.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+struct MovingBody {
+    glm::vec3 position;
+    glm::vec3 velocity;
+    float phase;
+    uint32_t instance[3];
+};
+
+// One scene per update policy, all fed the same transforms every frame.
+struct PolicyScene {
+    const char* name;
+    SceneBvhUpdate mode;
+    SceneBvh scene;
+    double totalMs = 0.0;
+    double worstMs = 0.0;
+};
+
+double traceMrays(const SceneBvh& scene, const std::vector<Ray>& rays, std::vector<RayHit>& hits) {
+    hits.assign(rays.size(), RayHit());
+    bench::Timer timer;
+    for (size_t i = 0; i < rays.size(); i++) {
+        scene.intersect(rays[i], hits[i]);
+    }
+    return rays.size() / (timer.elapsedMs() * 1000.0);
+}
+
+} // namespace
+
+// Usage: MazeBench scene [instances] [frames]
+// Balls roll around a static maze instance while platforms bob up and down.
+// Each frame the top level is refitted, rebuilt, or updated automatically;
+// update time, SAH cost and closest-hit throughput are compared. Fails if
+// the policies' hits disagree.
+int runSceneBenchmark(int argc, char** argv) {
+    int instanceCount = bench::intArg(argc, argv, 0, 4096);
+    int frames = bench::intArg(argc, argv, 1, 240);
+    const float dt = 1.0f / 60.0f;
+
+    TriangleMesh maze = bench::makeSyntheticMaze(64, 64, 99u);
+    TriangleMesh sphere = TriangleMesh::loadObj(bench::assetPath("models/sphere.obj"));
+    TriangleMesh platform;
+    bench::appendBox(platform, glm::vec3(-0.4f, -0.05f, -0.4f), glm::vec3(0.4f, 0.05f, 0.4f));
+    Aabb level = maze.bounds();
+
+    PolicyScene policies[] = {
+        {"refit", SceneBvhUpdate::Refit, SceneBvh()},
+        {"rebuild", SceneBvhUpdate::Rebuild, SceneBvh()},
+        {"auto", SceneBvhUpdate::Auto, SceneBvh()},
+    };
+
+    // Bottom levels are built once; only the sphere scale differs per instance.
+    uint32_t state = 7u;
+    auto uniform = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) * (1.0f / 16777216.0f);
+    };
+    glm::vec3 sphereExtent = sphere.bounds().extent();
+    float sphereScale = 0.3f / std::max(sphereExtent.x, std::max(sphereExtent.y, sphereExtent.z));
+
+    std::vector<MovingBody> bodies(instanceCount);
+    for (auto& body : bodies) {
+        body.position = level.min + glm::vec3(uniform(), 0.0f, uniform()) * level.extent();
+        body.position.y = 0.15f;
+        float angle = uniform() * 6.2831853f;
+        body.velocity = glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * (1.0f + 3.0f * uniform());
+        body.phase = uniform() * 6.2831853f;
+    }
+
+    double addMs[3] = {};
+    for (int p = 0; p < 3; p++) {
+        SceneBvh& scene = policies[p].scene;
+        bench::Timer timer;
+        uint32_t mazeMesh = scene.addMesh(maze);
+        uint32_t sphereMesh = scene.addMesh(sphere);
+        uint32_t platformMesh = scene.addMesh(platform);
+        addMs[p] = timer.elapsedMs();
+
+        scene.addInstance(mazeMesh, glm::mat4(1.0f));
+        for (size_t i = 0; i < bodies.size(); i++) {
+            // Every eighth body is a moving platform.
+            bool isPlatform = i % 8 == 0;
+            glm::mat4 transform = glm::translate(glm::mat4(1.0f), bodies[i].position);
+            if (!isPlatform) {
+                transform = glm::scale(transform, glm::vec3(sphereScale));
+            }
+            bodies[i].instance[p] = scene.addInstance(isPlatform ? platformMesh : sphereMesh, transform);
+        }
+        scene.update(SceneBvhUpdate::Rebuild);
+    }
+
+    std::printf("bottom levels built once in %.2f ms (%zu + %zu + %zu triangles), %d instances\n",
+                addMs[0], maze.size(), sphere.size(), platform.size(), instanceCount + 1);
+    std::printf("%6s %-8s %9s %9s %9s %8s\n", "frame", "policy", "update ms", "sah", "Mrays/s", "rebuilds");
+
+    std::vector<Ray> rays = bench::makeCoherentRays(level, 128, 128);
+    std::vector<RayHit> reference, hits;
+    size_t mismatches = 0;
+
+    for (int frame = 1; frame <= frames; frame++) {
+        float time = frame * dt;
+        for (size_t i = 0; i < bodies.size(); i++) {
+            MovingBody& body = bodies[i];
+            bool isPlatform = i % 8 == 0;
+            glm::mat4 transform;
+            if (isPlatform) {
+                glm::vec3 position = body.position + glm::vec3(0.0f, 0.5f + 0.5f * std::sin(time * 2.0f + body.phase), 0.0f);
+                transform = glm::translate(glm::mat4(1.0f), position);
+            } else {
+                body.position += body.velocity * dt;
+                for (int axis = 0; axis < 3; axis += 2) {
+                    if (body.position[axis] < level.min[axis] || body.position[axis] > level.max[axis]) {
+                        body.velocity[axis] = -body.velocity[axis];
+                    }
+                }
+                transform = glm::scale(glm::translate(glm::mat4(1.0f), body.position), glm::vec3(sphereScale));
+            }
+            for (auto& policy : policies) {
+                policy.scene.setTransform(body.instance[&policy - policies], transform);
+            }
+        }
+
+        for (auto& policy : policies) {
+            policy.scene.update(policy.mode);
+            policy.totalMs += policy.scene.getStats().updateMs;
+            policy.worstMs = std::max(policy.worstMs, policy.scene.getStats().updateMs);
+        }
+
+        if (frame % 60 == 0 || frame == frames) {
+            for (auto& policy : policies) {
+                const SceneBvhStats& stats = policy.scene.getStats();
+                double mrays = traceMrays(policy.scene, rays, &policy == policies ? reference : hits);
+                if (&policy != policies) {
+                    for (size_t i = 0; i < rays.size(); i++) {
+                        mismatches += hits[i].valid() != reference[i].valid() ||
+                                      hits[i].instanceId != reference[i].instanceId;
+                    }
+                }
+                std::printf("%6d %-8s %9.3f %9.2f %9.2f %8u\n", frame, policy.name, stats.updateMs,
+                            stats.sahCost, mrays, stats.rebuildCount);
+            }
+        }
+    }
+
+    std::printf("\n%-8s %12s %12s\n", "policy", "mean ms", "worst ms");
+    for (const auto& policy : policies) {
+        std::printf("%-8s %12.3f %12.3f\n", policy.name, policy.totalMs / frames, policy.worstMs);
+    }
+    std::printf("hit mismatches between policies: %zu\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
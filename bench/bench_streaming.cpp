@@ -0,0 +1,147 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "world/chunk_streamer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Stands in for the GPU: counts live chunks and optionally keeps the meshes.
+class RecordingUploader : public ChunkUploader {
+public:
+    explicit RecordingUploader(bool keepMeshes) : keepMeshes(keepMeshes) {}
+
+    uint32_t upload(MazeMeshChunk&& mesh) override {
+        live++;
+        if (keepMeshes) {
+            meshes[{mesh.chunkX, mesh.chunkZ}] = std::move(mesh);
+        }
+        return nextHandle++;
+    }
+
+    void release(uint32_t) override { live--; }
+
+    bool keepMeshes;
+    uint32_t live = 0;
+    uint32_t nextHandle = 0;
+    std::map<std::pair<uint32_t, uint32_t>, MazeMeshChunk> meshes;
+};
+
+// Chunks streamed in one at a time, with their neighbours generated around
+// them, must mesh exactly like the same chunks cut from the whole maze.
+void reportConsistency() {
+    MazeWorld world(300, 300, 32, 77u);
+    MazeGrid whole = world.generate(0, 0, world.getChunksX(), world.getChunksZ());
+    MazeMeshSettings meshSettings;
+    meshSettings.origin = glm::vec3(-150.0f, 0.0f, -150.0f);
+    std::vector<MazeMeshChunk> expected = buildMazeMeshes(whole, meshSettings, ThreadPool::global());
+
+    RecordingUploader uploader(true);
+    ThreadPool pool(2);
+    StreamingSettings settings;
+    settings.loadRadius = 1000.0f;
+    settings.unloadRadius = 1000.0f;
+    ChunkStreamer streamer(world, meshSettings, uploader, pool, settings);
+    int frames = 0;
+    while ((uploader.meshes.size() < expected.size() || streamer.getStats().pendingChunks > 0) && frames < 10000) {
+        streamer.update(glm::vec3(0.0f));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        frames++;
+    }
+
+    bool matches = uploader.meshes.size() == expected.size();
+    for (const MazeMeshChunk& chunk : expected) {
+        auto it = uploader.meshes.find({chunk.chunkX, chunk.chunkZ});
+        if (it == uploader.meshes.end() || it->second.indices != chunk.indices ||
+            it->second.vertices.size() != chunk.vertices.size()) {
+            matches = false;
+            continue;
+        }
+        // Positions are rounded differently once the block origin is added.
+        for (size_t v = 0; v < chunk.vertices.size(); v++) {
+            glm::vec3 offset = it->second.vertices[v].position - chunk.vertices[v].position;
+            matches = matches && glm::dot(offset, offset) < 1e-8f &&
+                      it->second.vertices[v].normal == chunk.vertices[v].normal;
+        }
+    }
+    std::printf("300x300 world in %u chunks: perfect %s, streamed chunks match whole-maze meshing: %s\n",
+                world.getChunksX() * world.getChunksZ(), whole.isPerfect() ? "yes" : "NO", matches ? "yes" : "NO");
+}
+
+// A camera flying across a huge maze at `speed` m/s, frames paced at 60 Hz
+// with the rest of the frame spent sleeping, as if rendering.
+void reportFlight(uint32_t worldSize, float speed, float seconds, const StreamingSettings& settings) {
+    MazeWorld world(worldSize, worldSize, 32, 5u);
+    MazeMeshSettings meshSettings;
+    RecordingUploader uploader(false);
+    ThreadPool pool(2);
+    ChunkStreamer streamer(world, meshSettings, uploader, pool, settings);
+
+    const double frameMs = 1000.0 / 60.0;
+    int frames = static_cast<int>(seconds * 60.0f);
+    glm::vec3 position(0.5f * worldSize, 1.7f, 0.5f * worldSize);
+    glm::vec3 direction = glm::normalize(glm::vec3(1.0f, 0.0f, 0.6f));
+    double missingSum = 0.0;
+    uint32_t maxResident = 0;
+    double bandwidthSum = 0.0;
+    int bandwidthSamples = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        bench::Timer timer;
+        streamer.update(position);
+        const StreamingStats& stats = streamer.getStats();
+        // Skip the initial fill.
+        if (frame >= 60) {
+            missingSum += stats.missingChunks;
+            bandwidthSum += stats.uploadMBps;
+            bandwidthSamples++;
+        }
+        maxResident = std::max(maxResident, stats.residentChunks);
+        position += direction * (speed / 60.0f);
+        double rest = frameMs - timer.elapsedMs();
+        if (rest > 0.0) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(rest));
+        }
+    }
+    StreamingStats stats = streamer.getStats();
+    bool accounted = uploader.live == stats.residentChunks;
+    streamer.clear();
+    std::printf("%8.0f %8u %8u %10.1f %10.2f %10.2f %10llu %8llu %10.2f %10s\n", speed, stats.residentChunks,
+                maxResident, stats.residentBytes / (1024.0 * 1024.0),
+                bandwidthSamples ? bandwidthSum / bandwidthSamples : 0.0,
+                frames > 60 ? missingSum / (frames - 60) : 0.0,
+                static_cast<unsigned long long>(stats.totalEvictions),
+                static_cast<unsigned long long>(stats.hitchCount), stats.maxUpdateMs,
+                accounted && uploader.live == 0 ? "yes" : "NO");
+}
+
+} // namespace
+
+// Usage: MazeBench streaming [worldSize] [seconds]
+// Chunk streaming over a generated maze of worldSize^2 cells: first checks
+// that chunks streamed one by one mesh exactly like the whole maze, then
+// flies a camera across the world at increasing speeds, reporting resident
+// chunks and memory, upload bandwidth, chunks still missing inside the
+// load radius per frame (pop-in), evictions, and hitches (updates over
+// hitchMs). The uploader's live count must match the resident chunks and
+// drop to zero after clear.
+int runStreamingBenchmark(int argc, char** argv) {
+    uint32_t worldSize = static_cast<uint32_t>(bench::intArg(argc, argv, 0, 100000));
+    float seconds = static_cast<float>(bench::intArg(argc, argv, 1, 4));
+
+    reportConsistency();
+
+    StreamingSettings settings;
+    std::printf("\nworld %ux%u cells, load radius %.0f m, unload %.0f m, budget %zu KB/frame\n\n", worldSize,
+                worldSize, settings.loadRadius, settings.unloadRadius, settings.uploadBudgetBytes / 1024);
+    std::printf("%8s %8s %8s %10s %10s %10s %10s %8s %10s %10s\n", "speed", "resident", "max", "MB", "MB/s",
+                "missing", "evictions", "hitches", "max ms", "released");
+    for (float speed : {5.0f, 20.0f, 80.0f}) {
+        reportFlight(worldSize, speed, seconds, settings);
+    }
+    return 0;
+}
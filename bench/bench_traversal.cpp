@@ -0,0 +1,115 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "bvh/bvh.h"
+#include "bvh/wide_bvh.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+// The binary BVH's results, which the wide BVHs must reproduce.
+struct Reference {
+    std::vector<RayHit> hits;
+    std::vector<uint8_t> occluded;
+};
+
+// Returns false if the results differ from the reference (when one is given).
+template <typename Accel>
+bool traceRays(const char* label, const char* pattern, const Accel& accel,
+               const std::vector<Ray>& rays, const Reference& reference) {
+    std::vector<RayHit> hits(rays.size());
+    bench::Timer timer;
+    for (size_t i = 0; i < rays.size(); i++) {
+        accel.intersect(rays[i], hits[i]);
+    }
+    double closestMs = timer.elapsedMs();
+
+    std::vector<uint8_t> occluded(rays.size());
+    timer.reset();
+    for (size_t i = 0; i < rays.size(); i++) {
+        occluded[i] = accel.occluded(rays[i]);
+    }
+    double anyMs = timer.elapsedMs();
+
+    size_t occludedCount = 0;
+    size_t mismatches = 0;
+    for (size_t i = 0; i < rays.size(); i++) {
+        occludedCount += occluded[i];
+        if (reference.hits.empty()) {
+            continue;
+        }
+        if (hits[i].valid() != reference.hits[i].valid() ||
+            (hits[i].valid() && std::fabs(hits[i].t - reference.hits[i].t) > 1e-3f * (1.0f + reference.hits[i].t)) ||
+            occluded[i] != reference.occluded[i]) {
+            mismatches++;
+        }
+    }
+
+    std::printf("%-8s %-11s %10.2f %10.2f %8zu %10zu\n", label, pattern,
+                rays.size() / (closestMs * 1000.0), rays.size() / (anyMs * 1000.0),
+                mismatches, occludedCount);
+    return mismatches == 0;
+}
+
+bool runScene(const char* name, const TriangleMesh& mesh, int rayDim) {
+    BvhBuildSettings settings;
+    settings.maxLeafSize = 4;
+    Bvh bvh;
+    bvh.build(mesh, settings);
+    Bvh4 bvh4;
+    bvh4.build(bvh);
+
+    settings.maxLeafSize = 8;
+    Bvh bvhWide;
+    bvhWide.build(mesh, settings);
+    Bvh8 bvh8;
+    bvh8.build(bvhWide);
+
+    std::printf("\n%s: %zu triangles, BVH4 %u nodes (%.0f%% slots, %.0f%% lanes), BVH8 %u nodes (%.0f%% slots, %.0f%% lanes)\n",
+                name, mesh.size(),
+                bvh4.getStats().nodeCount, bvh4.getStats().childFill * 100.0f, bvh4.getStats().packFill * 100.0f,
+                bvh8.getStats().nodeCount, bvh8.getStats().childFill * 100.0f, bvh8.getStats().packFill * 100.0f);
+    std::printf("%-8s %-11s %10s %10s %8s %10s\n", "kernel", "rays", "closest", "any-hit", "mismatch", "occluded");
+
+    struct Pattern {
+        const char* name;
+        std::vector<Ray> rays;
+    };
+    Pattern patterns[] = {
+        {"coherent", bench::makeCoherentRays(bvh.bounds(), rayDim, rayDim)},
+        {"incoherent", bench::makeIncoherentRays(bvh.bounds(), static_cast<size_t>(rayDim) * rayDim, 99u)},
+    };
+
+    bool passed = true;
+    for (const auto& pattern : patterns) {
+        Reference reference;
+        reference.hits.resize(pattern.rays.size());
+        reference.occluded.resize(pattern.rays.size());
+        for (size_t i = 0; i < pattern.rays.size(); i++) {
+            bvh.intersect(pattern.rays[i], reference.hits[i]);
+            reference.occluded[i] = bvh.occluded(pattern.rays[i]);
+        }
+        traceRays("binary", pattern.name, bvh, pattern.rays, Reference());
+        passed = traceRays("bvh4", pattern.name, bvh4, pattern.rays, reference) && passed;
+        passed = traceRays("bvh8", pattern.name, bvh8, pattern.rays, reference) && passed;
+    }
+    return passed;
+}
+
+} // namespace
+
+// Usage: MazeBench traversal [mazeCells] [raysPerSide]
+// Throughput is reported in Mrays/s on a single thread. Fails if BVH4 or
+// BVH8 hits or occlusion differ from the binary BVH.
+int runTraversalBenchmark(int argc, char** argv) {
+    int cells = bench::intArg(argc, argv, 0, 300);
+    int rayDim = bench::intArg(argc, argv, 1, 512);
+
+    bool passed = runScene("maze.obj", TriangleMesh::loadObj(bench::assetPath("models/maze.obj")), rayDim);
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "synthetic %dx%d", cells, cells);
+    passed = runScene(name, bench::makeSyntheticMaze(cells, cells, 1234u), rayDim) && passed;
+    return passed ? 0 : 1;
+}
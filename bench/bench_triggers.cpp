@@ -0,0 +1,195 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "physics/physics_world.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int LevelCells = 100;
+
+// Boxes and spheres of 0.5-2 m scattered over the level.
+std::vector<TriggerDesc> makeTriggers(int count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<TriggerDesc> triggers(count);
+    for (int i = 0; i < count; i++) {
+        TriggerDesc& desc = triggers[i];
+        glm::vec3 center(unit(rng) * LevelCells, 0.5f, unit(rng) * LevelCells);
+        float size = 0.25f + unit(rng) * 0.75f;
+        if (i % 2) {
+            desc.shape = TriggerShape::Sphere;
+            desc.a = center;
+            desc.radius = size;
+        } else {
+            desc.a = center - glm::vec3(size, 0.5f, size);
+            desc.b = center + glm::vec3(size, 0.5f, size);
+        }
+        desc.tag = static_cast<uint32_t>(i % 4);
+    }
+    return triggers;
+}
+
+// Every body against every trigger, in the order TriggerSet keeps its pairs.
+void bruteForcePairs(const PhysicsWorld& world, const std::vector<TriggerId>& ids,
+                     const std::vector<TriggerDesc>& descs, std::vector<TriggerPair>& out) {
+    out.clear();
+    for (uint32_t b = 0; b < world.getBodyCount(); b++) {
+        const RigidBody& body = world.getBody(b);
+        for (size_t t = 0; t < descs.size(); t++) {
+            const TriggerDesc& desc = descs[t];
+            bool inside;
+            if (desc.shape == TriggerShape::Box) {
+                glm::vec3 offset = body.position - glm::clamp(body.position, desc.a, desc.b);
+                inside = glm::dot(offset, offset) <= body.radius * body.radius;
+            } else {
+                glm::vec3 offset = body.position - desc.a;
+                inside = glm::dot(offset, offset) <= (body.radius + desc.radius) * (body.radius + desc.radius);
+            }
+            if (inside) {
+                out.push_back({b, ids[t].index, ids[t].generation, desc.tag});
+            }
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const TriggerPair& a, const TriggerPair& b) {
+        return a.body != b.body ? a.body < b.body : a.trigger < b.trigger;
+    });
+}
+
+// Balls rolling through the maze under a growing number of triggers. The
+// set's pairs must match testing every body against every trigger.
+bool reportScaling(int ballCount, int triggerCount, const TriangleMesh& level, int steps) {
+    PhysicsWorld world;
+    world.setStaticGeometry(level);
+    std::vector<TriggerDesc> descs = makeTriggers(triggerCount, 7u);
+    std::vector<TriggerId> ids;
+    for (const auto& desc : descs) {
+        ids.push_back(world.addTrigger(desc));
+    }
+    std::mt19937 rng(9u);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < ballCount; i++) {
+        BodyDesc desc;
+        desc.radius = 0.2f;
+        desc.position = glm::vec3(std::floor(unit(rng) * LevelCells) + 0.5f, 0.21f,
+                                  std::floor(unit(rng) * LevelCells) + 0.5f);
+        float angle = unit(rng) * 6.2831853f;
+        desc.velocity = glm::vec3(std::cos(angle), 0.0f, std::sin(angle)) * 2.0f;
+        desc.sleepSpeed = 0.0f;
+        world.addBody(desc);
+    }
+
+    double triggerMs = 0.0;
+    double bruteMs = 0.0;
+    uint64_t tests = 0;
+    uint64_t events = 0;
+    size_t pairs = 0;
+    bool matches = true;
+    std::vector<TriggerPair> expected;
+    for (int i = 0; i < steps; i++) {
+        world.step();
+        const PhysicsStats& stats = world.getStats();
+        triggerMs += stats.triggerMs;
+        tests += stats.triggerTests;
+        events += stats.triggerEventCount;
+
+        bench::Timer timer;
+        bruteForcePairs(world, ids, descs, expected);
+        bruteMs += timer.elapsedMs();
+        const std::vector<TriggerPair>& actual = world.getTriggers().getPairs();
+        pairs = actual.size();
+        matches = matches && actual.size() == expected.size() &&
+                  std::equal(actual.begin(), actual.end(), expected.begin(),
+                             [](const TriggerPair& a, const TriggerPair& b) {
+                                 return a.body == b.body && a.trigger == b.trigger && a.tag == b.tag;
+                             });
+    }
+    std::printf("%6d %8d %10.3f %10.3f %12.2f %10zu %10.1f %8s\n", ballCount, triggerCount, triggerMs / steps,
+                bruteMs / steps, static_cast<double>(tests) / steps / ballCount, pairs,
+                static_cast<double>(events) / steps, matches ? "yes" : "NO");
+    return matches;
+}
+
+// One ball rolling over a bounce pad, then a trigger removed under a
+// resting ball: checks the pad launches the ball exactly once and that
+// removal reports an exit.
+bool reportBouncePad() {
+    TriangleMesh level;
+    bench::appendBox(level, glm::vec3(-5.0f, -1.0f, -5.0f), glm::vec3(20.0f, 0.0f, 5.0f));
+    PhysicsWorld world;
+    world.setStaticGeometry(level);
+
+    TriggerDesc pad;
+    pad.a = glm::vec3(4.0f, 0.0f, -1.0f);
+    pad.b = glm::vec3(5.0f, 0.1f, 1.0f);
+    pad.bounceImpulse = glm::vec3(0.0f, 6.0f, 0.0f);
+    world.addTrigger(pad);
+    TriggerDesc goal;
+    goal.shape = TriggerShape::Sphere;
+    goal.a = glm::vec3(-2.0f, 0.25f, 0.0f);
+    goal.radius = 0.5f;
+    goal.tag = 1;
+    TriggerId goalId = world.addTrigger(goal);
+
+    BodyDesc rolling;
+    rolling.radius = 0.25f;
+    rolling.position = glm::vec3(0.0f, 0.25f, 0.0f);
+    rolling.velocity = glm::vec3(3.0f, 0.0f, 0.0f);
+    uint32_t ball = world.addBody(rolling);
+    BodyDesc resting = rolling;
+    resting.position = goal.a;
+    resting.velocity = glm::vec3(0.0f);
+    world.addBody(resting);
+
+    int enters = 0;
+    int exits = 0;
+    float peak = 0.0f;
+    for (int i = 0; i < 360; i++) {
+        world.step();
+        for (const TriggerEvent& event : world.getTriggerEvents()) {
+            if (event.bodyId == ball && event.tag == 0) {
+                enters += event.type == TriggerEvent::Type::Enter;
+                exits += event.type == TriggerEvent::Type::Exit;
+            }
+        }
+        peak = std::max(peak, world.getBody(ball).position.y);
+    }
+
+    world.removeTrigger(goalId);
+    world.step();
+    bool removedExit = false;
+    for (const TriggerEvent& event : world.getTriggerEvents()) {
+        removedExit = removedExit || (event.type == TriggerEvent::Type::Exit && event.tag == 1 &&
+                                      event.trigger == goalId);
+    }
+    std::printf("bounce pad: %d enter, %d exit, peak height %.2f m; removed goal reports exit: %s\n", enters,
+                exits, peak, removedExit ? "yes" : "NO");
+    return enters == 1 && exits == 1 && peak > 1.0f && removedExit;
+}
+
+} // namespace
+
+// Usage: MazeBench triggers [balls] [steps]
+// Trigger overlap cost per step over a 100x100 maze as the trigger count
+// grows, next to testing every ball against every trigger, with tests per
+// ball after the grid, overlapping pairs and events per step. The pairs
+// must match the exhaustive test. Then a bounce pad and trigger removal
+// check. Fails if either check does.
+int runTriggersBenchmark(int argc, char** argv) {
+    int ballCount = bench::intArg(argc, argv, 0, 2000);
+    int steps = bench::intArg(argc, argv, 1, 20);
+
+    TriangleMesh level = bench::makeSyntheticMaze(LevelCells, LevelCells, 5u);
+    std::printf("%6s %8s %10s %10s %12s %10s %10s %8s\n", "balls", "triggers", "grid ms", "all ms", "tests/ball",
+                "pairs", "events", "match");
+    bool passed = true;
+    for (int triggers : {10, 100, 1000, 4000}) {
+        passed = reportScaling(ballCount, triggers, level, steps) && passed;
+    }
+    std::printf("\n");
+    passed = reportBouncePad() && passed;
+    return passed ? 0 : 1;
+}
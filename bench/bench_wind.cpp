@@ -0,0 +1,171 @@
+#include "bench.h"
+#include "bench_common.h"
+#include "core/thread_pool.h"
+#include "physics/physics_world.h"
+#include "physics/wind_field.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int LevelCells = 100;
+
+// Boxes and capsules of 1-6 m scattered over the level, half of them gusty;
+// neighbouring zones overlap.
+std::vector<WindZone> makeZones(int count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<WindZone> zones(count);
+    for (auto& zone : zones) {
+        glm::vec3 center(unit(rng) * LevelCells, 0.5f, unit(rng) * LevelCells);
+        glm::vec3 half(0.5f + unit(rng) * 2.5f, 1.0f, 0.5f + unit(rng) * 2.5f);
+        if (unit(rng) < 0.5f) {
+            zone.shape = WindShape::Box;
+            zone.a = center - half;
+            zone.b = center + half;
+        } else {
+            zone.shape = WindShape::Capsule;
+            zone.a = center - glm::vec3(half.x, 0.0f, 0.0f);
+            zone.b = center + glm::vec3(half.x, 0.0f, half.z);
+            zone.radius = 0.5f + unit(rng);
+        }
+        float angle = unit(rng) * 6.2831853f;
+        zone.direction = glm::vec3(std::cos(angle), 0.0f, std::sin(angle));
+        zone.strength = 1.0f + unit(rng) * 4.0f;
+        zone.turbulence = unit(rng) < 0.5f ? 0.5f : 0.0f;
+    }
+    return zones;
+}
+
+std::vector<glm::vec3> makePoints(int count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<glm::vec3> points(count);
+    for (auto& point : points) {
+        point = glm::vec3(unit(rng) * LevelCells, 0.2f, unit(rng) * LevelCells);
+    }
+    return points;
+}
+
+glm::vec3 bruteForce(const std::vector<WindZone>& zones, const glm::vec3& point, float time) {
+    glm::vec3 force(0.0f);
+    for (const auto& zone : zones) {
+        if (windZoneContains(zone, point)) {
+            force += windZoneForce(zone, point, time);
+        }
+    }
+    return force;
+}
+
+void reportField(int zoneCount, const std::vector<glm::vec3>& points, ThreadPool& serialPool,
+                 ThreadPool& parallelPool, int repeats) {
+    std::vector<WindZone> zones = makeZones(zoneCount, 17u);
+    WindField field;
+    bench::Timer timer;
+    field.build(zones);
+    double buildMs = timer.elapsedMs();
+    const float time = 1.25f;
+
+    // Normalised directions make the brute force inputs match the field's.
+    std::vector<WindZone> reference = field.getZones();
+    std::vector<glm::vec3> expected(points.size());
+    timer.reset();
+    for (size_t i = 0; i < points.size(); i++) {
+        expected[i] = bruteForce(reference, points[i], time);
+    }
+    double bruteMs = timer.elapsedMs();
+
+    std::vector<glm::vec3> scalar(points.size());
+    double scalarMs = 1e30;
+    for (int r = 0; r < repeats; r++) {
+        timer.reset();
+        for (size_t i = 0; i < points.size(); i++) {
+            scalar[i] = field.sample(points[i], time);
+        }
+        scalarMs = std::min(scalarMs, timer.elapsedMs());
+    }
+
+    std::vector<glm::vec3> batched;
+    double batchedMs = 1e30;
+    double pooledMs = 1e30;
+    for (int r = 0; r < repeats; r++) {
+        timer.reset();
+        field.sampleMany(points, time, batched, serialPool);
+        batchedMs = std::min(batchedMs, timer.elapsedMs());
+        timer.reset();
+        field.sampleMany(points, time, batched, parallelPool);
+        pooledMs = std::min(pooledMs, timer.elapsedMs());
+    }
+
+    float maxError = 0.0f;
+    for (size_t i = 0; i < points.size(); i++) {
+        maxError = std::max(maxError, glm::length(scalar[i] - expected[i]));
+        maxError = std::max(maxError, glm::length(batched[i] - expected[i]));
+    }
+    auto rate = [&](double ms) { return points.size() / (ms / 1000.0) / 1e6; };
+    std::printf("%6d %8.2f %8.2f %10.2f %10.2f %10.2f %10.2f %10.2f %10.1e\n", zoneCount, field.getCellSize(), buildMs,
+                static_cast<double>(field.getZoneTests()) / points.size(), rate(bruteMs), rate(scalarMs),
+                rate(batchedMs), rate(pooledMs), maxError);
+}
+
+// Balls rolling through the maze under a growing number of zones.
+void reportStep(int ballCount, int zoneCount, const TriangleMesh& level, int steps) {
+    PhysicsWorld world;
+    world.setStaticGeometry(level);
+    world.setWindZones(makeZones(zoneCount, 17u));
+    std::vector<glm::vec3> starts = makePoints(ballCount, 23u);
+    for (const auto& start : starts) {
+        BodyDesc desc;
+        desc.radius = 0.2f;
+        desc.position = glm::vec3(std::floor(start.x) + 0.5f, 0.21f, std::floor(start.z) + 0.5f);
+        world.addBody(desc);
+    }
+    for (int i = 0; i < 10; i++) {
+        world.step();
+    }
+    double windMs = 0.0;
+    uint64_t tests = 0;
+    bench::Timer timer;
+    for (int i = 0; i < steps; i++) {
+        world.step();
+        windMs += world.getStats().windMs;
+        tests += world.getStats().windZoneTests;
+    }
+    double stepMs = timer.elapsedMs() / steps;
+    std::printf("%6d %6d %10.0f %10.3f %10.3f %12.2f\n", ballCount, zoneCount, 1000.0 / stepMs, stepMs,
+                windMs / steps, static_cast<double>(tests) / steps / ballCount);
+}
+
+} // namespace
+
+// Usage: MazeBench wind [points] [repeats]
+// Wind force queries per second (millions) over a 100x100 level as the
+// zone count grows: testing every zone, the grid-indexed scalar sample(),
+// and the batched sampleMany() on one thread and on the global pool. Zone
+// tests are per point after the grid. The error is the largest difference
+// from testing every zone. The second table steps 2000 balls with the same
+// zones: the wind share of the step should stay flat as zones are added.
+int runWindBenchmark(int argc, char** argv) {
+    int pointCount = bench::intArg(argc, argv, 0, 50000);
+    int repeats = bench::intArg(argc, argv, 1, 5);
+
+    ThreadPool serialPool(1);
+    ThreadPool& parallelPool = ThreadPool::global();
+    std::vector<glm::vec3> points = makePoints(pointCount, 5u);
+    std::printf("%d points, %u threads\n\n", pointCount, parallelPool.getThreadCount());
+    std::printf("%6s %8s %8s %10s %10s %10s %10s %10s %10s\n", "zones", "cell", "build ms", "tests/pt", "all zones",
+                "sample", "batched", "pool", "max error");
+    for (int zones : {10, 100, 400, 1600, 6400}) {
+        reportField(zones, points, serialPool, parallelPool, repeats);
+    }
+
+    TriangleMesh level = bench::makeSyntheticMaze(LevelCells, LevelCells, 5u);
+    std::printf("\n%6s %6s %10s %10s %10s %12s\n", "balls", "zones", "steps/s", "step ms", "wind ms", "tests/ball");
+    for (int zones : {0, 100, 1000, 6400}) {
+        reportStep(2000, zones, level, 30);
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include "bench.h"
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+struct BenchmarkEntry {
+    const char* name;
+    int (*run)(int argc, char** argv);
+};
+
+static const BenchmarkEntry benchmarks[] = {
+    {"bvh", runBvhBenchmark},
+    {"traversal", runTraversalBenchmark},
+    {"pathtracer", runPathTracerBenchmark},
+    {"packets", runPacketBenchmark},
+    {"scene", runSceneBenchmark},
+    {"physics", runPhysicsBenchmark},
+    {"broadphase", runBroadphaseBenchmark},
+    {"narrowphase", runNarrowphaseBenchmark},
+    {"balls", runBallsBenchmark},
+    {"handoff", runHandoffBenchmark},
+    {"rollback", runRollbackBenchmark},
+    {"wind", runWindBenchmark},
+    {"triggers", runTriggersBenchmark},
+    {"maze", runMazeBenchmark},
+    {"mazemesh", runMazeMeshBenchmark},
+    {"streaming", runStreamingBenchmark},
+    {"pathfinding", runPathfindingBenchmark},
+    {"flowfield", runFlowFieldBenchmark},
+    {"hierarchy", runHierarchyBenchmark},
+    {"level", runLevelBenchmark},
+    {"compression", runCompressionBenchmark},
+};
+
+int main(int argc, char** argv) {
+    try {
+        if (argc < 2) {
+            int result = 0;
+            for (const auto& benchmark : benchmarks) {
+                std::cout << "== " << benchmark.name << " ==" << std::endl;
+                result |= benchmark.run(0, nullptr);
+            }
+            return result;
+        }
+
+        for (const auto& benchmark : benchmarks) {
+            if (std::strcmp(argv[1], benchmark.name) == 0) {
+                return benchmark.run(argc - 2, argv + 2);
+            }
+        }
+
+        std::cerr << "Unknown benchmark '" << argv[1] << "'. Available:";
+        for (const auto& benchmark : benchmarks) {
+            std::cerr << " " << benchmark.name;
+        }
+        std::cerr << std::endl;
+        return EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
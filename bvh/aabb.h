@@ -0,0 +1,59 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <limits>
+
+struct Aabb {
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+    void grow(const glm::vec3& p) {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+
+    void grow(const Aabb& other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    bool isEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+    glm::vec3 extent() const { return max - min; }
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+
+    float surfaceArea() const {
+        if (isEmpty()) {
+            return 0.0f;
+        }
+        glm::vec3 e = extent();
+        return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+
+    bool overlaps(const Aabb& other) const {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+               min.y <= other.max.y && max.y >= other.min.y &&
+               min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    // Bounds of this box under an affine transform (Arvo's method).
+    Aabb transformed(const glm::mat4& m) const {
+        if (isEmpty()) {
+            return *this;
+        }
+        Aabb result;
+        result.min = result.max = glm::vec3(m[3]);
+        for (int col = 0; col < 3; col++) {
+            glm::vec3 a = glm::vec3(m[col]) * min[col];
+            glm::vec3 b = glm::vec3(m[col]) * max[col];
+            result.min += glm::min(a, b);
+            result.max += glm::max(a, b);
+        }
+        return result;
+    }
+
+    bool contains(const glm::vec3& p) const {
+        return p.x >= min.x && p.x <= max.x &&
+               p.y >= min.y && p.y <= max.y &&
+               p.z >= min.z && p.z <= max.z;
+    }
+};
@@ -0,0 +1,449 @@
+#include "bvh.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace {
+
+constexpr int MaxBins = 64;
+// Ranges bigger than this get their bounds/binning passes split across the pool.
+constexpr uint32_t ParallelBinningThreshold = 1u << 16;
+constexpr size_t BinningGrain = 1u << 14;
+
+struct Bin {
+    Aabb bounds;
+    uint32_t count = 0;
+};
+
+struct BinSet {
+    Bin bins[3][MaxBins];
+
+    void merge(const BinSet& other, int binCount) {
+        for (int axis = 0; axis < 3; axis++) {
+            for (int i = 0; i < binCount; i++) {
+                bins[axis][i].bounds.grow(other.bins[axis][i].bounds);
+                bins[axis][i].count += other.bins[axis][i].count;
+            }
+        }
+    }
+};
+
+struct RangeBounds {
+    Aabb bounds;
+    Aabb centroidBounds;
+};
+
+struct BuildContext {
+    BuildContext(const BvhBuildSettings& settings, ThreadPool& pool)
+        : settings(settings), pool(pool), group(pool) {}
+
+    const BvhBuildSettings& settings;
+    ThreadPool& pool;
+    TaskGroup group;
+
+    std::vector<Aabb> primBounds;
+    std::vector<glm::vec3> centroids;
+    std::vector<uint32_t> indices;
+
+    // Temporary nodes in allocation order; siblings are allocated in pairs.
+    std::vector<BvhNode> nodes;
+    std::atomic<uint32_t> nodeCount{0};
+};
+
+RangeBounds computeRangeBounds(BuildContext& ctx, uint32_t begin, uint32_t end) {
+    auto accumulate = [&ctx](size_t first, size_t last, RangeBounds& out) {
+        for (size_t i = first; i < last; i++) {
+            uint32_t prim = ctx.indices[i];
+            out.bounds.grow(ctx.primBounds[prim]);
+            out.centroidBounds.grow(ctx.centroids[prim]);
+        }
+    };
+
+    RangeBounds result;
+    uint32_t count = end - begin;
+    if (count < ParallelBinningThreshold || ctx.pool.getThreadCount() == 1) {
+        accumulate(begin, end, result);
+        return result;
+    }
+
+    size_t chunkCount = (count + BinningGrain - 1) / BinningGrain;
+    std::vector<RangeBounds> partial(chunkCount);
+    ctx.pool.parallelFor(count, BinningGrain, [&](size_t first, size_t last) {
+        accumulate(begin + first, begin + last, partial[first / BinningGrain]);
+    });
+    for (const auto& p : partial) {
+        result.bounds.grow(p.bounds);
+        result.centroidBounds.grow(p.centroidBounds);
+    }
+    return result;
+}
+
+int binIndex(float value, float minValue, float scale, int binCount) {
+    int index = static_cast<int>((value - minValue) * scale);
+    return std::min(std::max(index, 0), binCount - 1);
+}
+
+void fillBins(BuildContext& ctx, uint32_t begin, uint32_t end, const Aabb& centroidBounds, BinSet& out) {
+    int binCount = ctx.settings.binCount;
+    glm::vec3 extent = centroidBounds.extent();
+    glm::vec3 scale;
+    for (int axis = 0; axis < 3; axis++) {
+        scale[axis] = extent[axis] > 0.0f ? binCount / extent[axis] : 0.0f;
+    }
+
+    auto accumulate = [&](size_t first, size_t last, BinSet& bins) {
+        for (size_t i = first; i < last; i++) {
+            uint32_t prim = ctx.indices[i];
+            const glm::vec3& c = ctx.centroids[prim];
+            for (int axis = 0; axis < 3; axis++) {
+                Bin& bin = bins.bins[axis][binIndex(c[axis], centroidBounds.min[axis], scale[axis], binCount)];
+                bin.bounds.grow(ctx.primBounds[prim]);
+                bin.count++;
+            }
+        }
+    };
+
+    uint32_t count = end - begin;
+    if (count < ParallelBinningThreshold || ctx.pool.getThreadCount() == 1) {
+        accumulate(begin, end, out);
+        return;
+    }
+
+    size_t chunkCount = (count + BinningGrain - 1) / BinningGrain;
+    std::vector<BinSet> partial(chunkCount);
+    ctx.pool.parallelFor(count, BinningGrain, [&](size_t first, size_t last) {
+        accumulate(begin + first, begin + last, partial[first / BinningGrain]);
+    });
+    for (const auto& p : partial) {
+        out.merge(p, binCount);
+    }
+}
+
+void makeLeaf(BvhNode& node, uint32_t begin, uint32_t end) {
+    node.leftFirst = begin;
+    node.count = end - begin;
+}
+
+void buildRange(BuildContext& ctx, uint32_t nodeIndex, uint32_t begin, uint32_t end, uint32_t depth) {
+    const BvhBuildSettings& settings = ctx.settings;
+    RangeBounds range = computeRangeBounds(ctx, begin, end);
+
+    BvhNode& node = ctx.nodes[nodeIndex];
+    node.boundsMin = range.bounds.min;
+    node.boundsMax = range.bounds.max;
+
+    uint32_t count = end - begin;
+    if (count <= 1 || depth + 1 >= BvhMaxDepth) {
+        makeLeaf(node, begin, end);
+        return;
+    }
+
+    int binCount = settings.binCount;
+    BinSet bins;
+    fillBins(ctx, begin, end, range.centroidBounds, bins);
+
+    float nodeArea = range.bounds.surfaceArea();
+    float invNodeArea = nodeArea > 0.0f ? 1.0f / nodeArea : 1.0f;
+
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    int bestSplit = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        if (range.centroidBounds.extent()[axis] <= 0.0f) {
+            continue;
+        }
+
+        float rightArea[MaxBins];
+        uint32_t rightCount[MaxBins];
+        Aabb accum;
+        uint32_t accumCount = 0;
+        for (int i = binCount - 1; i > 0; i--) {
+            accum.grow(bins.bins[axis][i].bounds);
+            accumCount += bins.bins[axis][i].count;
+            rightArea[i] = accum.surfaceArea();
+            rightCount[i] = accumCount;
+        }
+
+        accum = Aabb();
+        accumCount = 0;
+        for (int i = 0; i < binCount - 1; i++) {
+            accum.grow(bins.bins[axis][i].bounds);
+            accumCount += bins.bins[axis][i].count;
+            if (accumCount == 0 || rightCount[i + 1] == 0) {
+                continue;
+            }
+            float cost = settings.traversalCost + settings.intersectionCost * invNodeArea *
+                         (accum.surfaceArea() * accumCount + rightArea[i + 1] * rightCount[i + 1]);
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = i + 1;
+            }
+        }
+    }
+
+    float leafCost = settings.intersectionCost * count;
+    if (count <= settings.maxLeafSize && (bestAxis < 0 || leafCost <= bestCost)) {
+        makeLeaf(node, begin, end);
+        return;
+    }
+
+    uint32_t mid = begin;
+    if (bestAxis >= 0) {
+        float minValue = range.centroidBounds.min[bestAxis];
+        float scale = binCount / range.centroidBounds.extent()[bestAxis];
+        auto first = ctx.indices.begin() + begin;
+        auto last = ctx.indices.begin() + end;
+        mid = static_cast<uint32_t>(std::partition(first, last, [&](uint32_t prim) {
+            return binIndex(ctx.centroids[prim][bestAxis], minValue, scale, binCount) < bestSplit;
+        }) - ctx.indices.begin());
+    }
+    if (mid == begin || mid == end) {
+        // All centroids coincide; fall back to an object median split.
+        mid = begin + count / 2;
+    }
+
+    uint32_t left = ctx.nodeCount.fetch_add(2, std::memory_order_relaxed);
+    node.leftFirst = left;
+    node.count = 0;
+
+    if (count > settings.parallelThreshold) {
+        ctx.group.run([&ctx, left, begin, mid, depth]() { buildRange(ctx, left, begin, mid, depth + 1); });
+    } else {
+        buildRange(ctx, left, begin, mid, depth + 1);
+    }
+    buildRange(ctx, left + 1, mid, end, depth + 1);
+}
+
+} // namespace
+
+void Bvh::build(const TriangleMesh& mesh, const BvhBuildSettings& settings) {
+    build(mesh, ThreadPool::global(), settings);
+}
+
+void Bvh::build(const TriangleMesh& mesh, ThreadPool& pool, const BvhBuildSettings& settings) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    nodes.clear();
+    triangles.clear();
+    primitiveIds.clear();
+    stats = BvhBuildStats();
+
+    const std::vector<Triangle>& source = mesh.getTriangles();
+    uint32_t primCount = static_cast<uint32_t>(source.size());
+    if (primCount == 0) {
+        return;
+    }
+
+    BvhBuildSettings clamped = settings;
+    clamped.binCount = std::min(std::max(clamped.binCount, 2), MaxBins);
+    clamped.maxLeafSize = std::max(clamped.maxLeafSize, 1u);
+
+    BuildContext ctx(clamped, pool);
+    ctx.primBounds.resize(primCount);
+    ctx.centroids.resize(primCount);
+    ctx.indices.resize(primCount);
+    pool.parallelFor(primCount, BinningGrain, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            ctx.primBounds[i] = source[i].bounds();
+            ctx.centroids[i] = ctx.primBounds[i].center();
+            ctx.indices[i] = static_cast<uint32_t>(i);
+        }
+    });
+
+    ctx.nodes.resize(2 * static_cast<size_t>(primCount) - 1);
+    ctx.nodeCount = 1;
+    buildRange(ctx, 0, 0, primCount, 0);
+    ctx.group.wait();
+
+    // Flatten into depth-first order so the left child is always adjacent.
+    struct StackEntry {
+        uint32_t node;
+        uint32_t parent;
+        uint32_t depth;
+    };
+    const uint32_t noParent = ~0u;
+
+    nodes.reserve(ctx.nodeCount.load());
+    std::vector<StackEntry> stack;
+    stack.push_back({0, noParent, 0});
+    while (!stack.empty()) {
+        StackEntry entry = stack.back();
+        stack.pop_back();
+
+        uint32_t newIndex = static_cast<uint32_t>(nodes.size());
+        if (entry.parent != noParent) {
+            nodes[entry.parent].leftFirst = newIndex;
+        }
+
+        const BvhNode& node = ctx.nodes[entry.node];
+        nodes.push_back(node);
+        stats.maxDepth = std::max(stats.maxDepth, entry.depth);
+        if (node.isLeaf()) {
+            stats.leafCount++;
+            continue;
+        }
+        stack.push_back({node.leftFirst + 1, newIndex, entry.depth + 1});
+        stack.push_back({node.leftFirst, noParent, entry.depth + 1});
+    }
+
+    // Depth-first leaf order matches the partitioned index order, so the
+    // leaves' triangle ranges stay valid once triangles are reordered.
+    triangles.resize(primCount);
+    primitiveIds = std::move(ctx.indices);
+    pool.parallelFor(primCount, BinningGrain, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            triangles[i] = source[primitiveIds[i]];
+        }
+    });
+
+    stats.nodeCount = static_cast<uint32_t>(nodes.size());
+    stats.sahCost = computeSahCost(clamped.traversalCost, clamped.intersectionCost);
+    stats.buildMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void Bvh::assign(const BvhNode* nodeData, size_t nodeCount, const Triangle* triangleData,
+                 const uint32_t* primitiveIdData, size_t triangleCount) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    nodes.assign(nodeData, nodeData + nodeCount);
+    triangles.assign(triangleData, triangleData + triangleCount);
+    primitiveIds.assign(primitiveIdData, primitiveIdData + triangleCount);
+    stats = BvhBuildStats();
+    stats.nodeCount = static_cast<uint32_t>(nodes.size());
+    for (const auto& node : nodes) {
+        stats.leafCount += node.isLeaf() ? 1 : 0;
+    }
+    stats.sahCost = computeSahCost();
+    stats.buildMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+float computeSahCost(const std::vector<BvhNode>& nodes, float traversalCost, float intersectionCost) {
+    if (nodes.empty()) {
+        return 0.0f;
+    }
+
+    float rootArea = Aabb{nodes[0].boundsMin, nodes[0].boundsMax}.surfaceArea();
+    if (rootArea <= 0.0f) {
+        uint32_t primitives = 0;
+        for (const auto& node : nodes) {
+            primitives += node.count;
+        }
+        return intersectionCost * static_cast<float>(primitives);
+    }
+
+    double cost = 0.0;
+    for (const auto& node : nodes) {
+        Aabb box{node.boundsMin, node.boundsMax};
+        double area = box.surfaceArea();
+        cost += node.isLeaf() ? area * intersectionCost * node.count : area * traversalCost;
+    }
+    return static_cast<float>(cost / rootArea);
+}
+
+float Bvh::computeSahCost(float traversalCost, float intersectionCost) const {
+    return ::computeSahCost(nodes, traversalCost, intersectionCost);
+}
+
+bool Bvh::intersect(const Ray& ray, RayHit& hit) const {
+    if (nodes.empty()) {
+        return false;
+    }
+
+    Ray r = ray;
+    glm::vec3 invDir = safeInverseDirection(r.direction);
+    const float miss = std::numeric_limits<float>::max();
+    bool found = false;
+
+    uint32_t stack[BvhMaxDepth];
+    uint32_t stackSize = 0;
+    uint32_t index = 0;
+    for (;;) {
+        const BvhNode& node = nodes[index];
+        if (node.isLeaf()) {
+            for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+                const Triangle& tri = triangles[i];
+                float t, u, v;
+                if (intersectTriangle(r, tri.v0, tri.v1 - tri.v0, tri.v2 - tri.v0, t, u, v)) {
+                    r.tMax = t;
+                    hit.t = t;
+                    hit.u = u;
+                    hit.v = v;
+                    hit.primitiveId = primitiveIds[i];
+                    found = true;
+                }
+            }
+            if (stackSize == 0) {
+                break;
+            }
+            index = stack[--stackSize];
+            continue;
+        }
+
+        uint32_t nearChild = index + 1;
+        uint32_t farChild = node.leftFirst;
+        float tNear = intersectAabb(nodes[nearChild].boundsMin, nodes[nearChild].boundsMax,
+                                    r.origin, invDir, r.tMin, r.tMax);
+        float tFar = intersectAabb(nodes[farChild].boundsMin, nodes[farChild].boundsMax,
+                                   r.origin, invDir, r.tMin, r.tMax);
+        if (tFar < tNear) {
+            std::swap(nearChild, farChild);
+            std::swap(tNear, tFar);
+        }
+
+        if (tNear == miss) {
+            if (stackSize == 0) {
+                break;
+            }
+            index = stack[--stackSize];
+            continue;
+        }
+        index = nearChild;
+        if (tFar != miss) {
+            stack[stackSize++] = farChild;
+        }
+    }
+    return found;
+}
+
+bool Bvh::occluded(const Ray& ray) const {
+    if (nodes.empty()) {
+        return false;
+    }
+
+    glm::vec3 invDir = safeInverseDirection(ray.direction);
+    const float miss = std::numeric_limits<float>::max();
+
+    uint32_t stack[BvhMaxDepth];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const BvhNode& node = nodes[stack[--stackSize]];
+        if (intersectAabb(node.boundsMin, node.boundsMax, ray.origin, invDir, ray.tMin, ray.tMax) == miss) {
+            continue;
+        }
+        if (!node.isLeaf()) {
+            stack[stackSize++] = node.leftFirst;
+            stack[stackSize++] = static_cast<uint32_t>(&node - nodes.data()) + 1;
+            continue;
+        }
+        for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+            const Triangle& tri = triangles[i];
+            float t, u, v;
+            if (intersectTriangle(ray, tri.v0, tri.v1 - tri.v0, tri.v2 - tri.v0, t, u, v)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+Aabb Bvh::bounds() const {
+    if (nodes.empty()) {
+        return Aabb();
+    }
+    return Aabb{nodes[0].boundsMin, nodes[0].boundsMax};
+}
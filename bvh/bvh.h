@@ -0,0 +1,78 @@
+#pragma once
+
+#include "bvh/aabb.h"
+#include "bvh/ray.h"
+#include "bvh/triangle_mesh.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// 32-byte node in depth-first order: an interior node's left child directly
+// follows it and leftFirst holds the right child index; a leaf stores its
+// first triangle in leftFirst and a non-zero triangle count.
+struct BvhNode {
+    glm::vec3 boundsMin;
+    uint32_t leftFirst;
+    glm::vec3 boundsMax;
+    uint32_t count;
+
+    bool isLeaf() const { return count != 0; }
+};
+
+static_assert(sizeof(BvhNode) == 32, "BvhNode must stay 32 bytes");
+
+struct BvhBuildSettings {
+    int binCount = 16;
+    uint32_t maxLeafSize = 8;
+    float traversalCost = 1.0f;
+    float intersectionCost = 1.0f;
+    // Subtrees larger than this are built as separate tasks.
+    uint32_t parallelThreshold = 4096;
+};
+
+// Traversal stacks are fixed-size, so build() turns nodes at this depth into leaves.
+constexpr uint32_t BvhMaxDepth = 64;
+
+// SAH cost of a depth-first node array, normalised by the root surface area.
+float computeSahCost(const std::vector<BvhNode>& nodes, float traversalCost = 1.0f, float intersectionCost = 1.0f);
+
+struct BvhBuildStats {
+    double buildMs = 0.0;
+    uint32_t nodeCount = 0;
+    uint32_t leafCount = 0;
+    uint32_t maxDepth = 0;
+    float sahCost = 0.0f;
+};
+
+class Bvh {
+public:
+    void build(const TriangleMesh& mesh, const BvhBuildSettings& settings = BvhBuildSettings());
+    void build(const TriangleMesh& mesh, ThreadPool& pool, const BvhBuildSettings& settings = BvhBuildSettings());
+    // Takes over a finished tree (e.g. stored in a level file) without
+    // rebuilding: nodes in depth-first order, triangles in leaf order.
+    void assign(const BvhNode* nodeData, size_t nodeCount, const Triangle* triangleData,
+                const uint32_t* primitiveIdData, size_t triangleCount);
+
+    // SAH cost of the finished tree, normalised by the root surface area.
+    float computeSahCost(float traversalCost = 1.0f, float intersectionCost = 1.0f) const;
+
+    // Scalar single-ray queries; the reference for the wide and packet kernels.
+    bool intersect(const Ray& ray, RayHit& hit) const;
+    bool occluded(const Ray& ray) const;
+
+    const std::vector<BvhNode>& getNodes() const { return nodes; }
+    // Triangles in leaf order; getPrimitiveIds maps them back to the source mesh.
+    const std::vector<Triangle>& getTriangles() const { return triangles; }
+    const std::vector<uint32_t>& getPrimitiveIds() const { return primitiveIds; }
+    const BvhBuildStats& getStats() const { return stats; }
+
+    bool empty() const { return nodes.empty(); }
+    Aabb bounds() const;
+
+private:
+    std::vector<BvhNode> nodes;
+    std::vector<Triangle> triangles;
+    std::vector<uint32_t> primitiveIds;
+    BvhBuildStats stats;
+};
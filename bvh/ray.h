@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+struct Ray {
+    glm::vec3 origin;
+    float tMin = 0.0f;
+    glm::vec3 direction;
+    float tMax = std::numeric_limits<float>::max();
+};
+
+struct RayHit {
+    static constexpr uint32_t InvalidId = ~0u;
+
+    float t = std::numeric_limits<float>::max();
+    float u = 0.0f;
+    float v = 0.0f;
+    uint32_t primitiveId = InvalidId;
+    uint32_t instanceId = InvalidId;
+
+    bool valid() const { return primitiveId != InvalidId; }
+};
+
+// Reciprocal direction for slab tests; zero components become huge values of
+// the matching sign instead of infinities so 0 * inf never produces NaN.
+inline glm::vec3 safeInverseDirection(const glm::vec3& d) {
+    const float big = 1e30f;
+    glm::vec3 inv;
+    for (int i = 0; i < 3; i++) {
+        inv[i] = std::fabs(d[i]) > 1e-30f ? 1.0f / d[i] : (d[i] < 0.0f ? -big : big);
+    }
+    return inv;
+}
+
+// Slab test; returns the entry distance, or +max when the box is missed.
+inline float intersectAabb(const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+                           const glm::vec3& origin, const glm::vec3& invDir, float tMin, float tMax) {
+    glm::vec3 t0 = (boundsMin - origin) * invDir;
+    glm::vec3 t1 = (boundsMax - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, tMin));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+    return enter <= exit ? enter : std::numeric_limits<float>::max();
+}
+
+// Moller-Trumbore; returns true and fills t/u/v when the hit lies in (tMin, tMax).
+inline bool intersectTriangle(const Ray& ray, const glm::vec3& v0, const glm::vec3& e1, const glm::vec3& e2,
+                              float& t, float& u, float& v) {
+    glm::vec3 pvec = glm::cross(ray.direction, e2);
+    float det = glm::dot(e1, pvec);
+    if (std::fabs(det) < 1e-12f) {
+        return false;
+    }
+    float invDet = 1.0f / det;
+    glm::vec3 tvec = ray.origin - v0;
+    u = glm::dot(tvec, pvec) * invDet;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+    glm::vec3 qvec = glm::cross(tvec, e1);
+    v = glm::dot(ray.direction, qvec) * invDet;
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+    t = glm::dot(e2, qvec) * invDet;
+    return t > ray.tMin && t < ray.tMax;
+}
@@ -0,0 +1,493 @@
+#include "ray_packet.h"
+#include "core/simd.h"
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace {
+
+// The emulated 8-wide type is slower than SSE, so packets are tested in
+// chunks of the widest native vector.
+#if MAZE_SIMD_AVX
+using vfloat = simd::vfloat8;
+#else
+using vfloat = simd::vfloat4;
+#endif
+
+constexpr int Lanes = vfloat::Width;
+
+uint32_t chunkBits(uint32_t mask, int chunk) {
+    return (mask >> (chunk * Lanes)) & ((1u << Lanes) - 1);
+}
+
+// Interval bounds of the packet's origins and inverse directions. When all
+// rays share their direction signs the intervals enclose the packet like a
+// frustum, and a node missed by the interval slab test is missed by every
+// ray in it.
+struct PacketFrustum {
+    bool valid = false;
+    bool negative[3] = {};
+    float originMin[3], originMax[3];
+    float invMin[3], invMax[3];
+    float tMin = 0.0f;
+    float tMax = 0.0f;
+};
+
+template <int N>
+PacketFrustum computeFrustum(const RayPacket<N>& packet, const float* tMax) {
+    PacketFrustum frustum;
+    const float* origins[3] = {packet.originX, packet.originY, packet.originZ};
+    const float* invDirs[3] = {packet.invDirX, packet.invDirY, packet.invDirZ};
+
+    for (int axis = 0; axis < 3; axis++) {
+        frustum.originMin[axis] = frustum.invMin[axis] = std::numeric_limits<float>::max();
+        frustum.originMax[axis] = frustum.invMax[axis] = -std::numeric_limits<float>::max();
+    }
+    frustum.tMin = std::numeric_limits<float>::max();
+    frustum.tMax = -std::numeric_limits<float>::max();
+
+    int signs[3] = {0, 0, 0};
+    for (int lane = 0; lane < N; lane++) {
+        if (!(packet.activeMask & (1u << lane))) {
+            continue;
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            frustum.originMin[axis] = std::min(frustum.originMin[axis], origins[axis][lane]);
+            frustum.originMax[axis] = std::max(frustum.originMax[axis], origins[axis][lane]);
+            frustum.invMin[axis] = std::min(frustum.invMin[axis], invDirs[axis][lane]);
+            frustum.invMax[axis] = std::max(frustum.invMax[axis], invDirs[axis][lane]);
+            signs[axis] |= invDirs[axis][lane] < 0.0f ? 2 : 1;
+        }
+        frustum.tMin = std::min(frustum.tMin, packet.tMin[lane]);
+        frustum.tMax = std::max(frustum.tMax, tMax[lane]);
+    }
+
+    frustum.valid = packet.activeMask != 0;
+    for (int axis = 0; axis < 3; axis++) {
+        frustum.valid &= signs[axis] != 3;
+        frustum.negative[axis] = signs[axis] == 2;
+    }
+    return frustum;
+}
+
+bool frustumMisses(const PacketFrustum& frustum, const BvhNode& node) {
+    float enter = frustum.tMin;
+    float exit = frustum.tMax;
+    for (int axis = 0; axis < 3; axis++) {
+        float iLo = frustum.invMin[axis];
+        float iHi = frustum.invMax[axis];
+        // Entry distance is smallest at the origin extreme nearest the
+        // entry plane, exit distance largest at the opposite extreme.
+        float nearDelta, farDelta;
+        if (frustum.negative[axis]) {
+            nearDelta = node.boundsMax[axis] - frustum.originMin[axis];
+            farDelta = node.boundsMin[axis] - frustum.originMax[axis];
+        } else {
+            nearDelta = node.boundsMin[axis] - frustum.originMax[axis];
+            farDelta = node.boundsMax[axis] - frustum.originMin[axis];
+        }
+        enter = std::max(enter, std::min(nearDelta * iLo, nearDelta * iHi));
+        exit = std::min(exit, std::max(farDelta * iLo, farDelta * iHi));
+    }
+    return enter > exit;
+}
+
+// Per-ray slab test of the rays in activeMask; returns the rays that hit.
+template <int N>
+uint32_t slabTest(const RayPacket<N>& packet, const float* tMax, const BvhNode& node, uint32_t activeMask) {
+    uint32_t result = 0;
+    for (int chunk = 0; chunk < N / Lanes; chunk++) {
+        uint32_t bits = chunkBits(activeMask, chunk);
+        if (bits == 0) {
+            continue;
+        }
+        int offset = chunk * Lanes;
+        vfloat ox = vfloat::load(packet.originX + offset);
+        vfloat oy = vfloat::load(packet.originY + offset);
+        vfloat oz = vfloat::load(packet.originZ + offset);
+        vfloat ix = vfloat::load(packet.invDirX + offset);
+        vfloat iy = vfloat::load(packet.invDirY + offset);
+        vfloat iz = vfloat::load(packet.invDirZ + offset);
+
+        vfloat t0x = (vfloat(node.boundsMin.x) - ox) * ix;
+        vfloat t1x = (vfloat(node.boundsMax.x) - ox) * ix;
+        vfloat t0y = (vfloat(node.boundsMin.y) - oy) * iy;
+        vfloat t1y = (vfloat(node.boundsMax.y) - oy) * iy;
+        vfloat t0z = (vfloat(node.boundsMin.z) - oz) * iz;
+        vfloat t1z = (vfloat(node.boundsMax.z) - oz) * iz;
+
+        vfloat enter = max(max(min(t0x, t1x), min(t0y, t1y)),
+                            max(min(t0z, t1z), vfloat::load(packet.tMin + offset)));
+        vfloat exit = min(min(max(t0x, t1x), max(t0y, t1y)),
+                           min(max(t0z, t1z), vfloat::load(tMax + offset)));
+        result |= (static_cast<uint32_t>(movemask(enter <= exit)) & bits) << offset;
+    }
+    return result;
+}
+
+// Moller-Trumbore against all rays in activeMask; rays that hit closer than
+// their current tMax get it lowered to the hit distance.
+template <int N>
+uint32_t intersectTriangles(const RayPacket<N>& packet, const Triangle& tri, uint32_t activeMask,
+                            float* tMax, float* u, float* v) {
+    glm::vec3 e1 = tri.v1 - tri.v0;
+    glm::vec3 e2 = tri.v2 - tri.v0;
+    vfloat e1x(e1.x), e1y(e1.y), e1z(e1.z);
+    vfloat e2x(e2.x), e2y(e2.y), e2z(e2.z);
+    vfloat zero(0.0f), one(1.0f);
+
+    uint32_t result = 0;
+    for (int chunk = 0; chunk < N / Lanes; chunk++) {
+        uint32_t bits = chunkBits(activeMask, chunk);
+        if (bits == 0) {
+            continue;
+        }
+        int offset = chunk * Lanes;
+        vfloat dx = vfloat::load(packet.dirX + offset);
+        vfloat dy = vfloat::load(packet.dirY + offset);
+        vfloat dz = vfloat::load(packet.dirZ + offset);
+
+        vfloat px = dy * e2z - dz * e2y;
+        vfloat py = dz * e2x - dx * e2z;
+        vfloat pz = dx * e2y - dy * e2x;
+        vfloat det = e1x * px + e1y * py + e1z * pz;
+        vfloat invDet = one / det;
+
+        vfloat tx = vfloat::load(packet.originX + offset) - vfloat(tri.v0.x);
+        vfloat ty = vfloat::load(packet.originY + offset) - vfloat(tri.v0.y);
+        vfloat tz = vfloat::load(packet.originZ + offset) - vfloat(tri.v0.z);
+        vfloat uu = (tx * px + ty * py + tz * pz) * invDet;
+
+        vfloat qx = ty * e1z - tz * e1y;
+        vfloat qy = tz * e1x - tx * e1z;
+        vfloat qz = tx * e1y - ty * e1x;
+        vfloat vv = (dx * qx + dy * qy + dz * qz) * invDet;
+        vfloat tt = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+
+        vfloat tMaxChunk = vfloat::load(tMax + offset);
+        vfloat hit = (abs(det) >= vfloat(1e-12f)) & (uu >= zero) & (uu <= one) & (vv >= zero) &
+                      (uu + vv <= one) & (tt > vfloat::load(packet.tMin + offset)) & (tt < tMaxChunk);
+        uint32_t hitBits = static_cast<uint32_t>(movemask(hit)) & bits;
+        if (hitBits == 0) {
+            continue;
+        }
+
+        // Scatter only lanes in the mask; the others may be padding or rays
+        // that were culled at this leaf.
+        alignas(32) float laneT[Lanes], laneU[Lanes], laneV[Lanes];
+        tt.store(laneT);
+        uu.store(laneU);
+        vv.store(laneV);
+        for (int lanes = static_cast<int>(hitBits); lanes != 0;) {
+            int lane = simd::popLowestLane(lanes);
+            tMax[offset + lane] = laneT[lane];
+            if (u) {
+                u[offset + lane] = laneU[lane];
+                v[offset + lane] = laneV[lane];
+            }
+        }
+        result |= hitBits << offset;
+    }
+    return result;
+}
+
+struct StackEntry {
+    uint32_t node;
+    uint32_t mask;
+};
+
+// Orders children by the packet's mean direction instead of per ray.
+template <int N>
+glm::vec3 meanDirection(const RayPacket<N>& packet) {
+    glm::vec3 sum(0.0f);
+    for (int lane = 0; lane < N; lane++) {
+        if (packet.activeMask & (1u << lane)) {
+            sum += glm::vec3(packet.dirX[lane], packet.dirY[lane], packet.dirZ[lane]);
+        }
+    }
+    return sum;
+}
+
+bool leftChildFirst(const std::vector<BvhNode>& nodes, uint32_t index, const glm::vec3& direction) {
+    const BvhNode& left = nodes[index + 1];
+    const BvhNode& right = nodes[nodes[index].leftFirst];
+    glm::vec3 delta = (left.boundsMin + left.boundsMax) - (right.boundsMin + right.boundsMax);
+    return glm::dot(delta, direction) <= 0.0f;
+}
+
+uint32_t directionOctant(const Ray& ray) {
+    glm::vec3 inv = safeInverseDirection(ray.direction);
+    return (inv.x < 0.0f ? 1u : 0u) | (inv.y < 0.0f ? 2u : 0u) | (inv.z < 0.0f ? 4u : 0u);
+}
+
+uint32_t expandBits(uint32_t v) {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+// Orders rays by direction octant, then by the Morton code of their origin
+// within the octant. Packets are cut from runs of equal octant so every
+// packet keeps uniform direction signs (and with them a valid frustum),
+// and neighbouring origins land in the same packet.
+std::vector<uint32_t> sortByOctant(const std::vector<Ray>& rays, std::vector<uint32_t>& octantEnds) {
+    Aabb bounds;
+    for (const auto& ray : rays) {
+        bounds.grow(ray.origin);
+    }
+    glm::vec3 scale = 1023.0f / glm::max(bounds.extent(), glm::vec3(1e-6f));
+
+    // 3 octant bits, the top 29 of the 30-bit Morton code, 32 index bits.
+
+    std::vector<uint64_t> keys(rays.size());
+    std::array<uint32_t, 8> counts = {};
+    for (size_t i = 0; i < rays.size(); i++) {
+        glm::vec3 cell = (rays[i].origin - bounds.min) * scale;
+        uint32_t morton = expandBits(static_cast<uint32_t>(cell.x)) |
+                          (expandBits(static_cast<uint32_t>(cell.y)) << 1) |
+                          (expandBits(static_cast<uint32_t>(cell.z)) << 2);
+        uint32_t octant = directionOctant(rays[i]);
+        counts[octant]++;
+        keys[i] = (static_cast<uint64_t>(octant) << 61) | (static_cast<uint64_t>(morton >> 1) << 32) | i;
+    }
+    std::sort(keys.begin(), keys.end());
+
+    octantEnds.resize(8);
+    uint32_t end = 0;
+    for (int octant = 0; octant < 8; octant++) {
+        end += counts[octant];
+        octantEnds[octant] = end;
+    }
+
+    std::vector<uint32_t> order(rays.size());
+    for (size_t i = 0; i < rays.size(); i++) {
+        order[i] = static_cast<uint32_t>(keys[i]);
+    }
+    return order;
+}
+
+template <typename TraceFn>
+void traceStream(const std::vector<Ray>& rays, TraceFn&& trace) {
+    constexpr int Width = 16;
+    std::vector<uint32_t> octantEnds;
+    std::vector<uint32_t> order = sortByOctant(rays, octantEnds);
+
+    Ray gathered[Width];
+    uint32_t begin = 0;
+    for (uint32_t end : octantEnds) {
+        for (uint32_t first = begin; first < end; first += Width) {
+            int count = static_cast<int>(std::min<uint32_t>(Width, end - first));
+            for (int lane = 0; lane < count; lane++) {
+                gathered[lane] = rays[order[first + lane]];
+            }
+            RayPacket<Width> packet;
+            packet.load(gathered, count);
+            trace(packet, order.data() + first, count);
+        }
+        begin = end;
+    }
+}
+
+} // namespace
+
+template <int N>
+void RayPacket<N>::load(const Ray* rays, int count) {
+    count = std::min(count, N);
+    activeMask = (1u << count) - 1;
+    for (int lane = 0; lane < N; lane++) {
+        // Padding lanes repeat the first ray so SIMD math stays finite.
+        const Ray& ray = rays[lane < count ? lane : 0];
+        glm::vec3 inv = safeInverseDirection(ray.direction);
+        originX[lane] = ray.origin.x;
+        originY[lane] = ray.origin.y;
+        originZ[lane] = ray.origin.z;
+        dirX[lane] = ray.direction.x;
+        dirY[lane] = ray.direction.y;
+        dirZ[lane] = ray.direction.z;
+        invDirX[lane] = inv.x;
+        invDirY[lane] = inv.y;
+        invDirZ[lane] = inv.z;
+        tMin[lane] = ray.tMin;
+        tMax[lane] = ray.tMax;
+    }
+}
+
+template <int N>
+void PacketHit<N>::reset() {
+    for (int lane = 0; lane < N; lane++) {
+        t[lane] = std::numeric_limits<float>::max();
+        u[lane] = 0.0f;
+        v[lane] = 0.0f;
+        primitiveId[lane] = RayHit::InvalidId;
+    }
+}
+
+template <int N>
+RayHit PacketHit<N>::get(int lane) const {
+    RayHit hit;
+    hit.t = t[lane];
+    hit.u = u[lane];
+    hit.v = v[lane];
+    hit.primitiveId = primitiveId[lane];
+    return hit;
+}
+
+template <int N>
+void intersectPacket(const Bvh& bvh, const RayPacket<N>& packet, PacketHit<N>& hit, PacketTraversalStats* stats) {
+    hit.reset();
+    const std::vector<BvhNode>& nodes = bvh.getNodes();
+    if (nodes.empty() || packet.activeMask == 0) {
+        return;
+    }
+    const std::vector<Triangle>& triangles = bvh.getTriangles();
+    const std::vector<uint32_t>& primitiveIds = bvh.getPrimitiveIds();
+
+    alignas(32) float tMax[N];
+    std::copy(packet.tMax, packet.tMax + N, tMax);
+    PacketFrustum frustum = computeFrustum(packet, tMax);
+    glm::vec3 direction = meanDirection(packet);
+    uint64_t visited = 0, culled = 0;
+
+    StackEntry stack[BvhMaxDepth + 1];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = {0, packet.activeMask};
+    while (stackSize > 0) {
+        StackEntry entry = stack[--stackSize];
+        const BvhNode& node = nodes[entry.node];
+        visited++;
+        if (frustum.valid && frustumMisses(frustum, node)) {
+            culled++;
+            continue;
+        }
+        uint32_t mask = slabTest(packet, tMax, node, entry.mask);
+        if (mask == 0) {
+            continue;
+        }
+
+        if (node.isLeaf()) {
+            bool shortened = false;
+            for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+                uint32_t hits = intersectTriangles(packet, triangles[i], mask, tMax, hit.u, hit.v);
+                for (int lanes = static_cast<int>(hits); lanes != 0;) {
+                    hit.primitiveId[simd::popLowestLane(lanes)] = primitiveIds[i];
+                }
+                shortened |= hits != 0;
+            }
+            if (shortened && frustum.valid) {
+                frustum = computeFrustum(packet, tMax);
+            }
+            continue;
+        }
+
+        uint32_t nearChild = entry.node + 1;
+        uint32_t farChild = node.leftFirst;
+        if (!leftChildFirst(nodes, entry.node, direction)) {
+            std::swap(nearChild, farChild);
+        }
+        stack[stackSize++] = {farChild, mask};
+        stack[stackSize++] = {nearChild, mask};
+    }
+
+    for (int lane = 0; lane < N; lane++) {
+        if (hit.primitiveId[lane] != RayHit::InvalidId) {
+            hit.t[lane] = tMax[lane];
+        }
+    }
+    if (stats) {
+        stats->nodesVisited += visited;
+        stats->nodesCulled += culled;
+        stats->packets++;
+    }
+}
+
+template <int N>
+uint32_t occludedPacket(const Bvh& bvh, const RayPacket<N>& packet, PacketTraversalStats* stats) {
+    const std::vector<BvhNode>& nodes = bvh.getNodes();
+    if (nodes.empty() || packet.activeMask == 0) {
+        return 0;
+    }
+    const std::vector<Triangle>& triangles = bvh.getTriangles();
+
+    alignas(32) float tMax[N];
+    std::copy(packet.tMax, packet.tMax + N, tMax);
+    PacketFrustum frustum = computeFrustum(packet, tMax);
+    glm::vec3 direction = meanDirection(packet);
+    uint64_t visited = 0, culled = 0;
+    uint32_t occluded = 0;
+
+    StackEntry stack[BvhMaxDepth + 1];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = {0, packet.activeMask};
+    while (stackSize > 0 && occluded != packet.activeMask) {
+        StackEntry entry = stack[--stackSize];
+        const BvhNode& node = nodes[entry.node];
+        visited++;
+        if (frustum.valid && frustumMisses(frustum, node)) {
+            culled++;
+            continue;
+        }
+        uint32_t mask = slabTest(packet, tMax, node, entry.mask & ~occluded);
+        if (mask == 0) {
+            continue;
+        }
+
+        if (node.isLeaf()) {
+            for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count && mask != 0; i++) {
+                uint32_t hits = intersectTriangles<N>(packet, triangles[i], mask, tMax, nullptr, nullptr);
+                occluded |= hits;
+                mask &= ~hits;
+            }
+            continue;
+        }
+
+        uint32_t nearChild = entry.node + 1;
+        uint32_t farChild = node.leftFirst;
+        if (!leftChildFirst(nodes, entry.node, direction)) {
+            std::swap(nearChild, farChild);
+        }
+        stack[stackSize++] = {farChild, mask};
+        stack[stackSize++] = {nearChild, mask};
+    }
+
+    if (stats) {
+        stats->nodesVisited += visited;
+        stats->nodesCulled += culled;
+        stats->packets++;
+    }
+    return occluded;
+}
+
+void intersectStream(const Bvh& bvh, const std::vector<Ray>& rays, std::vector<RayHit>& hits,
+                     PacketTraversalStats* stats) {
+    hits.assign(rays.size(), RayHit());
+    PacketHit<16> packetHit;
+    traceStream(rays, [&](const RayPacket<16>& packet, const uint32_t* indices, int count) {
+        intersectPacket(bvh, packet, packetHit, stats);
+        for (int lane = 0; lane < count; lane++) {
+            hits[indices[lane]] = packetHit.get(lane);
+        }
+    });
+}
+
+void occludedStream(const Bvh& bvh, const std::vector<Ray>& rays, std::vector<uint8_t>& occluded,
+                    PacketTraversalStats* stats) {
+    occluded.assign(rays.size(), 0);
+    traceStream(rays, [&](const RayPacket<16>& packet, const uint32_t* indices, int count) {
+        uint32_t mask = occludedPacket(bvh, packet, stats);
+        for (int lane = 0; lane < count; lane++) {
+            occluded[indices[lane]] = (mask >> lane) & 1;
+        }
+    });
+}
+
+template struct RayPacket<8>;
+template struct RayPacket<16>;
+template struct PacketHit<8>;
+template struct PacketHit<16>;
+
+template void intersectPacket<8>(const Bvh&, const RayPacket<8>&, PacketHit<8>&, PacketTraversalStats*);
+template void intersectPacket<16>(const Bvh&, const RayPacket<16>&, PacketHit<16>&, PacketTraversalStats*);
+template uint32_t occludedPacket<8>(const Bvh&, const RayPacket<8>&, PacketTraversalStats*);
+template uint32_t occludedPacket<16>(const Bvh&, const RayPacket<16>&, PacketTraversalStats*);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "bvh/bvh.h"
+#include "bvh/ray.h"
+#include <cstdint>
+#include <vector>
+
+// Packet of N rays (N = 8 or 16) stored SoA for 4- or 8-wide SIMD. Unused
+// lanes are inactive and never report hits.
+template <int N>
+struct alignas(32) RayPacket {
+    static_assert(N == 8 || N == 16, "ray packets are 8 or 16 rays wide");
+    static constexpr int Width = N;
+
+    float originX[N], originY[N], originZ[N];
+    float dirX[N], dirY[N], dirZ[N];
+    float invDirX[N], invDirY[N], invDirZ[N];
+    float tMin[N], tMax[N];
+    uint32_t activeMask = 0;
+
+    void load(const Ray* rays, int count);
+};
+
+template <int N>
+struct alignas(32) PacketHit {
+    float t[N];
+    float u[N];
+    float v[N];
+    uint32_t primitiveId[N];
+
+    void reset();
+    RayHit get(int lane) const;
+};
+
+struct PacketTraversalStats {
+    uint64_t nodesVisited = 0;
+    uint64_t nodesCulled = 0;  // rejected by the packet frustum test alone
+    uint64_t packets = 0;
+};
+
+// Packet traversal of the binary BVH. Each node is first tested against the
+// packet's interval bounds (a conservative frustum); only surviving nodes
+// are slab-tested per ray, and triangles are tested against all active
+// rays at once.
+template <int N>
+void intersectPacket(const Bvh& bvh, const RayPacket<N>& packet, PacketHit<N>& hit,
+                     PacketTraversalStats* stats = nullptr);
+
+// Returns the mask of occluded lanes; traversal stops once all are blocked.
+template <int N>
+uint32_t occludedPacket(const Bvh& bvh, const RayPacket<N>& packet, PacketTraversalStats* stats = nullptr);
+
+// Ray streams: incoherent (secondary) rays are bucketed by direction octant
+// so that every packet has uniform direction signs, then traced as packets.
+void intersectStream(const Bvh& bvh, const std::vector<Ray>& rays, std::vector<RayHit>& hits,
+                     PacketTraversalStats* stats = nullptr);
+void occludedStream(const Bvh& bvh, const std::vector<Ray>& rays, std::vector<uint8_t>& occluded,
+                    PacketTraversalStats* stats = nullptr);
+
+extern template struct RayPacket<8>;
+extern template struct RayPacket<16>;
+extern template struct PacketHit<8>;
+extern template struct PacketHit<16>;
@@ -0,0 +1,323 @@
+#include "scene_bvh.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// Spreads the low 10 bits of v so that two zero bits separate each one.
+uint32_t expandBits(uint32_t v) {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+uint32_t mortonCode(const glm::vec3& unit) {
+    glm::vec3 cell = glm::clamp(unit * 1024.0f, glm::vec3(0.0f), glm::vec3(1023.0f));
+    return (expandBits(static_cast<uint32_t>(cell.x)) << 2) |
+           (expandBits(static_cast<uint32_t>(cell.y)) << 1) |
+           expandBits(static_cast<uint32_t>(cell.z));
+}
+
+uint32_t mortonOf(uint64_t key) {
+    return static_cast<uint32_t>(key >> 32);
+}
+
+// First index of the upper half of a sorted key range: the split falls where
+// the highest bit that differs across the range flips.
+uint32_t findSplit(const std::vector<uint64_t>& keys, uint32_t begin, uint32_t end) {
+    uint32_t first = mortonOf(keys[begin]);
+    uint32_t last = mortonOf(keys[end - 1]);
+    if (first == last) {
+        return begin + (end - begin) / 2;
+    }
+
+    uint32_t highestBit = first ^ last;
+    while (highestBit & (highestBit - 1)) {
+        highestBit &= highestBit - 1;
+    }
+
+    uint32_t split = begin;
+    uint32_t step = end - 1 - begin;
+    do {
+        step = (step + 1) >> 1;
+        uint32_t candidate = split + step;
+        if (candidate < end - 1 && (first ^ mortonOf(keys[candidate])) < highestBit) {
+            split = candidate;
+        }
+    } while (step > 1);
+    return split + 1;
+}
+
+struct StackEntry {
+    uint32_t node;
+    float distance;
+};
+
+} // namespace
+
+SceneBvh::SceneBvh(const SceneBvhSettings& settings) : settings(settings) {
+    this->settings.maxLeafSize = std::max(this->settings.maxLeafSize, 1u);
+}
+
+uint32_t SceneBvh::addMesh(const TriangleMesh& mesh) {
+    return addMesh(mesh, ThreadPool::global());
+}
+
+uint32_t SceneBvh::addMesh(const TriangleMesh& mesh, ThreadPool& pool) {
+    BvhBuildSettings buildSettings;
+    buildSettings.maxLeafSize = 8;
+    Bvh bvh;
+    bvh.build(mesh, pool, buildSettings);
+
+    BottomLevel bottom;
+    bottom.accel.build(bvh);
+    bottom.bounds = bvh.bounds();
+    meshes.push_back(std::move(bottom));
+    return static_cast<uint32_t>(meshes.size() - 1);
+}
+
+uint32_t SceneBvh::addInstance(uint32_t meshId, const glm::mat4& transform) {
+    if (meshId >= meshes.size()) {
+        throw std::runtime_error("SceneBvh::addInstance: invalid mesh id");
+    }
+    SceneInstance instance;
+    instance.meshId = meshId;
+    instances.push_back(instance);
+    setTransform(static_cast<uint32_t>(instances.size() - 1), transform);
+    topologyDirty = true;
+    return static_cast<uint32_t>(instances.size() - 1);
+}
+
+void SceneBvh::setTransform(uint32_t instanceId, const glm::mat4& transform) {
+    SceneInstance& instance = instances[instanceId];
+    instance.transform = transform;
+    instance.inverseTransform = glm::inverse(transform);
+    instance.worldBounds = meshes[instance.meshId].bounds.transformed(transform);
+}
+
+void SceneBvh::clearInstances() {
+    instances.clear();
+    nodes.clear();
+    leafInstances.clear();
+    topologyDirty = true;
+}
+
+void SceneBvh::update(SceneBvhUpdate mode) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    stats.rebuilt = false;
+    if (mode == SceneBvhUpdate::Rebuild || topologyDirty) {
+        rebuild();
+    } else {
+        refit();
+        if (mode == SceneBvhUpdate::Auto &&
+            computeSahCost(nodes) > stats.rebuildSahCost * settings.rebuildThreshold) {
+            rebuild();
+        }
+    }
+    stats.sahCost = computeSahCost(nodes);
+    if (stats.rebuilt) {
+        stats.rebuildSahCost = stats.sahCost;
+    }
+    stats.nodeCount = static_cast<uint32_t>(nodes.size());
+    stats.updateMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void SceneBvh::rebuild() {
+    nodes.clear();
+    leafInstances.clear();
+    topologyDirty = false;
+    stats.rebuilt = true;
+    stats.rebuildCount++;
+    if (instances.empty()) {
+        return;
+    }
+
+    Aabb centroidBounds;
+    for (const auto& instance : instances) {
+        centroidBounds.grow(instance.worldBounds.center());
+    }
+    glm::vec3 scale = 1.0f / glm::max(centroidBounds.extent(), glm::vec3(1e-6f));
+
+    // Morton code in the high half, instance id in the low half, ordered
+    // with three 10-bit radix passes over the 30-bit codes.
+    std::vector<uint64_t> keys(instances.size());
+    for (size_t i = 0; i < instances.size(); i++) {
+        glm::vec3 unit = (instances[i].worldBounds.center() - centroidBounds.min) * scale;
+        keys[i] = (static_cast<uint64_t>(mortonCode(unit)) << 32) | i;
+    }
+    std::vector<uint64_t> scratch(keys.size());
+    for (int shift = 32; shift < 62; shift += 10) {
+        uint32_t offsets[1025] = {};
+        for (uint64_t key : keys) {
+            offsets[((key >> shift) & 1023) + 1]++;
+        }
+        for (int i = 0; i < 1024; i++) {
+            offsets[i + 1] += offsets[i];
+        }
+        for (uint64_t key : keys) {
+            scratch[offsets[(key >> shift) & 1023]++] = key;
+        }
+        keys.swap(scratch);
+    }
+
+    leafInstances.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        leafInstances[i] = static_cast<uint32_t>(keys[i]);
+    }
+    nodes.reserve(2 * keys.size());
+    emitNode(keys, 0, static_cast<uint32_t>(keys.size()), 0);
+    refit();
+}
+
+uint32_t SceneBvh::emitNode(const std::vector<uint64_t>& keys, uint32_t begin, uint32_t end, uint32_t depth) {
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(BvhNode{});
+
+    uint32_t count = end - begin;
+    if (count <= settings.maxLeafSize || depth + 1 >= BvhMaxDepth) {
+        nodes[index].leftFirst = begin;
+        nodes[index].count = count;
+        return index;
+    }
+
+    // Depth-first order: the left subtree directly follows its parent.
+    uint32_t split = findSplit(keys, begin, end);
+    emitNode(keys, begin, split, depth + 1);
+    uint32_t right = emitNode(keys, split, end, depth + 1);
+    nodes[index].leftFirst = right;
+    nodes[index].count = 0;
+    return index;
+}
+
+void SceneBvh::refit() {
+    // Children always follow their parent, so a reverse pass sees them first.
+    for (size_t i = nodes.size(); i-- > 0;) {
+        BvhNode& node = nodes[i];
+        Aabb box;
+        if (node.isLeaf()) {
+            for (uint32_t j = node.leftFirst; j < node.leftFirst + node.count; j++) {
+                box.grow(instances[leafInstances[j]].worldBounds);
+            }
+        } else {
+            const BvhNode& left = nodes[i + 1];
+            const BvhNode& right = nodes[node.leftFirst];
+            box.grow(Aabb{left.boundsMin, left.boundsMax});
+            box.grow(Aabb{right.boundsMin, right.boundsMax});
+        }
+        node.boundsMin = box.min;
+        node.boundsMax = box.max;
+    }
+}
+
+Ray SceneBvh::toLocal(const SceneInstance& instance, const Ray& ray) const {
+    // The direction is not renormalised, so local t equals world t.
+    Ray local = ray;
+    local.origin = glm::vec3(instance.inverseTransform * glm::vec4(ray.origin, 1.0f));
+    local.direction = glm::vec3(instance.inverseTransform * glm::vec4(ray.direction, 0.0f));
+    return local;
+}
+
+bool SceneBvh::intersect(const Ray& ray, RayHit& hit) const {
+    if (nodes.empty()) {
+        return false;
+    }
+
+    Ray r = ray;
+    glm::vec3 invDir = safeInverseDirection(r.direction);
+    const float miss = std::numeric_limits<float>::max();
+    bool found = false;
+
+    StackEntry stack[BvhMaxDepth + 1];
+    uint32_t stackSize = 0;
+    float rootDistance = intersectAabb(nodes[0].boundsMin, nodes[0].boundsMax, r.origin, invDir, r.tMin, r.tMax);
+    if (rootDistance != miss) {
+        stack[stackSize++] = {0, rootDistance};
+    }
+
+    while (stackSize > 0) {
+        StackEntry current = stack[--stackSize];
+        if (current.distance > r.tMax) {
+            continue;
+        }
+
+        const BvhNode& node = nodes[current.node];
+        if (node.isLeaf()) {
+            for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+                uint32_t instanceId = leafInstances[i];
+                const SceneInstance& instance = instances[instanceId];
+                RayHit localHit;
+                if (meshes[instance.meshId].accel.intersect(toLocal(instance, r), localHit)) {
+                    r.tMax = localHit.t;
+                    hit = localHit;
+                    hit.instanceId = instanceId;
+                    found = true;
+                }
+            }
+            continue;
+        }
+
+        uint32_t nearChild = current.node + 1;
+        uint32_t farChild = node.leftFirst;
+        float tNear = intersectAabb(nodes[nearChild].boundsMin, nodes[nearChild].boundsMax,
+                                    r.origin, invDir, r.tMin, r.tMax);
+        float tFar = intersectAabb(nodes[farChild].boundsMin, nodes[farChild].boundsMax,
+                                   r.origin, invDir, r.tMin, r.tMax);
+        if (tFar < tNear) {
+            std::swap(nearChild, farChild);
+            std::swap(tNear, tFar);
+        }
+        if (tFar != miss) {
+            stack[stackSize++] = {farChild, tFar};
+        }
+        if (tNear != miss) {
+            stack[stackSize++] = {nearChild, tNear};
+        }
+    }
+    return found;
+}
+
+bool SceneBvh::occluded(const Ray& ray) const {
+    if (nodes.empty()) {
+        return false;
+    }
+
+    glm::vec3 invDir = safeInverseDirection(ray.direction);
+    const float miss = std::numeric_limits<float>::max();
+
+    uint32_t stack[BvhMaxDepth + 1];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        uint32_t index = stack[--stackSize];
+        const BvhNode& node = nodes[index];
+        if (intersectAabb(node.boundsMin, node.boundsMax, ray.origin, invDir, ray.tMin, ray.tMax) == miss) {
+            continue;
+        }
+        if (!node.isLeaf()) {
+            stack[stackSize++] = node.leftFirst;
+            stack[stackSize++] = index + 1;
+            continue;
+        }
+        for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+            const SceneInstance& instance = instances[leafInstances[i]];
+            if (meshes[instance.meshId].accel.occluded(toLocal(instance, ray))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+Aabb SceneBvh::bounds() const {
+    if (nodes.empty()) {
+        return Aabb();
+    }
+    return Aabb{nodes[0].boundsMin, nodes[0].boundsMax};
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "bvh/aabb.h"
+#include "bvh/bvh.h"
+#include "bvh/ray.h"
+#include "bvh/triangle_mesh.h"
+#include "bvh/wide_bvh.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+struct SceneInstance {
+    uint32_t meshId = 0;
+    glm::mat4 transform = glm::mat4(1.0f);
+    glm::mat4 inverseTransform = glm::mat4(1.0f);
+    Aabb worldBounds;
+};
+
+struct SceneBvhSettings {
+    uint32_t maxLeafSize = 2;
+    // Auto updates rebuild once the refitted tree's SAH cost exceeds the
+    // cost right after the last rebuild by this factor.
+    float rebuildThreshold = 1.5f;
+};
+
+enum class SceneBvhUpdate {
+    Refit,    // keep the topology, recompute bounds bottom-up
+    Rebuild,  // LBVH rebuild from instance centroid Morton codes
+    Auto,     // refit, rebuild when topology changed or quality degraded
+};
+
+struct SceneBvhStats {
+    double updateMs = 0.0;
+    bool rebuilt = false;
+    uint32_t rebuildCount = 0;
+    uint32_t nodeCount = 0;
+    float sahCost = 0.0f;
+    float rebuildSahCost = 0.0f;  // cost right after the last rebuild
+};
+
+// Two-level acceleration structure: a bottom-level BVH8 per mesh built once,
+// and a top-level binary BVH over instance world bounds that is refitted or
+// rebuilt every frame. Top-level nodes use the depth-first BvhNode layout,
+// so refitting is a single reverse pass over the node array.
+class SceneBvh {
+public:
+    explicit SceneBvh(const SceneBvhSettings& settings = SceneBvhSettings());
+
+    uint32_t addMesh(const TriangleMesh& mesh);
+    uint32_t addMesh(const TriangleMesh& mesh, ThreadPool& pool);
+    uint32_t addInstance(uint32_t meshId, const glm::mat4& transform);
+    void setTransform(uint32_t instanceId, const glm::mat4& transform);
+    void clearInstances();
+
+    void update(SceneBvhUpdate mode = SceneBvhUpdate::Auto);
+
+    // World-space queries; hits report the instance and the triangle index
+    // within that instance's mesh.
+    bool intersect(const Ray& ray, RayHit& hit) const;
+    bool occluded(const Ray& ray) const;
+
+    const SceneInstance& getInstance(uint32_t id) const { return instances[id]; }
+    uint32_t getInstanceCount() const { return static_cast<uint32_t>(instances.size()); }
+    uint32_t getMeshCount() const { return static_cast<uint32_t>(meshes.size()); }
+    const std::vector<BvhNode>& getNodes() const { return nodes; }
+    const SceneBvhStats& getStats() const { return stats; }
+    Aabb bounds() const;
+
+private:
+    struct BottomLevel {
+        Bvh8 accel;
+        Aabb bounds;
+    };
+
+    void rebuild();
+    void refit();
+    uint32_t emitNode(const std::vector<uint64_t>& keys, uint32_t begin, uint32_t end, uint32_t depth);
+    Ray toLocal(const SceneInstance& instance, const Ray& ray) const;
+
+    SceneBvhSettings settings;
+    std::vector<BottomLevel> meshes;
+    std::vector<SceneInstance> instances;
+    std::vector<BvhNode> nodes;
+    // Instance ids in leaf order.
+    std::vector<uint32_t> leafInstances;
+    bool topologyDirty = true;
+    SceneBvhStats stats;
+};
@@ -0,0 +1,74 @@
+#include "triangle_mesh.h"
+#include "model.h"
+#include "tiny_obj_loader.h"
+#include <stdexcept>
+
+void TriangleMesh::append(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                          const glm::mat4& transform) {
+    auto transformPoint = [&transform](const glm::vec3& p) {
+        return glm::vec3(transform * glm::vec4(p, 1.0f));
+    };
+
+    if (indices.empty()) {
+        triangles.reserve(triangles.size() + vertices.size() / 3);
+        for (size_t i = 0; i + 2 < vertices.size(); i += 3) {
+            triangles.push_back({transformPoint(vertices[i].position),
+                                 transformPoint(vertices[i + 1].position),
+                                 transformPoint(vertices[i + 2].position)});
+        }
+        return;
+    }
+
+    triangles.reserve(triangles.size() + indices.size() / 3);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        triangles.push_back({transformPoint(vertices[indices[i]].position),
+                             transformPoint(vertices[indices[i + 1]].position),
+                             transformPoint(vertices[indices[i + 2]].position)});
+    }
+}
+
+void TriangleMesh::append(const TriangleMesh& other) {
+    triangles.insert(triangles.end(), other.triangles.begin(), other.triangles.end());
+}
+
+TriangleMesh TriangleMesh::fromModel(const Model& model, const glm::mat4& transform) {
+    TriangleMesh mesh;
+    mesh.append(model.GetVertices(), model.GetIndices(), transform);
+    return mesh;
+}
+
+TriangleMesh TriangleMesh::loadObj(const std::string& path) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str())) {
+        throw std::runtime_error(warn + err);
+    }
+
+    TriangleMesh mesh;
+    for (const auto& shape : shapes) {
+        const auto& indices = shape.mesh.indices;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            Triangle triangle;
+            glm::vec3* corners[3] = {&triangle.v0, &triangle.v1, &triangle.v2};
+            for (int k = 0; k < 3; k++) {
+                int v = indices[i + k].vertex_index;
+                *corners[k] = {attrib.vertices[3 * v + 0],
+                               attrib.vertices[3 * v + 1],
+                               attrib.vertices[3 * v + 2]};
+            }
+            mesh.triangles.push_back(triangle);
+        }
+    }
+    return mesh;
+}
+
+Aabb TriangleMesh::bounds() const {
+    Aabb box;
+    for (const auto& triangle : triangles) {
+        box.grow(triangle.bounds());
+    }
+    return box;
+}
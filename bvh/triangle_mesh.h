@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Types.h"
+#include "bvh/aabb.h"
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+class Model;
+
+struct Triangle {
+    glm::vec3 v0;
+    glm::vec3 v1;
+    glm::vec3 v2;
+
+    Aabb bounds() const {
+        Aabb box;
+        box.grow(v0);
+        box.grow(v1);
+        box.grow(v2);
+        return box;
+    }
+
+    glm::vec3 centroid() const { return (v0 + v1 + v2) * (1.0f / 3.0f); }
+};
+
+// Flat triangle soup used by the CPU-side spatial structures. OBJ models store
+// unindexed vertex streams, so an empty index list means consecutive
+// vertex triplets.
+class TriangleMesh {
+public:
+    void append(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                const glm::mat4& transform = glm::mat4(1.0f));
+    void append(const Triangle& triangle) { triangles.push_back(triangle); }
+    void append(const TriangleMesh& other);
+
+    static TriangleMesh fromModel(const Model& model, const glm::mat4& transform = glm::mat4(1.0f));
+    static TriangleMesh loadObj(const std::string& path);
+
+    const std::vector<Triangle>& getTriangles() const { return triangles; }
+    size_t size() const { return triangles.size(); }
+    bool empty() const { return triangles.empty(); }
+    void reserve(size_t count) { triangles.reserve(count); }
+    void clear() { triangles.clear(); }
+
+    Aabb bounds() const;
+
+private:
+    std::vector<Triangle> triangles;
+};
@@ -0,0 +1,356 @@
+#include "wide_bvh.h"
+#include "core/simd.h"
+#include <algorithm>
+
+namespace {
+
+// Closest-first traversal can push up to N - 1 siblings per level.
+template <int N>
+constexpr uint32_t wideStackSize() {
+    return BvhMaxDepth * (N - 1) + 1;
+}
+
+struct StackEntry {
+    uint32_t node;
+    uint32_t packCount;
+    float distance;
+};
+
+template <int N>
+struct RayLanes {
+    using V = typename simd::FloatVector<N>::Type;
+
+    explicit RayLanes(const Ray& ray)
+        : ox(ray.origin.x), oy(ray.origin.y), oz(ray.origin.z),
+          dx(ray.direction.x), dy(ray.direction.y), dz(ray.direction.z) {
+        glm::vec3 inv = safeInverseDirection(ray.direction);
+        ix = V(inv.x);
+        iy = V(inv.y);
+        iz = V(inv.z);
+    }
+
+    V ox, oy, oz;
+    V dx, dy, dz;
+    V ix, iy, iz;
+};
+
+// Returns a bit mask of the children whose boxes the ray enters before tMax.
+template <int N>
+int intersectChildren(const WideBvhNode<N>& node, const RayLanes<N>& ray, float tMin, float tMax,
+                      float* entry) {
+    using V = typename simd::FloatVector<N>::Type;
+
+    V t0x = (V::load(node.boundsMinX) - ray.ox) * ray.ix;
+    V t1x = (V::load(node.boundsMaxX) - ray.ox) * ray.ix;
+    V t0y = (V::load(node.boundsMinY) - ray.oy) * ray.iy;
+    V t1y = (V::load(node.boundsMaxY) - ray.oy) * ray.iy;
+    V t0z = (V::load(node.boundsMinZ) - ray.oz) * ray.iz;
+    V t1z = (V::load(node.boundsMaxZ) - ray.oz) * ray.iz;
+
+    V tNear = simd::max(simd::max(simd::min(t0x, t1x), simd::min(t0y, t1y)),
+                        simd::max(simd::min(t0z, t1z), V(tMin)));
+    V tFar = simd::min(simd::min(simd::max(t0x, t1x), simd::max(t0y, t1y)),
+                       simd::min(simd::max(t0z, t1z), V(tMax)));
+    tNear.store(entry);
+    return simd::movemask(tNear <= tFar);
+}
+
+// Vectorised Moller-Trumbore across the N triangles of a pack. Writes the
+// per-lane distances/barycentrics and returns the mask of valid hits.
+template <int N>
+int intersectPack(const TrianglePack<N>& pack, const RayLanes<N>& ray, float tMin, float tMax,
+                  float* t, float* u, float* v) {
+    using V = typename simd::FloatVector<N>::Type;
+
+    V e1x = V::load(pack.e1x), e1y = V::load(pack.e1y), e1z = V::load(pack.e1z);
+    V e2x = V::load(pack.e2x), e2y = V::load(pack.e2y), e2z = V::load(pack.e2z);
+
+    V px = ray.dy * e2z - ray.dz * e2y;
+    V py = ray.dz * e2x - ray.dx * e2z;
+    V pz = ray.dx * e2y - ray.dy * e2x;
+    V det = e1x * px + e1y * py + e1z * pz;
+    V invDet = V(1.0f) / det;
+
+    V tx = ray.ox - V::load(pack.v0x);
+    V ty = ray.oy - V::load(pack.v0y);
+    V tz = ray.oz - V::load(pack.v0z);
+    V uu = (tx * px + ty * py + tz * pz) * invDet;
+
+    V qx = ty * e1z - tz * e1y;
+    V qy = tz * e1x - tx * e1z;
+    V qz = tx * e1y - ty * e1x;
+    V vv = (ray.dx * qx + ray.dy * qy + ray.dz * qz) * invDet;
+    V tt = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+
+    V mask = (simd::abs(det) > V(1e-12f)) & (uu >= V(0.0f)) & (vv >= V(0.0f)) &
+             (uu + vv <= V(1.0f)) & (tt > V(tMin)) & (tt < V(tMax));
+    tt.store(t);
+    uu.store(u);
+    vv.store(v);
+    return simd::movemask(mask);
+}
+
+template <int N>
+void setChildBounds(WideBvhNode<N>& node, int slot, const BvhNode& child) {
+    node.boundsMinX[slot] = child.boundsMin.x;
+    node.boundsMinY[slot] = child.boundsMin.y;
+    node.boundsMinZ[slot] = child.boundsMin.z;
+    node.boundsMaxX[slot] = child.boundsMax.x;
+    node.boundsMaxY[slot] = child.boundsMax.y;
+    node.boundsMaxZ[slot] = child.boundsMax.z;
+}
+
+template <int N>
+WideBvhNode<N> makeEmptyNode() {
+    WideBvhNode<N> node;
+    for (int i = 0; i < N; i++) {
+        node.boundsMinX[i] = node.boundsMinY[i] = node.boundsMinZ[i] = 0.0f;
+        node.boundsMaxX[i] = node.boundsMaxY[i] = node.boundsMaxZ[i] = 0.0f;
+        node.child[i] = WideBvhNode<N>::EmptySlot;
+        node.packCount[i] = 0;
+    }
+    return node;
+}
+
+float nodeArea(const BvhNode& node) {
+    return Aabb{node.boundsMin, node.boundsMax}.surfaceArea();
+}
+
+} // namespace
+
+template <int N>
+void WideBvh<N>::build(const Bvh& source) {
+    nodes.clear();
+    packs.clear();
+    stats = WideBvhStats();
+    if (source.empty()) {
+        return;
+    }
+
+    const std::vector<BvhNode>& binary = source.getNodes();
+    subtreeFirst.resize(binary.size());
+    subtreeCount.resize(binary.size());
+    for (size_t i = binary.size(); i-- > 0;) {
+        if (binary[i].isLeaf()) {
+            subtreeFirst[i] = binary[i].leftFirst;
+            subtreeCount[i] = binary[i].count;
+        } else {
+            subtreeFirst[i] = subtreeFirst[i + 1];
+            subtreeCount[i] = subtreeCount[i + 1] + subtreeCount[binary[i].leftFirst];
+        }
+    }
+
+    if (isPackedLeaf(source, 0)) {
+        nodes.push_back(makeEmptyNode<N>());
+        setChildBounds(nodes[0], 0, binary[0]);
+        emitLeaf(source, 0, nodes[0].child[0], nodes[0].packCount[0]);
+    } else {
+        collapse(source, 0);
+    }
+
+    subtreeFirst.clear();
+    subtreeFirst.shrink_to_fit();
+    subtreeCount.clear();
+    subtreeCount.shrink_to_fit();
+
+    uint32_t usedSlots = 0;
+    for (const auto& node : nodes) {
+        for (int i = 0; i < N; i++) {
+            usedSlots += node.child[i] != WideBvhNode<N>::EmptySlot;
+        }
+    }
+    stats.nodeCount = static_cast<uint32_t>(nodes.size());
+    stats.packCount = static_cast<uint32_t>(packs.size());
+    stats.childFill = static_cast<float>(usedSlots) / (nodes.size() * N);
+    stats.packFill = packs.empty() ? 0.0f
+                                   : static_cast<float>(source.getTriangles().size()) / (packs.size() * N);
+}
+
+template <int N>
+bool WideBvh<N>::isPackedLeaf(const Bvh& source, uint32_t binaryIndex) const {
+    return source.getNodes()[binaryIndex].isLeaf() || subtreeCount[binaryIndex] <= static_cast<uint32_t>(N);
+}
+
+template <int N>
+uint32_t WideBvh<N>::collapse(const Bvh& source, uint32_t binaryIndex) {
+    const std::vector<BvhNode>& binary = source.getNodes();
+
+    // Open up the largest interior candidate until the node is full.
+    uint32_t candidates[N];
+    int candidateCount = 0;
+    candidates[candidateCount++] = binaryIndex + 1;
+    candidates[candidateCount++] = binary[binaryIndex].leftFirst;
+    while (candidateCount < N) {
+        int best = -1;
+        float bestArea = -1.0f;
+        for (int i = 0; i < candidateCount; i++) {
+            const BvhNode& candidate = binary[candidates[i]];
+            if (!isPackedLeaf(source, candidates[i]) && nodeArea(candidate) > bestArea) {
+                bestArea = nodeArea(candidate);
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        uint32_t opened = candidates[best];
+        candidates[best] = opened + 1;
+        candidates[candidateCount++] = binary[opened].leftFirst;
+    }
+
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(makeEmptyNode<N>());
+    for (int i = 0; i < candidateCount; i++) {
+        const BvhNode& child = binary[candidates[i]];
+        setChildBounds(nodes[index], i, child);
+        if (isPackedLeaf(source, candidates[i])) {
+            uint32_t first, count;
+            emitLeaf(source, candidates[i], first, count);
+            nodes[index].child[i] = first;
+            nodes[index].packCount[i] = count;
+        } else {
+            // collapse() may grow the node array, so write through the index.
+            uint32_t childIndex = collapse(source, candidates[i]);
+            nodes[index].child[i] = childIndex;
+        }
+    }
+    return index;
+}
+
+template <int N>
+void WideBvh<N>::emitLeaf(const Bvh& source, uint32_t binaryIndex, uint32_t& first, uint32_t& count) {
+    const std::vector<Triangle>& triangles = source.getTriangles();
+    const std::vector<uint32_t>& ids = source.getPrimitiveIds();
+    uint32_t triangleFirst = subtreeFirst[binaryIndex];
+    uint32_t triangleCount = subtreeCount[binaryIndex];
+
+    first = static_cast<uint32_t>(packs.size());
+    count = (triangleCount + N - 1) / N;
+    for (uint32_t p = 0; p < count; p++) {
+        TrianglePack<N> pack;
+        for (int lane = 0; lane < N; lane++) {
+            uint32_t local = p * N + lane;
+            glm::vec3 v0(0.0f), e1(0.0f), e2(0.0f);
+            uint32_t id = RayHit::InvalidId;
+            if (local < triangleCount) {
+                const Triangle& tri = triangles[triangleFirst + local];
+                v0 = tri.v0;
+                e1 = tri.v1 - tri.v0;
+                e2 = tri.v2 - tri.v0;
+                id = ids[triangleFirst + local];
+            }
+            // Padding lanes are degenerate (zero edges) and can never hit.
+            pack.v0x[lane] = v0.x; pack.v0y[lane] = v0.y; pack.v0z[lane] = v0.z;
+            pack.e1x[lane] = e1.x; pack.e1y[lane] = e1.y; pack.e1z[lane] = e1.z;
+            pack.e2x[lane] = e2.x; pack.e2y[lane] = e2.y; pack.e2z[lane] = e2.z;
+            pack.primitiveId[lane] = id;
+        }
+        packs.push_back(pack);
+    }
+}
+
+template <int N>
+bool WideBvh<N>::intersect(const Ray& ray, RayHit& hit) const {
+    if (nodes.empty()) {
+        return false;
+    }
+
+    RayLanes<N> lanes(ray);
+    float tMin = ray.tMin;
+    float tMax = ray.tMax;
+    bool found = false;
+
+    StackEntry stack[wideStackSize<N>()];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = {0, 0, tMin};
+
+    alignas(32) float entry[N];
+    alignas(32) float t[N], u[N], v[N];
+    while (stackSize > 0) {
+        StackEntry current = stack[--stackSize];
+        if (current.distance > tMax) {
+            continue;
+        }
+
+        if (current.packCount != 0) {
+            for (uint32_t p = current.node; p < current.node + current.packCount; p++) {
+                int mask = intersectPack(packs[p], lanes, tMin, tMax, t, u, v);
+                while (mask) {
+                    int lane = simd::popLowestLane(mask);
+                    if (t[lane] < tMax) {
+                        tMax = t[lane];
+                        hit.t = t[lane];
+                        hit.u = u[lane];
+                        hit.v = v[lane];
+                        hit.primitiveId = packs[p].primitiveId[lane];
+                        found = true;
+                    }
+                }
+            }
+            continue;
+        }
+
+        const WideBvhNode<N>& node = nodes[current.node];
+        int mask = intersectChildren(node, lanes, tMin, tMax, entry);
+
+        // Push hit children far-to-near so the nearest is popped first.
+        StackEntry hits[N];
+        int hitCount = 0;
+        while (mask) {
+            int slot = simd::popLowestLane(mask);
+            if (node.child[slot] == WideBvhNode<N>::EmptySlot) {
+                continue;
+            }
+            StackEntry e{node.child[slot], node.packCount[slot], entry[slot]};
+            int i = hitCount++;
+            while (i > 0 && hits[i - 1].distance < e.distance) {
+                hits[i] = hits[i - 1];
+                i--;
+            }
+            hits[i] = e;
+        }
+        for (int i = 0; i < hitCount; i++) {
+            stack[stackSize++] = hits[i];
+        }
+    }
+    return found;
+}
+
+template <int N>
+bool WideBvh<N>::occluded(const Ray& ray) const {
+    if (nodes.empty()) {
+        return false;
+    }
+
+    RayLanes<N> lanes(ray);
+    StackEntry stack[wideStackSize<N>()];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = {0, 0, ray.tMin};
+
+    alignas(32) float entry[N];
+    alignas(32) float t[N], u[N], v[N];
+    while (stackSize > 0) {
+        StackEntry current = stack[--stackSize];
+        if (current.packCount != 0) {
+            for (uint32_t p = current.node; p < current.node + current.packCount; p++) {
+                if (intersectPack(packs[p], lanes, ray.tMin, ray.tMax, t, u, v)) {
+                    return true;
+                }
+            }
+            continue;
+        }
+
+        const WideBvhNode<N>& node = nodes[current.node];
+        int mask = intersectChildren(node, lanes, ray.tMin, ray.tMax, entry);
+        while (mask) {
+            int slot = simd::popLowestLane(mask);
+            if (node.child[slot] != WideBvhNode<N>::EmptySlot) {
+                stack[stackSize++] = {node.child[slot], node.packCount[slot], entry[slot]};
+            }
+        }
+    }
+    return false;
+}
+
+template class WideBvh<4>;
+template class WideBvh<8>;
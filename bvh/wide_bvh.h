@@ -0,0 +1,74 @@
+#pragma once
+
+#include "bvh/bvh.h"
+#include "bvh/ray.h"
+#include <cstdint>
+#include <vector>
+
+// N-wide BVH (N = 4 or 8) collapsed from a binary Bvh. Child boxes are stored
+// SoA so one SIMD slab test covers all children, and leaf triangles are
+// packed N at a time (vertex + two edges) for a vectorised Moller-Trumbore.
+template <int N>
+struct alignas(32) WideBvhNode {
+    static constexpr uint32_t EmptySlot = ~0u;
+
+    float boundsMinX[N], boundsMinY[N], boundsMinZ[N];
+    float boundsMaxX[N], boundsMaxY[N], boundsMaxZ[N];
+    // Interior child: node index with packCount 0. Leaf child: first
+    // triangle pack and the number of packs. Unused slots hold EmptySlot.
+    uint32_t child[N];
+    uint32_t packCount[N];
+};
+
+template <int N>
+struct alignas(32) TrianglePack {
+    float v0x[N], v0y[N], v0z[N];
+    float e1x[N], e1y[N], e1z[N];
+    float e2x[N], e2y[N], e2z[N];
+    uint32_t primitiveId[N];
+};
+
+struct WideBvhStats {
+    uint32_t nodeCount = 0;
+    uint32_t packCount = 0;
+    // Fraction of triangle lanes and child slots that hold real data.
+    float packFill = 0.0f;
+    float childFill = 0.0f;
+};
+
+template <int N>
+class WideBvh {
+public:
+    static_assert(N == 4 || N == 8, "WideBvh supports 4 and 8 wide nodes");
+    static constexpr int Width = N;
+
+    void build(const Bvh& source);
+
+    bool intersect(const Ray& ray, RayHit& hit) const;
+    bool occluded(const Ray& ray) const;
+
+    const std::vector<WideBvhNode<N>>& getNodes() const { return nodes; }
+    const std::vector<TrianglePack<N>>& getPacks() const { return packs; }
+    const WideBvhStats& getStats() const { return stats; }
+    bool empty() const { return nodes.empty(); }
+
+private:
+    bool isPackedLeaf(const Bvh& source, uint32_t binaryIndex) const;
+    uint32_t collapse(const Bvh& source, uint32_t binaryIndex);
+    void emitLeaf(const Bvh& source, uint32_t binaryIndex, uint32_t& first, uint32_t& count);
+
+    std::vector<WideBvhNode<N>> nodes;
+    std::vector<TrianglePack<N>> packs;
+    WideBvhStats stats;
+
+    // Triangle range of every binary subtree (contiguous in depth-first order),
+    // so small subtrees can be flattened into a single leaf of full packs.
+    std::vector<uint32_t> subtreeFirst;
+    std::vector<uint32_t> subtreeCount;
+};
+
+using Bvh4 = WideBvh<4>;
+using Bvh8 = WideBvh<8>;
+
+extern template class WideBvh<4>;
+extern template class WideBvh<8>;
@@ -0,0 +1,290 @@
+#include "lz4.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+constexpr size_t MinMatch = 4;
+// The last match must start this far before the end and the last 5 bytes
+// are always literals, so decoders may copy in 8-byte steps.
+constexpr size_t MatchStartLimit = 12;
+constexpr size_t LastLiterals = 5;
+constexpr size_t MaxOffset = 65535;
+constexpr int HashLog = 16;
+constexpr int MaxLevel = 12;
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+constexpr size_t WildCopy = 16;
+
+// Copies whole 16-byte steps covering count bytes. Source and destination
+// may overlap as long as they are at least 16 bytes apart.
+void wildCopy(uint8_t* to, const uint8_t* from, size_t count) {
+    for (size_t i = 0; i < count; i += WildCopy) {
+        std::memcpy(to + i, from + i, WildCopy);
+    }
+}
+
+int lowestSetBit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+uint32_t hash4(uint32_t value) {
+    return (value * 2654435761u) >> (32 - HashLog);
+}
+
+size_t matchLength(const uint8_t* src, size_t a, size_t b, size_t limit) {
+    size_t length = 0;
+    while (b + length + 8 <= limit) {
+        uint64_t x, y;
+        std::memcpy(&x, src + a + length, 8);
+        std::memcpy(&y, src + b + length, 8);
+        if (x != y) {
+            return length + static_cast<size_t>(lowestSetBit(x ^ y) >> 3);
+        }
+        length += 8;
+    }
+    while (b + length < limit && src[a + length] == src[b + length]) {
+        length++;
+    }
+    return length;
+}
+
+uint8_t* writeLength(uint8_t* out, size_t length) {
+    while (length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = static_cast<uint8_t>(length);
+    return out;
+}
+
+uint8_t* writeSequence(uint8_t* out, const uint8_t* literals, size_t literalCount, size_t offset, size_t length) {
+    uint8_t* token = out++;
+    size_t matchCode = length - MinMatch;
+    *token = static_cast<uint8_t>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15));
+    if (literalCount >= 15) {
+        out = writeLength(out, literalCount - 15);
+    }
+    std::memcpy(out, literals, literalCount);
+    out += literalCount;
+    *out++ = static_cast<uint8_t>(offset);
+    *out++ = static_cast<uint8_t>(offset >> 8);
+    if (matchCode >= 15) {
+        out = writeLength(out, matchCode - 15);
+    }
+    return out;
+}
+
+uint8_t* writeLastLiterals(uint8_t* out, const uint8_t* literals, size_t literalCount) {
+    *out++ = static_cast<uint8_t>(std::min<size_t>(literalCount, 15) << 4);
+    if (literalCount >= 15) {
+        out = writeLength(out, literalCount - 15);
+    }
+    std::memcpy(out, literals, literalCount);
+    return out + literalCount;
+}
+
+// Per-thread tables, so compressing many blocks does not allocate.
+struct MatchTables {
+    std::vector<int64_t> head;
+    std::vector<uint16_t> chain;
+};
+
+MatchTables& matchTables() {
+    static thread_local MatchTables tables;
+    return tables;
+}
+
+} // namespace
+
+size_t lz4CompressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t lz4Compress(const uint8_t* src, size_t size, uint8_t* dst, int level) {
+    uint8_t* out = dst;
+    if (size <= MatchStartLimit) {
+        return static_cast<size_t>(writeLastLiterals(out, src, size) - dst);
+    }
+    level = std::min(std::max(level, 0), MaxLevel);
+    MatchTables& tables = matchTables();
+    tables.head.assign(size_t(1) << HashLog, -1);
+    if (level > 0) {
+        tables.chain.assign(MaxOffset + 1, 0);
+    }
+    const size_t attempts = size_t(1) << level;
+    const size_t matchStartEnd = size - MatchStartLimit;
+    const size_t matchEnd = size - LastLiterals;
+
+    // Chain links are distances to the previous position with the same
+    // hash, 0 ending the chain.
+    size_t inserted = 0;
+    auto insertUpTo = [&](size_t position) {
+        for (; inserted < position; inserted++) {
+            uint32_t h = hash4(read32(src + inserted));
+            int64_t previous = tables.head[h];
+            size_t delta = previous < 0 ? 0 : inserted - static_cast<size_t>(previous);
+            tables.chain[inserted & MaxOffset] = static_cast<uint16_t>(delta > MaxOffset ? 0 : delta);
+            tables.head[h] = static_cast<int64_t>(inserted);
+        }
+    };
+
+    size_t anchor = 0;
+    size_t ip = 0;
+    while (ip < matchStartEnd) {
+        size_t bestLength = 0;
+        size_t bestOffset = 0;
+        if (level == 0) {
+            uint32_t h = hash4(read32(src + ip));
+            int64_t candidate = tables.head[h];
+            tables.head[h] = static_cast<int64_t>(ip);
+            if (candidate >= 0 && ip - static_cast<size_t>(candidate) <= MaxOffset &&
+                read32(src + candidate) == read32(src + ip)) {
+                bestOffset = ip - static_cast<size_t>(candidate);
+                bestLength = MinMatch + matchLength(src, static_cast<size_t>(candidate) + MinMatch, ip + MinMatch,
+                                                    matchEnd);
+            }
+        } else {
+            insertUpTo(ip);
+            int64_t candidate = tables.head[hash4(read32(src + ip))];
+            for (size_t i = 0; i < attempts && candidate >= 0; i++) {
+                size_t position = static_cast<size_t>(candidate);
+                if (ip - position > MaxOffset) {
+                    break;
+                }
+                if (read32(src + position) == read32(src + ip)) {
+                    size_t length = MinMatch + matchLength(src, position + MinMatch, ip + MinMatch, matchEnd);
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestOffset = ip - position;
+                    }
+                }
+                uint16_t delta = tables.chain[position & MaxOffset];
+                candidate = delta == 0 ? -1 : candidate - delta;
+            }
+        }
+
+        if (bestLength == 0) {
+            // Skip faster through data that does not compress.
+            ip += level == 0 ? 1 + ((ip - anchor) >> 6) : 1;
+            continue;
+        }
+        // Grow the match backwards over literals that also match.
+        while (ip > anchor && ip > bestOffset && src[ip - 1] == src[ip - 1 - bestOffset]) {
+            ip--;
+            bestLength++;
+        }
+        out = writeSequence(out, src + anchor, ip - anchor, bestOffset, bestLength);
+        ip += bestLength;
+        anchor = ip;
+        if (level == 0 && ip < matchStartEnd) {
+            tables.head[hash4(read32(src + ip - 2))] = static_cast<int64_t>(ip - 2);
+        }
+    }
+    out = writeLastLiterals(out, src + anchor, size - anchor);
+    return static_cast<size_t>(out - dst);
+}
+
+void lz4Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+    auto corrupt = []() { throw std::runtime_error("lz4Decompress: corrupt block"); };
+    size_t ip = 0;
+    size_t op = 0;
+    auto readLength = [&](size_t length) {
+        uint8_t byte;
+        do {
+            if (ip >= srcSize) {
+                corrupt();
+            }
+            byte = src[ip++];
+            length += byte;
+        } while (byte == 255);
+        return length;
+    };
+
+    for (;;) {
+        if (ip >= srcSize) {
+            corrupt();
+        }
+        uint8_t token = src[ip++];
+        size_t literalCount = token >> 4;
+        if (literalCount == 15) {
+            literalCount = readLength(literalCount);
+        }
+        if (literalCount > srcSize - ip || literalCount > dstSize - op) {
+            corrupt();
+        }
+        // Fixed-size copies compile to a few vector moves; they may run past
+        // the literals, but the slack is in bounds and overwritten later.
+        if (literalCount <= WildCopy && srcSize - ip >= WildCopy && dstSize - op >= WildCopy) {
+            std::memcpy(dst + op, src + ip, WildCopy);
+        } else if (srcSize - ip >= literalCount + WildCopy && dstSize - op >= literalCount + WildCopy) {
+            wildCopy(dst + op, src + ip, literalCount);
+        } else {
+            std::memcpy(dst + op, src + ip, literalCount);
+        }
+        ip += literalCount;
+        op += literalCount;
+        if (ip == srcSize) {
+            break;
+        }
+
+        if (srcSize - ip < 2) {
+            corrupt();
+        }
+        size_t offset = src[ip] | (static_cast<size_t>(src[ip + 1]) << 8);
+        ip += 2;
+        size_t length = token & 15;
+        if (length == 15) {
+            length = readLength(length);
+        }
+        length += MinMatch;
+        if (offset == 0 || offset > op || length > dstSize - op) {
+            corrupt();
+        }
+        uint8_t* to = dst + op;
+        const uint8_t* from = to - offset;
+        if (offset >= WildCopy && length <= WildCopy + 2 && dstSize - op >= WildCopy + 2) {
+            // Most matches are short: two fixed copies, no loop.
+            std::memcpy(to, from, WildCopy);
+            std::memcpy(to + WildCopy, from + WildCopy, 2);
+        } else if (offset >= WildCopy && dstSize - op >= length + WildCopy) {
+            wildCopy(to, from, length);
+        } else if (dstSize - op >= length + 8) {
+            // A short offset repeats a pattern; a whole number of repeats
+            // of at least 8 bytes is a distance 8-byte steps can copy from.
+            size_t step = offset >= 8 ? offset : offset * ((8 + offset - 1) / offset);
+            size_t i = 0;
+            for (; i < step && i < length && offset < 8; i++) {
+                to[i] = from[i];
+            }
+            for (; i < length; i += 8) {
+                std::memcpy(to + i, to + i - step, 8);
+            }
+        } else {
+            for (size_t i = 0; i < length; i++) {
+                to[i] = from[i];
+            }
+        }
+        op += length;
+    }
+    if (op != dstSize) {
+        corrupt();
+    }
+}
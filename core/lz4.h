@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// LZ4 block format (no frame): sequences of literals followed by a match
+// of at least 4 bytes at most 64 KB back, so blocks decode with nothing
+// but byte copies. Output is compatible with the reference library.
+
+// Largest compressed size of `size` input bytes.
+size_t lz4CompressBound(size_t size);
+
+// Compresses into dst, which must hold lz4CompressBound(size) bytes, and
+// returns the compressed size. Level 0 takes the first match a hash table
+// offers (fast); higher levels search a hash chain of up to 2^level
+// earlier positions for the longest match, which encodes several times
+// slower for a better ratio and decodes just as fast.
+size_t lz4Compress(const uint8_t* src, size_t size, uint8_t* dst, int level = 0);
+
+// Decompresses a block of exactly dstSize bytes. Never reads or writes out
+// of bounds; throws std::runtime_error for corrupt input.
+void lz4Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
@@ -0,0 +1,129 @@
+#include "mapped_file.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("MappedFile: cannot open " + path);
+    }
+    fileHandle = file;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        close();
+        throw std::runtime_error("MappedFile: cannot read the size of " + path);
+    }
+    byteSize = static_cast<size_t>(fileSize.QuadPart);
+    if (byteSize == 0) {
+        return;
+    }
+    mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle) {
+        close();
+        throw std::runtime_error("MappedFile: cannot map " + path);
+    }
+    bytes = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+    fileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("MappedFile: cannot open " + path);
+    }
+    struct stat info;
+    if (fstat(fileDescriptor, &info) != 0) {
+        close();
+        throw std::runtime_error("MappedFile: cannot read the size of " + path);
+    }
+    byteSize = static_cast<size_t>(info.st_size);
+    if (byteSize == 0) {
+        return;
+    }
+    void* mapping = mmap(nullptr, byteSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    bytes = mapping == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(mapping);
+#endif
+    if (!bytes) {
+        close();
+        throw std::runtime_error("MappedFile: cannot map " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        std::swap(bytes, other.bytes);
+        std::swap(byteSize, other.byteSize);
+#if defined(_WIN32)
+        std::swap(fileHandle, other.fileHandle);
+        std::swap(mappingHandle, other.mappingHandle);
+#else
+        std::swap(fileDescriptor, other.fileDescriptor);
+#endif
+    }
+    return *this;
+}
+
+void MappedFile::prefetch(size_t offset, size_t size) const {
+    if (!bytes || offset >= byteSize) {
+        return;
+    }
+    size = std::min(size, byteSize - offset);
+#if defined(_WIN32)
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<uint8_t*>(bytes + offset);
+    range.NumberOfBytes = size;
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    // madvise wants a page-aligned start.
+    uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t start = reinterpret_cast<uintptr_t>(bytes + offset) & ~(pageSize - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(bytes + offset + size);
+    madvise(reinterpret_cast<void*>(start), end - start, MADV_WILLNEED);
+#endif
+}
+
+void MappedFile::close() {
+#if defined(_WIN32)
+    if (bytes) {
+        UnmapViewOfFile(bytes);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+    }
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    if (bytes) {
+        munmap(const_cast<uint8_t*>(bytes), byteSize);
+    }
+    if (fileDescriptor >= 0) {
+        ::close(fileDescriptor);
+    }
+    fileDescriptor = -1;
+#endif
+    bytes = nullptr;
+    byteSize = 0;
+}
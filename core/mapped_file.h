@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file. Pages are loaded by the OS on
+// first access, so opening costs the same for any file size and data that
+// is never read is never loaded.
+class MappedFile {
+public:
+    MappedFile() = default;
+    // Throws std::runtime_error if the file cannot be opened or mapped.
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return byteSize; }
+    bool empty() const { return byteSize == 0; }
+
+    // Asks the OS to read the range ahead (asynchronously where supported).
+    void prefetch(size_t offset, size_t size) const;
+
+private:
+    void close();
+
+    const uint8_t* bytes = nullptr;
+    size_t byteSize = 0;
+#if defined(_WIN32)
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+};
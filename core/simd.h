@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Thin 4/8-wide float vectors. vfloat4 maps to SSE and vfloat8 to AVX when
+// the compiler targets them (see MAZE_ENABLE_AVX2 in CMakeLists.txt);
+// otherwise both fall back to plain arrays the optimiser can unroll.
+// Comparisons return lane masks of the same type (all bits set when true).
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MAZE_SIMD_SSE 1
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define MAZE_SIMD_AVX 1
+#endif
+
+namespace simd {
+
+template <int N>
+struct ScalarVec {
+    static constexpr int Width = N;
+    float v[N];
+
+    ScalarVec() = default;
+    explicit ScalarVec(float s) {
+        for (int i = 0; i < N; i++) v[i] = s;
+    }
+
+    static ScalarVec load(const float* p) {
+        ScalarVec r;
+        for (int i = 0; i < N; i++) r.v[i] = p[i];
+        return r;
+    }
+    void store(float* p) const {
+        for (int i = 0; i < N; i++) p[i] = v[i];
+    }
+    float operator[](int i) const { return v[i]; }
+
+    static ScalarVec fromBits(const uint32_t* bits) {
+        ScalarVec r;
+        std::memcpy(r.v, bits, sizeof(r.v));
+        return r;
+    }
+};
+
+namespace detail {
+
+inline uint32_t bitsOf(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float floatOf(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+inline float maskLane(bool b) { return floatOf(b ? ~0u : 0u); }
+
+} // namespace detail
+
+#define MAZE_SCALAR_BINARY(op, expr)                                              \
+    template <int N>                                                              \
+    inline ScalarVec<N> op(const ScalarVec<N>& a, const ScalarVec<N>& b) {        \
+        ScalarVec<N> r;                                                           \
+        for (int i = 0; i < N; i++) {                                             \
+            float x = a.v[i], y = b.v[i];                                         \
+            (void)x; (void)y;                                                     \
+            r.v[i] = (expr);                                                      \
+        }                                                                         \
+        return r;                                                                 \
+    }
+
+MAZE_SCALAR_BINARY(operator+, x + y)
+MAZE_SCALAR_BINARY(operator-, x - y)
+MAZE_SCALAR_BINARY(operator*, x * y)
+MAZE_SCALAR_BINARY(operator/, x / y)
+MAZE_SCALAR_BINARY(min, x < y ? x : y)
+MAZE_SCALAR_BINARY(max, x > y ? x : y)
+MAZE_SCALAR_BINARY(operator<, detail::maskLane(x < y))
+MAZE_SCALAR_BINARY(operator<=, detail::maskLane(x <= y))
+MAZE_SCALAR_BINARY(operator>, detail::maskLane(x > y))
+MAZE_SCALAR_BINARY(operator>=, detail::maskLane(x >= y))
+MAZE_SCALAR_BINARY(operator&, detail::floatOf(detail::bitsOf(x) & detail::bitsOf(y)))
+MAZE_SCALAR_BINARY(operator|, detail::floatOf(detail::bitsOf(x) | detail::bitsOf(y)))
+MAZE_SCALAR_BINARY(andNot, detail::floatOf(~detail::bitsOf(x) & detail::bitsOf(y)))
+
+#undef MAZE_SCALAR_BINARY
+
+template <int N>
+inline ScalarVec<N> select(const ScalarVec<N>& mask, const ScalarVec<N>& a, const ScalarVec<N>& b) {
+    ScalarVec<N> r;
+    for (int i = 0; i < N; i++) r.v[i] = detail::bitsOf(mask.v[i]) ? a.v[i] : b.v[i];
+    return r;
+}
+
+template <int N>
+inline ScalarVec<N> abs(const ScalarVec<N>& a) {
+    ScalarVec<N> r;
+    for (int i = 0; i < N; i++) r.v[i] = std::fabs(a.v[i]);
+    return r;
+}
+
+template <int N>
+inline ScalarVec<N> sqrt(const ScalarVec<N>& a) {
+    ScalarVec<N> r;
+    for (int i = 0; i < N; i++) r.v[i] = std::sqrt(a.v[i]);
+    return r;
+}
+
+template <int N>
+inline ScalarVec<N> fmadd(const ScalarVec<N>& a, const ScalarVec<N>& b, const ScalarVec<N>& c) {
+    return a * b + c;
+}
+
+template <int N>
+inline int movemask(const ScalarVec<N>& m) {
+    int bits = 0;
+    for (int i = 0; i < N; i++) bits |= (detail::bitsOf(m.v[i]) >> 31) << i;
+    return bits;
+}
+
+#if MAZE_SIMD_SSE
+
+struct vfloat4 {
+    static constexpr int Width = 4;
+    __m128 v;
+
+    vfloat4() = default;
+    vfloat4(__m128 v) : v(v) {}
+    explicit vfloat4(float s) : v(_mm_set1_ps(s)) {}
+
+    static vfloat4 load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    float operator[](int i) const {
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, v);
+        return lanes[i];
+    }
+};
+
+inline vfloat4 operator+(const vfloat4& a, const vfloat4& b) { return _mm_add_ps(a.v, b.v); }
+inline vfloat4 operator-(const vfloat4& a, const vfloat4& b) { return _mm_sub_ps(a.v, b.v); }
+inline vfloat4 operator*(const vfloat4& a, const vfloat4& b) { return _mm_mul_ps(a.v, b.v); }
+inline vfloat4 operator/(const vfloat4& a, const vfloat4& b) { return _mm_div_ps(a.v, b.v); }
+inline vfloat4 min(const vfloat4& a, const vfloat4& b) { return _mm_min_ps(a.v, b.v); }
+inline vfloat4 max(const vfloat4& a, const vfloat4& b) { return _mm_max_ps(a.v, b.v); }
+inline vfloat4 operator<(const vfloat4& a, const vfloat4& b) { return _mm_cmplt_ps(a.v, b.v); }
+inline vfloat4 operator<=(const vfloat4& a, const vfloat4& b) { return _mm_cmple_ps(a.v, b.v); }
+inline vfloat4 operator>(const vfloat4& a, const vfloat4& b) { return _mm_cmpgt_ps(a.v, b.v); }
+inline vfloat4 operator>=(const vfloat4& a, const vfloat4& b) { return _mm_cmpge_ps(a.v, b.v); }
+inline vfloat4 operator&(const vfloat4& a, const vfloat4& b) { return _mm_and_ps(a.v, b.v); }
+inline vfloat4 operator|(const vfloat4& a, const vfloat4& b) { return _mm_or_ps(a.v, b.v); }
+inline vfloat4 andNot(const vfloat4& a, const vfloat4& b) { return _mm_andnot_ps(a.v, b.v); }
+inline vfloat4 abs(const vfloat4& a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+inline vfloat4 sqrt(const vfloat4& a) { return _mm_sqrt_ps(a.v); }
+inline int movemask(const vfloat4& m) { return _mm_movemask_ps(m.v); }
+
+inline vfloat4 select(const vfloat4& mask, const vfloat4& a, const vfloat4& b) {
+    return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+}
+
+inline vfloat4 fmadd(const vfloat4& a, const vfloat4& b, const vfloat4& c) {
+#if defined(__FMA__)
+    return _mm_fmadd_ps(a.v, b.v, c.v);
+#else
+    return _mm_add_ps(_mm_mul_ps(a.v, b.v), c.v);
+#endif
+}
+
+#else
+using vfloat4 = ScalarVec<4>;
+#endif
+
+#if MAZE_SIMD_AVX
+
+struct vfloat8 {
+    static constexpr int Width = 8;
+    __m256 v;
+
+    vfloat8() = default;
+    vfloat8(__m256 v) : v(v) {}
+    explicit vfloat8(float s) : v(_mm256_set1_ps(s)) {}
+
+    static vfloat8 load(const float* p) { return _mm256_loadu_ps(p); }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+    float operator[](int i) const {
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, v);
+        return lanes[i];
+    }
+};
+
+inline vfloat8 operator+(const vfloat8& a, const vfloat8& b) { return _mm256_add_ps(a.v, b.v); }
+inline vfloat8 operator-(const vfloat8& a, const vfloat8& b) { return _mm256_sub_ps(a.v, b.v); }
+inline vfloat8 operator*(const vfloat8& a, const vfloat8& b) { return _mm256_mul_ps(a.v, b.v); }
+inline vfloat8 operator/(const vfloat8& a, const vfloat8& b) { return _mm256_div_ps(a.v, b.v); }
+inline vfloat8 min(const vfloat8& a, const vfloat8& b) { return _mm256_min_ps(a.v, b.v); }
+inline vfloat8 max(const vfloat8& a, const vfloat8& b) { return _mm256_max_ps(a.v, b.v); }
+inline vfloat8 operator<(const vfloat8& a, const vfloat8& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+inline vfloat8 operator<=(const vfloat8& a, const vfloat8& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+inline vfloat8 operator>(const vfloat8& a, const vfloat8& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+inline vfloat8 operator>=(const vfloat8& a, const vfloat8& b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ); }
+inline vfloat8 operator&(const vfloat8& a, const vfloat8& b) { return _mm256_and_ps(a.v, b.v); }
+inline vfloat8 operator|(const vfloat8& a, const vfloat8& b) { return _mm256_or_ps(a.v, b.v); }
+inline vfloat8 andNot(const vfloat8& a, const vfloat8& b) { return _mm256_andnot_ps(a.v, b.v); }
+inline vfloat8 abs(const vfloat8& a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+inline vfloat8 sqrt(const vfloat8& a) { return _mm256_sqrt_ps(a.v); }
+inline int movemask(const vfloat8& m) { return _mm256_movemask_ps(m.v); }
+
+inline vfloat8 select(const vfloat8& mask, const vfloat8& a, const vfloat8& b) {
+    return _mm256_blendv_ps(b.v, a.v, mask.v);
+}
+
+inline vfloat8 fmadd(const vfloat8& a, const vfloat8& b, const vfloat8& c) {
+#if defined(__FMA__)
+    return _mm256_fmadd_ps(a.v, b.v, c.v);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a.v, b.v), c.v);
+#endif
+}
+
+#else
+using vfloat8 = ScalarVec<8>;
+#endif
+
+// Returns the index of the lowest set bit of a movemask result and clears it.
+inline int popLowestLane(int& mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, static_cast<unsigned long>(mask));
+#else
+    int index = __builtin_ctz(static_cast<unsigned>(mask));
+#endif
+    mask &= mask - 1;
+    return static_cast<int>(index);
+}
+
+template <int N> struct FloatVector;
+template <> struct FloatVector<4> { using Type = vfloat4; };
+template <> struct FloatVector<8> { using Type = vfloat8; };
+
+template <typename V>
+inline V operator-(const V& a) {
+    return V(0.0f) - a;
+}
+
+template <typename V>
+inline bool any(const V& mask) {
+    return movemask(mask) != 0;
+}
+
+template <typename V>
+inline bool all(const V& mask) {
+    return movemask(mask) == (1 << V::Width) - 1;
+}
+
+} // namespace simd
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. The ring has a power-of-two number of slots; head and tail sit on
+// their own cache lines and each side caches the other's index so the common
+// case touches no shared line at all.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity);
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side. Returns false instead of blocking when the queue is full.
+    bool push(const T& value);
+    // Consumer side. Returns false when the queue is empty.
+    bool pop(T& value);
+
+    size_t getCapacity() const { return slots.size(); }
+
+private:
+    static constexpr size_t CacheLine = 64;
+
+    std::vector<T> slots;
+    size_t mask = 0;
+    alignas(CacheLine) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+    alignas(CacheLine) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+};
+
+template <typename T>
+SpscQueue<T>::SpscQueue(size_t capacity) {
+    if (capacity == 0) {
+        throw std::runtime_error("SpscQueue: capacity must be positive");
+    }
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    slots.resize(size);
+    mask = size - 1;
+}
+
+template <typename T>
+bool SpscQueue<T>::push(const T& value) {
+    size_t index = tail.load(std::memory_order_relaxed);
+    if (index - cachedHead == slots.size()) {
+        cachedHead = head.load(std::memory_order_acquire);
+        if (index - cachedHead == slots.size()) {
+            return false;
+        }
+    }
+    slots[index & mask] = value;
+    tail.store(index + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool SpscQueue<T>::pop(T& value) {
+    size_t index = head.load(std::memory_order_relaxed);
+    if (index == cachedTail) {
+        cachedTail = tail.load(std::memory_order_acquire);
+        if (index == cachedTail) {
+            return false;
+        }
+    }
+    value = slots[index & mask];
+    head.store(index + 1, std::memory_order_release);
+    return true;
+}
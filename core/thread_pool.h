@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size worker pool shared by the CPU-side systems (BVH builds, physics,
+// maze generation...). The calling thread counts as one of the threads: it
+// executes queued tasks while it waits in TaskGroup::wait, so nested
+// parallelism never deadlocks and a pool of size 1 simply runs inline.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    void enqueue(std::function<void()> task);
+    bool runPendingTask();
+
+    // Calls fn(begin, end) over [0, count) in chunks of at most grainSize.
+    template <typename Fn>
+    void parallelFor(size_t count, size_t grainSize, Fn&& fn);
+
+    static ThreadPool& global();
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+};
+
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename Fn>
+    void run(Fn&& fn);
+
+    // Blocks until every task has finished, helping with queued work
+    // meanwhile. Rethrows the first exception raised by a task.
+    void wait();
+
+private:
+    ThreadPool& pool;
+    std::atomic<uint32_t> pending{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+};
+
+template <typename Fn>
+void TaskGroup::run(Fn&& fn) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+    pool.enqueue([this, task = std::forward<Fn>(fn)]() mutable {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+        pending.fetch_sub(1, std::memory_order_release);
+    });
+}
+
+template <typename Fn>
+void ThreadPool::parallelFor(size_t count, size_t grainSize, Fn&& fn) {
+    if (count == 0) {
+        return;
+    }
+    if (grainSize == 0) {
+        grainSize = 1;
+    }
+    if (count <= grainSize || workers.empty()) {
+        fn(size_t(0), count);
+        return;
+    }
+
+    TaskGroup group(*this);
+    for (size_t begin = grainSize; begin < count; begin += grainSize) {
+        size_t end = begin + grainSize < count ? begin + grainSize : count;
+        group.run([&fn, begin, end]() { fn(begin, end); });
+    }
+    fn(size_t(0), grainSize);
+    group.wait();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free handoff of the latest value from one writer thread to one reader
+// thread. The writer fills its private buffer and publishes it by swapping it
+// with the shared middle slot; the reader swaps its buffer with the middle
+// slot only when something new was published. Neither side ever waits, and
+// the reader always sees a complete value, skipping any it was too slow for.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer side: the buffer to fill, then hand it over.
+    T& writeBuffer() { return buffers[writeIndex]; }
+    void publish();
+
+    // Reader side: picks up the newest published value, if any; returns
+    // whether readBuffer() changed.
+    bool update();
+    const T& readBuffer() const { return buffers[readIndex]; }
+
+private:
+    static constexpr uint8_t IndexMask = 3;
+    static constexpr uint8_t FreshBit = 4;
+
+    T buffers[3];
+    uint8_t writeIndex = 0;
+    alignas(64) std::atomic<uint8_t> middle{1};
+    alignas(64) uint8_t readIndex = 2;
+};
+
+template <typename T>
+void TripleBuffer<T>::publish() {
+    uint8_t previous = middle.exchange(static_cast<uint8_t>(writeIndex | FreshBit), std::memory_order_acq_rel);
+    writeIndex = previous & IndexMask;
+}
+
+template <typename T>
+bool TripleBuffer<T>::update() {
+    if (!(middle.load(std::memory_order_relaxed) & FreshBit)) {
+        return false;
+    }
+    uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+    readIndex = previous & IndexMask;
+    return true;
+}
@@ -0,0 +1,608 @@
+#include "level_file.h"
+#include "core/lz4.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+uint64_t sectionCount(const LevelSectionEntry* entry) {
+    return entry ? entry->count : 0;
+}
+
+// Decoded on open even when deferred.
+constexpr uint32_t ResidentSections =
+    levelSectionBit(LevelSection::MazeInfo) | levelSectionBit(LevelSection::MazeEastWalls) |
+    levelSectionBit(LevelSection::MazeSouthWalls) | levelSectionBit(LevelSection::MeshChunks) |
+    levelSectionBit(LevelSection::BroadphaseInfo) | levelSectionBit(LevelSection::BroadphaseCellStart);
+
+// Element size each section type must be stored with.
+uint32_t expectedElementSize(LevelSection type) {
+    switch (type) {
+    case LevelSection::MazeInfo: return sizeof(LevelMazeInfo);
+    case LevelSection::MazeEastWalls:
+    case LevelSection::MazeSouthWalls: return sizeof(uint64_t);
+    case LevelSection::MeshChunks: return sizeof(LevelChunk);
+    case LevelSection::MeshVertices: return sizeof(Vertex);
+    case LevelSection::MeshIndices:
+    case LevelSection::BroadphaseCellStart:
+    case LevelSection::BroadphaseCellTriangles:
+    case LevelSection::BvhPrimitiveIds: return sizeof(uint32_t);
+    case LevelSection::CollisionTriangles:
+    case LevelSection::BvhTriangles: return sizeof(Triangle);
+    case LevelSection::BroadphaseInfo: return sizeof(LevelBroadphaseInfo);
+    case LevelSection::BvhNodes: return sizeof(BvhNode);
+    case LevelSection::BouncePads: return sizeof(LevelBouncePad);
+    case LevelSection::WindZones: return sizeof(LevelWindZone);
+    case LevelSection::Mirrors: return sizeof(LevelMirror);
+    default: return 0;
+    }
+}
+
+struct PendingSection {
+    LevelSection type;
+    const void* data;
+    uint32_t elementSize;
+    uint64_t count;
+    // Block header, table and blocks when compressed.
+    std::vector<uint8_t> stored;
+};
+
+template <typename T>
+void addSection(std::vector<PendingSection>& sections, LevelSection type, const T* data, size_t count) {
+    if (count > 0) {
+        sections.push_back({type, data, static_cast<uint32_t>(sizeof(T)), static_cast<uint64_t>(count), {}});
+    }
+}
+
+// Compresses the blocks on the pool. Leaves `stored` empty when
+// compression would not save space.
+void compressSection(PendingSection& section, const LevelWriteSettings& settings, ThreadPool& pool) {
+    const uint8_t* raw = static_cast<const uint8_t*>(section.data);
+    uint64_t rawBytes = section.count * section.elementSize;
+    uint64_t blockSize = settings.blockSize;
+    size_t blockCount = static_cast<size_t>((rawBytes + blockSize - 1) / blockSize);
+    std::vector<std::vector<uint8_t>> blocks(blockCount);
+    pool.parallelFor(blockCount, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            uint64_t first = i * blockSize;
+            size_t size = static_cast<size_t>(std::min(blockSize, rawBytes - first));
+            blocks[i].resize(lz4CompressBound(size));
+            size_t compressed = lz4Compress(raw + first, size, blocks[i].data(), settings.compressionLevel);
+            if (compressed < size) {
+                blocks[i].resize(compressed);
+            } else {
+                blocks[i].assign(raw + first, raw + first + size);
+            }
+        }
+    });
+
+    LevelBlockHeader header{};
+    header.blockSize = settings.blockSize;
+    header.blockCount = static_cast<uint32_t>(blockCount);
+    std::vector<uint64_t> blockEnds(blockCount);
+    uint64_t dataBytes = 0;
+    for (size_t i = 0; i < blockCount; i++) {
+        dataBytes += blocks[i].size();
+        blockEnds[i] = dataBytes;
+    }
+    header.storedSize = sizeof(LevelBlockHeader) + blockCount * sizeof(uint64_t) + dataBytes;
+    if (header.storedSize >= rawBytes) {
+        return;
+    }
+    section.stored.resize(header.storedSize);
+    uint8_t* out = section.stored.data();
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    std::memcpy(out, blockEnds.data(), blockCount * sizeof(uint64_t));
+    out += blockCount * sizeof(uint64_t);
+    for (const auto& block : blocks) {
+        std::memcpy(out, block.data(), block.size());
+        out += block.size();
+    }
+}
+
+uint64_t alignUp(uint64_t value) {
+    return (value + LevelSectionAlignment - 1) & ~(LevelSectionAlignment - 1);
+}
+
+} // namespace
+
+LevelContent buildLevelContent(const MazeGrid& maze, const MazeMeshSettings& settings, float ballRadius,
+                               ThreadPool& pool) {
+    LevelContent content;
+    content.maze = maze;
+    content.meshSettings = settings;
+    content.chunks = buildMazeMeshes(maze, settings, pool);
+    size_t indexCount = 0;
+    for (const auto& chunk : content.chunks) {
+        indexCount += chunk.indices.size();
+    }
+    content.collision.reserve(indexCount / 3);
+    for (const auto& chunk : content.chunks) {
+        content.collision.append(chunk.vertices, chunk.indices);
+    }
+    const std::vector<Triangle>& triangles = content.collision.getTriangles();
+    content.broadphase.build(triangles, UniformGrid::suggestCellSize(triangles, ballRadius));
+    content.bvh.build(content.collision, pool);
+    return content;
+}
+
+void writeLevelFile(const std::string& path, const LevelContent& content, const LevelWriteSettings& settings) {
+    writeLevelFile(path, content, settings, ThreadPool::global());
+}
+
+void writeLevelFile(const std::string& path, const LevelContent& content, const LevelWriteSettings& settings,
+                    ThreadPool& pool) {
+    const MazeGrid& maze = content.maze;
+    const MazeMeshSettings& mesh = content.meshSettings;
+    if (maze.getCellCount() == 0) {
+        throw std::runtime_error("LevelFile: level has no maze");
+    }
+    LevelMazeInfo mazeInfo{};
+    mazeInfo.width = maze.getWidth();
+    mazeInfo.height = maze.getHeight();
+    mazeInfo.rowWords = maze.getRowWords();
+    mazeInfo.chunkSize = mesh.chunkSize;
+    mazeInfo.cellSize = mesh.cellSize;
+    mazeInfo.wallHeight = mesh.wallHeight;
+    mazeInfo.wallThickness = mesh.wallThickness;
+    mazeInfo.floor = mesh.floor ? 1u : 0u;
+    mazeInfo.origin = mesh.origin;
+
+    // Chunk meshes are concatenated; indices stay relative to their chunk.
+    std::vector<LevelChunk> chunks(content.chunks.size());
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    for (size_t i = 0; i < content.chunks.size(); i++) {
+        const MazeMeshChunk& source = content.chunks[i];
+        LevelChunk& chunk = chunks[i];
+        chunk.chunkX = source.chunkX;
+        chunk.chunkZ = source.chunkZ;
+        chunk.firstVertex = static_cast<uint32_t>(vertices.size());
+        chunk.vertexCount = static_cast<uint32_t>(source.vertices.size());
+        chunk.firstIndex = static_cast<uint32_t>(indices.size());
+        chunk.indexCount = static_cast<uint32_t>(source.indices.size());
+        chunk.boundsMin = source.bounds.min;
+        chunk.boundsMax = source.bounds.max;
+        vertices.insert(vertices.end(), source.vertices.begin(), source.vertices.end());
+        indices.insert(indices.end(), source.indices.begin(), source.indices.end());
+    }
+
+    LevelBroadphaseInfo broadphaseInfo{};
+    const UniformGrid& grid = content.broadphase;
+    broadphaseInfo.origin = grid.getOrigin();
+    broadphaseInfo.cellSize = grid.getCellSize();
+    broadphaseInfo.cellsX = grid.getCellsX();
+    broadphaseInfo.cellsZ = grid.getCellsZ();
+
+    std::vector<LevelBouncePad> pads(content.bouncePads.size());
+    for (size_t i = 0; i < pads.size(); i++) {
+        const TriggerDesc& desc = content.bouncePads[i];
+        pads[i] = LevelBouncePad{static_cast<uint32_t>(desc.shape), desc.a, desc.b, desc.radius, desc.bounceImpulse,
+                                 desc.tag};
+    }
+    std::vector<LevelWindZone> zones(content.windZones.size());
+    for (size_t i = 0; i < zones.size(); i++) {
+        const WindZone& zone = content.windZones[i];
+        zones[i] = LevelWindZone{static_cast<uint32_t>(zone.shape), zone.a, zone.b, zone.radius, zone.direction,
+                                 zone.strength, zone.turbulence, zone.turbulenceScale, zone.gustSpeed, 0u};
+    }
+
+    std::vector<PendingSection> sections;
+    addSection(sections, LevelSection::MazeInfo, &mazeInfo, 1);
+    addSection(sections, LevelSection::MazeEastWalls, maze.eastRow(0), maze.getWordCount());
+    addSection(sections, LevelSection::MazeSouthWalls, maze.southRow(0), maze.getWordCount());
+    addSection(sections, LevelSection::MeshChunks, chunks.data(), chunks.size());
+    addSection(sections, LevelSection::MeshVertices, vertices.data(), vertices.size());
+    addSection(sections, LevelSection::MeshIndices, indices.data(), indices.size());
+    const std::vector<Triangle>& triangles = content.collision.getTriangles();
+    addSection(sections, LevelSection::CollisionTriangles, triangles.data(), triangles.size());
+    if (!grid.empty()) {
+        addSection(sections, LevelSection::BroadphaseInfo, &broadphaseInfo, 1);
+        addSection(sections, LevelSection::BroadphaseCellStart, grid.getCellStart().data(),
+                   grid.getCellStart().size());
+        addSection(sections, LevelSection::BroadphaseCellTriangles, grid.getCellTriangles().data(),
+                   grid.getCellTriangles().size());
+    }
+    const Bvh& bvh = content.bvh;
+    addSection(sections, LevelSection::BvhNodes, bvh.getNodes().data(), bvh.getNodes().size());
+    addSection(sections, LevelSection::BvhTriangles, bvh.getTriangles().data(), bvh.getTriangles().size());
+    addSection(sections, LevelSection::BvhPrimitiveIds, bvh.getPrimitiveIds().data(), bvh.getPrimitiveIds().size());
+    addSection(sections, LevelSection::BouncePads, pads.data(), pads.size());
+    addSection(sections, LevelSection::WindZones, zones.data(), zones.size());
+    addSection(sections, LevelSection::Mirrors, content.mirrors.data(), content.mirrors.size());
+    if (settings.compression != LevelCompression::None) {
+        if (settings.blockSize == 0) {
+            throw std::runtime_error("LevelFile: block size must be positive");
+        }
+        for (auto& section : sections) {
+            if (section.count * section.elementSize >= settings.minCompressedSize) {
+                compressSection(section, settings, pool);
+            }
+        }
+    }
+
+    std::vector<LevelSectionEntry> table(sections.size());
+    uint64_t offset = sizeof(LevelHeader) + table.size() * sizeof(LevelSectionEntry);
+    for (size_t i = 0; i < sections.size(); i++) {
+        offset = alignUp(offset);
+        bool compressed = !sections[i].stored.empty();
+        LevelCompression compression = compressed ? settings.compression : LevelCompression::None;
+        table[i] = LevelSectionEntry{static_cast<uint32_t>(sections[i].type), static_cast<uint32_t>(compression),
+                                     sections[i].elementSize, 0u, offset, sections[i].count};
+        offset += compressed ? sections[i].stored.size() : sections[i].count * sections[i].elementSize;
+    }
+    LevelHeader header{};
+    std::memcpy(header.magic, LevelMagic, sizeof(LevelMagic));
+    header.version = LevelVersion;
+    header.sectionCount = static_cast<uint32_t>(table.size());
+    header.fileSize = offset;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("LevelFile: cannot create " + path);
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(LevelSectionEntry));
+    uint64_t written = sizeof(LevelHeader) + table.size() * sizeof(LevelSectionEntry);
+    const char padding[LevelSectionAlignment] = {};
+    for (size_t i = 0; i < sections.size(); i++) {
+        out.write(padding, static_cast<std::streamsize>(table[i].offset - written));
+        bool compressed = !sections[i].stored.empty();
+        const void* data = compressed ? sections[i].stored.data() : sections[i].data;
+        uint64_t bytes = compressed ? sections[i].stored.size() : sections[i].count * sections[i].elementSize;
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        written = table[i].offset + bytes;
+    }
+    if (!out) {
+        throw std::runtime_error("LevelFile: cannot write " + path);
+    }
+}
+
+LevelFile::LevelFile(const std::string& path) : LevelFile(path, ThreadPool::global()) {}
+
+LevelFile::LevelFile(const std::string& path, ThreadPool& pool, uint32_t deferredSections) : file(path) {
+    validate(path, pool, deferredSections & ~ResidentSections);
+}
+
+void LevelFile::validate(const std::string& path, ThreadPool& pool, uint32_t deferredSections) {
+    auto fail = [&](const char* reason) {
+        throw std::runtime_error("LevelFile: " + path + ": " + reason);
+    };
+    if (file.size() < sizeof(LevelHeader)) {
+        fail("not a level file");
+    }
+    const LevelHeader& header = *reinterpret_cast<const LevelHeader*>(file.data());
+    if (std::memcmp(header.magic, LevelMagic, sizeof(LevelMagic)) != 0) {
+        fail("not a level file");
+    }
+    if (header.version != LevelVersion) {
+        fail("unsupported version");
+    }
+    if (header.fileSize != file.size()) {
+        fail("truncated");
+    }
+    uint64_t tableEnd = sizeof(LevelHeader) + static_cast<uint64_t>(header.sectionCount) * sizeof(LevelSectionEntry);
+    if (tableEnd > file.size()) {
+        fail("truncated section table");
+    }
+
+    const LevelSectionEntry* table = reinterpret_cast<const LevelSectionEntry*>(file.data() + sizeof(LevelHeader));
+    for (uint32_t i = 0; i < header.sectionCount; i++) {
+        const LevelSectionEntry& entry = table[i];
+        // Sections from newer writers are skipped.
+        if (entry.type >= static_cast<uint32_t>(LevelSection::Count)) {
+            continue;
+        }
+        LevelSection type = static_cast<LevelSection>(entry.type);
+        if (entry.elementSize != expectedElementSize(type) ||
+            entry.flags > static_cast<uint32_t>(LevelCompression::Lz4)) {
+            fail("unsupported section encoding");
+        }
+        if (entry.offset % LevelSectionAlignment != 0 || entry.offset < tableEnd || entry.offset > file.size()) {
+            fail("section out of bounds");
+        }
+        uint64_t available = file.size() - entry.offset;
+        if (entry.flags == static_cast<uint32_t>(LevelCompression::None)) {
+            if (entry.count > available / entry.elementSize) {
+                fail("section out of bounds");
+            }
+        } else if (!validBlocks(entry, available)) {
+            fail("malformed compressed section");
+        }
+        if (sections[entry.type]) {
+            fail("duplicate section");
+        }
+        sections[entry.type] = &entry;
+        sectionData[entry.type] = entry.flags == 0 ? file.data() + entry.offset : nullptr;
+    }
+    decompressSections(pool, deferredSections);
+
+    auto count = [&](LevelSection type) -> uint64_t {
+        const LevelSectionEntry* entry = findSection(type);
+        return entry ? entry->count : 0;
+    };
+    if (count(LevelSection::MazeInfo) != 1 || !sectionData[static_cast<size_t>(LevelSection::MazeInfo)]) {
+        fail("missing maze");
+    }
+    mazeInfo = array<LevelMazeInfo>(LevelSection::MazeInfo).data;
+    // In 64 bits, so widths near 2^32 cannot wrap to a few row words; the
+    // wall sections must then hold exactly width * height bits each.
+    uint64_t rowWords = (static_cast<uint64_t>(mazeInfo->width) + 63) / 64;
+    uint64_t words = rowWords * mazeInfo->height;
+    if (mazeInfo->width == 0 || mazeInfo->height == 0 || mazeInfo->rowWords != rowWords ||
+        count(LevelSection::MazeEastWalls) != words || count(LevelSection::MazeSouthWalls) != words) {
+        fail("maze walls do not match its size");
+    }
+
+    uint64_t vertexCount = count(LevelSection::MeshVertices);
+    uint64_t indexCount = count(LevelSection::MeshIndices);
+    for (const LevelChunk& chunk : getChunks()) {
+        if (static_cast<uint64_t>(chunk.firstVertex) + chunk.vertexCount > vertexCount ||
+            static_cast<uint64_t>(chunk.firstIndex) + chunk.indexCount > indexCount) {
+            fail("chunk mesh out of bounds");
+        }
+    }
+
+    uint64_t triangleCount = count(LevelSection::CollisionTriangles);
+    if (findSection(LevelSection::BroadphaseInfo)) {
+        broadphaseInfo = array<LevelBroadphaseInfo>(LevelSection::BroadphaseInfo).data;
+        if (count(LevelSection::BroadphaseInfo) != 1 || !broadphaseInfo) {
+            fail("malformed broadphase");
+        }
+        uint64_t cells = static_cast<uint64_t>(broadphaseInfo->cellsX) * broadphaseInfo->cellsZ;
+        LevelArray<uint32_t> cellStart = array<uint32_t>(LevelSection::BroadphaseCellStart);
+        if (!(broadphaseInfo->cellSize > 0.0f) || count(LevelSection::BroadphaseCellStart) != cells + 1 ||
+            (!cellStart.empty() && cellStart[cells] != count(LevelSection::BroadphaseCellTriangles))) {
+            fail("malformed broadphase");
+        }
+    }
+    uint64_t bvhTriangles = count(LevelSection::BvhTriangles);
+    if ((count(LevelSection::BvhNodes) == 0) != (bvhTriangles == 0) ||
+        count(LevelSection::BvhPrimitiveIds) != bvhTriangles || (bvhTriangles && bvhTriangles != triangleCount)) {
+        fail("malformed BVH");
+    }
+    // Cell, index and node contents are checked where they are used
+    // (loadBroadphase, loadBvh and the asset manager's mesh copies):
+    // checking them here would read the whole file on open.
+}
+
+bool LevelFile::validBlocks(const LevelSectionEntry& entry, uint64_t available) const {
+    if (available < sizeof(LevelBlockHeader)) {
+        return false;
+    }
+    const uint8_t* base = file.data() + entry.offset;
+    const LevelBlockHeader& header = *reinterpret_cast<const LevelBlockHeader*>(base);
+    if (header.blockSize == 0 || header.storedSize > available || entry.count > UINT64_MAX / entry.elementSize) {
+        return false;
+    }
+    uint64_t rawBytes = entry.count * entry.elementSize;
+    uint64_t tableBytes = sizeof(LevelBlockHeader) + static_cast<uint64_t>(header.blockCount) * sizeof(uint64_t);
+    if (header.blockCount != (rawBytes + header.blockSize - 1) / header.blockSize || tableBytes > header.storedSize) {
+        return false;
+    }
+    const uint64_t* blockEnds = reinterpret_cast<const uint64_t*>(base + sizeof(LevelBlockHeader));
+    uint64_t previous = 0;
+    for (uint32_t i = 0; i < header.blockCount; i++) {
+        uint64_t rawSize = std::min<uint64_t>(header.blockSize, rawBytes - static_cast<uint64_t>(i) * header.blockSize);
+        if (blockEnds[i] < previous || blockEnds[i] - previous > rawSize) {
+            return false;
+        }
+        previous = blockEnds[i];
+    }
+    return tableBytes + previous == header.storedSize;
+}
+
+void LevelFile::decompressSections(ThreadPool& pool, uint32_t deferredSections) {
+    struct Block {
+        LevelSection type;
+        uint32_t index;
+    };
+    std::vector<Block> blocks;
+    for (size_t type = 0; type < static_cast<size_t>(LevelSection::Count); type++) {
+        const LevelSectionEntry* entry = sections[type];
+        if (!entry || entry->flags == 0 || (deferredSections >> type) & 1u) {
+            continue;
+        }
+        decoded[type].resize(static_cast<size_t>((entry->count * entry->elementSize + 7) / 8));
+        sectionData[type] = reinterpret_cast<const uint8_t*>(decoded[type].data());
+        uint32_t blockCount = reinterpret_cast<const LevelBlockHeader*>(file.data() + entry->offset)->blockCount;
+        for (uint32_t i = 0; i < blockCount; i++) {
+            blocks.push_back({static_cast<LevelSection>(type), i});
+        }
+    }
+    // Blocks of all sections at once, so small sections do not serialise.
+    pool.parallelFor(blocks.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            size_t type = static_cast<size_t>(blocks[i].type);
+            decompressBlock(*sections[type], blocks[i].index, reinterpret_cast<uint8_t*>(decoded[type].data()));
+        }
+    });
+}
+
+void LevelFile::decompressBlock(const LevelSectionEntry& entry, uint32_t index, uint8_t* destination) const {
+    const uint8_t* base = file.data() + entry.offset;
+    const LevelBlockHeader& header = *reinterpret_cast<const LevelBlockHeader*>(base);
+    const uint64_t* blockEnds = reinterpret_cast<const uint64_t*>(base + sizeof(LevelBlockHeader));
+    const uint8_t* blocks = reinterpret_cast<const uint8_t*>(blockEnds + header.blockCount);
+    uint64_t rawBytes = entry.count * entry.elementSize;
+    uint64_t first = static_cast<uint64_t>(index) * header.blockSize;
+    size_t rawSize = static_cast<size_t>(std::min<uint64_t>(header.blockSize, rawBytes - first));
+    uint64_t begin = index == 0 ? 0 : blockEnds[index - 1];
+    size_t storedSize = static_cast<size_t>(blockEnds[index] - begin);
+    if (storedSize == rawSize) {
+        std::memcpy(destination + first, blocks + begin, rawSize);
+    } else {
+        lz4Decompress(blocks + begin, storedSize, destination + first, rawSize);
+    }
+}
+
+const LevelSectionEntry* LevelFile::findSection(LevelSection type) const {
+    return type < LevelSection::Count ? sections[static_cast<size_t>(type)] : nullptr;
+}
+
+uint64_t LevelFile::getStoredBytes(LevelSection type) const {
+    const LevelSectionEntry* entry = findSection(type);
+    if (!entry) {
+        return 0;
+    }
+    if (entry->flags == 0) {
+        return entry->count * entry->elementSize;
+    }
+    return reinterpret_cast<const LevelBlockHeader*>(file.data() + entry->offset)->storedSize;
+}
+
+void LevelFile::readSection(LevelSection type, void* destination, ThreadPool& pool) const {
+    const LevelSectionEntry* entry = findSection(type);
+    if (!entry) {
+        return;
+    }
+    uint8_t* out = static_cast<uint8_t*>(destination);
+    uint64_t rawBytes = entry->count * entry->elementSize;
+    const uint8_t* data = sectionData[static_cast<size_t>(type)];
+    if (data) {
+        std::memcpy(out, data, static_cast<size_t>(rawBytes));
+        return;
+    }
+    uint32_t blockCount = reinterpret_cast<const LevelBlockHeader*>(file.data() + entry->offset)->blockCount;
+    pool.parallelFor(blockCount, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            decompressBlock(*entry, static_cast<uint32_t>(i), out);
+        }
+    });
+}
+
+MazeGrid LevelFile::getMaze() const {
+    return MazeGrid::view(mazeInfo->width, mazeInfo->height, array<uint64_t>(LevelSection::MazeEastWalls).data,
+                          array<uint64_t>(LevelSection::MazeSouthWalls).data);
+}
+
+MazeMeshSettings LevelFile::getMeshSettings() const {
+    MazeMeshSettings settings;
+    settings.cellSize = mazeInfo->cellSize;
+    settings.wallHeight = mazeInfo->wallHeight;
+    settings.wallThickness = mazeInfo->wallThickness;
+    settings.chunkSize = mazeInfo->chunkSize;
+    settings.floor = mazeInfo->floor != 0;
+    settings.origin = mazeInfo->origin;
+    return settings;
+}
+
+bool LevelFile::loadBroadphase(UniformGrid& grid) const {
+    return loadBroadphase(grid, ThreadPool::global());
+}
+
+bool LevelFile::loadBroadphase(UniformGrid& grid, ThreadPool& pool) const {
+    if (!broadphaseInfo) {
+        return false;
+    }
+    // Cells index the collision triangles unchecked during queries.
+    LevelArray<uint32_t> cellStart = array<uint32_t>(LevelSection::BroadphaseCellStart);
+    std::vector<uint32_t> decodedTriangles;
+    LevelArray<uint32_t> cellTriangles =
+        decodedArray(LevelSection::BroadphaseCellTriangles, decodedTriangles, pool);
+    uint64_t triangleCount = sectionCount(findSection(LevelSection::CollisionTriangles));
+    for (size_t c = 0; c + 1 < cellStart.size(); c++) {
+        if (cellStart[c] > cellStart[c + 1]) {
+            throw std::runtime_error("LevelFile: malformed broadphase");
+        }
+    }
+    for (uint32_t triangle : cellTriangles) {
+        if (triangle >= triangleCount) {
+            throw std::runtime_error("LevelFile: broadphase triangle out of bounds");
+        }
+    }
+    grid.assign(broadphaseInfo->origin, broadphaseInfo->cellSize, broadphaseInfo->cellsX, broadphaseInfo->cellsZ,
+                cellStart.data, cellTriangles.data);
+    return true;
+}
+
+bool LevelFile::loadBvh(Bvh& bvh) const {
+    return loadBvh(bvh, ThreadPool::global());
+}
+
+bool LevelFile::loadBvh(Bvh& bvh, ThreadPool& pool) const {
+    if (sectionCount(findSection(LevelSection::BvhNodes)) == 0) {
+        return false;
+    }
+    std::vector<BvhNode> decodedNodes;
+    std::vector<Triangle> decodedTriangles;
+    std::vector<uint32_t> decodedIds;
+    LevelArray<BvhNode> nodes = decodedArray(LevelSection::BvhNodes, decodedNodes, pool);
+    LevelArray<Triangle> triangles = decodedArray(LevelSection::BvhTriangles, decodedTriangles, pool);
+    LevelArray<uint32_t> primitiveIds = decodedArray(LevelSection::BvhPrimitiveIds, decodedIds, pool);
+    uint64_t triangleCount = sectionCount(findSection(LevelSection::CollisionTriangles));
+    for (uint32_t id : primitiveIds) {
+        if (id >= triangleCount) {
+            throw std::runtime_error("LevelFile: BVH triangle out of bounds");
+        }
+    }
+    // Traversal follows child indices and leaf ranges unchecked and with a
+    // fixed stack, so the nodes must form exactly the depth-first layout Bvh
+    // builds: left child next, right child after the left subtree, depth
+    // below BvhMaxDepth.
+    struct Entry {
+        uint64_t node;
+        uint32_t depth;
+    };
+    std::vector<Entry> stack = {{0, 0}};
+    uint64_t next = 0;
+    while (!stack.empty()) {
+        Entry entry = stack.back();
+        stack.pop_back();
+        if (entry.node != next || entry.node >= nodes.size() || entry.depth >= BvhMaxDepth) {
+            throw std::runtime_error("LevelFile: malformed BVH");
+        }
+        next++;
+        const BvhNode& node = nodes[entry.node];
+        if (node.isLeaf()) {
+            if (node.leftFirst > triangles.size() || node.count > triangles.size() - node.leftFirst) {
+                throw std::runtime_error("LevelFile: BVH leaf out of bounds");
+            }
+            continue;
+        }
+        stack.push_back({node.leftFirst, entry.depth + 1});
+        stack.push_back({entry.node + 1, entry.depth + 1});
+    }
+    if (next != nodes.size()) {
+        throw std::runtime_error("LevelFile: malformed BVH");
+    }
+    bvh.assign(nodes.data, nodes.size(), triangles.data, primitiveIds.data, triangles.size());
+    return true;
+}
+
+std::vector<WindZone> LevelFile::loadWindZones() const {
+    std::vector<LevelWindZone> decoded;
+    LevelArray<LevelWindZone> stored = decodedArray(LevelSection::WindZones, decoded, ThreadPool::global());
+    std::vector<WindZone> zones(stored.size());
+    std::transform(stored.begin(), stored.end(), zones.begin(), toWindZone);
+    return zones;
+}
+
+TriggerDesc LevelFile::toTrigger(const LevelBouncePad& pad) {
+    TriggerDesc desc;
+    desc.shape = static_cast<TriggerShape>(pad.shape);
+    desc.a = pad.a;
+    desc.b = pad.b;
+    desc.radius = pad.radius;
+    desc.bounceImpulse = pad.impulse;
+    desc.tag = pad.tag;
+    return desc;
+}
+
+WindZone LevelFile::toWindZone(const LevelWindZone& stored) {
+    WindZone zone;
+    zone.shape = static_cast<WindShape>(stored.shape);
+    zone.a = stored.a;
+    zone.b = stored.b;
+    zone.radius = stored.radius;
+    zone.direction = stored.direction;
+    zone.strength = stored.strength;
+    zone.turbulence = stored.turbulence;
+    zone.turbulenceScale = stored.turbulenceScale;
+    zone.gustSpeed = stored.gustSpeed;
+    return zone;
+}
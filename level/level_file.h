@@ -0,0 +1,152 @@
+#pragma once
+
+#include "core/mapped_file.h"
+#include "level_format.h"
+#include "bvh/bvh.h"
+#include "bvh/triangle_mesh.h"
+#include "maze/maze_grid.h"
+#include "maze/maze_mesher.h"
+#include "physics/trigger_set.h"
+#include "physics/uniform_grid.h"
+#include "physics/wind_field.h"
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Everything a level file holds, built in memory.
+struct LevelContent {
+    MazeGrid maze;
+    MazeMeshSettings meshSettings;
+    std::vector<MazeMeshChunk> chunks;
+    // Every chunk's triangles, in chunk order.
+    TriangleMesh collision;
+    UniformGrid broadphase;
+    Bvh bvh;
+    std::vector<TriggerDesc> bouncePads;
+    std::vector<WindZone> windZones;
+    std::vector<LevelMirror> mirrors;
+};
+
+// Meshes the maze and builds the collision structures; the broadphase cell
+// size is picked for balls of the given radius. Entities are left empty.
+LevelContent buildLevelContent(const MazeGrid& maze, const MazeMeshSettings& settings, float ballRadius,
+                               ThreadPool& pool);
+
+struct LevelWriteSettings {
+    LevelCompression compression = LevelCompression::None;
+    // lz4Compress level: 0 for fast loads during development, 8 or more
+    // for files that are distributed.
+    int compressionLevel = 0;
+    // Bytes of each independently compressed block, the unit of parallel
+    // decompression.
+    uint32_t blockSize = 256 * 1024;
+    // Smaller sections are stored as they are.
+    uint64_t minCompressedSize = 4096;
+};
+
+// Compression runs on the pool. Throws std::runtime_error if the file
+// cannot be written.
+void writeLevelFile(const std::string& path, const LevelContent& content,
+                    const LevelWriteSettings& settings = LevelWriteSettings());
+void writeLevelFile(const std::string& path, const LevelContent& content, const LevelWriteSettings& settings,
+                    ThreadPool& pool);
+
+// A level file mapped into memory. Opening checks the header, the section
+// table and the sizes that tie sections together, but reads no
+// uncompressed section data, so it costs the same for any level size;
+// pages are faulted in as the arrays are first used. The maze, meshes and
+// entity tables can be used in place. Restoring physics and the BVH is
+// not zero-copy: the broadphase grid and BVH are copied into their
+// containers and PhysicsWorld copies the collision triangles, which is a
+// memcpy and not a rebuild. Compressed
+// sections are decompressed on open, all blocks of all sections in
+// parallel. Arrays returned point into the mapping or the decompressed
+// copies and live as long as the LevelFile.
+class LevelFile {
+public:
+    // Throws std::runtime_error for missing, truncated or malformed files.
+    explicit LevelFile(const std::string& path);
+    // Compressed sections whose levelSectionBit is set in deferredSections
+    // are left compressed: their arrays are empty and readSection decodes
+    // them, e.g. straight into a staging buffer. The maze, the chunk table
+    // and the broadphase header and cell starts are always decoded, since
+    // opening validates them and getMaze uses the walls in place.
+    LevelFile(const std::string& path, ThreadPool& pool, uint32_t deferredSections = 0);
+
+    // Null for sections the file does not have.
+    const LevelSectionEntry* findSection(LevelSection type) const;
+    // Bytes of the section once decompressed / as stored in the file.
+    uint64_t getSectionBytes(LevelSection type) const {
+        const LevelSectionEntry* entry = findSection(type);
+        return entry ? entry->count * entry->elementSize : 0;
+    }
+    uint64_t getStoredBytes(LevelSection type) const;
+    // Writes the whole section to destination, decompressing its blocks in
+    // parallel when it is compressed.
+    void readSection(LevelSection type, void* destination, ThreadPool& pool) const;
+    // Asks the OS to read the whole file ahead.
+    void prefetch() const { file.prefetch(0, file.size()); }
+    size_t getFileSize() const { return file.size(); }
+
+    const LevelMazeInfo& getMazeInfo() const { return *mazeInfo; }
+    // Read-only view of the walls in the mapping.
+    MazeGrid getMaze() const;
+    MazeMeshSettings getMeshSettings() const;
+
+    LevelArray<LevelChunk> getChunks() const { return array<LevelChunk>(LevelSection::MeshChunks); }
+    LevelArray<Vertex> getVertices() const { return array<Vertex>(LevelSection::MeshVertices); }
+    LevelArray<uint32_t> getIndices() const { return array<uint32_t>(LevelSection::MeshIndices); }
+    LevelArray<Triangle> getCollisionTriangles() const { return array<Triangle>(LevelSection::CollisionTriangles); }
+    LevelArray<LevelBouncePad> getBouncePads() const { return array<LevelBouncePad>(LevelSection::BouncePads); }
+    LevelArray<LevelWindZone> getWindZones() const { return array<LevelWindZone>(LevelSection::WindZones); }
+    LevelArray<LevelMirror> getMirrors() const { return array<LevelMirror>(LevelSection::Mirrors); }
+
+    // False if the file has no broadphase grid / BVH. Throws
+    // std::runtime_error if its cells, nodes or leaves point out of bounds.
+    // Deferred sections are decoded on the pool, by default the global one.
+    bool loadBroadphase(UniformGrid& grid) const;
+    bool loadBroadphase(UniformGrid& grid, ThreadPool& pool) const;
+    bool loadBvh(Bvh& bvh) const;
+    bool loadBvh(Bvh& bvh, ThreadPool& pool) const;
+    std::vector<WindZone> loadWindZones() const;
+
+    static TriggerDesc toTrigger(const LevelBouncePad& pad);
+    static WindZone toWindZone(const LevelWindZone& zone);
+
+private:
+    template <typename T>
+    LevelArray<T> array(LevelSection type) const {
+        const LevelSectionEntry* entry = findSection(type);
+        const uint8_t* data = entry ? sectionData[static_cast<size_t>(type)] : nullptr;
+        if (!data) {
+            return LevelArray<T>();
+        }
+        return LevelArray<T>{reinterpret_cast<const T*>(data), static_cast<size_t>(entry->count)};
+    }
+    // The section in place, or decoded into scratch if it was deferred.
+    template <typename T>
+    LevelArray<T> decodedArray(LevelSection type, std::vector<T>& scratch, ThreadPool& pool) const {
+        const LevelSectionEntry* entry = findSection(type);
+        if (!entry || sectionData[static_cast<size_t>(type)]) {
+            return array<T>(type);
+        }
+        scratch.resize(static_cast<size_t>(entry->count));
+        readSection(type, scratch.data(), pool);
+        return LevelArray<T>{scratch.data(), scratch.size()};
+    }
+    void validate(const std::string& path, ThreadPool& pool, uint32_t deferredSections);
+    bool validBlocks(const LevelSectionEntry& entry, uint64_t available) const;
+    void decompressSections(ThreadPool& pool, uint32_t deferredSections);
+    void decompressBlock(const LevelSectionEntry& entry, uint32_t index, uint8_t* destination) const;
+
+    MappedFile file;
+    // Per LevelSection, or null.
+    const LevelSectionEntry* sections[static_cast<size_t>(LevelSection::Count)] = {};
+    // The mapping for stored sections, the decompressed copy otherwise;
+    // null for deferred sections.
+    const uint8_t* sectionData[static_cast<size_t>(LevelSection::Count)] = {};
+    std::vector<uint64_t> decoded[static_cast<size_t>(LevelSection::Count)];
+    const LevelMazeInfo* mazeInfo = nullptr;
+    const LevelBroadphaseInfo* broadphaseInfo = nullptr;
+};
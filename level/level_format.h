@@ -0,0 +1,172 @@
+#pragma once
+
+#include "Types.h"
+#include "bvh/bvh.h"
+#include "bvh/triangle_mesh.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+// On-disk layout of binary level files. A 32-byte header is followed by the
+// section table and then the sections, each starting on a 64-byte boundary.
+// Sections are flat arrays of the structs below (or of Vertex, Triangle,
+// BvhNode and uint32_t/uint64_t) in host byte order, which is
+// little-endian on every supported target, so a mapped file is used in
+// place: nothing is parsed or converted on load.
+//
+// A section may instead be compressed. Its data is then split into blocks
+// of LevelBlockHeader::blockSize bytes that are compressed independently,
+// so blocks decode in parallel straight to their place in the output. The
+// header is followed by each block's end offset and the blocks themselves;
+// a block whose stored size equals its size is stored as is.
+
+constexpr char LevelMagic[8] = {'M', 'Z', 'L', 'E', 'V', 'E', 'L', '1'};
+constexpr uint32_t LevelVersion = 1;
+constexpr uint64_t LevelSectionAlignment = 64;
+
+struct LevelHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t fileSize;
+    uint64_t reserved;
+};
+
+enum class LevelSection : uint32_t {
+    MazeInfo,                // 1 LevelMazeInfo
+    MazeEastWalls,           // rowWords * height uint64_t, MazeGrid's row layout
+    MazeSouthWalls,
+    MeshChunks,              // LevelChunk, row-major
+    MeshVertices,            // Vertex; chunks own consecutive ranges
+    MeshIndices,             // uint32_t, relative to the chunk's first vertex
+    CollisionTriangles,      // Triangle, the physics static geometry
+    BroadphaseInfo,          // 1 LevelBroadphaseInfo
+    BroadphaseCellStart,     // uint32_t, cellsX * cellsZ + 1 (UniformGrid CSR)
+    BroadphaseCellTriangles, // uint32_t into CollisionTriangles
+    BvhNodes,                // BvhNode, depth-first
+    BvhTriangles,            // Triangle in leaf order
+    BvhPrimitiveIds,         // uint32_t into CollisionTriangles
+    BouncePads,              // LevelBouncePad
+    WindZones,               // LevelWindZone
+    Mirrors,                 // LevelMirror
+    Count
+};
+
+enum class LevelCompression : uint32_t {
+    None,
+    Lz4,
+};
+
+constexpr uint32_t levelSectionBit(LevelSection type) {
+    return 1u << static_cast<uint32_t>(type);
+}
+
+struct LevelSectionEntry {
+    uint32_t type;
+    // LevelCompression.
+    uint32_t flags;
+    uint32_t elementSize;
+    uint32_t reserved;
+    uint64_t offset;
+    // Elements once decompressed.
+    uint64_t count;
+};
+
+struct LevelBlockHeader {
+    // Header, block table and blocks.
+    uint64_t storedSize;
+    uint32_t blockSize;
+    uint32_t blockCount;
+};
+
+struct LevelMazeInfo {
+    uint32_t width;
+    uint32_t height;
+    uint32_t rowWords;
+    uint32_t chunkSize;
+    float cellSize;
+    float wallHeight;
+    float wallThickness;
+    uint32_t floor;
+    glm::vec3 origin;
+    uint32_t reserved;
+};
+
+struct LevelChunk {
+    uint32_t chunkX;
+    uint32_t chunkZ;
+    uint32_t firstVertex;
+    uint32_t vertexCount;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+};
+
+struct LevelBroadphaseInfo {
+    glm::vec2 origin;
+    float cellSize;
+    uint32_t cellsX;
+    uint32_t cellsZ;
+    uint32_t reserved;
+};
+
+// TriggerDesc of a bounce pad; shape is a TriggerShape.
+struct LevelBouncePad {
+    uint32_t shape;
+    glm::vec3 a;
+    glm::vec3 b;
+    float radius;
+    glm::vec3 impulse;
+    uint32_t tag;
+};
+
+// WindZone; shape is a WindShape.
+struct LevelWindZone {
+    uint32_t shape;
+    glm::vec3 a;
+    glm::vec3 b;
+    float radius;
+    glm::vec3 direction;
+    float strength;
+    float turbulence;
+    float turbulenceScale;
+    float gustSpeed;
+    uint32_t reserved;
+};
+
+// Flat mirror quad: corner + s * edgeU + t * edgeV for s, t in [0, 1].
+struct LevelMirror {
+    glm::vec3 corner;
+    float reflectivity;
+    glm::vec3 edgeU;
+    uint32_t reserved0;
+    glm::vec3 edgeV;
+    uint32_t reserved1;
+};
+
+static_assert(sizeof(LevelHeader) == 32, "LevelHeader is part of the file format");
+static_assert(sizeof(LevelSectionEntry) == 32, "LevelSectionEntry is part of the file format");
+static_assert(sizeof(LevelBlockHeader) == 16, "LevelBlockHeader is part of the file format");
+static_assert(sizeof(LevelMazeInfo) == 48, "LevelMazeInfo is part of the file format");
+static_assert(sizeof(LevelChunk) == 48, "LevelChunk is part of the file format");
+static_assert(sizeof(LevelBroadphaseInfo) == 24, "LevelBroadphaseInfo is part of the file format");
+static_assert(sizeof(LevelBouncePad) == 48, "LevelBouncePad is part of the file format");
+static_assert(sizeof(LevelWindZone) == 64, "LevelWindZone is part of the file format");
+static_assert(sizeof(LevelMirror) == 48, "LevelMirror is part of the file format");
+static_assert(sizeof(Vertex) == 32, "Vertex is stored in level files");
+static_assert(sizeof(Triangle) == 36, "Triangle is stored in level files");
+static_assert(sizeof(BvhNode) == 32, "BvhNode is stored in level files");
+
+// Read-only array inside a mapped or decompressed section.
+template <typename T>
+struct LevelArray {
+    const T* data = nullptr;
+    size_t count = 0;
+
+    const T* begin() const { return data; }
+    const T* end() const { return data + count; }
+    const T& operator[](size_t i) const { return data[i]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
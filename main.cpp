@@ -1,10 +1,24 @@
 #include "VulkanContext.h"
-#include "Model.h"
+#include "AssetManager.h"
 #include "Camera.h"
+#include "ChunkRenderer.h"
+#include "bvh/triangle_mesh.h"
+#include "core/thread_pool.h"
+#include "level/level_file.h"
+#include "physics/physics_thread.h"
+#include "physics/physics_world.h"
+#include "renderer/path_tracer.h"
+#include "world/chunk_streamer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
 #include <stdexcept>
 #include <iostream>
 #include <chrono>
+#include <memory>
 #include <GLFW/glfw3.h>
+#include <glm/gtc/matrix_transform.hpp>
 
 static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     auto camera = static_cast<Camera*>(glfwGetWindowUserPointer(window));
@@ -13,8 +27,72 @@ static void keyCallback(GLFWwindow* window, int key, int scancode, int action, i
     }
 }
 
-int main() {
+// Unit cube centred on the origin, as consecutive triangles. Stands in
+// for models that are still loading.
+static std::vector<Vertex> cubeVertices() {
+    std::vector<Vertex> vertices;
+    for (int axis = 0; axis < 3; axis++) {
+        for (float side : {-1.0f, 1.0f}) {
+            glm::vec3 normal(0.0f);
+            normal[axis] = side;
+            glm::vec3 u(0.0f);
+            glm::vec3 v(0.0f);
+            u[(axis + 1) % 3] = 0.5f;
+            v[(axis + 2) % 3] = 0.5f;
+            if (side < 0.0f) {
+                std::swap(u, v);
+            }
+            glm::vec3 centre = 0.5f * normal;
+            glm::vec3 corners[4] = {centre - u - v, centre + u - v, centre + u + v, centre - u + v};
+            for (int corner : {0, 1, 2, 0, 2, 3}) {
+                vertices.push_back(Vertex{corners[corner], normal, glm::vec2(0.0f)});
+            }
+        }
+    }
+    return vertices;
+}
+
+// Path-traces the current view on the CPU as a ground-truth reference.
+static void renderReferenceImage(const TriangleMesh& mazeMesh, LevelArray<LevelMirror> mirrors,
+                                 const TriangleMesh& sphereMesh, const Camera& camera) {
+    PathTracerScene scene;
+    scene.addMesh(mazeMesh, PathTracerMaterial{glm::vec3(0.75f), 0.0f});
+    for (const LevelMirror& mirror : mirrors) {
+        TriangleMesh quad;
+        glm::vec3 opposite = mirror.corner + mirror.edgeU + mirror.edgeV;
+        quad.append(Triangle{mirror.corner, mirror.corner + mirror.edgeU, opposite});
+        quad.append(Triangle{mirror.corner, opposite, mirror.corner + mirror.edgeV});
+        scene.addMesh(quad, PathTracerMaterial{glm::vec3(0.95f), mirror.reflectivity});
+    }
+    scene.addMesh(sphereMesh, PathTracerMaterial{glm::vec3(0.95f), 1.0f});
+    scene.build(ThreadPool::global());
+
+    PathTracerSettings settings;
+    settings.width = WINDOW_WIDTH;
+    settings.height = WINDOW_HEIGHT;
+    PathTracer tracer(scene, ThreadPool::global(), settings);
+    tracer.setCamera(camera.getViewMatrix(), camera.getProjectionMatrix());
+    tracer.render(64);
+    tracer.savePng("reference.png");
+    tracer.saveExr("reference.exr");
+
+    std::cout << "Reference image written (" << tracer.getSampleCount() << " spp, "
+              << tracer.getRenderMs() << " ms)" << std::endl;
+}
+
+// Usage: VulkanMazeGame [balls] [streamedMazeSize] [levelFile]
+// Extra balls are dropped on a grid over the maze for stress testing.
+// Space kicks the first ball upwards. With a streamed maze size, a
+// generated maze of that many cells per side is streamed around the camera
+// and drawn instead of the level; it is render-only, the balls still roll
+// on the level. A binary level file replaces maze.obj: its chunk meshes are
+// uploaded from the mapping and physics, wind zones and bounce pads come
+// from its stored collision data. Models load in the background while
+// frames are drawn; the time to the first frame and until every model is
+// on the GPU are printed.
+int main(int argc, char** argv) {
     try {
+        auto startTime = std::chrono::high_resolution_clock::now();
         VulkanContext context;
         context.initWindow(800, 600, "3D Maze Game");
         context.initVulkan();
@@ -25,16 +103,131 @@ int main() {
 
         std::string mazePath = R"(D:\vscode\final\models\maze.obj)";
         std::string spherePath = R"(D:\vscode\final\models\sphere.obj)";
-        
-        Model mazeModel(context.getDevice(), context.getPhysicalDevice(), 
-                       context.getCommandPool(), context.getGraphicsQueue(),
-                       mazePath);
-        
-        Model sphereModel(context.getDevice(), context.getPhysicalDevice(), 
-                         context.getCommandPool(), context.getGraphicsQueue(),
-                         spherePath);
+        std::string levelPath = argc > 3 ? argv[3] : "";
+
+        // Declared before the asset manager, whose jobs may still be copying
+        // out of the mapping when it is destroyed.
+        std::unique_ptr<LevelFile> level;
+
+        // Parsing and uploads never block a frame; until a model is ready
+        // its draws use the cube placeholder or are skipped.
+        ThreadPool assetPool(3);
+        AssetManager assets(context, assetPool);
+        AssetHandle placeholder = assets.loadMesh(cubeVertices());
+        AssetHandle sphereModel = assets.loadModel(spherePath);
+
+        // The level is either a binary level file, whose chunks become one
+        // model each and show as boxes over their bounds while loading, or
+        // maze.obj.
+        std::vector<AssetHandle> mazeModels;
+        std::vector<glm::mat4> mazePlaceholders;
+        TriangleMesh mazeMesh;
+        Aabb mazeBounds;
+        if (!levelPath.empty()) {
+            auto levelStart = std::chrono::high_resolution_clock::now();
+            level = std::make_unique<LevelFile>(levelPath);
+            LevelArray<Vertex> vertices = level->getVertices();
+            LevelArray<uint32_t> indices = level->getIndices();
+            for (const LevelChunk& chunk : level->getChunks()) {
+                if (chunk.vertexCount == 0) {
+                    continue;
+                }
+                mazeModels.push_back(assets.loadMesh(vertices.data + chunk.firstVertex, chunk.vertexCount,
+                                                     indices.data + chunk.firstIndex, chunk.indexCount));
+                glm::vec3 centre = 0.5f * (chunk.boundsMin + chunk.boundsMax);
+                mazePlaceholders.push_back(glm::scale(glm::translate(glm::mat4(1.0f), centre),
+                                                      chunk.boundsMax - chunk.boundsMin));
+                mazeBounds.grow(chunk.boundsMin);
+                mazeBounds.grow(chunk.boundsMax);
+            }
+            std::cout << "Level opened in " << std::chrono::duration<double, std::milli>(
+                             std::chrono::high_resolution_clock::now() - levelStart).count()
+                      << " ms (" << level->getFileSize() / (1024 * 1024) << " MB, " << mazeModels.size()
+                      << " chunks)" << std::endl;
+        } else {
+            mazeModels.push_back(assets.loadModel(mazePath));
+        }
+
+        // Physics starts once the models it depends on are parsed: the ball
+        // is a physics sphere matching the sphere model's size, dropped into
+        // the maze above its centre, and without a level file the static
+        // geometry is maze.obj. It runs on its own thread at 240 Hz; frames
+        // draw the latest snapshot interpolated one step behind, so a slow
+        // step never stalls rendering. Its jobs get their own pool: the F12
+        // reference render fills the global one with tile tasks for seconds.
+        ThreadPool physicsPool(3);
+        std::unique_ptr<PhysicsWorld> physics;
+        std::unique_ptr<PhysicsThread> physicsThread;
+        TriangleMesh sphereMesh;
+        uint32_t ball = 0;
+        std::vector<glm::mat4> ballTransforms;
+        auto startPhysics = [&]() {
+            auto physicsStart = std::chrono::high_resolution_clock::now();
+            sphereMesh.append(assets.getVertices(sphereModel), assets.getIndices(sphereModel));
+            glm::vec3 sphereExtent = sphereMesh.bounds().extent();
+
+            PhysicsSettings physicsSettings;
+            physicsSettings.timeStep = 1.0f / 240.0f;
+            physics = std::make_unique<PhysicsWorld>(physicsSettings, physicsPool);
+            if (level) {
+                UniformGrid grid;
+                LevelArray<Triangle> triangles = level->getCollisionTriangles();
+                physics->setStaticGeometry(triangles.data, triangles.size(),
+                                           level->loadBroadphase(grid) ? &grid : nullptr);
+                physics->setWindZones(level->loadWindZones());
+                for (const LevelBouncePad& pad : level->getBouncePads()) {
+                    physics->addTrigger(LevelFile::toTrigger(pad));
+                }
+            } else {
+                mazeMesh.append(assets.getVertices(mazeModels.front()), assets.getIndices(mazeModels.front()));
+                mazeBounds = mazeMesh.bounds();
+                physics->setStaticGeometry(mazeMesh);
+            }
+            BodyDesc ballDesc;
+            ballDesc.radius = 0.5f * std::max(sphereExtent.x, std::max(sphereExtent.y, sphereExtent.z));
+            ballDesc.position = glm::vec3(mazeBounds.center().x, mazeBounds.max.y + ballDesc.radius,
+                                          mazeBounds.center().z);
+            ball = physics->addBody(ballDesc);
+
+            int extraBalls = argc > 1 ? std::max(std::atoi(argv[1]) - 1, 0) : 0;
+            int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(extraBalls))));
+            for (int i = 0; i < extraBalls; i++) {
+                BodyDesc desc = ballDesc;
+                desc.position = glm::vec3(mazeBounds.min.x + (i % side + 0.5f) / side * mazeBounds.extent().x,
+                                          mazeBounds.max.y + ballDesc.radius * 3.0f,
+                                          mazeBounds.min.z + (i / side + 0.5f) / side * mazeBounds.extent().z);
+                physics->addBody(desc);
+            }
+            ballTransforms.resize(physics->getBodyCount());
+            physicsThread = std::make_unique<PhysicsThread>(*physics);
+            physicsThread->start();
+            std::cout << "Physics started in " << std::chrono::duration<double, std::milli>(
+                             std::chrono::high_resolution_clock::now() - physicsStart).count()
+                      << " ms" << std::endl;
+        };
+
+        // Streaming meshes chunks on its own pool so physics and BVH work
+        // never pick up streaming jobs.
+        uint32_t streamedSize = argc > 2 ? static_cast<uint32_t>(std::max(std::atoi(argv[2]), 0)) : 0;
+        std::unique_ptr<ThreadPool> streamingPool;
+        std::unique_ptr<ChunkRenderer> chunkRenderer;
+        std::unique_ptr<ChunkStreamer> chunkStreamer;
+        if (streamedSize > 0) {
+            MazeWorld streamedWorld(streamedSize, streamedSize, 32, 1234u);
+            MazeMeshSettings meshSettings;
+            meshSettings.origin = glm::vec3(-0.5f * streamedSize, 0.0f, -0.5f * streamedSize);
+            streamingPool = std::make_unique<ThreadPool>(3);
+            chunkRenderer = std::make_unique<ChunkRenderer>(assets);
+            chunkStreamer = std::make_unique<ChunkStreamer>(streamedWorld, meshSettings, *chunkRenderer,
+                                                            *streamingPool);
+        }
+        auto lastStatsTime = std::chrono::high_resolution_clock::now();
 
         auto lastTime = std::chrono::high_resolution_clock::now();
+        bool referenceKeyDown = false;
+        bool kickKeyDown = false;
+        bool firstFrame = true;
+        bool loadReported = false;
 
         while (!glfwWindowShouldClose(context.getWindow())) {
             auto currentTime = std::chrono::high_resolution_clock::now();
@@ -44,6 +237,64 @@ int main() {
             camera.update(deltaTime);
             glfwPollEvents();
 
+            assets.update();
+            if (!physicsThread && assets.getState(sphereModel) != AssetState::Loading &&
+                (level || assets.getState(mazeModels.front()) != AssetState::Loading)) {
+                startPhysics();
+            }
+            if (!loadReported && assets.isIdle()) {
+                const AssetStats& stats = assets.getStats();
+                std::cout << "Assets loaded in " << stats.loadMs << " ms (" << stats.ready << " models, "
+                          << stats.uploadedBytes / (1024 * 1024) << " MB in " << stats.batches
+                          << " upload batches, max update " << stats.maxUpdateMs << " ms)" << std::endl;
+                loadReported = true;
+            }
+
+            if (chunkStreamer) {
+                chunkStreamer->update(camera.getPosition());
+                if (std::chrono::duration<float>(currentTime - lastStatsTime).count() >= 1.0f) {
+                    const StreamingStats& stats = chunkStreamer->getStats();
+                    std::cout << "streaming: " << stats.residentChunks << " chunks ("
+                              << stats.residentBytes / (1024 * 1024) << " MB), " << stats.uploadMBps
+                              << " MB/s, " << stats.missingChunks << " missing, " << stats.hitchCount
+                              << " hitches, max update " << stats.maxUpdateMs << " ms" << std::endl;
+                    lastStatsTime = currentTime;
+                }
+            }
+
+            if (physicsThread) {
+                bool kickKey = glfwGetKey(context.getWindow(), GLFW_KEY_SPACE) == GLFW_PRESS;
+                if (kickKey && !kickKeyDown) {
+                    PhysicsCommand kick;
+                    kick.type = PhysicsCommand::Type::ApplyImpulse;
+                    kick.bodyId = ball;
+                    kick.vector = glm::vec3(0.0f, 5.0f, 0.0f);
+                    physicsThread->submit(kick);
+                }
+                kickKeyDown = kickKey;
+
+                const PhysicsSnapshot& snapshot = physicsThread->acquireSnapshot();
+                float alpha = snapshot.interpolationAlpha(PhysicsSnapshot::Clock::now());
+                for (uint32_t i = 0; i < ballTransforms.size(); i++) {
+                    ballTransforms[i] = snapshot.getBodyTransform(i, alpha);
+                }
+
+                bool referenceKey = glfwGetKey(context.getWindow(), GLFW_KEY_F12) == GLFW_PRESS;
+                if (referenceKey && !referenceKeyDown) {
+                    if (level && mazeMesh.empty()) {
+                        for (const Triangle& triangle : level->getCollisionTriangles()) {
+                            mazeMesh.append(triangle);
+                        }
+                    }
+                    TriangleMesh ballMesh;
+                    ballMesh.append(assets.getVertices(sphereModel), assets.getIndices(sphereModel),
+                                    ballTransforms[ball]);
+                    renderReferenceImage(mazeMesh, level ? level->getMirrors() : LevelArray<LevelMirror>(), ballMesh,
+                                         camera);
+                }
+                referenceKeyDown = referenceKey;
+            }
+
             context.beginFrame();
             VkCommandBuffer commandBuffer = context.beginRenderPass();
             
@@ -53,13 +304,40 @@ int main() {
             ubo.proj = camera.getProjectionMatrix();
             context.updateUniformBuffer(ubo);
 
-            mazeModel.draw(commandBuffer);
-            sphereModel.draw(commandBuffer);
+            if (chunkRenderer) {
+                context.pushModelMatrix(commandBuffer, glm::mat4(1.0f));
+                chunkRenderer->draw(commandBuffer);
+            } else {
+                for (size_t i = 0; i < mazeModels.size(); i++) {
+                    bool ready = assets.isReady(mazeModels[i]);
+                    if (!ready && i >= mazePlaceholders.size()) {
+                        continue;
+                    }
+                    context.pushModelMatrix(commandBuffer, ready ? glm::mat4(1.0f) : mazePlaceholders[i]);
+                    assets.draw(commandBuffer, mazeModels[i], placeholder);
+                }
+            }
+            context.pushModelMatrix(commandBuffer, glm::mat4(1.0f));
+            uint32_t firstBall = context.pushInstances(ballTransforms);
+            assets.drawInstanced(commandBuffer, sphereModel, static_cast<uint32_t>(ballTransforms.size()), firstBall,
+                                 placeholder);
             context.endRenderPass();
             context.endFrame();
+            if (firstFrame) {
+                std::cout << "First frame after " << std::chrono::duration<double, std::milli>(
+                                 std::chrono::high_resolution_clock::now() - startTime).count()
+                          << " ms (" << assets.getStats().ready << " of " << assets.getStats().requested
+                          << " models ready)" << std::endl;
+                firstFrame = false;
+            }
         }
 
+        if (physicsThread) {
+            physicsThread->stop();
+        }
         vkDeviceWaitIdle(context.getDevice());
+        chunkStreamer.reset();
+        chunkRenderer.reset();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
         return EXIT_FAILURE;
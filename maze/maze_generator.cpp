@@ -0,0 +1,353 @@
+#include "maze_generator.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+uint64_t splitMix(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Generation is bound by random draws, so a splitmix stream is used rather
+// than std::mt19937: it is several times faster and its output is the same
+// on every standard library, which keeps mazes reproducible across
+// platforms.
+class MazeRng {
+public:
+    explicit MazeRng(uint64_t seed) : state(seed) {}
+
+    uint64_t next() { return splitMix(state); }
+
+    // Uniform in [0, n), by multiply-shift.
+    uint32_t below(uint32_t n) { return static_cast<uint32_t>(((next() >> 32) * n) >> 32); }
+
+    bool coin() {
+        if (coinBits == 0) {
+            coinWord = next();
+            coinBits = 64;
+        }
+        coinBits--;
+        bool result = coinWord & 1u;
+        coinWord >>= 1;
+        return result;
+    }
+
+private:
+    uint64_t state;
+    uint64_t coinWord = 0;
+    uint32_t coinBits = 0;
+};
+
+enum Direction : uint8_t { East, South, West, North };
+
+// Region-local cell indices, row-major.
+struct RegionCells {
+    const MazeRegion& region;
+    uint32_t width;
+    uint32_t height;
+
+    explicit RegionCells(const MazeRegion& region)
+        : region(region), width(region.x1 - region.x0), height(region.z1 - region.z0) {}
+
+    uint32_t count() const { return width * height; }
+
+    // Returns the neighbour in `direction`, or UINT32_MAX outside the region.
+    uint32_t neighbour(uint32_t cell, uint8_t direction) const {
+        uint32_t x = cell % width;
+        uint32_t z = cell / width;
+        switch (direction) {
+        case East: return x + 1 < width ? cell + 1 : UINT32_MAX;
+        case South: return z + 1 < height ? cell + width : UINT32_MAX;
+        case West: return x > 0 ? cell - 1 : UINT32_MAX;
+        default: return z > 0 ? cell - width : UINT32_MAX;
+        }
+    }
+
+    void open(MazeGrid& grid, uint32_t cell, uint8_t direction) const {
+        uint32_t x = region.x0 + cell % width;
+        uint32_t z = region.z0 + cell / width;
+        switch (direction) {
+        case East: grid.openEast(x, z); break;
+        case South: grid.openSouth(x, z); break;
+        case West: grid.openEast(x - 1, z); break;
+        default: grid.openSouth(x, z - 1); break;
+        }
+    }
+};
+
+bool testBit(const std::vector<uint64_t>& bits, uint32_t index) { return (bits[index >> 6] >> (index & 63)) & 1u; }
+void setBit(std::vector<uint64_t>& bits, uint32_t index) { bits[index >> 6] |= uint64_t(1) << (index & 63); }
+
+void carveBacktracker(MazeGrid& grid, const RegionCells& cells, MazeRng& rng) {
+    std::vector<uint64_t> visited((cells.count() + 63) / 64, 0);
+    std::vector<uint32_t> stack;
+    uint32_t start = rng.below(cells.count());
+    setBit(visited, start);
+    stack.push_back(start);
+    while (!stack.empty()) {
+        uint32_t cell = stack.back();
+        uint8_t options[4];
+        uint32_t neighbours[4];
+        uint32_t optionCount = 0;
+        for (uint8_t direction = 0; direction < 4; direction++) {
+            uint32_t next = cells.neighbour(cell, direction);
+            if (next != UINT32_MAX && !testBit(visited, next)) {
+                options[optionCount] = direction;
+                neighbours[optionCount++] = next;
+            }
+        }
+        if (optionCount == 0) {
+            stack.pop_back();
+            continue;
+        }
+        uint32_t pick = optionCount == 1 ? 0 : rng.below(optionCount);
+        cells.open(grid, cell, options[pick]);
+        setBit(visited, neighbours[pick]);
+        stack.push_back(neighbours[pick]);
+    }
+}
+
+// Random walks from each cell not yet in the maze until they hit it; the
+// last direction taken out of each cell is remembered, so retracing the
+// walk from its start follows the loop-erased path.
+void carveWilson(MazeGrid& grid, const RegionCells& cells, MazeRng& rng) {
+    std::vector<uint64_t> inMaze((cells.count() + 63) / 64, 0);
+    std::vector<uint8_t> exitDirection(cells.count());
+    setBit(inMaze, rng.below(cells.count()));
+    for (uint32_t start = 0; start < cells.count(); start++) {
+        if (testBit(inMaze, start)) {
+            continue;
+        }
+        uint32_t cell = start;
+        while (!testBit(inMaze, cell)) {
+            uint8_t direction;
+            uint32_t next;
+            do {
+                direction = static_cast<uint8_t>(rng.next() & 3u);
+                next = cells.neighbour(cell, direction);
+            } while (next == UINT32_MAX);
+            exitDirection[cell] = direction;
+            cell = next;
+        }
+        cell = start;
+        while (!testBit(inMaze, cell)) {
+            setBit(inMaze, cell);
+            cells.open(grid, cell, exitDirection[cell]);
+            cell = cells.neighbour(cell, exitDirection[cell]);
+        }
+    }
+}
+
+// The grid's rows are word-aligned and regions start on a multiple of 64
+// (or at 0), so the generator can write straight into them.
+void carveEller(MazeGrid& grid, const MazeRegion& region, uint64_t seed) {
+    EllerGenerator generator(region.x1 - region.x0, seed);
+    uint32_t firstWord = region.x0 >> 6;
+    for (uint32_t z = region.z0; z < region.z1; z++) {
+        generator.nextRow(z + 1 == region.z1, grid.eastRow(z) + firstWord, grid.southRow(z) + firstWord);
+    }
+}
+
+} // namespace
+
+EllerGenerator::EllerGenerator(uint32_t width, uint64_t seed)
+    : width(width), seed(seed), label(width), roots(width), parent(2 * static_cast<size_t>(width)),
+      remap(2 * static_cast<size_t>(width), UINT32_MAX), cellCount(2 * static_cast<size_t>(width)),
+      chosen(2 * static_cast<size_t>(width)), down(2 * static_cast<size_t>(width)), openedSouth(width) {
+    if (width == 0) {
+        throw std::runtime_error("EllerGenerator: width must be positive");
+    }
+    for (uint32_t x = 0; x < width; x++) {
+        label[x] = x;
+        parent[x] = x;
+    }
+}
+
+uint32_t EllerGenerator::find(uint32_t a) {
+    while (parent[a] != a) {
+        parent[a] = parent[parent[a]];
+        a = parent[a];
+    }
+    return a;
+}
+
+void EllerGenerator::nextRow(bool lastRow, uint64_t* eastBits, uint64_t* southBits) {
+    // Each row draws from its own stream, derived from the seed and the row
+    // index.
+    MazeRng rng(deriveMazeSeed(seed, rowCount));
+    rowCount++;
+
+    // Join neighbours in different sets at random; the last row joins them
+    // all so the maze ends connected.
+    for (uint32_t x = 0; x + 1 < width; x++) {
+        uint32_t a = find(label[x]);
+        uint32_t b = find(label[x + 1]);
+        if (a != b && (lastRow || rng.coin())) {
+            parent[a > b ? a : b] = a < b ? a : b;
+            eastBits[x >> 6] &= ~(uint64_t(1) << (x & 63));
+        }
+    }
+    if (lastRow) {
+        return;
+    }
+
+    // Every set carries on downwards through at least one cell: open each
+    // cell's south wall on a coin flip, then, for sets that got none, the
+    // cell picked for them by reservoir sampling.
+    for (uint32_t x = 0; x < width; x++) {
+        roots[x] = find(label[x]);
+        cellCount[roots[x]] = 0;
+        down[roots[x]] = 0;
+    }
+    for (uint32_t x = 0; x < width; x++) {
+        uint32_t root = roots[x];
+        if (rng.below(++cellCount[root]) == 0) {
+            chosen[root] = x;
+        }
+        openedSouth[x] = rng.coin();
+        down[root] |= openedSouth[x];
+    }
+    for (uint32_t x = 0; x < width; x++) {
+        uint32_t root = roots[x];
+        if (!down[root]) {
+            openedSouth[chosen[root]] = 1;
+            down[root] = 1;
+        }
+    }
+
+    // Relabel the next row compactly, as MazeGrid::isPerfect does: cells
+    // below an opening keep their set, the others start new ones.
+    uint32_t next = 0;
+    for (uint32_t x = 0; x < width; x++) {
+        if (openedSouth[x]) {
+            southBits[x >> 6] &= ~(uint64_t(1) << (x & 63));
+            if (remap[roots[x]] == UINT32_MAX) {
+                remap[roots[x]] = next++;
+            }
+            label[x] = remap[roots[x]];
+        } else {
+            label[x] = UINT32_MAX;
+        }
+    }
+    for (uint32_t x = 0; x < width; x++) {
+        remap[roots[x]] = UINT32_MAX;
+        if (label[x] == UINT32_MAX) {
+            label[x] = next++;
+        }
+    }
+    for (uint32_t i = 0; i < next; i++) {
+        parent[i] = i;
+    }
+}
+
+uint64_t deriveMazeSeed(uint64_t seed, uint64_t part) {
+    uint64_t state = seed ^ (part * 0xD1B54A32D192ED03ull);
+    return splitMix(state);
+}
+
+void carveMaze(MazeGrid& grid, const MazeRegion& region, MazeAlgorithm algorithm, uint64_t seed) {
+    if (region.x0 >= region.x1 || region.z0 >= region.z1 || region.x1 > grid.getWidth() ||
+        region.z1 > grid.getHeight()) {
+        throw std::runtime_error("carveMaze: region outside the grid");
+    }
+    if (algorithm == MazeAlgorithm::Eller) {
+        if (region.x0 & 63) {
+            throw std::runtime_error("carveMaze: Eller regions must start on a multiple of 64");
+        }
+        carveEller(grid, region, seed);
+        return;
+    }
+    uint64_t cellCount = static_cast<uint64_t>(region.x1 - region.x0) * (region.z1 - region.z0);
+    if (cellCount >= UINT32_MAX) {
+        throw std::runtime_error("carveMaze: region too large, use Eller or parallel generation");
+    }
+    RegionCells cells(region);
+    MazeRng rng(seed);
+    if (algorithm == MazeAlgorithm::Backtracker) {
+        carveBacktracker(grid, cells, rng);
+    } else {
+        carveWilson(grid, cells, rng);
+    }
+}
+
+MazeGrid generateMaze(uint32_t width, uint32_t height, MazeAlgorithm algorithm, uint64_t seed) {
+    MazeGrid grid(width, height);
+    carveMaze(grid, {0, 0, width, height}, algorithm, seed);
+    return grid;
+}
+
+MazeGrid generateMazeParallel(uint32_t width, uint32_t height, MazeAlgorithm algorithm, uint64_t seed,
+                              ThreadPool& pool, uint32_t regionSize) {
+    MazeGrid grid(width, height);
+    regionSize = std::max<uint32_t>(64, (regionSize + 63) & ~63u);
+    uint32_t regionsX = (width + regionSize - 1) / regionSize;
+    uint32_t regionsZ = (height + regionSize - 1) / regionSize;
+    uint32_t regionCount = regionsX * regionsZ;
+    auto regionAt = [&](uint32_t index) {
+        uint32_t rx = index % regionsX;
+        uint32_t rz = index / regionsX;
+        return MazeRegion{rx * regionSize, rz * regionSize, std::min(width, (rx + 1) * regionSize),
+                          std::min(height, (rz + 1) * regionSize)};
+    };
+
+    pool.parallelFor(regionCount, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            carveMaze(grid, regionAt(static_cast<uint32_t>(i)), algorithm, deriveMazeSeed(seed, i));
+        }
+    });
+
+    // Each region is a perfect maze on its own; a spanning tree over the
+    // regions (Kruskal in a seeded random edge order) with one opening per
+    // tree edge joins them without creating loops.
+    struct RegionEdge {
+        uint32_t a;
+        uint32_t b;
+        bool horizontal;
+    };
+    std::vector<RegionEdge> edges;
+    for (uint32_t rz = 0; rz < regionsZ; rz++) {
+        for (uint32_t rx = 0; rx < regionsX; rx++) {
+            uint32_t index = rz * regionsX + rx;
+            if (rx + 1 < regionsX) {
+                edges.push_back({index, index + 1, true});
+            }
+            if (rz + 1 < regionsZ) {
+                edges.push_back({index, index + regionsX, false});
+            }
+        }
+    }
+    MazeRng rng(deriveMazeSeed(seed, regionCount));
+    for (size_t i = edges.size(); i > 1; i--) {
+        std::swap(edges[i - 1], edges[rng.below(static_cast<uint32_t>(i))]);
+    }
+    std::vector<uint32_t> parent(regionCount);
+    for (uint32_t i = 0; i < regionCount; i++) {
+        parent[i] = i;
+    }
+    auto find = [&](uint32_t a) {
+        while (parent[a] != a) {
+            parent[a] = parent[parent[a]];
+            a = parent[a];
+        }
+        return a;
+    };
+    for (const RegionEdge& edge : edges) {
+        uint32_t a = find(edge.a);
+        uint32_t b = find(edge.b);
+        if (a == b) {
+            continue;
+        }
+        parent[a] = b;
+        MazeRegion region = regionAt(edge.a);
+        if (edge.horizontal) {
+            grid.openEast(region.x1 - 1, region.z0 + rng.below(region.z1 - region.z0));
+        } else {
+            grid.openSouth(region.x0 + rng.below(region.x1 - region.x0), region.z1 - 1);
+        }
+    }
+    return grid;
+}
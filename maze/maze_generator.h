@@ -0,0 +1,70 @@
+#pragma once
+
+#include "maze_grid.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// All three carve perfect mazes (exactly one path between any two cells).
+// The recursive backtracker gives long winding corridors but keeps a stack
+// of up to one entry per cell; Wilson's algorithm samples uniformly among
+// all perfect mazes but its first random walks are slow on big grids;
+// Eller's works row by row in O(width) memory.
+enum class MazeAlgorithm { Backtracker, Wilson, Eller };
+
+struct MazeRegion {
+    uint32_t x0 = 0;
+    uint32_t z0 = 0;
+    uint32_t x1 = 0;
+    uint32_t z1 = 0;
+};
+
+// Carves a perfect maze inside `region` of a grid whose walls there are all
+// closed. Walls on the region's border are left closed. The same seed
+// always carves the same maze.
+void carveMaze(MazeGrid& grid, const MazeRegion& region, MazeAlgorithm algorithm, uint64_t seed);
+
+// Decorrelated seed for one part of a maze (a region, a chunk...), so parts
+// can be generated independently and in any order.
+uint64_t deriveMazeSeed(uint64_t seed, uint64_t part);
+
+MazeGrid generateMaze(uint32_t width, uint32_t height, MazeAlgorithm algorithm, uint64_t seed);
+
+// Splits the grid into square regions, carves them on the pool and joins
+// neighbouring regions along a random spanning tree of the region graph,
+// with one opening in each chosen shared border, which keeps the result
+// perfect. Region sides are rounded up to a multiple of 64 so each region
+// owns whole words of the bit rows. The maze depends on the seed and the
+// region size, never on the thread count.
+MazeGrid generateMazeParallel(uint32_t width, uint32_t height, MazeAlgorithm algorithm, uint64_t seed,
+                              ThreadPool& pool, uint32_t regionSize = 512);
+
+// Eller's algorithm one row at a time, for mazes of unbounded height: each
+// row can be written out and dropped as soon as it is generated.
+class EllerGenerator {
+public:
+    EllerGenerator(uint32_t width, uint64_t seed);
+
+    // Clears the bits of the row's openings, bit x for cell x; other bits
+    // are left alone, so the arrays should start with every wall set. The
+    // last row joins all remaining sets and keeps its south walls.
+    void nextRow(bool lastRow, uint64_t* eastBits, uint64_t* southBits);
+
+    uint64_t getRowCount() const { return rowCount; }
+
+private:
+    uint32_t find(uint32_t label);
+
+    uint32_t width;
+    uint64_t seed;
+    uint64_t rowCount = 0;
+    std::vector<uint32_t> label;
+    std::vector<uint32_t> roots;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> remap;
+    std::vector<uint32_t> cellCount;
+    std::vector<uint32_t> chosen;
+    std::vector<uint8_t> down;
+    std::vector<uint8_t> openedSouth;
+};
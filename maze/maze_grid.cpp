@@ -0,0 +1,178 @@
+#include "maze_grid.h"
+#include <stdexcept>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+uint64_t popcount(uint64_t word) {
+#if defined(_MSC_VER)
+    return __popcnt64(word);
+#else
+    return static_cast<uint64_t>(__builtin_popcountll(word));
+#endif
+}
+
+constexpr uint32_t NoLabel = UINT32_MAX;
+
+} // namespace
+
+MazeGrid::MazeGrid(uint32_t width, uint32_t height)
+    : width(width), height(height), rowWords(static_cast<uint32_t>((static_cast<uint64_t>(width) + 63) / 64)) {
+    if (width == 0 || height == 0) {
+        throw std::runtime_error("MazeGrid: size must be positive");
+    }
+    size_t words = static_cast<size_t>(rowWords) * height;
+    east.assign(words, ~uint64_t(0));
+    south.assign(words, ~uint64_t(0));
+    eastBits = east.data();
+    southBits = south.data();
+}
+
+MazeGrid::MazeGrid(const MazeGrid& other) {
+    *this = other;
+}
+
+MazeGrid& MazeGrid::operator=(const MazeGrid& other) {
+    width = other.width;
+    height = other.height;
+    rowWords = other.rowWords;
+    east = other.east;
+    south = other.south;
+    bool view = other.isView();
+    eastBits = view ? other.eastBits : east.data();
+    southBits = view ? other.southBits : south.data();
+    return *this;
+}
+
+MazeGrid MazeGrid::view(uint32_t width, uint32_t height, const uint64_t* eastRows, const uint64_t* southRows) {
+    if (width == 0 || height == 0 || !eastRows || !southRows) {
+        throw std::runtime_error("MazeGrid: invalid view");
+    }
+    MazeGrid grid;
+    grid.width = width;
+    grid.height = height;
+    grid.rowWords = static_cast<uint32_t>((static_cast<uint64_t>(width) + 63) / 64);
+    grid.eastBits = eastRows;
+    grid.southBits = southRows;
+    return grid;
+}
+
+void MazeGrid::openEast(uint32_t x, uint32_t z) {
+    if (x + 1 < width) {
+        east[static_cast<size_t>(z) * rowWords + (x >> 6)] &= ~(uint64_t(1) << (x & 63));
+    }
+}
+
+void MazeGrid::openSouth(uint32_t x, uint32_t z) {
+    if (z + 1 < height) {
+        south[static_cast<size_t>(z) * rowWords + (x >> 6)] &= ~(uint64_t(1) << (x & 63));
+    }
+}
+
+void MazeGrid::closeEast(uint32_t x, uint32_t z) {
+    east[static_cast<size_t>(z) * rowWords + (x >> 6)] |= uint64_t(1) << (x & 63);
+}
+
+void MazeGrid::closeSouth(uint32_t x, uint32_t z) {
+    south[static_cast<size_t>(z) * rowWords + (x >> 6)] |= uint64_t(1) << (x & 63);
+}
+
+uint64_t MazeGrid::countPassages() const {
+    // Padding bits past the last column stay set, so counting walls over
+    // whole words and subtracting from the bit count gives the openings.
+    uint64_t bits = static_cast<uint64_t>(rowWords) * 64 * height * 2;
+    uint64_t walls = 0;
+    for (size_t i = 0; i < getWordCount(); i++) {
+        walls += popcount(eastBits[i]) + popcount(southBits[i]);
+    }
+    return bits - walls;
+}
+
+bool MazeGrid::isPerfect() const {
+    if (countPassages() != getCellCount() - 1) {
+        return false;
+    }
+
+    // Sweep the rows keeping a union-find over the sets of cells connected
+    // so far. A set that does not continue into the next row can never
+    // reach the cells below it, so the maze is connected exactly when every
+    // set continues until the last row, where one set must remain.
+    std::vector<uint32_t> label(width);
+    std::vector<uint32_t> roots(width);
+    std::vector<uint32_t> parent(2 * static_cast<size_t>(width));
+    std::vector<uint32_t> remap(2 * static_cast<size_t>(width), NoLabel);
+    std::vector<uint8_t> continues(2 * static_cast<size_t>(width));
+    auto find = [&](uint32_t a) {
+        while (parent[a] != a) {
+            parent[a] = parent[parent[a]];
+            a = parent[a];
+        }
+        return a;
+    };
+    for (uint32_t x = 0; x < width; x++) {
+        label[x] = x;
+        parent[x] = x;
+    }
+
+    for (uint32_t z = 0; z < height; z++) {
+        for (uint32_t x = 0; x + 1 < width; x++) {
+            if (!hasEastWall(x, z)) {
+                uint32_t a = find(label[x]);
+                uint32_t b = find(label[x + 1]);
+                parent[a > b ? a : b] = a < b ? a : b;
+            }
+        }
+        for (uint32_t x = 0; x < width; x++) {
+            roots[x] = find(label[x]);
+        }
+        if (z + 1 == height) {
+            for (uint32_t x = 1; x < width; x++) {
+                if (roots[x] != roots[0]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        for (uint32_t x = 0; x < width; x++) {
+            continues[roots[x]] = 0;
+        }
+        for (uint32_t x = 0; x < width; x++) {
+            if (!hasSouthWall(x, z)) {
+                continues[roots[x]] = 1;
+            }
+        }
+        for (uint32_t x = 0; x < width; x++) {
+            if (!continues[roots[x]]) {
+                return false;
+            }
+        }
+
+        // Relabel the next row compactly: cells below an opening keep their
+        // set, the others start new ones.
+        uint32_t next = 0;
+        for (uint32_t x = 0; x < width; x++) {
+            if (!hasSouthWall(x, z)) {
+                if (remap[roots[x]] == NoLabel) {
+                    remap[roots[x]] = next++;
+                }
+                label[x] = remap[roots[x]];
+            } else {
+                label[x] = NoLabel;
+            }
+        }
+        for (uint32_t x = 0; x < width; x++) {
+            remap[roots[x]] = NoLabel;
+            if (label[x] == NoLabel) {
+                label[x] = next++;
+            }
+        }
+        for (uint32_t i = 0; i < next; i++) {
+            parent[i] = i;
+        }
+    }
+    return true;
+}
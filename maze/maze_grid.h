@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Walls of a rectangular grid maze, bit-packed: one bit for the wall on the
+// east (+x) side of each cell and one for the south (+z) side, so a cell
+// costs two bits and a 10000x10000 maze 25 MB. Each row starts on a new
+// 64-bit word, so regions whose columns start on a multiple of 64 own
+// whole words and can be carved from different threads. The outer border
+// is always walled; the east bit of the last column and the south bit of
+// the last row are kept set.
+class MazeGrid {
+public:
+    MazeGrid() = default;
+    // Every wall closed.
+    MazeGrid(uint32_t width, uint32_t height);
+    MazeGrid(const MazeGrid& other);
+    MazeGrid& operator=(const MazeGrid& other);
+    MazeGrid(MazeGrid&&) = default;
+    MazeGrid& operator=(MazeGrid&&) = default;
+
+    // Read-only grid over rows stored elsewhere, in the layout above (a
+    // mapped level file). The rows must outlive the grid, and the members
+    // that change walls must not be called on it; the writable row
+    // accessors return null.
+    static MazeGrid view(uint32_t width, uint32_t height, const uint64_t* eastRows, const uint64_t* southRows);
+    bool isView() const { return east.empty() && eastBits != nullptr; }
+
+    uint32_t getWidth() const { return width; }
+    uint32_t getHeight() const { return height; }
+    uint64_t getCellCount() const { return static_cast<uint64_t>(width) * height; }
+
+    bool hasEastWall(uint32_t x, uint32_t z) const { return testBit(eastBits, x, z); }
+    bool hasSouthWall(uint32_t x, uint32_t z) const { return testBit(southBits, x, z); }
+    bool hasWestWall(uint32_t x, uint32_t z) const { return x == 0 || hasEastWall(x - 1, z); }
+    bool hasNorthWall(uint32_t x, uint32_t z) const { return z == 0 || hasSouthWall(x, z - 1); }
+    // Opening the outer border is ignored.
+    void openEast(uint32_t x, uint32_t z);
+    void openSouth(uint32_t x, uint32_t z);
+    // For doors; the outer border is closed already.
+    void closeEast(uint32_t x, uint32_t z);
+    void closeSouth(uint32_t x, uint32_t z);
+
+    // Raw rows for row-at-a-time generators: bit x of the row is the wall
+    // of cell x.
+    uint64_t* eastRow(uint32_t z) { return east.data() + static_cast<size_t>(z) * rowWords; }
+    uint64_t* southRow(uint32_t z) { return south.data() + static_cast<size_t>(z) * rowWords; }
+    const uint64_t* eastRow(uint32_t z) const { return eastBits + static_cast<size_t>(z) * rowWords; }
+    const uint64_t* southRow(uint32_t z) const { return southBits + static_cast<size_t>(z) * rowWords; }
+    uint32_t getRowWords() const { return rowWords; }
+    size_t getWordCount() const { return static_cast<size_t>(rowWords) * height; }
+
+    uint64_t countPassages() const;
+    // A perfect maze has exactly one path between any two cells: it is
+    // connected and has cells - 1 passages. Checked row by row in O(width)
+    // memory, so it also works on the largest grids.
+    bool isPerfect() const;
+
+    // Owned bytes; 0 for views.
+    size_t memoryBytes() const { return (east.size() + south.size()) * sizeof(uint64_t); }
+
+private:
+    bool testBit(const uint64_t* bits, uint32_t x, uint32_t z) const {
+        return (bits[static_cast<size_t>(z) * rowWords + (x >> 6)] >> (x & 63)) & 1u;
+    }
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t rowWords = 0;
+    std::vector<uint64_t> east;
+    std::vector<uint64_t> south;
+    // The rows read: the vectors' data, or a view's external rows.
+    const uint64_t* eastBits = nullptr;
+    const uint64_t* southBits = nullptr;
+};
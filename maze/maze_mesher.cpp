@@ -0,0 +1,228 @@
+#include "maze_mesher.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Wall along z on grid line x = lineX, beside row z.
+bool hasWallAlongZ(const MazeGrid& grid, int64_t lineX, int64_t z) {
+    if (z < 0 || z >= grid.getHeight() || lineX < 0 || lineX > grid.getWidth()) {
+        return false;
+    }
+    if (lineX == 0 || lineX == grid.getWidth()) {
+        return true;
+    }
+    return grid.hasEastWall(static_cast<uint32_t>(lineX - 1), static_cast<uint32_t>(z));
+}
+
+// Wall along x on grid line z = lineZ, beside column x.
+bool hasWallAlongX(const MazeGrid& grid, int64_t x, int64_t lineZ) {
+    if (x < 0 || x >= grid.getWidth() || lineZ < 0 || lineZ > grid.getHeight()) {
+        return false;
+    }
+    if (lineZ == 0 || lineZ == grid.getHeight()) {
+        return true;
+    }
+    return grid.hasSouthWall(static_cast<uint32_t>(x), static_cast<uint32_t>(lineZ - 1));
+}
+
+// Column (i, j) of the post/wall/cell grid: even indices are grid lines,
+// odd ones cell interiors.
+bool isSolid(const MazeGrid& grid, int64_t i, int64_t j) {
+    int64_t x = i >> 1;
+    int64_t z = j >> 1;
+    bool onLineX = (i & 1) == 0;
+    bool onLineZ = (j & 1) == 0;
+    if (onLineX && onLineZ) {
+        return hasWallAlongZ(grid, x, z - 1) || hasWallAlongZ(grid, x, z) || hasWallAlongX(grid, x - 1, z) ||
+               hasWallAlongX(grid, x, z);
+    }
+    if (onLineX) {
+        return hasWallAlongZ(grid, x, z);
+    }
+    if (onLineZ) {
+        return hasWallAlongX(grid, x, z);
+    }
+    return false;
+}
+
+// Low edge of column i along its axis; column i spans [edge(i), edge(i + 1)].
+float columnEdge(int64_t i, const MazeMeshSettings& settings) {
+    float line = static_cast<float>(i >> 1) * settings.cellSize;
+    float half = settings.wallThickness * 0.5f;
+    return (i & 1) ? line + half : line - half;
+}
+
+glm::vec2 faceTexCoord(const glm::vec3& p, const glm::vec3& normal) {
+    if (normal.y != 0.0f) {
+        return glm::vec2(p.x, p.z);
+    }
+    if (normal.x != 0.0f) {
+        return glm::vec2(p.z, p.y);
+    }
+    return glm::vec2(p.x, p.y);
+}
+
+// Corners in order around the quad; the winding is flipped if needed so
+// the front face looks along the normal.
+void addQuad(MazeMeshChunk& chunk, glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3,
+             const glm::vec3& normal, const glm::vec3& origin) {
+    if (glm::dot(glm::cross(p1 - p0, p2 - p0), normal) < 0.0f) {
+        std::swap(p1, p3);
+    }
+    uint32_t base = static_cast<uint32_t>(chunk.vertices.size());
+    for (glm::vec3 p : {p0, p1, p2, p3}) {
+        p += origin;
+        Vertex vertex{};
+        vertex.position = p;
+        vertex.normal = normal;
+        vertex.texCoord = faceTexCoord(p, normal);
+        chunk.vertices.push_back(vertex);
+        chunk.bounds.grow(p);
+    }
+    for (uint32_t offset : {0u, 1u, 2u, 0u, 2u, 3u}) {
+        chunk.indices.push_back(base + offset);
+    }
+}
+
+} // namespace
+
+MazeMeshChunk buildMazeChunkMesh(const MazeGrid& grid, const MazeMeshSettings& settings, uint32_t chunkX,
+                                 uint32_t chunkZ) {
+    if (settings.chunkSize == 0) {
+        throw std::runtime_error("MazeMesher: chunk size must be positive");
+    }
+    MazeMeshChunk chunk;
+    chunk.chunkX = chunkX;
+    chunk.chunkZ = chunkZ;
+
+    uint64_t size = settings.chunkSize;
+    if (chunkX * size >= grid.getWidth() || chunkZ * size >= grid.getHeight()) {
+        throw std::runtime_error("MazeMesher: chunk outside the maze");
+    }
+    // Chunk c covers columns [2 c size, 2 (c + 1) size); the last chunk on
+    // each axis also takes the closing post line.
+    int64_t i0 = 2 * static_cast<int64_t>(chunkX * size);
+    int64_t j0 = 2 * static_cast<int64_t>(chunkZ * size);
+    int64_t i1 = (chunkX + 1) * size >= grid.getWidth() ? 2 * static_cast<int64_t>(grid.getWidth()) + 1
+                                                        : i0 + 2 * static_cast<int64_t>(size);
+    int64_t j1 = (chunkZ + 1) * size >= grid.getHeight() ? 2 * static_cast<int64_t>(grid.getHeight()) + 1
+                                                         : j0 + 2 * static_cast<int64_t>(size);
+
+    // The chunk's columns plus a one-column margin for the neighbour tests.
+    int64_t stride = i1 - i0 + 2;
+    std::vector<uint8_t> solid(static_cast<size_t>(stride * (j1 - j0 + 2)));
+    for (int64_t j = j0 - 1; j <= j1; j++) {
+        for (int64_t i = i0 - 1; i <= i1; i++) {
+            solid[(j - j0 + 1) * stride + (i - i0 + 1)] = isSolid(grid, i, j);
+        }
+    }
+    auto at = [&](int64_t i, int64_t j) { return solid[(j - j0 + 1) * stride + (i - i0 + 1)] != 0; };
+    float height = settings.wallHeight;
+
+    if (settings.floor) {
+        float x0 = static_cast<float>(chunkX) * settings.chunkSize * settings.cellSize;
+        float z0 = static_cast<float>(chunkZ) * settings.chunkSize * settings.cellSize;
+        float x1 = std::min<float>(static_cast<float>(chunkX + 1) * settings.chunkSize,
+                                   static_cast<float>(grid.getWidth())) * settings.cellSize;
+        float z1 = std::min<float>(static_cast<float>(chunkZ + 1) * settings.chunkSize,
+                                   static_cast<float>(grid.getHeight())) * settings.cellSize;
+        addQuad(chunk, {x0, 0.0f, z0}, {x1, 0.0f, z0}, {x1, 0.0f, z1}, {x0, 0.0f, z1}, {0.0f, 1.0f, 0.0f},
+                settings.origin);
+    }
+
+    // Tops: grow a rectangle along i, then along j while whole rows of it
+    // are solid and not yet covered.
+    std::vector<uint8_t> covered(solid.size());
+    auto isCovered = [&](int64_t i, int64_t j) { return covered[(j - j0 + 1) * stride + (i - i0 + 1)] != 0; };
+    for (int64_t j = j0; j < j1; j++) {
+        for (int64_t i = i0; i < i1; i++) {
+            if (!at(i, j) || isCovered(i, j)) {
+                continue;
+            }
+            int64_t iEnd = i + 1;
+            while (iEnd < i1 && at(iEnd, j) && !isCovered(iEnd, j)) {
+                iEnd++;
+            }
+            int64_t jEnd = j + 1;
+            for (; jEnd < j1; jEnd++) {
+                bool rowSolid = true;
+                for (int64_t k = i; k < iEnd && rowSolid; k++) {
+                    rowSolid = at(k, jEnd) && !isCovered(k, jEnd);
+                }
+                if (!rowSolid) {
+                    break;
+                }
+            }
+            for (int64_t b = j; b < jEnd; b++) {
+                std::fill_n(covered.begin() + (b - j0 + 1) * stride + (i - i0 + 1), iEnd - i, uint8_t(1));
+            }
+            float x0 = columnEdge(i, settings);
+            float x1 = columnEdge(iEnd, settings);
+            float z0 = columnEdge(j, settings);
+            float z1 = columnEdge(jEnd, settings);
+            addQuad(chunk, {x0, height, z0}, {x1, height, z0}, {x1, height, z1}, {x0, height, z1},
+                    {0.0f, 1.0f, 0.0f}, settings.origin);
+        }
+    }
+
+    // Sides: a solid column next to an empty one shows a face; consecutive
+    // faces on the same border merge into one quad.
+    for (int side = -1; side <= 1; side += 2) {
+        for (int64_t i = i0; i < i1; i++) {
+            float x = columnEdge(side > 0 ? i + 1 : i, settings);
+            for (int64_t j = j0; j < j1;) {
+                if (!at(i, j) || at(i + side, j)) {
+                    j++;
+                    continue;
+                }
+                int64_t jEnd = j + 1;
+                while (jEnd < j1 && at(i, jEnd) && !at(i + side, jEnd)) {
+                    jEnd++;
+                }
+                float z0 = columnEdge(j, settings);
+                float z1 = columnEdge(jEnd, settings);
+                addQuad(chunk, {x, 0.0f, z0}, {x, 0.0f, z1}, {x, height, z1}, {x, height, z0},
+                        {static_cast<float>(side), 0.0f, 0.0f}, settings.origin);
+                j = jEnd;
+            }
+        }
+        for (int64_t j = j0; j < j1; j++) {
+            float z = columnEdge(side > 0 ? j + 1 : j, settings);
+            for (int64_t i = i0; i < i1;) {
+                if (!at(i, j) || at(i, j + side)) {
+                    i++;
+                    continue;
+                }
+                int64_t iEnd = i + 1;
+                while (iEnd < i1 && at(iEnd, j) && !at(iEnd, j + side)) {
+                    iEnd++;
+                }
+                float x0 = columnEdge(i, settings);
+                float x1 = columnEdge(iEnd, settings);
+                addQuad(chunk, {x0, 0.0f, z}, {x1, 0.0f, z}, {x1, height, z}, {x0, height, z},
+                        {0.0f, 0.0f, static_cast<float>(side)}, settings.origin);
+                i = iEnd;
+            }
+        }
+    }
+    return chunk;
+}
+
+std::vector<MazeMeshChunk> buildMazeMeshes(const MazeGrid& grid, const MazeMeshSettings& settings,
+                                           ThreadPool& pool) {
+    if (settings.chunkSize == 0) {
+        throw std::runtime_error("MazeMesher: chunk size must be positive");
+    }
+    uint32_t chunksX = (grid.getWidth() + settings.chunkSize - 1) / settings.chunkSize;
+    uint32_t chunksZ = (grid.getHeight() + settings.chunkSize - 1) / settings.chunkSize;
+    std::vector<MazeMeshChunk> chunks(static_cast<size_t>(chunksX) * chunksZ);
+    pool.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            chunks[c] = buildMazeChunkMesh(grid, settings, static_cast<uint32_t>(c % chunksX),
+                                           static_cast<uint32_t>(c / chunksX));
+        }
+    });
+    return chunks;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Types.h"
+#include "bvh/aabb.h"
+#include "maze_grid.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+struct MazeMeshSettings {
+    float cellSize = 1.0f;
+    float wallHeight = 1.0f;
+    float wallThickness = 0.1f;
+    // Cells per chunk side.
+    uint32_t chunkSize = 32;
+    // One floor quad under each chunk.
+    bool floor = true;
+    // World position of the grid's corner, for grids holding only part of
+    // a larger maze.
+    glm::vec3 origin = glm::vec3(0.0f);
+};
+
+// Indexed geometry of one square chunk of the maze, in world space: cell
+// (x, z) spans origin + [x, x + 1] * cellSize on the floor plane.
+struct MazeMeshChunk {
+    uint32_t chunkX = 0;
+    uint32_t chunkZ = 0;
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    Aabb bounds;
+};
+
+// Walls sit on the cell borders, with a square post at each corner that
+// has a wall touching it. Seen from above, posts, wall segments and cell
+// interiors form a grid of (2w + 1) x (2h + 1) solid or empty columns, so
+// the wall geometry is that grid extruded to the wall height. Faces between
+// two solid columns are hidden and never emitted; the visible top faces are
+// merged into rectangles greedily and the side faces into runs along each
+// column border. A face belongs to the chunk holding its solid column and
+// merging stops at chunk borders. Normals are axis-aligned and texture
+// coordinates are world positions on the face plane, so textures tile
+// across merged quads.
+MazeMeshChunk buildMazeChunkMesh(const MazeGrid& grid, const MazeMeshSettings& settings, uint32_t chunkX,
+                                 uint32_t chunkZ);
+
+// Every chunk, row-major, built on the pool.
+std::vector<MazeMeshChunk> buildMazeMeshes(const MazeGrid& grid, const MazeMeshSettings& settings,
+                                           ThreadPool& pool);
@@ -0,0 +1,50 @@
+#include "maze_world.h"
+#include <algorithm>
+#include <stdexcept>
+
+MazeWorld::MazeWorld(uint32_t width, uint32_t height, uint32_t chunkSize, uint64_t seed, MazeAlgorithm algorithm)
+    : width(width), height(height), chunkSize(chunkSize), seed(seed), algorithm(algorithm) {
+    if (width == 0 || height == 0 || chunkSize == 0) {
+        throw std::runtime_error("MazeWorld: size and chunk size must be positive");
+    }
+    if (algorithm == MazeAlgorithm::Eller && chunkSize % 64 != 0) {
+        throw std::runtime_error("MazeWorld: Eller chunks must be a multiple of 64 cells wide");
+    }
+    chunksX = (width + chunkSize - 1) / chunkSize;
+    chunksZ = (height + chunkSize - 1) / chunkSize;
+}
+
+MazeGrid MazeWorld::generate(uint32_t chunkX0, uint32_t chunkZ0, uint32_t chunkX1, uint32_t chunkZ1) const {
+    if (chunkX0 >= chunkX1 || chunkZ0 >= chunkZ1 || chunkX1 > chunksX || chunkZ1 > chunksZ) {
+        throw std::runtime_error("MazeWorld: chunk range outside the world");
+    }
+    uint32_t x0 = chunkX0 * chunkSize;
+    uint32_t z0 = chunkZ0 * chunkSize;
+    MazeGrid grid(std::min(width, chunkX1 * chunkSize) - x0, std::min(height, chunkZ1 * chunkSize) - z0);
+
+    for (uint32_t cz = chunkZ0; cz < chunkZ1; cz++) {
+        for (uint32_t cx = chunkX0; cx < chunkX1; cx++) {
+            uint64_t chunkIndex = static_cast<uint64_t>(cz) * chunksX + cx;
+            MazeRegion region;
+            region.x0 = cx * chunkSize - x0;
+            region.z0 = cz * chunkSize - z0;
+            region.x1 = std::min(width, (cx + 1) * chunkSize) - x0;
+            region.z1 = std::min(height, (cz + 1) * chunkSize) - z0;
+            uint64_t chunkSeed = deriveMazeSeed(seed, chunkIndex);
+            carveMaze(grid, region, algorithm, chunkSeed);
+
+            if (cx == 0 && cz == 0) {
+                continue;
+            }
+            uint64_t link = deriveMazeSeed(chunkSeed, 1);
+            bool west = cz == 0 || (cx != 0 && (link & 1));
+            uint32_t offset = static_cast<uint32_t>(link >> 32);
+            if (west && cx > chunkX0) {
+                grid.openEast(region.x0 - 1, region.z0 + offset % (region.z1 - region.z0));
+            } else if (!west && cz > chunkZ0) {
+                grid.openSouth(region.x0 + offset % (region.x1 - region.x0), region.z0 - 1);
+            }
+        }
+    }
+    return grid;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "maze_generator.h"
+#include <cstdint>
+
+// A maze too large to hold, described by its size and seed and generated a
+// few chunks at a time. Each chunk is carved on its own from a seed derived
+// from its index, with its borders closed; chunks are then joined along a
+// spanning tree in which every chunk opens into its west or north
+// neighbour (chosen by hash, and always towards chunk (0, 0) on the first
+// row and column). Every link depends only on the chunk itself, so any
+// block of chunks can be generated without the rest, and the whole world
+// is a perfect maze.
+class MazeWorld {
+public:
+    // Eller's algorithm needs a chunk size that is a multiple of 64.
+    MazeWorld(uint32_t width, uint32_t height, uint32_t chunkSize, uint64_t seed,
+              MazeAlgorithm algorithm = MazeAlgorithm::Backtracker);
+
+    uint32_t getWidth() const { return width; }
+    uint32_t getHeight() const { return height; }
+    uint32_t getChunkSize() const { return chunkSize; }
+    uint32_t getChunksX() const { return chunksX; }
+    uint32_t getChunksZ() const { return chunksZ; }
+
+    // Walls of chunks [chunkX0, chunkX1) x [chunkZ0, chunkZ1), in a grid
+    // whose cell (0, 0) is cell (chunkX0, chunkZ0) * chunkSize of the world.
+    // Links to chunks outside the block are left closed.
+    MazeGrid generate(uint32_t chunkX0, uint32_t chunkZ0, uint32_t chunkX1, uint32_t chunkZ1) const;
+
+private:
+    uint32_t width;
+    uint32_t height;
+    uint32_t chunkSize;
+    uint32_t chunksX;
+    uint32_t chunksZ;
+    uint64_t seed;
+    MazeAlgorithm algorithm;
+};
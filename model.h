@@ -7,37 +7,42 @@
 
 class Model {
 public:
-    Model(VkDevice device, VkPhysicalDevice physicalDevice, 
-          VkCommandPool commandPool, VkQueue graphicsQueue,
-          const std::string& modelPath);
+    // Takes ownership of device buffers filled elsewhere (see AssetManager);
+    // indexBuffer may be VK_NULL_HANDLE. vertices and indices are the CPU
+    // copy GetVertices and GetIndices return and may be empty.
+    Model(VkDevice device, VkBuffer vertexBuffer, VkDeviceMemory vertexBufferMemory, uint32_t vertexCount,
+          VkBuffer indexBuffer, VkDeviceMemory indexBufferMemory, uint32_t indexCount,
+          std::vector<Vertex> vertices = {}, std::vector<uint32_t> indices = {});
     ~Model();
 
+    Model(const Model&) = delete;
+    Model& operator=(const Model&) = delete;
+
+    // Parses an OBJ file into consecutive triangles. Touches no Vulkan
+    // state, so it may run on any thread.
+    static std::vector<Vertex> loadObj(const std::string& modelPath);
+
     void draw(VkCommandBuffer commandBuffer);
+    // Draws instanceCount copies using the per-instance matrices bound at
+    // binding 1, starting at firstInstance (see VulkanContext::pushInstances).
+    void drawInstanced(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance);
     void updateUniformBuffer(const glm::mat4& view, const glm::mat4& projection, const glm::mat4& model);
 
     const std::vector<Vertex>& GetVertices() const { return vertices; }
     const std::vector<uint32_t>& GetIndices() const { return indices; }
 
 private:
-    void loadModel(const std::string& modelPath);
-    void createVertexBuffer(VkPhysicalDevice physicalDevice);
-    void createBuffer(VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage,
-                     VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-    uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
-    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
-
     VkDevice device;
-    VkPhysicalDevice physicalDevice;
-    VkCommandPool commandPool;
-    VkQueue graphicsQueue;
 
     std::vector<Vertex> vertices;
     std::vector<uint32_t> indices;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
 
-    VkBuffer vertexBuffer;
-    VkDeviceMemory vertexBufferMemory;
-    VkBuffer indexBuffer;
-    VkDeviceMemory indexBufferMemory;
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
     VkBuffer uniformBuffer;
     VkDeviceMemory uniformBufferMemory;
     void* uniformBufferMapped;
@@ -0,0 +1,104 @@
+#include "distance_field.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t FrontierGrain = 2048;
+
+// Appends the open neighbours of `cell` that have no distance yet.
+template <typename Out>
+void expandCell(const MazeGrid& grid, const std::vector<uint16_t>& values, uint32_t cell, Out&& out) {
+    uint32_t width = grid.getWidth();
+    uint32_t x = cell % width;
+    uint32_t z = cell / width;
+    if (!grid.hasEastWall(x, z) && values[cell + 1] == DistanceField::Unreachable) {
+        out(cell + 1);
+    }
+    if (!grid.hasSouthWall(x, z) && values[cell + width] == DistanceField::Unreachable) {
+        out(cell + width);
+    }
+    if (!grid.hasWestWall(x, z) && values[cell - 1] == DistanceField::Unreachable) {
+        out(cell - 1);
+    }
+    if (!grid.hasNorthWall(x, z) && values[cell - width] == DistanceField::Unreachable) {
+        out(cell - width);
+    }
+}
+
+} // namespace
+
+void DistanceField::build(const MazeGrid& grid, uint32_t goalCell, ThreadPool& pool) {
+    if (goalCell >= grid.getCellCount()) {
+        throw std::runtime_error("DistanceField: goal outside the grid");
+    }
+    goal = goalCell;
+    values.assign(grid.getCellCount(), Unreachable);
+    values[goal] = 0;
+    frontier.assign(1, goal);
+    maxDistance = 0;
+
+    for (uint32_t distance = 1; !frontier.empty(); distance++) {
+        uint16_t value = static_cast<uint16_t>(distance % Period);
+        nextFrontier.clear();
+        if (frontier.size() <= FrontierGrain || pool.getThreadCount() == 1) {
+            for (uint32_t cell : frontier) {
+                expandCell(grid, values, cell, [&](uint32_t next) {
+                    values[next] = value;
+                    nextFrontier.push_back(next);
+                });
+            }
+        } else {
+            // Candidates only read the field; claiming them afterwards in
+            // chunk order drops cells reached from two frontier cells.
+            size_t chunkCount = (frontier.size() + FrontierGrain - 1) / FrontierGrain;
+            if (chunks.size() < chunkCount) {
+                chunks.resize(chunkCount);
+            }
+            pool.parallelFor(frontier.size(), FrontierGrain, [&](size_t begin, size_t end) {
+                FrontierChunk& chunk = chunks[begin / FrontierGrain];
+                chunk.candidates.clear();
+                for (size_t i = begin; i < end; i++) {
+                    expandCell(grid, values, frontier[i], [&](uint32_t next) { chunk.candidates.push_back(next); });
+                }
+            });
+            for (size_t c = 0; c < chunkCount; c++) {
+                for (uint32_t next : chunks[c].candidates) {
+                    if (values[next] == Unreachable) {
+                        values[next] = value;
+                        nextFrontier.push_back(next);
+                    }
+                }
+            }
+        }
+        if (!nextFrontier.empty()) {
+            maxDistance = distance;
+        }
+        frontier.swap(nextFrontier);
+    }
+}
+
+uint32_t DistanceField::nextStep(const MazeGrid& grid, uint32_t cell) const {
+    uint16_t value = values[cell];
+    if (cell == goal || value == Unreachable) {
+        return NoMazeCell;
+    }
+    uint16_t closer = static_cast<uint16_t>((value + Period - 1) % Period);
+    uint32_t width = grid.getWidth();
+    uint32_t x = cell % width;
+    uint32_t z = cell / width;
+    if (!grid.hasEastWall(x, z) && values[cell + 1] == closer) {
+        return cell + 1;
+    }
+    if (!grid.hasSouthWall(x, z) && values[cell + width] == closer) {
+        return cell + width;
+    }
+    if (!grid.hasWestWall(x, z) && values[cell - 1] == closer) {
+        return cell - 1;
+    }
+    if (!grid.hasNorthWall(x, z) && values[cell - width] == closer) {
+        return cell - width;
+    }
+    return NoMazeCell;
+}
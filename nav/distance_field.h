@@ -0,0 +1,52 @@
+#pragma once
+
+#include "maze/maze_grid.h"
+#include "maze_pathfinder.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// BFS distance from every cell to one goal, two bytes per cell, for O(1)
+// hints: the next step towards the goal from anywhere is a table lookup
+// and four wall tests. Distances are stored modulo Period, so mazes whose
+// paths run longer than 16 bits allow still fit. Adjacent reachable cells
+// differ by exactly one step, which is all nextStep needs; getDistance is
+// exact only while isExact() holds.
+class DistanceField {
+public:
+    static constexpr uint16_t Unreachable = UINT16_MAX;
+    static constexpr uint32_t Period = UINT16_MAX;
+
+    // Level-synchronous BFS. Wide frontiers are expanded on the pool, each
+    // chunk of the frontier collecting candidate cells that are then
+    // claimed in chunk order, so the field does not depend on the thread
+    // count. Maze frontiers are often narrow; those levels run serially.
+    void build(const MazeGrid& grid, uint32_t goal, ThreadPool& pool);
+
+    uint32_t getGoal() const { return goal; }
+    uint16_t getValue(uint32_t cell) const { return values[cell]; }
+    bool isReachable(uint32_t cell) const { return values[cell] != Unreachable; }
+    uint32_t getDistance(uint32_t cell) const { return values[cell]; }
+    // No reachable cell is Period or more steps from the goal.
+    bool isExact() const { return maxDistance < Period; }
+    uint32_t getMaxDistance() const { return maxDistance; }
+
+    // The open neighbour one step closer to the goal, or NoMazeCell at the
+    // goal and in unreachable cells.
+    uint32_t nextStep(const MazeGrid& grid, uint32_t cell) const;
+
+    size_t memoryBytes() const { return values.size() * sizeof(uint16_t); }
+
+private:
+    struct FrontierChunk {
+        std::vector<uint32_t> candidates;
+    };
+
+    std::vector<uint16_t> values;
+    std::vector<uint32_t> frontier;
+    std::vector<uint32_t> nextFrontier;
+    std::vector<FrontierChunk> chunks;
+    uint32_t goal = NoMazeCell;
+    uint32_t maxDistance = 0;
+};
@@ -0,0 +1,91 @@
+#include "flow_field.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+
+FlowField::Direction directionTo(uint32_t from, uint32_t to, uint32_t width) {
+    if (to == from + 1) {
+        return FlowField::East;
+    }
+    if (to == from + width) {
+        return FlowField::South;
+    }
+    return to + 1 == from ? FlowField::West : FlowField::North;
+}
+
+} // namespace
+
+void FlowField::build(const MazeGrid& grid, uint32_t targetCell, ThreadPool& pool) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    distances.build(grid, targetCell, pool);
+    width = grid.getWidth();
+    target = targetCell;
+    tree = grid.isPerfect();
+    directions.resize(grid.getCellCount());
+
+    size_t rowGrain = std::max<size_t>(1, 65536 / width);
+    pool.parallelFor(grid.getHeight(), rowGrain, [&](size_t begin, size_t end) {
+        for (size_t z = begin; z < end; z++) {
+            uint32_t rowStart = static_cast<uint32_t>(z * width);
+            for (uint32_t cell = rowStart; cell < rowStart + width; cell++) {
+                uint32_t next = distances.nextStep(grid, cell);
+                directions[cell] = next == NoMazeCell ? None : directionTo(cell, next, width);
+            }
+        }
+    });
+
+    stats.changedCells = directions.size();
+    stats.builds++;
+    stats.updateMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void FlowField::setTarget(const MazeGrid& grid, uint32_t targetCell, ThreadPool& pool) {
+    if (targetCell >= grid.getCellCount()) {
+        throw std::runtime_error("FlowField: target outside the grid");
+    }
+    if (directions.empty() || !tree) {
+        build(grid, targetCell, pool);
+        return;
+    }
+    auto startTime = std::chrono::high_resolution_clock::now();
+    if (targetCell == target) {
+        stats.changedCells = 0;
+    } else {
+        // Path from the new target down the tree to the old one.
+        path.clear();
+        uint32_t cell = targetCell;
+        while (cell != target) {
+            if (cell == NoMazeCell) {
+                // Not connected to the old target: no tree to re-root.
+                build(grid, targetCell, pool);
+                return;
+            }
+            path.push_back(cell);
+            cell = nextCell(cell);
+        }
+        path.push_back(target);
+        for (size_t i = path.size() - 1; i > 0; i--) {
+            directions[path[i]] = directionTo(path[i], path[i - 1], width);
+        }
+        directions[targetCell] = None;
+        target = targetCell;
+        stats.changedCells = path.size();
+        stats.reroots++;
+    }
+    stats.updateMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+uint32_t FlowField::nextCell(uint32_t cell) const {
+    switch (directions[cell]) {
+    case East: return cell + 1;
+    case South: return cell + width;
+    case West: return cell - 1;
+    case North: return cell - width;
+    default: return NoMazeCell;
+    }
+}
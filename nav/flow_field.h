@@ -0,0 +1,57 @@
+#pragma once
+
+#include "distance_field.h"
+#include "maze/maze_grid.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+struct FlowFieldStats {
+    // Cost of the last build or setTarget call.
+    double updateMs = 0.0;
+    // Cells whose direction the last update changed (all cells on a build).
+    uint64_t changedCells = 0;
+    uint64_t builds = 0;
+    uint64_t reroots = 0;
+};
+
+// One step towards a target from every cell of a maze, one byte per cell,
+// so any number of agents chasing the same target look up their way in
+// O(1) instead of running a search each. Built from a BFS wavefront out of
+// the target (DistanceField, parallel on wide frontiers), then each cell's
+// direction from the distances, in parallel over rows.
+//
+// On a perfect maze the directions form a tree rooted at the target, and
+// moving the target only re-roots it: the directions along the path from
+// the new target to the old one reverse and nothing else changes. setTarget
+// does exactly that, at the cost of the path length, which for a target
+// walking cell to cell is a single cell. Mazes with loops are rebuilt. Call
+// build again after changing the grid's walls.
+class FlowField {
+public:
+    enum Direction : uint8_t { East, South, West, North, None };
+
+    void build(const MazeGrid& grid, uint32_t target, ThreadPool& pool);
+    void setTarget(const MazeGrid& grid, uint32_t target, ThreadPool& pool);
+
+    uint32_t getTarget() const { return target; }
+    bool empty() const { return directions.empty(); }
+    // None at the target and in cells the target cannot be reached from.
+    Direction getDirection(uint32_t cell) const { return static_cast<Direction>(directions[cell]); }
+    // NoMazeCell where the direction is None.
+    uint32_t nextCell(uint32_t cell) const;
+    bool isTree() const { return tree; }
+
+    const FlowFieldStats& getStats() const { return stats; }
+    size_t memoryBytes() const { return directions.size() + distances.memoryBytes(); }
+
+private:
+    std::vector<uint8_t> directions;
+    DistanceField distances;
+    std::vector<uint32_t> path;
+    uint32_t width = 0;
+    uint32_t target = NoMazeCell;
+    bool tree = false;
+    FlowFieldStats stats;
+};
@@ -0,0 +1,95 @@
+#include "flow_steering.h"
+#include "core/thread_pool.h"
+#include "physics/physics_world.h"
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+constexpr size_t AgentGrain = 256;
+
+} // namespace
+
+FlowSteering::FlowSteering(const MazeGrid& grid, const FlowSteeringSettings& settings)
+    : grid(grid), settings(settings) {}
+
+uint32_t FlowSteering::cellAt(const glm::vec3& position) const {
+    float x = std::floor((position.x - settings.origin.x) / settings.cellSize);
+    float z = std::floor((position.z - settings.origin.z) / settings.cellSize);
+    if (!(x >= 0.0f && z >= 0.0f && x < static_cast<float>(grid.getWidth()) &&
+          z < static_cast<float>(grid.getHeight()))) {
+        return NoMazeCell;
+    }
+    return static_cast<uint32_t>(z) * grid.getWidth() + static_cast<uint32_t>(x);
+}
+
+glm::vec3 FlowSteering::cellCenter(uint32_t cell) const {
+    float x = static_cast<float>(cell % grid.getWidth()) + 0.5f;
+    float z = static_cast<float>(cell / grid.getWidth()) + 0.5f;
+    return settings.origin + glm::vec3(x, 0.0f, z) * settings.cellSize;
+}
+
+void FlowSteering::update(PhysicsWorld& world, const std::vector<uint32_t>& agents, const glm::vec3& targetPosition,
+                          ThreadPool& pool) {
+    uint32_t targetCell = cellAt(targetPosition);
+    if (targetCell != NoMazeCell) {
+        if (field.empty()) {
+            field.build(grid, targetCell, pool);
+        } else {
+            field.setTarget(grid, targetCell, pool);
+        }
+    }
+    stats.fieldMs = field.empty() ? 0.0 : field.getStats().updateMs;
+    if (field.empty()) {
+        stats.steerMs = 0.0;
+        stats.steeredAgents = 0;
+        stats.lostAgents = static_cast<uint32_t>(agents.size());
+        return;
+    }
+
+    auto steerStart = std::chrono::high_resolution_clock::now();
+    float dt = world.getSettings().timeStep;
+    impulses.resize(agents.size());
+    pool.parallelFor(agents.size(), AgentGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const RigidBody& body = world.getBody(agents[i]);
+            impulses[i] = glm::vec3(0.0f);
+            uint32_t cell = cellAt(body.position);
+            if (body.inverseMass == 0.0f || cell == NoMazeCell) {
+                continue;
+            }
+            glm::vec3 goal;
+            if (cell == field.getTarget()) {
+                goal = targetPosition;
+            } else {
+                uint32_t next = field.nextCell(cell);
+                if (next == NoMazeCell) {
+                    continue;
+                }
+                goal = cellCenter(next);
+            }
+            glm::vec3 toGoal(goal.x - body.position.x, 0.0f, goal.z - body.position.z);
+            float distance = glm::length(toGoal);
+            glm::vec3 desired = distance > 1e-4f ? toGoal * (settings.maxSpeed / distance) : glm::vec3(0.0f);
+            glm::vec3 error = desired - glm::vec3(body.velocity.x, 0.0f, body.velocity.z);
+            glm::vec3 force = error * (settings.responsiveness / body.inverseMass);
+            float magnitude = glm::length(force);
+            if (magnitude > settings.maxForce) {
+                force *= settings.maxForce / magnitude;
+            }
+            impulses[i] = force * dt;
+        }
+    });
+
+    uint32_t steered = 0;
+    for (size_t i = 0; i < agents.size(); i++) {
+        if (impulses[i] != glm::vec3(0.0f)) {
+            world.applyImpulse(agents[i], impulses[i]);
+            steered++;
+        }
+    }
+    stats.steeredAgents = steered;
+    stats.lostAgents = static_cast<uint32_t>(agents.size()) - steered;
+    stats.steerMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - steerStart).count();
+}
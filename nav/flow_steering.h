@@ -0,0 +1,67 @@
+#pragma once
+
+#include "flow_field.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+class PhysicsWorld;
+class ThreadPool;
+
+struct FlowSteeringSettings {
+    // Placement of the maze, as in MazeMeshSettings: cell (x, z) spans
+    // origin + [x, x + 1] * cellSize on the floor plane.
+    float cellSize = 1.0f;
+    glm::vec3 origin = glm::vec3(0.0f);
+    // Horizontal speed the agents try to reach, in m/s.
+    float maxSpeed = 3.0f;
+    // Fraction of the velocity error corrected per second.
+    float responsiveness = 4.0f;
+    // Newtons. Steering never pushes harder, so heavier agents accelerate
+    // more slowly and contacts still win against it.
+    float maxForce = 10.0f;
+};
+
+struct FlowSteeringStats {
+    // Flow field update (re-root or rebuild) of the last update call.
+    double fieldMs = 0.0;
+    // Sampling the field and computing the forces.
+    double steerMs = 0.0;
+    uint32_t steeredAgents = 0;
+    // Agents left without a push: outside the maze, immovable, or in cells
+    // cut off from the target.
+    uint32_t lostAgents = 0;
+};
+
+// Steers physics bodies through a maze towards one target with a shared
+// FlowField. Each agent looks up the cell it is in and heads for the centre
+// of the next cell on the way; on the target's cell it heads for the
+// target itself. The force pulls the horizontal velocity towards maxSpeed
+// in that direction and is applied as an impulse of force * timeStep, so
+// call update once before every physics step.
+class FlowSteering {
+public:
+    // The grid must outlive the steering.
+    explicit FlowSteering(const MazeGrid& grid, const FlowSteeringSettings& settings = FlowSteeringSettings());
+
+    // Moves the field's target to the cell under targetPosition, then
+    // pushes the agents. Forces are computed on the pool and applied in
+    // agent order, so results do not depend on the thread count.
+    void update(PhysicsWorld& world, const std::vector<uint32_t>& agents, const glm::vec3& targetPosition,
+                ThreadPool& pool);
+
+    // NoMazeCell outside the maze.
+    uint32_t cellAt(const glm::vec3& position) const;
+    glm::vec3 cellCenter(uint32_t cell) const;
+
+    const FlowField& getField() const { return field; }
+    const FlowSteeringSettings& getSettings() const { return settings; }
+    const FlowSteeringStats& getStats() const { return stats; }
+
+private:
+    const MazeGrid& grid;
+    FlowSteeringSettings settings;
+    FlowField field;
+    std::vector<glm::vec3> impulses;
+    FlowSteeringStats stats;
+};
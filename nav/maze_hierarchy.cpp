@@ -0,0 +1,451 @@
+#include "maze_hierarchy.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint8_t EntranceFlag = 1;
+constexpr uint8_t RemovedFlag = 2;
+
+bool heapAfter(uint32_t fA, uint32_t hA, uint32_t fB, uint32_t hB) {
+    return fA != fB ? fA > fB : hA > hB;
+}
+
+// Calls fn(neighbourCell) for each open neighbour of (x, z) inside region.
+template <typename Fn>
+void forEachRegionNeighbour(const MazeGrid& grid, const MazeRegion& region, uint32_t x, uint32_t z, Fn&& fn) {
+    uint32_t width = grid.getWidth();
+    uint32_t cell = z * width + x;
+    if (x + 1 < region.x1 && !grid.hasEastWall(x, z)) {
+        fn(cell + 1);
+    }
+    if (z + 1 < region.z1 && !grid.hasSouthWall(x, z)) {
+        fn(cell + width);
+    }
+    if (x > region.x0 && !grid.hasWestWall(x, z)) {
+        fn(cell - 1);
+    }
+    if (z > region.z0 && !grid.hasNorthWall(x, z)) {
+        fn(cell - width);
+    }
+}
+
+} // namespace
+
+MazeHierarchy::MazeHierarchy(const MazeGrid& grid, uint32_t clusterSize, ThreadPool& pool)
+    : grid(grid), clusterSize(clusterSize) {
+    if (clusterSize == 0) {
+        throw std::runtime_error("MazeHierarchy: cluster size must not be 0");
+    }
+    if (grid.getCellCount() >= NoMazeCell) {
+        throw std::runtime_error("MazeHierarchy: grid too large for 32-bit cell indices");
+    }
+    auto startTime = std::chrono::high_resolution_clock::now();
+    clustersX = (grid.getWidth() + clusterSize - 1) / clusterSize;
+    clustersZ = (grid.getHeight() + clusterSize - 1) / clusterSize;
+    clusters.resize(static_cast<size_t>(clustersX) * clustersZ);
+    pool.parallelFor(clusters.size(), 16, [&](size_t begin, size_t end) {
+        BuildScratch scratch;
+        for (size_t c = begin; c < end; c++) {
+            buildCluster(static_cast<uint32_t>(c), scratch);
+        }
+    });
+    updateTotals();
+    stats.buildMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+MazeRegion MazeHierarchy::clusterRegion(uint32_t cluster) const {
+    MazeRegion region;
+    region.x0 = (cluster % clustersX) * clusterSize;
+    region.z0 = (cluster / clustersX) * clusterSize;
+    region.x1 = std::min(region.x0 + clusterSize, grid.getWidth());
+    region.z1 = std::min(region.z0 + clusterSize, grid.getHeight());
+    return region;
+}
+
+uint32_t MazeHierarchy::clusterOf(uint32_t cell) const {
+    uint32_t width = grid.getWidth();
+    return (cell / width / clusterSize) * clustersX + (cell % width) / clusterSize;
+}
+
+void MazeHierarchy::buildCluster(uint32_t clusterIndex, BuildScratch& scratch) {
+    MazeRegion region = clusterRegion(clusterIndex);
+    uint32_t width = grid.getWidth();
+    uint32_t regionWidth = region.x1 - region.x0;
+    uint32_t regionHeight = region.z1 - region.z0;
+    uint32_t localCount = regionWidth * regionHeight;
+    // Everything below works on local indices and a mask of the openings
+    // that stay inside the cluster (bit d for direction d).
+    const int32_t offsets[4] = {1, static_cast<int32_t>(regionWidth), -1, -static_cast<int32_t>(regionWidth)};
+
+    scratch.open.resize(localCount);
+    scratch.degree.resize(localCount);
+    scratch.flags.resize(localCount);
+    for (uint32_t lz = 0; lz < regionHeight; lz++) {
+        uint32_t z = region.z0 + lz;
+        for (uint32_t lx = 0; lx < regionWidth; lx++) {
+            uint32_t x = region.x0 + lx;
+            bool east = !grid.hasEastWall(x, z);
+            bool south = !grid.hasSouthWall(x, z);
+            bool west = !grid.hasWestWall(x, z);
+            bool north = !grid.hasNorthWall(x, z);
+            uint8_t mask = static_cast<uint8_t>((east && lx + 1 < regionWidth) | (south && lz + 1 < regionHeight) << 1 |
+                                                (west && lx > 0) << 2 | (north && lz > 0) << 3);
+            // Entrances open onto another cluster.
+            bool exits = (east && lx + 1 == regionWidth) || (south && lz + 1 == regionHeight) || (west && lx == 0) ||
+                         (north && lz == 0);
+            uint32_t local = lz * regionWidth + lx;
+            scratch.open[local] = mask;
+            scratch.degree[local] = static_cast<uint8_t>((mask & 1) + (mask >> 1 & 1) + (mask >> 2 & 1) + (mask >> 3));
+            scratch.flags[local] = exits ? EntranceFlag : 0;
+        }
+    }
+
+    // Prune dead ends back to the nearest junction or entrance. Cells are
+    // flagged when queued, so each is queued once.
+    scratch.queue.clear();
+    for (uint32_t local = 0; local < localCount; local++) {
+        if (!scratch.flags[local] && scratch.degree[local] <= 1) {
+            scratch.flags[local] = RemovedFlag;
+            scratch.queue.push_back(local);
+        }
+    }
+    for (size_t head = 0; head < scratch.queue.size(); head++) {
+        uint32_t local = scratch.queue[head];
+        for (int d = 0; d < 4; d++) {
+            if (!(scratch.open[local] >> d & 1)) {
+                continue;
+            }
+            uint32_t next = local + offsets[d];
+            if (scratch.flags[next] & RemovedFlag) {
+                continue;
+            }
+            scratch.degree[next]--;
+            if (!scratch.flags[next] && scratch.degree[next] <= 1) {
+                scratch.flags[next] = RemovedFlag;
+                scratch.queue.push_back(next);
+            }
+        }
+    }
+
+    // Nodes: entrances and junctions left after pruning, in cell order.
+    Cluster& cluster = clusters[clusterIndex];
+    cluster.cells.clear();
+    scratch.nodeIndex.assign(localCount, NoMazeCell);
+    for (uint32_t local = 0; local < localCount; local++) {
+        bool kept = !(scratch.flags[local] & RemovedFlag);
+        if (kept && (scratch.flags[local] & EntranceFlag || scratch.degree[local] >= 3)) {
+            scratch.nodeIndex[local] = static_cast<uint32_t>(cluster.cells.size());
+            cluster.cells.push_back((region.z0 + local / regionWidth) * width + region.x0 + local % regionWidth);
+        }
+    }
+
+    // Edges: follow each corridor out of a node until the next node. Cells
+    // in between have exactly two neighbours left.
+    cluster.edgeStart.assign(cluster.cells.size() + 1, 0);
+    cluster.edges.clear();
+    for (uint32_t local = 0; local < localCount; local++) {
+        uint32_t node = scratch.nodeIndex[local];
+        if (node == NoMazeCell) {
+            continue;
+        }
+        for (int d = 0; d < 4; d++) {
+            if (!(scratch.open[local] >> d & 1) || scratch.flags[local + offsets[d]] & RemovedFlag) {
+                continue;
+            }
+            uint32_t cell = local + offsets[d];
+            // Direction back to the previous cell.
+            int back = (d + 2) & 3;
+            uint32_t length = 1;
+            while (scratch.nodeIndex[cell] == NoMazeCell) {
+                int forward = 0;
+                while (forward == back || !(scratch.open[cell] >> forward & 1) ||
+                       scratch.flags[cell + offsets[forward]] & RemovedFlag) {
+                    forward++;
+                }
+                cell += offsets[forward];
+                back = (forward + 2) & 3;
+                length++;
+            }
+            // Loops back to the same node are never shorter.
+            if (cell != local) {
+                cluster.edges.push_back({scratch.nodeIndex[cell], length});
+            }
+        }
+        cluster.edgeStart[node + 1] = static_cast<uint32_t>(cluster.edges.size());
+    }
+}
+
+void MazeHierarchy::updateTotals() {
+    nodeOffset.resize(clusters.size() + 1);
+    uint64_t nodes = 0;
+    uint64_t edges = 0;
+    for (size_t c = 0; c < clusters.size(); c++) {
+        nodeOffset[c] = static_cast<uint32_t>(nodes);
+        nodes += clusters[c].cells.size();
+        edges += clusters[c].edges.size();
+    }
+    nodeOffset[clusters.size()] = static_cast<uint32_t>(nodes);
+    totalNodes = static_cast<uint32_t>(nodes);
+    // Two more for the start and goal of a query. Stamps of earlier
+    // queries are stale whichever node they now belong to.
+    cost.resize(totalNodes + 2);
+    parent.resize(totalNodes + 2);
+    stamp.resize(totalNodes + 2, 0);
+    stats.clusterCount = static_cast<uint32_t>(clusters.size());
+    stats.nodeCount = nodes;
+    stats.edgeCount = edges;
+}
+
+uint32_t MazeHierarchy::wallsChanged(const MazeRegion& region, ThreadPool& pool) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    // An east or south wall also belongs to the cell beyond it.
+    uint32_t cx0 = region.x0 / clusterSize;
+    uint32_t cz0 = region.z0 / clusterSize;
+    uint32_t cx1 = std::min(region.x1, grid.getWidth() - 1) / clusterSize;
+    uint32_t cz1 = std::min(region.z1, grid.getHeight() - 1) / clusterSize;
+    std::vector<uint32_t> dirty;
+    for (uint32_t cz = cz0; cz <= cz1; cz++) {
+        for (uint32_t cx = cx0; cx <= cx1; cx++) {
+            dirty.push_back(cz * clustersX + cx);
+        }
+    }
+    pool.parallelFor(dirty.size(), 1, [&](size_t begin, size_t end) {
+        BuildScratch scratch;
+        for (size_t i = begin; i < end; i++) {
+            buildCluster(dirty[i], scratch);
+        }
+    });
+    updateTotals();
+    stats.rebuiltClusters = static_cast<uint32_t>(dirty.size());
+    stats.updateMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    return stats.rebuiltClusters;
+}
+
+void MazeHierarchy::clusterSearch(const MazeRegion& region, uint32_t from, uint32_t to,
+                                  std::vector<uint32_t>& distance, std::vector<uint32_t>& parentOut) {
+    uint32_t width = grid.getWidth();
+    uint32_t regionWidth = region.x1 - region.x0;
+    auto localOf = [&](uint32_t cell) { return (cell / width - region.z0) * regionWidth + cell % width - region.x0; };
+    distance.assign(static_cast<size_t>(regionWidth) * (region.z1 - region.z0), NoMazeCell);
+    parentOut.resize(distance.size());
+    distance[localOf(from)] = 0;
+    parentOut[localOf(from)] = from;
+    searchQueue.assign(1, from);
+    for (size_t head = 0; head < searchQueue.size(); head++) {
+        uint32_t cell = searchQueue[head];
+        if (cell == to) {
+            return;
+        }
+        uint32_t next = distance[localOf(cell)] + 1;
+        forEachRegionNeighbour(grid, region, cell % width, cell / width, [&](uint32_t neighbour) {
+            uint32_t local = localOf(neighbour);
+            if (distance[local] == NoMazeCell) {
+                distance[local] = next;
+                parentOut[local] = cell;
+                searchQueue.push_back(neighbour);
+            }
+        });
+    }
+}
+
+uint32_t MazeHierarchy::nodeCluster(uint32_t node) const {
+    return static_cast<uint32_t>(std::upper_bound(nodeOffset.begin(), nodeOffset.end(), node) - nodeOffset.begin()) -
+           1;
+}
+
+uint32_t MazeHierarchy::nodeCell(uint32_t node) const {
+    if (node == totalNodes) {
+        return startCell;
+    }
+    if (node == totalNodes + 1) {
+        return goalCell;
+    }
+    uint32_t cluster = nodeCluster(node);
+    return clusters[cluster].cells[node - nodeOffset[cluster]];
+}
+
+uint32_t MazeHierarchy::heuristic(uint32_t cell, uint32_t goal) const {
+    uint32_t width = grid.getWidth();
+    int64_t dx = static_cast<int64_t>(cell % width) - static_cast<int64_t>(goal % width);
+    int64_t dz = static_cast<int64_t>(cell / width) - static_cast<int64_t>(goal / width);
+    return static_cast<uint32_t>((dx < 0 ? -dx : dx) + (dz < 0 ? -dz : dz));
+}
+
+bool MazeHierarchy::relax(uint32_t node, uint32_t newCost, uint32_t from) {
+    if (stamp[node] == query && cost[node] <= newCost) {
+        return false;
+    }
+    stamp[node] = query;
+    cost[node] = newCost;
+    parent[node] = from;
+    return true;
+}
+
+void MazeHierarchy::pushOpen(uint32_t node, uint32_t cell) {
+    uint32_t h = heuristic(cell, goalCell);
+    open.push_back({cost[node] + h, h, node});
+    std::push_heap(open.begin(), open.end(),
+                   [](const OpenNode& a, const OpenNode& b) { return heapAfter(a.f, a.h, b.f, b.h); });
+}
+
+bool MazeHierarchy::findPath(uint32_t start, uint32_t goal, HierarchicalPath& path) {
+    path.waypoints.clear();
+    path.length = 0;
+    if (start >= grid.getCellCount() || goal >= grid.getCellCount()) {
+        throw std::runtime_error("MazeHierarchy: cell outside the grid");
+    }
+    if (++query == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0u);
+        query = 1;
+    }
+    open.clear();
+    stats.expandedNodes = 0;
+    startCell = start;
+    goalCell = goal;
+    uint32_t startNode = totalNodes;
+    uint32_t goalNode = totalNodes + 1;
+    uint32_t startCluster = clusterOf(start);
+    uint32_t goalCluster = clusterOf(goal);
+    MazeRegion startRegion = clusterRegion(startCluster);
+    MazeRegion goalRegion = clusterRegion(goalCluster);
+    uint32_t width = grid.getWidth();
+    auto localOf = [width](const MazeRegion& region, uint32_t cell) {
+        return (cell / width - region.z0) * (region.x1 - region.x0) + cell % width - region.x0;
+    };
+
+    // Connect the start to its cluster's nodes and the goal cluster's
+    // nodes to the goal.
+    clusterSearch(goalRegion, goal, NoMazeCell, goalDistance, searchParent);
+    clusterSearch(startRegion, start, NoMazeCell, startDistance, searchParent);
+    relax(startNode, 0, startNode);
+    const Cluster& first = clusters[startCluster];
+    for (uint32_t i = 0; i < first.cells.size(); i++) {
+        uint32_t distance = startDistance[localOf(startRegion, first.cells[i])];
+        if (distance != NoMazeCell && relax(nodeOffset[startCluster] + i, distance, startNode)) {
+            pushOpen(nodeOffset[startCluster] + i, first.cells[i]);
+        }
+    }
+    if (startCluster == goalCluster && startDistance[localOf(startRegion, goal)] != NoMazeCell) {
+        relax(goalNode, startDistance[localOf(startRegion, goal)], startNode);
+        pushOpen(goalNode, goal);
+    }
+
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(),
+                      [](const OpenNode& a, const OpenNode& b) { return heapAfter(a.f, a.h, b.f, b.h); });
+        OpenNode node = open.back();
+        open.pop_back();
+        if (node.f - node.h != cost[node.node]) {
+            continue;
+        }
+        stats.expandedNodes++;
+        if (node.node == goalNode) {
+            for (uint32_t id = goalNode; id != startNode; id = parent[id]) {
+                uint32_t cell = nodeCell(id);
+                if (path.waypoints.empty() || path.waypoints.back() != cell) {
+                    path.waypoints.push_back(cell);
+                }
+            }
+            if (path.waypoints.back() != start) {
+                path.waypoints.push_back(start);
+            }
+            std::reverse(path.waypoints.begin(), path.waypoints.end());
+            path.length = cost[goalNode];
+            return true;
+        }
+
+        uint32_t clusterIndex = nodeCluster(node.node);
+        const Cluster& cluster = clusters[clusterIndex];
+        uint32_t index = node.node - nodeOffset[clusterIndex];
+        uint32_t cell = cluster.cells[index];
+        uint32_t nodeCost = cost[node.node];
+        for (uint32_t e = cluster.edgeStart[index]; e < cluster.edgeStart[index + 1]; e++) {
+            const Edge& edge = cluster.edges[e];
+            uint32_t next = nodeOffset[clusterIndex] + edge.to;
+            if (relax(next, nodeCost + edge.cost, node.node)) {
+                pushOpen(next, cluster.cells[edge.to]);
+            }
+        }
+        // Openings onto other clusters lead to their entrance nodes.
+        uint32_t x = cell % width;
+        uint32_t z = cell / width;
+        uint32_t across[4];
+        int acrossCount = 0;
+        if (!grid.hasEastWall(x, z)) {
+            across[acrossCount++] = cell + 1;
+        }
+        if (!grid.hasSouthWall(x, z)) {
+            across[acrossCount++] = cell + width;
+        }
+        if (!grid.hasWestWall(x, z)) {
+            across[acrossCount++] = cell - 1;
+        }
+        if (!grid.hasNorthWall(x, z)) {
+            across[acrossCount++] = cell - width;
+        }
+        for (int i = 0; i < acrossCount; i++) {
+            uint32_t otherIndex = clusterOf(across[i]);
+            if (otherIndex == clusterIndex) {
+                continue;
+            }
+            const Cluster& other = clusters[otherIndex];
+            auto it = std::lower_bound(other.cells.begin(), other.cells.end(), across[i]);
+            uint32_t next = nodeOffset[otherIndex] + static_cast<uint32_t>(it - other.cells.begin());
+            if (relax(next, nodeCost + 1, node.node)) {
+                pushOpen(next, across[i]);
+            }
+        }
+        if (clusterIndex == goalCluster) {
+            uint32_t distance = goalDistance[localOf(goalRegion, cell)];
+            if (distance != NoMazeCell && relax(goalNode, nodeCost + distance, node.node)) {
+                pushOpen(goalNode, goal);
+            }
+        }
+    }
+    return false;
+}
+
+void MazeHierarchy::refineSegment(const HierarchicalPath& path, size_t segment, std::vector<uint32_t>& cells) {
+    uint32_t from = path.waypoints[segment];
+    uint32_t to = path.waypoints[segment + 1];
+    uint32_t clusterIndex = clusterOf(from);
+    if (clusterIndex != clusterOf(to)) {
+        cells.push_back(to);
+        return;
+    }
+    MazeRegion region = clusterRegion(clusterIndex);
+    clusterSearch(region, from, to, searchDistance, searchParent);
+    uint32_t width = grid.getWidth();
+    uint32_t regionWidth = region.x1 - region.x0;
+    size_t first = cells.size();
+    for (uint32_t cell = to; cell != from;
+         cell = searchParent[(cell / width - region.z0) * regionWidth + cell % width - region.x0]) {
+        cells.push_back(cell);
+    }
+    std::reverse(cells.begin() + first, cells.end());
+}
+
+void MazeHierarchy::refinePath(const HierarchicalPath& path, std::vector<uint32_t>& cells) {
+    cells.clear();
+    if (path.waypoints.empty()) {
+        return;
+    }
+    cells.push_back(path.waypoints[0]);
+    for (size_t segment = 0; segment + 1 < path.waypoints.size(); segment++) {
+        refineSegment(path, segment, cells);
+    }
+}
+
+size_t MazeHierarchy::memoryBytes() const {
+    size_t bytes = clusters.size() * sizeof(Cluster) + nodeOffset.size() * sizeof(uint32_t);
+    for (const Cluster& cluster : clusters) {
+        bytes += cluster.cells.capacity() * sizeof(uint32_t) + cluster.edgeStart.capacity() * sizeof(uint32_t) +
+                 cluster.edges.capacity() * sizeof(Edge);
+    }
+    return bytes + (cost.size() + parent.size() + stamp.size()) * sizeof(uint32_t);
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "maze/maze_generator.h"
+#include "maze/maze_grid.h"
+#include "maze_pathfinder.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+struct MazeHierarchyStats {
+    uint32_t clusterCount = 0;
+    uint64_t nodeCount = 0;
+    uint64_t edgeCount = 0;
+    double buildMs = 0.0;
+    // Last wallsChanged call.
+    uint32_t rebuiltClusters = 0;
+    double updateMs = 0.0;
+    // Last findPath call.
+    uint32_t expandedNodes = 0;
+};
+
+// Result of a hierarchical query: the cells where the path crosses cluster
+// borders or branches inside a cluster, from start to goal inclusive.
+// Consecutive waypoints are either neighbours across a cluster border or
+// in the same cluster, so each segment can be refined on its own, as the
+// walker gets there.
+struct HierarchicalPath {
+    std::vector<uint32_t> waypoints;
+    uint32_t length = 0;
+};
+
+// HPA*-style hierarchy for mazes too big to search cell by cell. The grid
+// is cut into square clusters. Inside each cluster, dead ends are pruned
+// away and the corridors between entrances (cells with an opening to a
+// neighbouring cluster) and junctions are contracted into weighted edges,
+// so a cluster keeps a small graph that holds every path between its
+// entrances, not only the shortest ones. Classic HPA* keeps a clique of
+// entrance-to-entrance distances instead; in a maze about every second
+// border cell is an entrance, and the cliques would cost several edges
+// per cell. Crossings between clusters are not stored: the
+// entrance on the other side of an opening is looked up in its cluster's
+// sorted node list. Paths found this way are as short as A*'s.
+//
+// Clusters are built independently on the pool, and rebuilt individually
+// when doors change their walls.
+class MazeHierarchy {
+public:
+    // The grid must outlive the hierarchy.
+    MazeHierarchy(const MazeGrid& grid, uint32_t clusterSize, ThreadPool& pool);
+
+    // Call after changing walls of the cells in `region`. Rebuilds the
+    // clusters whose graphs those walls touch, on the pool; returns their
+    // count.
+    uint32_t wallsChanged(const MazeRegion& region, ThreadPool& pool);
+
+    // A* over the cluster graphs, with the start and goal connected to
+    // their clusters by a BFS confined to the cluster. Returns false if the
+    // goal is unreachable. Not thread-safe: queries share scratch memory.
+    bool findPath(uint32_t start, uint32_t goal, HierarchicalPath& path);
+    // Appends the cells after waypoint `segment` up to and including
+    // waypoint segment + 1.
+    void refineSegment(const HierarchicalPath& path, size_t segment, std::vector<uint32_t>& cells);
+    // Every cell of the path, start to goal inclusive.
+    void refinePath(const HierarchicalPath& path, std::vector<uint32_t>& cells);
+
+    uint32_t getClusterSize() const { return clusterSize; }
+    const MazeHierarchyStats& getStats() const { return stats; }
+    size_t memoryBytes() const;
+
+private:
+    struct Edge {
+        // Node index inside the same cluster.
+        uint32_t to;
+        uint32_t cost;
+    };
+
+    struct Cluster {
+        // Entrance and junction cells, ascending.
+        std::vector<uint32_t> cells;
+        std::vector<uint32_t> edgeStart;
+        std::vector<Edge> edges;
+    };
+
+    // Per-thread working memory of buildCluster, by local cell index.
+    struct BuildScratch {
+        std::vector<uint8_t> open;
+        std::vector<uint8_t> degree;
+        std::vector<uint8_t> flags;
+        std::vector<uint32_t> nodeIndex;
+        std::vector<uint32_t> queue;
+    };
+
+    // Start and goal get the two ids after the cluster nodes.
+    struct OpenNode {
+        uint32_t f;
+        uint32_t h;
+        uint32_t node;
+    };
+
+    MazeRegion clusterRegion(uint32_t cluster) const;
+    uint32_t clusterOf(uint32_t cell) const;
+    void buildCluster(uint32_t cluster, BuildScratch& scratch);
+    void updateTotals();
+    // BFS from `from` that never leaves `region`: distances (NoMazeCell if
+    // unreached) and parents by local index.
+    void clusterSearch(const MazeRegion& region, uint32_t from, uint32_t to, std::vector<uint32_t>& distance,
+                       std::vector<uint32_t>& parent);
+    uint32_t nodeCluster(uint32_t node) const;
+    uint32_t nodeCell(uint32_t node) const;
+    uint32_t heuristic(uint32_t cell, uint32_t goal) const;
+    bool relax(uint32_t node, uint32_t cost, uint32_t parent);
+    void pushOpen(uint32_t node, uint32_t cell);
+
+    const MazeGrid& grid;
+    uint32_t clusterSize;
+    uint32_t clustersX;
+    uint32_t clustersZ;
+    std::vector<Cluster> clusters;
+    // Global id of each cluster's first node.
+    std::vector<uint32_t> nodeOffset;
+    uint32_t totalNodes = 0;
+
+    // Query scratch, as in MazePathfinder.
+    std::vector<uint32_t> cost;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> stamp;
+    std::vector<OpenNode> open;
+    uint32_t query = 0;
+    uint32_t startCell = NoMazeCell;
+    uint32_t goalCell = NoMazeCell;
+    std::vector<uint32_t> startDistance;
+    std::vector<uint32_t> goalDistance;
+    std::vector<uint32_t> searchDistance;
+    std::vector<uint32_t> searchParent;
+    std::vector<uint32_t> searchQueue;
+    MazeHierarchyStats stats;
+};
@@ -0,0 +1,177 @@
+#include "maze_pathfinder.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// East, south, west, north: +x, +z, -x, -z.
+constexpr int East = 0;
+constexpr int South = 1;
+constexpr int West = 2;
+constexpr int North = 3;
+
+bool heapAfter(uint32_t fA, uint32_t hA, uint32_t fB, uint32_t hB) {
+    // Min-heap on f; among equal f, prefer nodes nearer the goal.
+    return fA != fB ? fA > fB : hA > hB;
+}
+
+} // namespace
+
+MazePathfinder::MazePathfinder(const MazeGrid& grid)
+    : grid(grid), width(grid.getWidth()), cost(grid.getCellCount()), parent(grid.getCellCount()),
+      stamp(grid.getCellCount(), 0) {
+    if (grid.getCellCount() >= NoMazeCell) {
+        throw std::runtime_error("MazePathfinder: grid too large for 32-bit cell indices");
+    }
+}
+
+bool MazePathfinder::isOpen(uint32_t cell, int direction) const {
+    uint32_t x = cell % width;
+    uint32_t z = cell / width;
+    switch (direction) {
+    case East: return !grid.hasEastWall(x, z);
+    case South: return !grid.hasSouthWall(x, z);
+    case West: return !grid.hasWestWall(x, z);
+    default: return !grid.hasNorthWall(x, z);
+    }
+}
+
+uint32_t MazePathfinder::neighbour(uint32_t cell, int direction) const {
+    switch (direction) {
+    case East: return cell + 1;
+    case South: return cell + width;
+    case West: return cell - 1;
+    default: return cell - width;
+    }
+}
+
+uint32_t MazePathfinder::heuristic(uint32_t cell, uint32_t goal) const {
+    int64_t dx = static_cast<int64_t>(cell % width) - static_cast<int64_t>(goal % width);
+    int64_t dz = static_cast<int64_t>(cell / width) - static_cast<int64_t>(goal / width);
+    return static_cast<uint32_t>((dx < 0 ? -dx : dx) + (dz < 0 ? -dz : dz));
+}
+
+void MazePathfinder::beginQuery() {
+    if (++query == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0u);
+        query = 1;
+    }
+    open.clear();
+    expandedNodes = 0;
+}
+
+bool MazePathfinder::relax(uint32_t cell, uint32_t newCost, uint32_t from) {
+    if (stamp[cell] == query && cost[cell] <= newCost) {
+        return false;
+    }
+    stamp[cell] = query;
+    cost[cell] = newCost;
+    parent[cell] = from;
+    return true;
+}
+
+void MazePathfinder::pushOpen(uint32_t cell, uint32_t goal) {
+    uint32_t h = heuristic(cell, goal);
+    open.push_back({cost[cell] + h, h, cell});
+    std::push_heap(open.begin(), open.end(),
+                   [](const OpenNode& a, const OpenNode& b) { return heapAfter(a.f, a.h, b.f, b.h); });
+}
+
+MazePathfinder::OpenNode MazePathfinder::popOpen() {
+    std::pop_heap(open.begin(), open.end(),
+                  [](const OpenNode& a, const OpenNode& b) { return heapAfter(a.f, a.h, b.f, b.h); });
+    OpenNode node = open.back();
+    open.pop_back();
+    return node;
+}
+
+void MazePathfinder::buildPath(uint32_t start, uint32_t goal, std::vector<uint32_t>& path) const {
+    // Parents are either adjacent (A*) or in a straight line (JPS); walk
+    // the gaps cell by cell.
+    path.clear();
+    uint32_t cell = goal;
+    path.push_back(cell);
+    while (cell != start) {
+        uint32_t target = parent[cell];
+        int64_t step;
+        if (target / width == cell / width) {
+            step = target < cell ? -1 : 1;
+        } else {
+            step = target < cell ? -static_cast<int64_t>(width) : static_cast<int64_t>(width);
+        }
+        while (cell != target) {
+            cell = static_cast<uint32_t>(cell + step);
+            path.push_back(cell);
+        }
+    }
+    std::reverse(path.begin(), path.end());
+}
+
+bool MazePathfinder::findPathAStar(uint32_t start, uint32_t goal, std::vector<uint32_t>& path) {
+    path.clear();
+    beginQuery();
+    relax(start, 0, start);
+    pushOpen(start, goal);
+    while (!open.empty()) {
+        OpenNode node = popOpen();
+        // Stale entry: the cell was queued again with a lower cost.
+        if (node.f - node.h != cost[node.cell]) {
+            continue;
+        }
+        expandedNodes++;
+        if (node.cell == goal) {
+            buildPath(start, goal, path);
+            return true;
+        }
+        for (int direction = 0; direction < 4; direction++) {
+            if (!isOpen(node.cell, direction)) {
+                continue;
+            }
+            uint32_t next = neighbour(node.cell, direction);
+            if (relax(next, cost[node.cell] + 1, node.cell)) {
+                pushOpen(next, goal);
+            }
+        }
+    }
+    return false;
+}
+
+uint32_t MazePathfinder::jump(uint32_t cell, int direction, uint32_t goal, uint32_t& steps) const {
+    int left = (direction + 1) & 3;
+    int right = (direction + 3) & 3;
+    steps = 0;
+    while (isOpen(cell, direction)) {
+        cell = neighbour(cell, direction);
+        steps++;
+        if (cell == goal || isOpen(cell, left) || isOpen(cell, right)) {
+            return cell;
+        }
+    }
+    return NoMazeCell;
+}
+
+bool MazePathfinder::findPathJps(uint32_t start, uint32_t goal, std::vector<uint32_t>& path) {
+    path.clear();
+    beginQuery();
+    relax(start, 0, start);
+    pushOpen(start, goal);
+    while (!open.empty()) {
+        OpenNode node = popOpen();
+        if (node.f - node.h != cost[node.cell]) {
+            continue;
+        }
+        expandedNodes++;
+        if (node.cell == goal) {
+            buildPath(start, goal, path);
+            return true;
+        }
+        for (int direction = 0; direction < 4; direction++) {
+            uint32_t steps;
+            uint32_t next = jump(node.cell, direction, goal, steps);
+            if (next != NoMazeCell && relax(next, cost[node.cell] + steps, node.cell)) {
+                pushOpen(next, goal);
+            }
+        }
+    }
+    return false;
+}
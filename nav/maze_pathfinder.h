@@ -0,0 +1,60 @@
+#pragma once
+
+#include "maze/maze_grid.h"
+#include <cstdint>
+#include <vector>
+
+// Cells are addressed by index z * width + x throughout nav/.
+constexpr uint32_t NoMazeCell = UINT32_MAX;
+
+// Shortest paths between two cells of a grid maze (4-connected, unit
+// cost). Query scratch (costs, parents, the heap) lives in flat arrays
+// sized once per grid and reused; a generation stamp marks which entries
+// belong to the current query, so a query never clears the arrays.
+class MazePathfinder {
+public:
+    // The grid must outlive the pathfinder.
+    explicit MazePathfinder(const MazeGrid& grid);
+
+    // A* with the Manhattan distance. Fills `path` with the cells from
+    // start to goal inclusive; returns false if the goal is unreachable.
+    bool findPathAStar(uint32_t start, uint32_t goal, std::vector<uint32_t>& path);
+
+    // Jump point search. Classic JPS prunes symmetric paths on open grids;
+    // in a maze, corridors are one cell wide, so what it skips are the
+    // corridor cells: a jump runs straight until it reaches the goal or a
+    // cell with a side opening, and only those cells enter the open list.
+    // Dead-end corridors are dropped without being queued. Paths are as
+    // short as A*'s.
+    bool findPathJps(uint32_t start, uint32_t goal, std::vector<uint32_t>& path);
+
+    // Nodes taken off the open list by the last query.
+    uint32_t getExpandedNodes() const { return expandedNodes; }
+
+private:
+    struct OpenNode {
+        uint32_t f;
+        uint32_t h;
+        uint32_t cell;
+    };
+
+    bool isOpen(uint32_t cell, int direction) const;
+    uint32_t neighbour(uint32_t cell, int direction) const;
+    uint32_t heuristic(uint32_t cell, uint32_t goal) const;
+    void beginQuery();
+    // Sets the cost if the cell is unseen this query or the cost improves.
+    bool relax(uint32_t cell, uint32_t cost, uint32_t parent);
+    void pushOpen(uint32_t cell, uint32_t goal);
+    OpenNode popOpen();
+    uint32_t jump(uint32_t cell, int direction, uint32_t goal, uint32_t& steps) const;
+    void buildPath(uint32_t start, uint32_t goal, std::vector<uint32_t>& path) const;
+
+    const MazeGrid& grid;
+    uint32_t width;
+    std::vector<uint32_t> cost;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> stamp;
+    std::vector<OpenNode> open;
+    uint32_t query = 0;
+    uint32_t expandedNodes = 0;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cmath>
+
+inline glm::vec3 closestPointOnSegment(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b) {
+    glm::vec3 ab = b - a;
+    float lengthSquared = glm::dot(ab, ab);
+    float t = lengthSquared > 0.0f ? glm::clamp(glm::dot(p - a, ab) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+    return a + ab * t;
+}
+
+// Closest point on triangle abc to p: the projection onto the plane when it
+// falls inside the triangle, otherwise the nearest edge point. Unlike the
+// barycentric Voronoi-region walk this stays accurate on long slivers such
+// as the sides of thin floor slabs. Triangles thinner than float precision
+// are treated as their edges.
+inline glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    glm::vec3 ab = b - a;
+    glm::vec3 ac = c - a;
+    glm::vec3 n = glm::cross(ab, ac);
+    float areaSquared = glm::dot(n, n);
+    if (areaSquared > 1e-12f * glm::dot(ab, ab) * glm::dot(ac, ac)) {
+        glm::vec3 ap = p - a;
+        if (glm::dot(glm::cross(ab, ap), n) >= 0.0f &&
+            glm::dot(glm::cross(c - b, p - b), n) >= 0.0f &&
+            glm::dot(glm::cross(a - c, p - c), n) >= 0.0f) {
+            return p - n * (glm::dot(ap, n) / areaSquared);
+        }
+    }
+
+    glm::vec3 best = closestPointOnSegment(p, a, b);
+    glm::vec3 delta = p - best;
+    float bestDistance = glm::dot(delta, delta);
+    glm::vec3 candidates[2] = {closestPointOnSegment(p, a, c), closestPointOnSegment(p, b, c)};
+    for (const auto& candidate : candidates) {
+        delta = p - candidate;
+        float distance = glm::dot(delta, delta);
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+struct SphereContact {
+    glm::vec3 normal;      // from the triangle towards the sphere centre
+    glm::vec3 point;       // closest point on the triangle
+    float separation;      // distance to the surface, negative when penetrating
+};
+
+// Fills the contact for a sphere whose closest point on triangle abc is known.
+inline void sphereContactFromClosest(const glm::vec3& center, float radius, const glm::vec3& closest,
+                                     const glm::vec3& a, const glm::vec3& b, const glm::vec3& c,
+                                     SphereContact& contact) {
+    glm::vec3 delta = center - closest;
+    float distance = std::sqrt(glm::dot(delta, delta));
+    if (distance > 1e-6f) {
+        contact.normal = delta / distance;
+    } else {
+        // Centre lies on the triangle; push out along the face normal.
+        glm::vec3 n = glm::cross(b - a, c - a);
+        float length = glm::length(n);
+        contact.normal = length > 0.0f ? n / length : glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+    contact.point = closest;
+    contact.separation = distance - radius;
+}
+
+// Reports a contact when the sphere surface is within margin of the triangle.
+inline bool sphereTriangleContact(const glm::vec3& center, float radius, float margin,
+                                  const glm::vec3& a, const glm::vec3& b, const glm::vec3& c,
+                                  SphereContact& contact) {
+    glm::vec3 closest = closestPointOnTriangle(center, a, b, c);
+    glm::vec3 delta = center - closest;
+    float reach = radius + margin;
+    if (glm::dot(delta, delta) > reach * reach) {
+        return false;
+    }
+    sphereContactFromClosest(center, radius, closest, a, b, c, contact);
+    return true;
+}
@@ -0,0 +1,43 @@
+#include "grid_cells.h"
+#include <algorithm>
+#include <cmath>
+
+void fitGridCells(const glm::vec2& extent, uint64_t maxCells, float& cellSize, uint32_t& cellsX, uint32_t& cellsZ) {
+    // Counted in double so huge extents cannot overflow the conversion; a
+    // non-finite extent collapses its axis to one cell.
+    double width = std::isfinite(extent.x) && extent.x > 0.0f ? extent.x : 0.0;
+    double depth = std::isfinite(extent.y) && extent.y > 0.0f ? extent.y : 0.0;
+    for (;;) {
+        double x = std::floor(width / cellSize) + 1.0;
+        double z = std::floor(depth / cellSize) + 1.0;
+        if (x * z <= static_cast<double>(maxCells)) {
+            cellsX = static_cast<uint32_t>(x);
+            cellsZ = static_cast<uint32_t>(z);
+            return;
+        }
+        cellSize *= 1.5f;
+    }
+}
+
+bool gridCellRange(const glm::vec2& lo, const glm::vec2& hi, uint32_t cellsX, uint32_t cellsZ, uint32_t& x0,
+                   uint32_t& z0, uint32_t& x1, uint32_t& z1) {
+    if (cellsX == 0 || cellsZ == 0) {
+        return false;
+    }
+    glm::vec2 first(std::floor(lo.x), std::floor(lo.y));
+    glm::vec2 last(std::floor(hi.x), std::floor(hi.y));
+    if (!(last.x >= 0.0f && last.y >= 0.0f && first.x < static_cast<float>(cellsX) &&
+          first.y < static_cast<float>(cellsZ))) {
+        return false;
+    }
+    x0 = static_cast<uint32_t>(std::max(first.x, 0.0f));
+    z0 = static_cast<uint32_t>(std::max(first.y, 0.0f));
+    x1 = static_cast<uint32_t>(std::min(last.x, static_cast<float>(cellsX - 1)));
+    z1 = static_cast<uint32_t>(std::min(last.y, static_cast<float>(cellsZ - 1)));
+    return true;
+}
+
+void sortUniqueItems(std::vector<uint32_t>& items) {
+    std::sort(items.begin(), items.end());
+    items.erase(std::unique(items.begin(), items.end()), items.end());
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Building blocks shared by UniformGrid and RectGrid: 2D grids over XZ whose
+// cells are columns, each listing its items in one flat CSR array.
+
+// Picks the cell counts covering extent, growing cellSize by half until the
+// grid has at most maxCells cells. There is one cell more than the extent
+// needs, so points on the far edge still fall inside.
+void fitGridCells(const glm::vec2& extent, uint64_t maxCells, float& cellSize, uint32_t& cellsX, uint32_t& cellsZ);
+
+// Cells overlapping [lo, hi], both in cell units from the grid origin.
+// Clamps in float before converting, so far-away and non-finite bounds are
+// safe. False if the range misses the grid (or the grid is empty) or is NaN.
+bool gridCellRange(const glm::vec2& lo, const glm::vec2& hi, uint32_t cellsX, uint32_t cellsZ, uint32_t& x0,
+                   uint32_t& z0, uint32_t& x1, uint32_t& z1);
+
+// Sorts the candidates gathered from several cells and drops duplicates.
+void sortUniqueItems(std::vector<uint32_t>& items);
+
+// Two passes over forEachCell(item, visit), which calls visit(cell) for
+// every cell the item covers: count per cell, prefix sum, then scatter into
+// place, so each cell's list is contiguous and in ascending item order.
+// cellStart gets cellCount + 1 entries. Throws std::runtime_error, prefixed
+// with owner, if the references do not fit 32-bit offsets.
+template <typename ForEachCell>
+void buildGridCells(const char* owner, uint32_t itemCount, size_t cellCount, ForEachCell&& forEachCell,
+                    std::vector<uint32_t>& cellStart, std::vector<uint32_t>& cellItems) {
+    std::vector<uint64_t> counts(cellCount + 1, 0);
+    for (uint32_t i = 0; i < itemCount; i++) {
+        forEachCell(i, [&](uint32_t cell) { counts[cell + 1]++; });
+    }
+    for (size_t c = 0; c < cellCount; c++) {
+        counts[c + 1] += counts[c];
+    }
+    if (counts[cellCount] >= std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error(std::string(owner) + ": too many cell references");
+    }
+
+    cellStart.assign(counts.begin(), counts.end());
+    cellItems.resize(cellStart[cellCount]);
+    std::vector<uint32_t> cursor(cellStart.begin(), cellStart.end() - 1);
+    for (uint32_t i = 0; i < itemCount; i++) {
+        forEachCell(i, [&](uint32_t cell) { cellItems[cursor[cell]++] = i; });
+    }
+}
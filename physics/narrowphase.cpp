@@ -0,0 +1,263 @@
+#include "narrowphase.h"
+#include "core/simd.h"
+#include <cmath>
+
+namespace {
+
+enum PackedField {
+    Ax, Ay, Az,
+    ABx, ABy, ABz,
+    ACx, ACy, ACz,
+    // Unit face normal, zero for degenerate triangles.
+    Nx, Ny, Nz,
+    InvAB, InvAC, InvBC,
+    // 1 when the triangle has area; degenerate ones only use their edges.
+    HasFace,
+    PackedFieldCount
+};
+
+static_assert(PackedFieldCount == 16, "PackedTriangle holds 16 floats");
+
+inline float inverseOrZero(float x) {
+    return x > 0.0f ? 1.0f / x : 0.0f;
+}
+
+template <int N>
+struct alignas(32) TriangleLanes {
+    float field[PackedFieldCount][N];
+};
+
+// Gathers N 16-float records into SoA lanes.
+template <int N>
+void transposeRecords(const float* const* records, TriangleLanes<N>& lanes) {
+    for (int lane = 0; lane < N; lane++) {
+        for (int f = 0; f < PackedFieldCount; f++) {
+            lanes.field[f][lane] = records[lane][f];
+        }
+    }
+}
+
+#if MAZE_SIMD_SSE
+template <>
+void transposeRecords<4>(const float* const* records, TriangleLanes<4>& lanes) {
+    for (int block = 0; block < PackedFieldCount; block += 4) {
+        __m128 r0 = _mm_load_ps(records[0] + block);
+        __m128 r1 = _mm_load_ps(records[1] + block);
+        __m128 r2 = _mm_load_ps(records[2] + block);
+        __m128 r3 = _mm_load_ps(records[3] + block);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_store_ps(lanes.field[block + 0], r0);
+        _mm_store_ps(lanes.field[block + 1], r1);
+        _mm_store_ps(lanes.field[block + 2], r2);
+        _mm_store_ps(lanes.field[block + 3], r3);
+    }
+}
+#endif
+
+#if MAZE_SIMD_AVX
+// Two 8x8 transposes, one per half cache line.
+template <>
+void transposeRecords<8>(const float* const* records, TriangleLanes<8>& lanes) {
+    for (int block = 0; block < PackedFieldCount; block += 8) {
+        __m256 r[8];
+        for (int lane = 0; lane < 8; lane++) {
+            r[lane] = _mm256_load_ps(records[lane] + block);
+        }
+        __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+        __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+        __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+        __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+        __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+        __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+        __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+        __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+        __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+        _mm256_store_ps(lanes.field[block + 0], _mm256_permute2f128_ps(s0, s4, 0x20));
+        _mm256_store_ps(lanes.field[block + 1], _mm256_permute2f128_ps(s1, s5, 0x20));
+        _mm256_store_ps(lanes.field[block + 2], _mm256_permute2f128_ps(s2, s6, 0x20));
+        _mm256_store_ps(lanes.field[block + 3], _mm256_permute2f128_ps(s3, s7, 0x20));
+        _mm256_store_ps(lanes.field[block + 4], _mm256_permute2f128_ps(s0, s4, 0x31));
+        _mm256_store_ps(lanes.field[block + 5], _mm256_permute2f128_ps(s1, s5, 0x31));
+        _mm256_store_ps(lanes.field[block + 6], _mm256_permute2f128_ps(s2, s6, 0x31));
+        _mm256_store_ps(lanes.field[block + 7], _mm256_permute2f128_ps(s3, s7, 0x31));
+    }
+}
+#endif
+
+template <typename V>
+V clamp01(const V& x) {
+    return simd::min(simd::max(x, V(0.0f)), V(1.0f));
+}
+
+// (e x p) . n
+template <typename V>
+V triple(const V& ex, const V& ey, const V& ez, const V& px, const V& py, const V& pz,
+         const V& nx, const V& ny, const V& nz) {
+    V cx = ey * pz - ez * py;
+    V cy = ez * px - ex * pz;
+    V cz = ex * py - ey * px;
+    return simd::fmadd(cx, nx, simd::fmadd(cy, ny, cz * nz));
+}
+
+} // namespace
+
+PackedTriangle packTriangle(const Triangle& triangle) {
+    glm::vec3 ab = triangle.v1 - triangle.v0;
+    glm::vec3 ac = triangle.v2 - triangle.v0;
+    glm::vec3 bc = triangle.v2 - triangle.v1;
+    glm::vec3 n = glm::cross(ab, ac);
+    // Same sliver cut-off as closestPointOnTriangle.
+    float areaSquared = glm::dot(n, n);
+    bool hasFace = areaSquared > 1e-12f * glm::dot(ab, ab) * glm::dot(ac, ac);
+    n = hasFace ? n / std::sqrt(areaSquared) : glm::vec3(0.0f);
+
+    PackedTriangle packed;
+    float* f = packed.values;
+    f[Ax] = triangle.v0.x;
+    f[Ay] = triangle.v0.y;
+    f[Az] = triangle.v0.z;
+    f[ABx] = ab.x;
+    f[ABy] = ab.y;
+    f[ABz] = ab.z;
+    f[ACx] = ac.x;
+    f[ACy] = ac.y;
+    f[ACz] = ac.z;
+    f[Nx] = n.x;
+    f[Ny] = n.y;
+    f[Nz] = n.z;
+    f[InvAB] = inverseOrZero(glm::dot(ab, ab));
+    f[InvAC] = inverseOrZero(glm::dot(ac, ac));
+    f[InvBC] = inverseOrZero(glm::dot(bc, bc));
+    f[HasFace] = hasFace ? 1.0f : 0.0f;
+    return packed;
+}
+
+std::vector<PackedTriangle> packTriangles(const std::vector<Triangle>& triangles) {
+    std::vector<PackedTriangle> packed(triangles.size());
+    for (size_t i = 0; i < triangles.size(); i++) {
+        packed[i] = packTriangle(triangles[i]);
+    }
+    return packed;
+}
+
+uint32_t nativeBatchWidth() {
+#if MAZE_SIMD_AVX
+    return 8;
+#else
+    return 4;
+#endif
+}
+
+// Branch-free closest point: the projection onto the plane when it falls
+// inside the triangle, otherwise the nearest of the three edge points.
+template <int N>
+uint32_t sphereTriangleBatch(const PackedTriangle* triangles, const uint32_t* indices, int count,
+                             const glm::vec3& center, float reach, glm::vec3* closest) {
+    using V = typename simd::FloatVector<N>::Type;
+
+    // Padding lanes repeat the last triangle and are masked off below.
+    const float* records[N];
+    for (int lane = 0; lane < N; lane++) {
+        records[lane] = triangles[indices[lane < count ? lane : count - 1]].values;
+    }
+    TriangleLanes<N> lanes;
+    transposeRecords(records, lanes);
+    auto load = [&](PackedField f) { return V::load(lanes.field[f]); };
+
+    V ax = load(Ax), ay = load(Ay), az = load(Az);
+    V abx = load(ABx), aby = load(ABy), abz = load(ABz);
+    V acx = load(ACx), acy = load(ACy), acz = load(ACz);
+
+    V apx = V(center.x) - ax;
+    V apy = V(center.y) - ay;
+    V apz = V(center.z) - az;
+    V d20 = simd::fmadd(apx, abx, simd::fmadd(apy, aby, apz * abz));
+    V d21 = simd::fmadd(apx, acx, simd::fmadd(apy, acy, apz * acz));
+
+    // Face region: inside when p lies left of all three edges seen along
+    // the normal; the closest point is then the projection onto the plane.
+    V nx = load(Nx), ny = load(Ny), nz = load(Nz);
+    V bcx = acx - abx, bcy = acy - aby, bcz = acz - abz;
+    V bpx = apx - abx, bpy = apy - aby, bpz = apz - abz;
+    V cpx = apx - acx, cpy = apy - acy, cpz = apz - acz;
+    V sideAB = triple(abx, aby, abz, apx, apy, apz, nx, ny, nz);
+    V sideBC = triple(bcx, bcy, bcz, bpx, bpy, bpz, nx, ny, nz);
+    V sideCA = triple(-acx, -acy, -acz, cpx, cpy, cpz, nx, ny, nz);
+    V inside = (sideAB >= V(0.0f)) & (sideBC >= V(0.0f)) & (sideCA >= V(0.0f)) & (load(HasFace) > V(0.0f));
+    V height = simd::fmadd(apx, nx, simd::fmadd(apy, ny, apz * nz));
+    V bestX = V(center.x) - nx * height;
+    V bestY = V(center.y) - ny * height;
+    V bestZ = V(center.z) - nz * height;
+
+    // Edge ab.
+    V t = clamp01(d20 * load(InvAB));
+    V ex = simd::fmadd(abx, t, ax), ey = simd::fmadd(aby, t, ay), ez = simd::fmadd(abz, t, az);
+    V dx = V(center.x) - ex, dy = V(center.y) - ey, dz = V(center.z) - ez;
+    V edgeDistance = simd::fmadd(dx, dx, simd::fmadd(dy, dy, dz * dz));
+    V edgeX = ex, edgeY = ey, edgeZ = ez;
+
+    // Edge ac.
+    t = clamp01(d21 * load(InvAC));
+    ex = simd::fmadd(acx, t, ax);
+    ey = simd::fmadd(acy, t, ay);
+    ez = simd::fmadd(acz, t, az);
+    dx = V(center.x) - ex;
+    dy = V(center.y) - ey;
+    dz = V(center.z) - ez;
+    V distance = simd::fmadd(dx, dx, simd::fmadd(dy, dy, dz * dz));
+    V closer = distance < edgeDistance;
+    edgeX = simd::select(closer, ex, edgeX);
+    edgeY = simd::select(closer, ey, edgeY);
+    edgeZ = simd::select(closer, ez, edgeZ);
+    edgeDistance = simd::min(distance, edgeDistance);
+
+    // Edge bc, from b = a + ab.
+    V bx = ax + abx, by = ay + aby, bz = az + abz;
+    t = clamp01(simd::fmadd(bpx, bcx, simd::fmadd(bpy, bcy, bpz * bcz)) * load(InvBC));
+    ex = simd::fmadd(bcx, t, bx);
+    ey = simd::fmadd(bcy, t, by);
+    ez = simd::fmadd(bcz, t, bz);
+    dx = V(center.x) - ex;
+    dy = V(center.y) - ey;
+    dz = V(center.z) - ez;
+    distance = simd::fmadd(dx, dx, simd::fmadd(dy, dy, dz * dz));
+    closer = distance < edgeDistance;
+    edgeX = simd::select(closer, ex, edgeX);
+    edgeY = simd::select(closer, ey, edgeY);
+    edgeZ = simd::select(closer, ez, edgeZ);
+
+    bestX = simd::select(inside, bestX, edgeX);
+    bestY = simd::select(inside, bestY, edgeY);
+    bestZ = simd::select(inside, bestZ, edgeZ);
+    dx = V(center.x) - bestX;
+    dy = V(center.y) - bestY;
+    dz = V(center.z) - bestZ;
+    distance = simd::fmadd(dx, dx, simd::fmadd(dy, dy, dz * dz));
+
+    int mask = simd::movemask(distance <= V(reach * reach)) & ((1 << count) - 1);
+    if (mask == 0) {
+        return 0;
+    }
+    alignas(32) float px[N], py[N], pz[N];
+    bestX.store(px);
+    bestY.store(py);
+    bestZ.store(pz);
+    uint32_t hits = static_cast<uint32_t>(mask);
+    while (mask) {
+        int lane = simd::popLowestLane(mask);
+        closest[lane] = glm::vec3(px[lane], py[lane], pz[lane]);
+    }
+    return hits;
+}
+
+template uint32_t sphereTriangleBatch<4>(const PackedTriangle*, const uint32_t*, int, const glm::vec3&, float,
+                                         glm::vec3*);
+template uint32_t sphereTriangleBatch<8>(const PackedTriangle*, const uint32_t*, int, const glm::vec3&, float,
+                                         glm::vec3*);
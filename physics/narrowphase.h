@@ -0,0 +1,32 @@
+#pragma once
+
+#include "bvh/triangle_mesh.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Triangle preprocessed for the batched closest-point kernel: vertex a, the
+// edges ab and ac, the unit normal and the inverse squared edge lengths.
+// Exactly one cache line, so gathering a candidate touches a single line.
+struct alignas(64) PackedTriangle {
+    float values[16];
+};
+
+PackedTriangle packTriangle(const Triangle& triangle);
+std::vector<PackedTriangle> packTriangles(const std::vector<Triangle>& triangles);
+
+// Tests one sphere against up to N (4 or 8) packed triangles, picked by
+// index. Returns the mask of lanes within reach of the centre and writes
+// their closest points; other entries of `closest` are left untouched.
+template <int N>
+uint32_t sphereTriangleBatch(const PackedTriangle* triangles, const uint32_t* indices, int count,
+                             const glm::vec3& center, float reach, glm::vec3* closest);
+
+// The widest batch with native SIMD lanes in MazeCore's build: 8 with AVX,
+// otherwise 4 (8 lanes would be emulated and slower).
+uint32_t nativeBatchWidth();
+
+extern template uint32_t sphereTriangleBatch<4>(const PackedTriangle*, const uint32_t*, int, const glm::vec3&,
+                                                float, glm::vec3*);
+extern template uint32_t sphereTriangleBatch<8>(const PackedTriangle*, const uint32_t*, int, const glm::vec3&,
+                                                float, glm::vec3*);
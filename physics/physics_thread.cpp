@@ -0,0 +1,137 @@
+#include "physics_thread.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+float PhysicsSnapshot::interpolationAlpha(Clock::time_point now) const {
+    if (timeStep <= 0.0f) {
+        return 1.0f;
+    }
+    float alpha = std::chrono::duration<float>(now - time).count() / timeStep;
+    return std::clamp(alpha, 0.0f, 1.0f);
+}
+
+glm::mat4 PhysicsSnapshot::getBodyTransform(uint32_t id, float alpha) const {
+    const BodyPose& from = previous[id];
+    const BodyPose& to = current[id];
+    glm::vec3 position = glm::mix(from.position, to.position, alpha);
+    glm::quat orientation = glm::slerp(from.orientation, to.orientation, alpha);
+    return glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(orientation);
+}
+
+PhysicsThread::PhysicsThread(PhysicsWorld& world, size_t commandCapacity)
+    : world(world), commands(commandCapacity) {}
+
+PhysicsThread::~PhysicsThread() {
+    running.store(false, std::memory_order_relaxed);
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void PhysicsThread::start() {
+    if (thread.joinable()) {
+        throw std::runtime_error("PhysicsThread: already running");
+    }
+    // Publish the current state first so the reader never sees an empty
+    // snapshot.
+    auto now = PhysicsSnapshot::Clock::now();
+    lastPoses.clear();
+    publish(now);
+    snapshots.update();
+    running.store(true, std::memory_order_relaxed);
+    thread = std::thread([this]() { run(); });
+}
+
+void PhysicsThread::stop() {
+    running.store(false, std::memory_order_relaxed);
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (failed.load(std::memory_order_acquire)) {
+        failed.store(false, std::memory_order_relaxed);
+        std::rethrow_exception(error);
+    }
+}
+
+bool PhysicsThread::submit(const PhysicsCommand& command) {
+    return commands.push(command);
+}
+
+const PhysicsSnapshot& PhysicsThread::acquireSnapshot() {
+    if (failed.load(std::memory_order_acquire)) {
+        stop();
+    }
+    snapshots.update();
+    return snapshots.readBuffer();
+}
+
+void PhysicsThread::run() {
+    using Clock = PhysicsSnapshot::Clock;
+    const PhysicsSettings& settings = world.getSettings();
+    auto stepDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(settings.timeStep));
+    auto maxLag = stepDuration * settings.maxStepsPerAdvance;
+    auto nextStep = Clock::now() + stepDuration;
+
+    try {
+        while (running.load(std::memory_order_relaxed)) {
+            auto now = Clock::now();
+            if (now - nextStep > maxLag) {
+                nextStep = now;
+            }
+            while (nextStep <= now) {
+                applyCommands();
+                world.step();
+                publish(nextStep);
+                nextStep += stepDuration;
+            }
+            std::this_thread::sleep_until(nextStep);
+        }
+    } catch (...) {
+        error = std::current_exception();
+        failed.store(true, std::memory_order_release);
+    }
+}
+
+void PhysicsThread::applyCommands() {
+    PhysicsCommand command;
+    while (commands.pop(command)) {
+        switch (command.type) {
+        case PhysicsCommand::Type::ApplyImpulse:
+            world.applyImpulse(command.bodyId, command.vector);
+            break;
+        case PhysicsCommand::Type::WakeBody:
+            world.wakeBody(command.bodyId);
+            break;
+        case PhysicsCommand::Type::WakeAll:
+            world.wakeAll();
+            break;
+        }
+        commandCount++;
+    }
+}
+
+void PhysicsThread::publish(PhysicsSnapshot::Clock::time_point time) {
+    PhysicsSnapshot& snapshot = snapshots.writeBuffer();
+    uint32_t count = world.getBodyCount();
+    snapshot.current.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        const RigidBody& body = world.getBody(i);
+        snapshot.current[i] = {body.position, body.orientation};
+    }
+    // Bodies added since the last step start without motion to blend.
+    size_t known = std::min<size_t>(lastPoses.size(), count);
+    lastPoses.resize(count);
+    for (size_t i = known; i < count; i++) {
+        lastPoses[i] = snapshot.current[i];
+    }
+    snapshot.previous.assign(lastPoses.begin(), lastPoses.end());
+    lastPoses = snapshot.current;
+
+    snapshot.stepCount = world.getStats().stepCount;
+    snapshot.commandCount = commandCount;
+    snapshot.time = time;
+    snapshot.timeStep = world.getSettings().timeStep;
+    snapshot.stats = world.getStats();
+    snapshots.publish();
+}
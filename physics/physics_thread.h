@@ -0,0 +1,88 @@
+#pragma once
+
+#include "physics_world.h"
+#include "core/spsc_queue.h"
+#include "core/triple_buffer.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// Gameplay input for the physics thread, applied before the next step.
+struct PhysicsCommand {
+    enum class Type { ApplyImpulse, WakeBody, WakeAll };
+
+    Type type = Type::WakeAll;
+    uint32_t bodyId = 0;
+    glm::vec3 vector = glm::vec3(0.0f);
+};
+
+struct BodyPose {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::quat orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+};
+
+// Poses before and after one step. `time` is when the step was due, so
+// rendering one step behind the clock always has both ends available.
+struct PhysicsSnapshot {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t stepCount = 0;
+    uint64_t commandCount = 0;
+    Clock::time_point time;
+    float timeStep = 0.0f;
+    std::vector<BodyPose> previous;
+    std::vector<BodyPose> current;
+    PhysicsStats stats;
+
+    // Blend factor between previous and current for a frame drawn at `now`.
+    float interpolationAlpha(Clock::time_point now) const;
+    glm::mat4 getBodyTransform(uint32_t id, float alpha) const;
+};
+
+// Steps a PhysicsWorld at its fixed time step on a dedicated thread. After
+// every step the poses are published through a triple buffer, so the
+// renderer reads the latest complete snapshot without ever blocking on a
+// slow step; commands travel the other way through an SPSC queue. While
+// running, the world belongs to the physics thread: set it up before
+// start() and touch it again only after stop(). When the thread falls more
+// than maxStepsPerAdvance steps behind it drops the lost time, as advance()
+// does.
+class PhysicsThread {
+public:
+    explicit PhysicsThread(PhysicsWorld& world, size_t commandCapacity = 1024);
+    ~PhysicsThread();
+
+    PhysicsThread(const PhysicsThread&) = delete;
+    PhysicsThread& operator=(const PhysicsThread&) = delete;
+
+    void start();
+    // Joins the thread; rethrows an exception raised by a step.
+    void stop();
+    bool isRunning() const { return thread.joinable(); }
+
+    // Render thread side. submit returns false when the queue is full.
+    bool submit(const PhysicsCommand& command);
+    // Picks up the newest snapshot, rethrowing an exception from the physics
+    // thread. The reference stays valid until the next call.
+    const PhysicsSnapshot& acquireSnapshot();
+
+private:
+    void run();
+    void applyCommands();
+    void publish(PhysicsSnapshot::Clock::time_point time);
+
+    PhysicsWorld& world;
+    SpscQueue<PhysicsCommand> commands;
+    TripleBuffer<PhysicsSnapshot> snapshots;
+    std::vector<BodyPose> lastPoses;
+    uint64_t commandCount = 0;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+};
@@ -0,0 +1,836 @@
+#include "physics_world.h"
+#include "collision.h"
+#include "core/simd.h"
+#include "core/thread_pool.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// Bodies per parallel work item for contact search and integration.
+constexpr size_t BodyChunkSize = 128;
+// Islands per parallel work item for the solver; most islands are a single
+// ball with a few level contacts.
+constexpr size_t IslandGrainSize = 32;
+
+} // namespace
+
+PhysicsWorld::PhysicsWorld(const PhysicsSettings& settings) : PhysicsWorld(settings, ThreadPool::global()) {}
+
+PhysicsWorld::PhysicsWorld(const PhysicsSettings& settings, ThreadPool& pool) : settings(settings), pool(pool) {
+    levelBody.radius = 0.0f;
+    levelBody.inverseMass = 0.0f;
+    levelBody.inverseInertia = 0.0f;
+    if (settings.timeStep <= 0.0f) {
+        throw std::runtime_error("PhysicsWorld: time step must be positive");
+    }
+}
+
+void PhysicsWorld::setStaticGeometry(const TriangleMesh& mesh) {
+    const std::vector<Triangle>& triangles = mesh.getTriangles();
+    setStaticGeometry(triangles.data(), triangles.size());
+}
+
+void PhysicsWorld::setStaticGeometry(const Triangle* triangles, size_t count, const UniformGrid* grid) {
+    staticTriangles.assign(triangles, triangles + count);
+    staticBounds.resize(staticTriangles.size());
+    for (size_t i = 0; i < staticTriangles.size(); i++) {
+        staticBounds[i] = staticTriangles[i].bounds();
+    }
+    packedTriangles = packTriangles(staticTriangles);
+    staticGridDirty = grid == nullptr;
+    if (grid) {
+        staticGrid = *grid;
+    }
+    // Sleeping bodies may have lost their support.
+    wakeAll();
+}
+
+void PhysicsWorld::setWindZones(const std::vector<WindZone>& zones) {
+    windField.build(zones, settings.windCellSize);
+    stats.windMs = 0.0;
+    // Bodies resting in a new zone must feel it.
+    wakeAll();
+}
+
+TriggerId PhysicsWorld::addTrigger(const TriggerDesc& desc) {
+    return triggers.add(desc);
+}
+
+bool PhysicsWorld::removeTrigger(TriggerId id) {
+    return triggers.remove(id);
+}
+
+void PhysicsWorld::buildStaticGrid() {
+    float cellSize = settings.gridCellSize;
+    if (cellSize <= 0.0f) {
+        float maxRadius = 0.0f;
+        for (const auto& body : bodies) {
+            maxRadius = std::max(maxRadius, body.radius);
+        }
+        cellSize = UniformGrid::suggestCellSize(staticTriangles, maxRadius);
+    }
+    staticGrid.build(staticTriangles, cellSize);
+    staticGridDirty = false;
+}
+
+uint32_t PhysicsWorld::addBody(const BodyDesc& desc) {
+    RigidBody body;
+    body.position = desc.position;
+    body.velocity = desc.velocity;
+    body.radius = desc.radius;
+    body.restitution = desc.restitution;
+    body.friction = desc.friction;
+    body.rollingFriction = desc.rollingFriction;
+    body.sleepSpeed = desc.sleepSpeed;
+    if (desc.mass > 0.0f) {
+        body.inverseMass = 1.0f / desc.mass;
+        // Solid sphere: I = 2/5 m r^2.
+        body.inverseInertia = 2.5f / (desc.mass * desc.radius * desc.radius);
+    } else {
+        body.inverseMass = 0.0f;
+        body.inverseInertia = 0.0f;
+    }
+    bodies.push_back(body);
+    sleepGroups.push_back(Awake);
+    return static_cast<uint32_t>(bodies.size() - 1);
+}
+
+void PhysicsWorld::applyImpulse(uint32_t bodyId, const glm::vec3& impulse) {
+    wakeBody(bodyId);
+    RigidBody& body = bodies[bodyId];
+    body.velocity += impulse * body.inverseMass;
+}
+
+void PhysicsWorld::wakeBody(uint32_t bodyId) {
+    uint32_t group = sleepGroups[bodyId];
+    if (group == Awake) {
+        return;
+    }
+    for (uint32_t b = 0; b < bodies.size(); b++) {
+        if (sleepGroups[b] == group) {
+            sleepGroups[b] = Awake;
+            bodies[b].sleepTimer = 0.0f;
+        }
+    }
+    sleepingHashDirty = true;
+}
+
+void PhysicsWorld::wakeAll() {
+    for (uint32_t b = 0; b < bodies.size(); b++) {
+        if (sleepGroups[b] != Awake) {
+            sleepGroups[b] = Awake;
+            bodies[b].sleepTimer = 0.0f;
+            sleepingHashDirty = true;
+        }
+    }
+}
+
+void PhysicsWorld::saveState(PhysicsState& state) const {
+    state.stepCount = stats.stepCount;
+    state.accumulator = accumulator;
+    state.triggerPairs = triggers.getPairs();
+    state.bodies.resize(bodies.size());
+    for (uint32_t b = 0; b < bodies.size(); b++) {
+        const RigidBody& body = bodies[b];
+        state.bodies[b] = {body.position, body.sleepTimer, body.velocity, sleepGroups[b], body.angularVelocity,
+                           body.orientation};
+    }
+}
+
+void PhysicsWorld::restoreState(const PhysicsState& state) {
+    if (state.bodies.size() != bodies.size()) {
+        throw std::runtime_error("PhysicsWorld: saved state has a different body count");
+    }
+    stats.stepCount = state.stepCount;
+    accumulator = state.accumulator;
+    triggers.setPairs(state.triggerPairs);
+    for (uint32_t b = 0; b < bodies.size(); b++) {
+        const BodyState& saved = state.bodies[b];
+        RigidBody& body = bodies[b];
+        body.position = saved.position;
+        body.sleepTimer = saved.sleepTimer;
+        body.velocity = saved.velocity;
+        body.angularVelocity = saved.angularVelocity;
+        body.orientation = saved.orientation;
+        sleepGroups[b] = saved.sleepGroup;
+    }
+    // Rebuilt from the same set of sleeping bodies, the hash comes out the
+    // same as in the original run.
+    sleepingHashDirty = true;
+}
+
+uint32_t PhysicsWorld::advance(float dt) {
+    accumulator += dt;
+    uint32_t steps = 0;
+    while (accumulator >= settings.timeStep && steps < settings.maxStepsPerAdvance) {
+        step();
+        accumulator -= settings.timeStep;
+        steps++;
+    }
+    // Drop time we could not catch up on instead of spiralling.
+    accumulator = std::min(accumulator, settings.timeStep);
+    return steps;
+}
+
+void PhysicsWorld::step() {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    float dt = settings.timeStep;
+
+    if (staticGridDirty && settings.staticBroadphase) {
+        buildStaticGrid();
+    }
+    integrateForces(dt);
+    auto contactStart = std::chrono::high_resolution_clock::now();
+    findContacts(dt);
+    stats.contactMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - contactStart).count();
+
+    auto solveStart = std::chrono::high_resolution_clock::now();
+    buildIslands();
+    pool.parallelFor(stats.islandCount, IslandGrainSize, [&](size_t begin, size_t end) {
+        for (size_t island = begin; island < end; island++) {
+            solveIsland(static_cast<uint32_t>(island));
+        }
+    });
+    stats.solveMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - solveStart).count();
+    wakeTouchedBodies();
+    integratePositions(dt);
+    updateTriggers();
+    updateSleep(dt);
+
+    stats.stepCount++;
+    stats.contactCount = static_cast<uint32_t>(contacts.size());
+    stats.bodyContactCount = static_cast<uint32_t>(std::count_if(contacts.begin(), contacts.end(),
+        [](const Contact& contact) { return contact.bodyB != StaticBody; }));
+    stats.stepMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    stats.sleepingBodyCount = 0;
+    stats.activeBodyCount = 0;
+    for (uint32_t b = 0; b < bodies.size(); b++) {
+        if (sleepGroups[b] != Awake) {
+            stats.sleepingBodyCount++;
+        } else if (bodies[b].inverseMass > 0.0f) {
+            stats.activeBodyCount++;
+        }
+    }
+    if (stats.activeBodyCount > 0) {
+        msPerActiveBody = stats.stepMs / stats.activeBodyCount;
+    }
+    stats.sleepSavedMs = msPerActiveBody * stats.sleepingBodyCount;
+}
+
+void PhysicsWorld::integrateForces(float dt) {
+    windBodies.clear();
+    windPoints.clear();
+    for (uint32_t b = 0; b < bodies.size(); b++) {
+        if (bodies[b].inverseMass > 0.0f && sleepGroups[b] == Awake) {
+            bodies[b].velocity += settings.gravity * dt;
+            if (!windField.empty()) {
+                windBodies.push_back(b);
+                windPoints.push_back(bodies[b].position);
+            }
+        }
+    }
+
+    stats.windZoneTests = 0;
+    if (windField.empty()) {
+        return;
+    }
+    auto windStart = std::chrono::high_resolution_clock::now();
+    // Gusts are a function of simulated time, so rollback replays them.
+    float time = static_cast<float>(stats.stepCount) * dt;
+    windField.sampleMany(windPoints, time, windForces, pool);
+    for (size_t i = 0; i < windBodies.size(); i++) {
+        RigidBody& body = bodies[windBodies[i]];
+        body.velocity += windForces[i] * (body.inverseMass * dt);
+    }
+    stats.windZoneTests = windField.getZoneTests();
+    stats.windMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - windStart).count();
+}
+
+void PhysicsWorld::findContacts(float dt) {
+    size_t chunkCount = (bodies.size() + BodyChunkSize - 1) / BodyChunkSize;
+    if (chunks.size() < chunkCount) {
+        chunks.resize(chunkCount);
+    }
+
+    if (settings.bodyCollisions) {
+        float maxRadius = 0.0f;
+        awakeIds.clear();
+        hashPoints.clear();
+        for (uint32_t b = 0; b < bodies.size(); b++) {
+            maxRadius = std::max(maxRadius, bodies[b].radius);
+            if (sleepGroups[b] == Awake) {
+                awakeIds.push_back(b);
+                hashPoints.push_back(bodies[b].position);
+            }
+        }
+        // Ball-ball speculative margins are capped at the largest radius, so
+        // every pair that can touch this step lies in neighbouring cells.
+        bodyMargin = settings.speculativeContacts ? maxRadius : 0.0f;
+        float cellSize = 2.0f * maxRadius + bodyMargin + settings.contactSlop;
+        awakeHash.build(hashPoints, cellSize);
+        if (sleepingHashDirty || sleepingHash.getCellSize() != cellSize) {
+            sleepingIds.clear();
+            hashPoints.clear();
+            for (uint32_t b = 0; b < bodies.size(); b++) {
+                if (sleepGroups[b] != Awake) {
+                    sleepingIds.push_back(b);
+                    hashPoints.push_back(bodies[b].position);
+                }
+            }
+            sleepingHash.build(hashPoints, cellSize);
+            sleepingHashDirty = false;
+        }
+    }
+
+    pool.parallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            BodyChunk& chunk = chunks[c];
+            chunk.contacts.clear();
+            chunk.triangleTests = 0;
+            uint32_t first = static_cast<uint32_t>(c * BodyChunkSize);
+            uint32_t last = static_cast<uint32_t>(std::min(first + BodyChunkSize, bodies.size()));
+            for (uint32_t b = first; b < last; b++) {
+                if (sleepGroups[b] != Awake) {
+                    continue;
+                }
+                if (bodies[b].inverseMass > 0.0f) {
+                    findStaticContacts(b, dt, chunk);
+                }
+                if (settings.bodyCollisions) {
+                    findBodyContacts(b, dt, chunk);
+                }
+            }
+        }
+    });
+
+    contacts.clear();
+    for (size_t c = 0; c < chunkCount; c++) {
+        contacts.insert(contacts.end(), chunks[c].contacts.begin(), chunks[c].contacts.end());
+        stats.triangleTests += chunks[c].triangleTests;
+    }
+}
+
+void PhysicsWorld::findStaticContacts(uint32_t bodyId, float dt, BodyChunk& chunk) const {
+    const RigidBody& body = bodies[bodyId];
+
+    // Surfaces reachable within this step become speculative contacts.
+    float margin = settings.contactSlop;
+    if (settings.speculativeContacts) {
+        margin += glm::length(body.velocity) * dt;
+    }
+    Aabb reach;
+    reach.min = body.position - glm::vec3(body.radius + margin);
+    reach.max = body.position + glm::vec3(body.radius + margin);
+
+    // Candidates come back in ascending triangle order either way, which
+    // keeps the contact order and therefore the results deterministic.
+    std::vector<uint32_t>& candidates = chunk.candidates;
+    if (settings.staticBroadphase) {
+        staticGrid.query(reach, candidates);
+    } else {
+        candidates.resize(staticTriangles.size());
+        for (uint32_t i = 0; i < candidates.size(); i++) {
+            candidates[i] = i;
+        }
+    }
+
+    std::vector<uint32_t>& nearby = chunk.nearby;
+    nearby.clear();
+    for (uint32_t i : candidates) {
+        if (staticBounds[i].overlaps(reach)) {
+            nearby.push_back(i);
+        }
+    }
+    chunk.triangleTests += nearby.size();
+
+    uint32_t width = settings.narrowphaseWidth;
+    if (width != 4 && width != 8) {
+        for (uint32_t i : nearby) {
+            const Triangle& tri = staticTriangles[i];
+            SphereContact hit;
+            if (sphereTriangleContact(body.position, body.radius, margin, tri.v0, tri.v1, tri.v2, hit)) {
+                addContact(bodyId, StaticBody, hit.normal, hit.separation, dt, chunk.contacts);
+            }
+        }
+        return;
+    }
+    for (size_t first = 0; first < nearby.size(); first += width) {
+        int count = static_cast<int>(std::min<size_t>(width, nearby.size() - first));
+        glm::vec3 closest[8];
+        const uint32_t* indices = nearby.data() + first;
+        int mask = static_cast<int>(width == 8
+            ? sphereTriangleBatch<8>(packedTriangles.data(), indices, count, body.position, body.radius + margin, closest)
+            : sphereTriangleBatch<4>(packedTriangles.data(), indices, count, body.position, body.radius + margin, closest));
+        while (mask) {
+            int lane = simd::popLowestLane(mask);
+            const Triangle& tri = staticTriangles[indices[lane]];
+            SphereContact hit;
+            sphereContactFromClosest(body.position, body.radius, closest[lane], tri.v0, tri.v1, tri.v2, hit);
+            addContact(bodyId, StaticBody, hit.normal, hit.separation, dt, chunk.contacts);
+        }
+    }
+}
+
+void PhysicsWorld::findBodyContacts(uint32_t bodyId, float dt, BodyChunk& chunk) const {
+    const RigidBody& body = bodies[bodyId];
+    // Awake pairs once, from their lower index; sleeping bodies do not
+    // search, so awake bodies test all of them.
+    size_t awakeCount = 0;
+    awakeHash.query(body.position, chunk.neighbors);
+    for (uint32_t index : chunk.neighbors) {
+        if (awakeIds[index] > bodyId) {
+            chunk.neighbors[awakeCount++] = awakeIds[index];
+        }
+    }
+    chunk.neighbors.resize(awakeCount);
+    if (body.inverseMass > 0.0f && !sleepingIds.empty()) {
+        sleepingHash.query(body.position, chunk.candidates);
+        for (uint32_t index : chunk.candidates) {
+            chunk.neighbors.push_back(sleepingIds[index]);
+        }
+    }
+
+    for (uint32_t otherId : chunk.neighbors) {
+        const RigidBody& other = bodies[otherId];
+        if (body.inverseMass == 0.0f && other.inverseMass == 0.0f) {
+            continue;
+        }
+        float margin = settings.contactSlop;
+        if (settings.speculativeContacts) {
+            margin += std::min(glm::length(body.velocity - other.velocity) * dt, bodyMargin);
+        }
+        glm::vec3 delta = body.position - other.position;
+        float reach = body.radius + other.radius + margin;
+        float distanceSquared = glm::dot(delta, delta);
+        if (distanceSquared > reach * reach) {
+            continue;
+        }
+        float distance = std::sqrt(distanceSquared);
+        glm::vec3 normal = distance > 0.0f ? delta / distance : glm::vec3(0.0f, 1.0f, 0.0f);
+        float separation = distance - body.radius - other.radius;
+        // The movable body goes first; the solver never writes to immovable
+        // ones, which may be shared between islands.
+        if (body.inverseMass > 0.0f) {
+            addContact(bodyId, otherId, normal, separation, dt, chunk.contacts);
+        } else {
+            addContact(otherId, bodyId, -normal, separation, dt, chunk.contacts);
+        }
+    }
+}
+
+void PhysicsWorld::addContact(uint32_t bodyA, uint32_t bodyB, const glm::vec3& normal, float separation, float dt,
+                              std::vector<Contact>& out) const {
+    const RigidBody& a = bodies[bodyA];
+    const RigidBody& b = bodyB == StaticBody ? levelBody : bodies[bodyB];
+    Contact contact;
+    contact.bodyA = bodyA;
+    contact.bodyB = bodyB;
+    contact.normal = normal;
+    contact.separation = separation;
+    contact.normalImpulse = 0.0f;
+    contact.frictionImpulse = glm::vec3(0.0f);
+    if (bodyB == StaticBody) {
+        contact.friction = a.friction;
+        contact.restitution = a.restitution;
+    } else {
+        contact.friction = std::sqrt(a.friction * b.friction);
+        contact.restitution = std::max(a.restitution, b.restitution);
+    }
+    // Sleeping bodies act as immovable until they wake next step.
+    contact.movesB = bodyB != StaticBody && b.inverseMass > 0.0f && sleepGroups[bodyB] == Awake;
+    float inverseMassB = contact.movesB ? b.inverseMass : 0.0f;
+    float inverseInertiaB = contact.movesB ? b.inverseInertia : 0.0f;
+    // The lever arms are parallel to the normal, so only the linear
+    // velocities contribute to the normal constraint, and a tangential
+    // impulse turns each body by r^2 / I.
+    contact.normalMass = 1.0f / (a.inverseMass + inverseMassB);
+    contact.tangentMass = 1.0f / (a.inverseMass + inverseMassB + a.radius * a.radius * a.inverseInertia +
+                                  b.radius * b.radius * inverseInertiaB);
+
+    contact.approachSpeed = glm::dot(a.velocity - b.velocity, normal);
+    if (separation > 0.0f) {
+        // Only allow the approach that closes the gap this step.
+        contact.bias = -separation / dt;
+    } else {
+        contact.bias = settings.baumgarte * std::max(-separation - settings.contactSlop, 0.0f) / dt;
+    }
+    out.push_back(contact);
+}
+
+uint32_t PhysicsWorld::findRoot(uint32_t body) {
+    while (islandParent[body] != body) {
+        islandParent[body] = islandParent[islandParent[body]];
+        body = islandParent[body];
+    }
+    return body;
+}
+
+void PhysicsWorld::buildIslands() {
+    // Union-find over ball-ball contacts. Immovable and sleeping bodies and
+    // the level never join islands since the solver does not write to them.
+    islandParent.resize(bodies.size());
+    for (uint32_t i = 0; i < islandParent.size(); i++) {
+        islandParent[i] = i;
+    }
+    for (const auto& contact : contacts) {
+        if (!contact.movesB) {
+            continue;
+        }
+        uint32_t a = findRoot(contact.bodyA);
+        uint32_t b = findRoot(contact.bodyB);
+        if (a != b) {
+            // The lower index becomes the root, independent of contact order.
+            islandParent[std::max(a, b)] = std::min(a, b);
+        }
+    }
+
+    // Islands are numbered by first appearance in the contact list, and the
+    // counting sort below is stable, so each island keeps its contacts in
+    // the same relative order as a single sequential pass would.
+    islandOfRoot.assign(bodies.size(), UINT32_MAX);
+    contactIsland.resize(contacts.size());
+    uint32_t islandCount = 0;
+    for (size_t i = 0; i < contacts.size(); i++) {
+        uint32_t root = findRoot(contacts[i].bodyA);
+        if (islandOfRoot[root] == UINT32_MAX) {
+            islandOfRoot[root] = islandCount++;
+        }
+        contactIsland[i] = islandOfRoot[root];
+    }
+
+    islandStart.assign(islandCount + 1, 0);
+    for (uint32_t island : contactIsland) {
+        islandStart[island + 1]++;
+    }
+    uint32_t largest = 0;
+    for (uint32_t k = 0; k < islandCount; k++) {
+        largest = std::max(largest, islandStart[k + 1]);
+        islandStart[k + 1] += islandStart[k];
+    }
+    sortedContacts.resize(contacts.size());
+    for (size_t i = 0; i < contacts.size(); i++) {
+        sortedContacts[islandStart[contactIsland[i]]++] = contacts[i];
+    }
+    for (uint32_t k = islandCount; k > 0; k--) {
+        islandStart[k] = islandStart[k - 1];
+    }
+    islandStart[0] = 0;
+    contacts.swap(sortedContacts);
+
+    stats.islandCount = islandCount;
+    stats.largestIsland = largest;
+}
+
+void PhysicsWorld::solveIsland(uint32_t island) {
+    Contact* first = contacts.data() + islandStart[island];
+    Contact* last = contacts.data() + islandStart[island + 1];
+
+    for (uint32_t iteration = 0; iteration < settings.velocityIterations; iteration++) {
+        for (Contact* contact = first; contact != last; contact++) {
+            RigidBody& a = bodies[contact->bodyA];
+            RigidBody& b = contact->bodyB == StaticBody ? levelBody : bodies[contact->bodyB];
+            bool moveB = contact->movesB;
+            glm::vec3 n = contact->normal;
+            glm::vec3 ra = -n * a.radius;
+            glm::vec3 rb = n * b.radius;
+
+            float vn = glm::dot(a.velocity - b.velocity, n);
+            float lambda = (contact->bias - vn) * contact->normalMass;
+            float previous = contact->normalImpulse;
+            contact->normalImpulse = std::max(previous + lambda, 0.0f);
+            float applied = contact->normalImpulse - previous;
+            a.velocity += n * (applied * a.inverseMass);
+            if (moveB) {
+                b.velocity -= n * (applied * b.inverseMass);
+            }
+
+            glm::vec3 vc = a.velocity + glm::cross(a.angularVelocity, ra) - b.velocity - glm::cross(b.angularVelocity, rb);
+            glm::vec3 vt = vc - n * glm::dot(vc, n);
+            glm::vec3 previousFriction = contact->frictionImpulse;
+            glm::vec3 friction = previousFriction - vt * contact->tangentMass;
+            float maxFriction = contact->friction * contact->normalImpulse;
+            float frictionLength = glm::length(friction);
+            if (frictionLength > maxFriction) {
+                friction *= maxFriction / frictionLength;
+            }
+            contact->frictionImpulse = friction;
+
+            glm::vec3 delta = friction - previousFriction;
+            a.velocity += delta * a.inverseMass;
+            a.angularVelocity += glm::cross(ra, delta) * a.inverseInertia;
+            if (moveB) {
+                b.velocity -= delta * b.inverseMass;
+                b.angularVelocity -= glm::cross(rb, delta) * b.inverseInertia;
+            }
+        }
+    }
+
+    // Bounce off contacts that actually pushed back this step, using the
+    // approach speed from before the solve; speculative contacts would
+    // otherwise absorb the impact before the body touches the surface.
+    for (Contact* contact = first; contact != last; contact++) {
+        if (contact->normalImpulse <= 0.0f || contact->approachSpeed >= -settings.restitutionThreshold ||
+            contact->restitution <= 0.0f) {
+            continue;
+        }
+        RigidBody& a = bodies[contact->bodyA];
+        RigidBody& b = contact->bodyB == StaticBody ? levelBody : bodies[contact->bodyB];
+        float vn = glm::dot(a.velocity - b.velocity, contact->normal);
+        float lambda = (-contact->restitution * contact->approachSpeed - vn) * contact->normalMass;
+        float previous = contact->normalImpulse;
+        contact->normalImpulse = std::max(previous + lambda, 0.0f);
+        float applied = contact->normalImpulse - previous;
+        a.velocity += contact->normal * (applied * a.inverseMass);
+        if (contact->movesB) {
+            b.velocity -= contact->normal * (applied * b.inverseMass);
+        }
+    }
+
+    // Rolling resistance: torque opposing the spin, proportional to the
+    // normal load; friction carries the slowdown over to the linear velocity
+    // on later steps. Balls resting on each other brake each other too, so
+    // piles come to rest.
+    auto brakeSpin = [](RigidBody& body, float normalImpulse) {
+        float spin = glm::length(body.angularVelocity);
+        if (spin <= 0.0f) {
+            return;
+        }
+        float brake = body.rollingFriction * normalImpulse * body.radius * body.inverseInertia;
+        body.angularVelocity *= std::max(spin - brake, 0.0f) / spin;
+    };
+    for (Contact* contact = first; contact != last; contact++) {
+        if (contact->normalImpulse <= 0.0f) {
+            continue;
+        }
+        brakeSpin(bodies[contact->bodyA], contact->normalImpulse);
+        if (contact->movesB) {
+            brakeSpin(bodies[contact->bodyB], contact->normalImpulse);
+        }
+    }
+}
+
+void PhysicsWorld::wakeTouchedBodies() {
+    // A sleeping body that pushed back on an awake one wakes with its group
+    // for the next step; speculative contacts that stayed apart do not count.
+    bool any = false;
+    groupsToWake.assign(bodies.size(), 0);
+    for (const auto& contact : contacts) {
+        if (contact.bodyB != StaticBody && sleepGroups[contact.bodyB] != Awake && contact.normalImpulse > 0.0f) {
+            groupsToWake[sleepGroups[contact.bodyB]] = 1;
+            any = true;
+        }
+    }
+    if (!any) {
+        return;
+    }
+    for (uint32_t b = 0; b < bodies.size(); b++) {
+        if (sleepGroups[b] != Awake && groupsToWake[sleepGroups[b]]) {
+            sleepGroups[b] = Awake;
+            bodies[b].sleepTimer = 0.0f;
+        }
+    }
+    sleepingHashDirty = true;
+}
+
+void PhysicsWorld::updateTriggers() {
+    auto triggerStart = std::chrono::high_resolution_clock::now();
+    triggers.update(bodies, pool, triggerEvents);
+    for (const TriggerEvent& event : triggerEvents) {
+        if (event.type != TriggerEvent::Type::Enter) {
+            continue;
+        }
+        const TriggerDesc* desc = triggers.get(event.trigger);
+        if (desc && desc->bounceImpulse != glm::vec3(0.0f)) {
+            applyImpulse(event.bodyId, desc->bounceImpulse);
+        }
+    }
+    stats.triggerTests = triggers.getTests();
+    stats.triggerEventCount = static_cast<uint32_t>(triggerEvents.size());
+    stats.triggerMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - triggerStart).count();
+}
+
+void PhysicsWorld::updateSleep(float dt) {
+    if (!settings.allowSleeping) {
+        return;
+    }
+    for (uint32_t b = 0; b < bodies.size(); b++) {
+        RigidBody& body = bodies[b];
+        if (body.inverseMass == 0.0f || sleepGroups[b] != Awake) {
+            continue;
+        }
+        float limit = body.sleepSpeed * body.sleepSpeed;
+        float spin = glm::dot(body.angularVelocity, body.angularVelocity) * body.radius * body.radius;
+        bool slow = glm::dot(body.velocity, body.velocity) < limit && spin < limit;
+        body.sleepTimer = slow ? body.sleepTimer + dt : 0.0f;
+    }
+
+    // An island sleeps once its most recently moving body has rested long
+    // enough; the island root names the group so it also wakes as one.
+    islandRest.assign(bodies.size(), std::numeric_limits<float>::max());
+    for (uint32_t b = 0; b < bodies.size(); b++) {
+        if (bodies[b].inverseMass > 0.0f && sleepGroups[b] == Awake) {
+            uint32_t root = findRoot(b);
+            islandRest[root] = std::min(islandRest[root], bodies[b].sleepTimer);
+        }
+    }
+    for (uint32_t b = 0; b < bodies.size(); b++) {
+        RigidBody& body = bodies[b];
+        if (body.inverseMass == 0.0f || sleepGroups[b] != Awake) {
+            continue;
+        }
+        uint32_t root = findRoot(b);
+        if (islandRest[root] >= settings.sleepDelay) {
+            sleepGroups[b] = root;
+            body.velocity = glm::vec3(0.0f);
+            body.angularVelocity = glm::vec3(0.0f);
+            sleepingHashDirty = true;
+        }
+    }
+}
+
+void PhysicsWorld::integratePositions(float dt) {
+    size_t chunkCount = (bodies.size() + BodyChunkSize - 1) / BodyChunkSize;
+    if (chunks.size() < chunkCount) {
+        chunks.resize(chunkCount);
+    }
+    pool.parallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            BodyChunk& chunk = chunks[c];
+            chunk.ccdMs = 0.0;
+            chunk.ccdBodies = 0;
+            chunk.ccdIterations = 0;
+            chunk.ccdHits = 0;
+            size_t first = c * BodyChunkSize;
+            size_t last = std::min(first + BodyChunkSize, bodies.size());
+            for (size_t b = first; b < last; b++) {
+                RigidBody& body = bodies[b];
+                if (body.inverseMass == 0.0f || sleepGroups[b] != Awake) {
+                    continue;
+                }
+                glm::vec3 motion = body.velocity * dt;
+                float threshold = settings.ccdMotionThreshold * body.radius;
+                if (settings.continuousCollision && glm::dot(motion, motion) > threshold * threshold) {
+                    auto sweepStart = std::chrono::high_resolution_clock::now();
+                    body.position = sweepBody(body, motion, chunk);
+                    chunk.ccdBodies++;
+                    chunk.ccdMs += std::chrono::duration<double, std::milli>(
+                        std::chrono::high_resolution_clock::now() - sweepStart).count();
+                } else {
+                    body.position += motion;
+                }
+                glm::quat spin(0.0f, body.angularVelocity.x, body.angularVelocity.y, body.angularVelocity.z);
+                body.orientation = glm::normalize(body.orientation + spin * body.orientation * (0.5f * dt));
+            }
+        }
+    });
+
+    stats.ccdMs = 0.0;
+    stats.ccdBodies = 0;
+    stats.ccdIterations = 0;
+    stats.ccdHits = 0;
+    for (size_t c = 0; c < chunkCount; c++) {
+        stats.ccdMs += chunks[c].ccdMs;
+        stats.ccdBodies += chunks[c].ccdBodies;
+        stats.ccdIterations += chunks[c].ccdIterations;
+        stats.ccdHits += chunks[c].ccdHits;
+    }
+}
+
+void PhysicsWorld::gatherCandidates(const glm::vec3& from, const glm::vec3& to, float radius,
+                                    std::vector<uint32_t>& out) const {
+    if (settings.staticBroadphase && !staticGridDirty) {
+        staticGrid.querySweptSphere(from, to, radius, out);
+        return;
+    }
+    Aabb sweep;
+    sweep.grow(glm::min(from, to) - glm::vec3(radius));
+    sweep.grow(glm::max(from, to) + glm::vec3(radius));
+    out.clear();
+    for (uint32_t i = 0; i < staticTriangles.size(); i++) {
+        if (staticBounds[i].overlaps(sweep)) {
+            out.push_back(i);
+        }
+    }
+}
+
+glm::vec3 PhysicsWorld::sweepBody(const RigidBody& body, glm::vec3 motion, BodyChunk& chunk) const {
+    glm::vec3 position = body.position;
+    for (uint32_t subStep = 0; subStep <= settings.ccdMaxSubSteps; subStep++) {
+        float length = glm::length(motion);
+        if (length <= 0.0f) {
+            break;
+        }
+        gatherCandidates(position, position + motion, body.radius + settings.ccdTolerance, chunk.approaching);
+        std::vector<uint32_t>& approaching = chunk.approaching;
+
+        // Conservative advancement: the centre moves at most `length` per
+        // unit of t, so advancing by the gap to the nearest surface can
+        // never step past it. The distance to a triangle along a line is
+        // convex, so a triangle whose distance shrinks by less than the
+        // tolerance over the rest of the motion can be dropped for good.
+        float t = 0.0f;
+        bool hit = false;
+        glm::vec3 normal(0.0f);
+        for (uint32_t iteration = 0; iteration < settings.ccdMaxIterations; iteration++) {
+            chunk.ccdIterations++;
+            glm::vec3 center = position + motion * t;
+            float nearest = std::numeric_limits<float>::max();
+            size_t kept = 0;
+            for (uint32_t index : approaching) {
+                const Triangle& tri = staticTriangles[index];
+                glm::vec3 delta = center - closestPointOnTriangle(center, tri.v0, tri.v1, tri.v2);
+                float distance = glm::length(delta);
+                if (distance > 0.0f && glm::dot(delta, motion) >= -settings.ccdTolerance * distance) {
+                    continue;
+                }
+                approaching[kept++] = index;
+                if (distance < nearest) {
+                    nearest = distance;
+                    normal = distance > 0.0f ? delta / distance : -motion / length;
+                }
+            }
+            approaching.resize(kept);
+            if (kept == 0) {
+                break;
+            }
+            float gap = nearest - body.radius;
+            if (gap <= settings.ccdTolerance || iteration + 1 == settings.ccdMaxIterations) {
+                // Out of iterations counts as a hit; t never overshoots.
+                hit = true;
+                break;
+            }
+            t += gap / length;
+            if (t >= 1.0f) {
+                break;
+            }
+        }
+
+        if (!hit) {
+            position += motion;
+            break;
+        }
+        chunk.ccdHits++;
+        position += motion * t;
+        // Keep the part of the remaining motion that slides along the surface.
+        glm::vec3 rest = motion * (1.0f - t);
+        motion = rest - normal * std::min(glm::dot(rest, normal), 0.0f);
+        if (subStep == settings.ccdMaxSubSteps) {
+            break;
+        }
+    }
+    return position;
+}
+
+glm::mat4 PhysicsWorld::getBodyTransform(uint32_t id) const {
+    const RigidBody& body = bodies[id];
+    return glm::translate(glm::mat4(1.0f), body.position) * glm::mat4_cast(body.orientation);
+}
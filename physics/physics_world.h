@@ -0,0 +1,299 @@
+#pragma once
+
+#include "bvh/aabb.h"
+#include "bvh/triangle_mesh.h"
+#include "narrowphase.h"
+#include "spatial_hash.h"
+#include "trigger_set.h"
+#include "uniform_grid.h"
+#include "wind_field.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <vector>
+
+struct SphereContact;
+class ThreadPool;
+
+// Solid sphere; inverseMass == 0 makes it immovable.
+struct RigidBody {
+    glm::vec3 position = glm::vec3(0.0f);
+    float radius = 0.5f;
+    glm::vec3 velocity = glm::vec3(0.0f);
+    float inverseMass = 1.0f;
+    glm::vec3 angularVelocity = glm::vec3(0.0f);
+    float inverseInertia = 10.0f;
+    glm::quat orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    float restitution = 0.3f;
+    float friction = 0.6f;
+    float rollingFriction = 0.01f;
+    // While slower than this (linearly and at the surface), the sleep timer
+    // runs; 0 keeps the body awake.
+    float sleepSpeed = 0.05f;
+    float sleepTimer = 0.0f;
+};
+
+struct BodyDesc {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 velocity = glm::vec3(0.0f);
+    float radius = 0.5f;
+    float mass = 1.0f;
+    float restitution = 0.3f;
+    float friction = 0.6f;
+    float rollingFriction = 0.01f;
+    float sleepSpeed = 0.05f;
+};
+
+struct PhysicsSettings {
+    glm::vec3 gravity = glm::vec3(0.0f, -9.81f, 0.0f);
+    float timeStep = 1.0f / 120.0f;
+    uint32_t velocityIterations = 8;
+    // Allowed penetration and the fraction of the remainder removed per step.
+    float contactSlop = 0.005f;
+    float baumgarte = 0.2f;
+    // Approach speeds below this do not bounce, so resting balls settle.
+    float restitutionThreshold = 0.5f;
+    // advance() never runs more steps than this per call.
+    uint32_t maxStepsPerAdvance = 8;
+    // Contacts for surfaces the body can reach within the step, so fast
+    // bodies stop at walls instead of reacting after penetrating them.
+    bool speculativeContacts = true;
+    // Bodies moving more than this fraction of their radius in one step are
+    // swept to their time of impact by conservative advancement. After a
+    // hit the rest of the motion slides along the surface, at most
+    // ccdMaxSubSteps times; the body stops at the last impact after that.
+    bool continuousCollision = true;
+    float ccdMotionThreshold = 0.5f;
+    uint32_t ccdMaxIterations = 16;
+    uint32_t ccdMaxSubSteps = 2;
+    float ccdTolerance = 0.001f;
+    // Static broadphase; a cell size of 0 picks one from the level's
+    // triangle sizes and the largest ball radius at the first step.
+    bool staticBroadphase = true;
+    float gridCellSize = 0.0f;
+    // Triangles per narrowphase batch: 4 or 8 SIMD lanes, anything else
+    // tests them one at a time with the scalar routine. Defaults to the
+    // widest native batch.
+    uint32_t narrowphaseWidth = nativeBatchWidth();
+    // Ball-ball contacts, found through a spatial hash rebuilt each step.
+    bool bodyCollisions = true;
+    // Islands whose bodies have all been slow for sleepDelay seconds stop
+    // being simulated until something pushes them or they are woken.
+    bool allowSleeping = true;
+    float sleepDelay = 0.5f;
+    // Wind zone grid cell size; 0 picks half the median zone extent.
+    float windCellSize = 0.0f;
+};
+
+struct PhysicsStats {
+    uint64_t stepCount = 0;
+    uint32_t contactCount = 0;
+    uint32_t bodyContactCount = 0;
+    uint32_t islandCount = 0;
+    uint32_t largestIsland = 0;
+    uint64_t triangleTests = 0;
+    double stepMs = 0.0;
+    // Per-step collision cost: discrete contact search versus sweeps.
+    double contactMs = 0.0;
+    double solveMs = 0.0;
+    // Summed over the worker threads.
+    double ccdMs = 0.0;
+    uint32_t ccdBodies = 0;
+    uint32_t ccdIterations = 0;
+    uint32_t ccdHits = 0;
+    uint32_t activeBodyCount = 0;
+    uint32_t sleepingBodyCount = 0;
+    // Estimate: sleeping bodies times the cost per active body of the last
+    // step that had any.
+    double sleepSavedMs = 0.0;
+    double windMs = 0.0;
+    uint64_t windZoneTests = 0;
+    double triggerMs = 0.0;
+    uint64_t triggerTests = 0;
+    uint32_t triggerEventCount = 0;
+};
+
+// The part of a body that changes while stepping; shape and material stay
+// in the world.
+struct BodyState {
+    glm::vec3 position;
+    float sleepTimer;
+    glm::vec3 velocity;
+    uint32_t sleepGroup;
+    glm::vec3 angularVelocity;
+    glm::quat orientation;
+};
+
+// Everything a step reads from earlier steps, as one flat array, so rollback
+// and resimulation reproduce the original run bit for bit. Restoring needs
+// the same bodies, level and settings as when the state was saved.
+struct PhysicsState {
+    uint64_t stepCount = 0;
+    float accumulator = 0.0f;
+    std::vector<BodyState> bodies;
+    // Trigger overlaps, so replayed steps report the same enter/exit events.
+    std::vector<TriggerPair> triggerPairs;
+
+    size_t byteSize() const {
+        return sizeof(stepCount) + sizeof(accumulator) + bodies.size() * sizeof(BodyState) +
+               triggerPairs.size() * sizeof(TriggerPair);
+    }
+};
+
+// Fixed-step rigid sphere simulation under gravity and wind zones, against
+// static triangle geometry and between the spheres themselves. Contacts are
+// solved with sequential impulses (normal, Coulomb friction and rolling
+// resistance) and include speculative contacts for surfaces the body can
+// reach within one step.
+// Bodies touching each other form islands (union-find over ball-ball
+// contacts) that are solved independently on the thread pool, and islands
+// that come to rest fall asleep together: sleeping bodies are skipped by
+// integration, the contact search and the solver, and act as immovable
+// until a push, applyImpulse or wakeBody wakes their island. Every body
+// and island is processed in a fixed order regardless of the thread count,
+// so identical inputs give bitwise identical results, also when stepping
+// again from a state restored with restoreState.
+class PhysicsWorld {
+public:
+    explicit PhysicsWorld(const PhysicsSettings& settings = PhysicsSettings());
+    PhysicsWorld(const PhysicsSettings& settings, ThreadPool& pool);
+
+    void setStaticGeometry(const TriangleMesh& mesh);
+    // Both copy the triangles. A grid built earlier over the same triangles
+    // (e.g. loaded from a level file) is copied too, instead of being
+    // rebuilt on the next step.
+    void setStaticGeometry(const Triangle* triangles, size_t count, const UniformGrid* grid = nullptr);
+    // Replaces all wind zones and wakes every body.
+    void setWindZones(const std::vector<WindZone>& zones);
+    // Triggers report overlaps with dynamic bodies as events after every
+    // step; bounce pads apply their impulse to bodies entering them.
+    TriggerId addTrigger(const TriggerDesc& desc);
+    bool removeTrigger(TriggerId id);
+    // Events of the last step only.
+    const std::vector<TriggerEvent>& getTriggerEvents() const { return triggerEvents; }
+    uint32_t addBody(const BodyDesc& desc);
+    // Wakes the body first.
+    void applyImpulse(uint32_t bodyId, const glm::vec3& impulse);
+    // Wakes the body and everything that fell asleep with it. Call after
+    // changing a body's state through getBody() or moving things near it.
+    void wakeBody(uint32_t bodyId);
+    void wakeAll();
+    bool isSleeping(uint32_t bodyId) const { return sleepGroups[bodyId] != Awake; }
+
+    // Reuses the state's storage, so saving every step does not allocate.
+    void saveState(PhysicsState& state) const;
+    void restoreState(const PhysicsState& state);
+
+    void step();
+    // Runs the fixed steps that fit into dt; returns the number taken.
+    uint32_t advance(float dt);
+    // Fraction of a step left in the accumulator, for render interpolation.
+    float getInterpolationAlpha() const { return accumulator / settings.timeStep; }
+
+    RigidBody& getBody(uint32_t id) { return bodies[id]; }
+    const RigidBody& getBody(uint32_t id) const { return bodies[id]; }
+    uint32_t getBodyCount() const { return static_cast<uint32_t>(bodies.size()); }
+    glm::mat4 getBodyTransform(uint32_t id) const;
+
+    const PhysicsSettings& getSettings() const { return settings; }
+    const PhysicsStats& getStats() const { return stats; }
+    const UniformGrid& getStaticGrid() const { return staticGrid; }
+    const WindField& getWindField() const { return windField; }
+    const TriggerSet& getTriggers() const { return triggers; }
+
+private:
+    // bodyB of contacts with the level geometry.
+    static constexpr uint32_t StaticBody = UINT32_MAX;
+    // sleepGroups entry of awake bodies; sleeping ones hold their group id.
+    static constexpr uint32_t Awake = UINT32_MAX;
+
+    struct Contact {
+        uint32_t bodyA;
+        uint32_t bodyB;
+        glm::vec3 normal;  // from B towards A
+        float separation;
+        float bias;
+        float approachSpeed;
+        float friction;
+        float restitution;
+        // Effective masses, fixed for the step since the lever arms are.
+        float normalMass;
+        float tangentMass;
+        float normalImpulse;
+        glm::vec3 frictionImpulse;
+        // False for the level and for immovable or sleeping bodies.
+        bool movesB;
+    };
+
+    // Per-chunk working memory, so chunks of bodies can be processed on
+    // different threads; outputs are merged in chunk order.
+    struct BodyChunk {
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> approaching;
+        std::vector<uint32_t> nearby;
+        std::vector<uint32_t> neighbors;
+        std::vector<Contact> contacts;
+        uint64_t triangleTests = 0;
+        double ccdMs = 0.0;
+        uint32_t ccdBodies = 0;
+        uint32_t ccdIterations = 0;
+        uint32_t ccdHits = 0;
+    };
+
+    void buildStaticGrid();
+    void integrateForces(float dt);
+    void findContacts(float dt);
+    void findStaticContacts(uint32_t bodyId, float dt, BodyChunk& chunk) const;
+    void findBodyContacts(uint32_t bodyId, float dt, BodyChunk& chunk) const;
+    void addContact(uint32_t bodyA, uint32_t bodyB, const glm::vec3& normal, float separation, float dt,
+                    std::vector<Contact>& out) const;
+    void buildIslands();
+    void solveIsland(uint32_t island);
+    void wakeTouchedBodies();
+    void updateSleep(float dt);
+    void updateTriggers();
+    void integratePositions(float dt);
+    glm::vec3 sweepBody(const RigidBody& body, glm::vec3 motion, BodyChunk& chunk) const;
+    void gatherCandidates(const glm::vec3& from, const glm::vec3& to, float radius,
+                          std::vector<uint32_t>& out) const;
+    uint32_t findRoot(uint32_t body);
+
+    PhysicsSettings settings;
+    ThreadPool& pool;
+    std::vector<RigidBody> bodies;
+    // Stand-in for the level in ball-ball code paths: immovable, at rest.
+    RigidBody levelBody;
+    std::vector<Triangle> staticTriangles;
+    std::vector<Aabb> staticBounds;
+    std::vector<PackedTriangle> packedTriangles;
+    UniformGrid staticGrid;
+    bool staticGridDirty = false;
+    WindField windField;
+    std::vector<uint32_t> windBodies;
+    std::vector<glm::vec3> windPoints;
+    std::vector<glm::vec3> windForces;
+    TriggerSet triggers;
+    std::vector<TriggerEvent> triggerEvents;
+    // Awake bodies are rehashed every step; sleeping ones do not move, so
+    // their hash is only rebuilt when bodies fall asleep or wake.
+    SpatialHash awakeHash;
+    SpatialHash sleepingHash;
+    std::vector<uint32_t> awakeIds;
+    std::vector<uint32_t> sleepingIds;
+    std::vector<glm::vec3> hashPoints;
+    bool sleepingHashDirty = false;
+    double msPerActiveBody = 0.0;
+    float bodyMargin = 0.0f;
+    std::vector<uint32_t> sleepGroups;
+    std::vector<float> islandRest;
+    std::vector<uint8_t> groupsToWake;
+    std::vector<BodyChunk> chunks;
+    std::vector<Contact> contacts;
+    std::vector<Contact> sortedContacts;
+    std::vector<uint32_t> islandParent;
+    std::vector<uint32_t> islandOfRoot;
+    std::vector<uint32_t> contactIsland;
+    std::vector<uint32_t> islandStart;
+    float accumulator = 0.0f;
+    PhysicsStats stats;
+};
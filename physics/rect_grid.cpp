@@ -0,0 +1,92 @@
+#include "rect_grid.h"
+#include "grid_cells.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Grids larger than this per rectangle are mostly empty cells; the cell
+// size is grown until the grid fits.
+constexpr uint64_t MaxCellsPerRect = 16;
+
+} // namespace
+
+void RectGrid::clear() {
+    cellsX = cellsZ = 0;
+    cellStart.assign(1, 0);
+    cellItems.clear();
+}
+
+void RectGrid::build(const std::vector<glm::vec2>& rectMin, const std::vector<glm::vec2>& rectMax, float cellSize) {
+    clear();
+    glm::vec2 boundsMin(INFINITY);
+    glm::vec2 boundsMax(-INFINITY);
+    std::vector<float> extents;
+    for (size_t i = 0; i < rectMin.size(); i++) {
+        if (rectMin[i].x > rectMax[i].x || rectMin[i].y > rectMax[i].y) {
+            continue;
+        }
+        boundsMin = glm::min(boundsMin, rectMin[i]);
+        boundsMax = glm::max(boundsMax, rectMax[i]);
+        glm::vec2 extent = rectMax[i] - rectMin[i];
+        extents.push_back(std::max(extent.x, extent.y));
+    }
+    if (extents.empty()) {
+        return;
+    }
+    if (!(cellSize > 0.0f)) {
+        std::nth_element(extents.begin(), extents.begin() + extents.size() / 2, extents.end());
+        cellSize = std::max(extents[extents.size() / 2] * 0.5f, 1e-3f);
+    }
+    glm::vec2 extent = boundsMax - boundsMin;
+    fitGridCells(extent, MaxCellsPerRect * extents.size() + 16, cellSize, cellsX, cellsZ);
+    origin = boundsMin;
+    size = cellSize;
+    inverseSize = 1.0f / cellSize;
+
+    auto forEachCell = [&](uint32_t rect, auto&& fn) {
+        uint32_t x0, z0, x1, z1;
+        if (rectMin[rect].x > rectMax[rect].x || rectMin[rect].y > rectMax[rect].y ||
+            !cellRange(rectMin[rect], rectMax[rect], x0, z0, x1, z1)) {
+            return;
+        }
+        for (uint32_t z = z0; z <= z1; z++) {
+            for (uint32_t x = x0; x <= x1; x++) {
+                fn(z * cellsX + x);
+            }
+        }
+    };
+    buildGridCells("RectGrid", static_cast<uint32_t>(rectMin.size()), static_cast<size_t>(cellsX) * cellsZ,
+                   forEachCell, cellStart, cellItems);
+}
+
+bool RectGrid::cellRange(const glm::vec2& min, const glm::vec2& max, uint32_t& x0, uint32_t& z0, uint32_t& x1,
+                         uint32_t& z1) const {
+    return gridCellRange((min - origin) * inverseSize, (max - origin) * inverseSize, cellsX, cellsZ, x0, z0, x1, z1);
+}
+
+uint32_t RectGrid::cellOf(const glm::vec3& point) const {
+    float x = (point.x - origin.x) * inverseSize;
+    float z = (point.z - origin.y) * inverseSize;
+    if (!(x >= 0.0f && z >= 0.0f && x < static_cast<float>(cellsX) && z < static_cast<float>(cellsZ))) {
+        return NoCell;
+    }
+    return static_cast<uint32_t>(z) * cellsX + static_cast<uint32_t>(x);
+}
+
+void RectGrid::query(const glm::vec2& min, const glm::vec2& max, std::vector<uint32_t>& out) const {
+    out.clear();
+    uint32_t x0, z0, x1, z1;
+    if (!cellRange(min, max, x0, z0, x1, z1)) {
+        return;
+    }
+    for (uint32_t z = z0; z <= z1; z++) {
+        for (uint32_t x = x0; x <= x1; x++) {
+            uint32_t cell = z * cellsX + x;
+            out.insert(out.end(), cellBegin(cell), cellEnd(cell));
+        }
+    }
+    if (x0 != x1 || z0 != z1) {
+        sortUniqueItems(out);
+    }
+}
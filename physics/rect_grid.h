@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// 2D grid over XZ of axis-aligned rectangles, for the gameplay volumes
+// bodies are tested against (wind zones, triggers). Like UniformGrid,
+// cells are columns spanning the full height, stored CSR-style; each cell
+// lists its rectangles in ascending index order.
+class RectGrid {
+public:
+    static constexpr uint32_t NoCell = UINT32_MAX;
+
+    // Empty rectangles (min > max) are left out. A cell size of 0 picks half
+    // the median rectangle extent.
+    void build(const std::vector<glm::vec2>& rectMin, const std::vector<glm::vec2>& rectMax, float cellSize = 0.0f);
+    void clear();
+
+    uint32_t cellOf(const glm::vec3& point) const;
+    uint32_t getCellCount() const { return cellsX * cellsZ; }
+    const uint32_t* cellBegin(uint32_t cell) const { return cellItems.data() + cellStart[cell]; }
+    const uint32_t* cellEnd(uint32_t cell) const { return cellItems.data() + cellStart[cell + 1]; }
+    uint32_t cellItemCount(uint32_t cell) const { return cellStart[cell + 1] - cellStart[cell]; }
+
+    // Rectangles in the cells overlapping [min, max]. Output is sorted and
+    // unique; callers still test the actual overlap.
+    void query(const glm::vec2& min, const glm::vec2& max, std::vector<uint32_t>& out) const;
+
+    float getCellSize() const { return size; }
+    bool empty() const { return cellItems.empty(); }
+
+private:
+    bool cellRange(const glm::vec2& min, const glm::vec2& max, uint32_t& x0, uint32_t& z0, uint32_t& x1,
+                   uint32_t& z1) const;
+
+    glm::vec2 origin = glm::vec2(0.0f);
+    float size = 1.0f;
+    float inverseSize = 1.0f;
+    uint32_t cellsX = 0;
+    uint32_t cellsZ = 0;
+    std::vector<uint32_t> cellStart;
+    std::vector<uint32_t> cellItems;
+};
@@ -0,0 +1,74 @@
+#include "spatial_hash.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+uint32_t SpatialHash::bucketOf(int32_t x, int32_t y, int32_t z) const {
+    uint32_t h = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u ^
+                 static_cast<uint32_t>(z) * 83492791u;
+    return h & bucketMask;
+}
+
+void SpatialHash::build(const std::vector<glm::vec3>& points, float size) {
+    if (!(size > 0.0f)) {
+        throw std::runtime_error("SpatialHash: cell size must be positive");
+    }
+    cellSize = size;
+    inverseCellSize = 1.0f / size;
+
+    // About two buckets per point keeps collisions rare.
+    uint32_t bucketCount = 16;
+    while (bucketCount < points.size() * 2 && bucketCount < (1u << 30)) {
+        bucketCount <<= 1;
+    }
+    bucketMask = bucketCount - 1;
+
+    pointBuckets.resize(points.size());
+    bucketStart.assign(bucketCount + 1, 0);
+    for (size_t i = 0; i < points.size(); i++) {
+        glm::vec3 cell = glm::floor(points[i] * inverseCellSize);
+        pointBuckets[i] = bucketOf(static_cast<int32_t>(cell.x), static_cast<int32_t>(cell.y),
+                                   static_cast<int32_t>(cell.z));
+        bucketStart[pointBuckets[i] + 1]++;
+    }
+    for (uint32_t b = 0; b < bucketCount; b++) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+    bucketPoints.resize(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        bucketPoints[bucketStart[pointBuckets[i]]++] = static_cast<uint32_t>(i);
+    }
+    // The scatter advanced every start to the next bucket's; shift back.
+    for (uint32_t b = bucketCount; b > 0; b--) {
+        bucketStart[b] = bucketStart[b - 1];
+    }
+    bucketStart[0] = 0;
+}
+
+void SpatialHash::query(const glm::vec3& point, std::vector<uint32_t>& out) const {
+    out.clear();
+    if (bucketPoints.empty()) {
+        return;
+    }
+    glm::vec3 cell = glm::floor(point * inverseCellSize);
+    int32_t cx = static_cast<int32_t>(cell.x);
+    int32_t cy = static_cast<int32_t>(cell.y);
+    int32_t cz = static_cast<int32_t>(cell.z);
+
+    // Neighbouring cells can share a bucket; visit each bucket once.
+    uint32_t buckets[27];
+    int count = 0;
+    for (int32_t z = cz - 1; z <= cz + 1; z++) {
+        for (int32_t y = cy - 1; y <= cy + 1; y++) {
+            for (int32_t x = cx - 1; x <= cx + 1; x++) {
+                buckets[count++] = bucketOf(x, y, z);
+            }
+        }
+    }
+    std::sort(buckets, buckets + count);
+    count = static_cast<int>(std::unique(buckets, buckets + count) - buckets);
+    for (int i = 0; i < count; i++) {
+        out.insert(out.end(), bucketPoints.begin() + bucketStart[buckets[i]],
+                   bucketPoints.begin() + bucketStart[buckets[i] + 1]);
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Dynamic broadphase for bodies, rebuilt from scratch every step. Points are
+// binned into cubic cells hashed into a power-of-two bucket table; buckets
+// are stored CSR-style like UniformGrid's cells, filled by a counting sort so
+// each bucket lists its points in ascending index order.
+class SpatialHash {
+public:
+    void build(const std::vector<glm::vec3>& points, float cellSize);
+
+    // Points in the 3x3x3 cells around `point`. Hash collisions can add
+    // points from far away cells, so callers still test the distance.
+    void query(const glm::vec3& point, std::vector<uint32_t>& out) const;
+
+    float getCellSize() const { return cellSize; }
+    size_t getBucketCount() const { return bucketStart.empty() ? 0 : bucketStart.size() - 1; }
+
+private:
+    uint32_t bucketOf(int32_t x, int32_t y, int32_t z) const;
+
+    float cellSize = 1.0f;
+    float inverseCellSize = 1.0f;
+    uint32_t bucketMask = 0;
+    std::vector<uint32_t> pointBuckets;
+    std::vector<uint32_t> bucketStart;
+    std::vector<uint32_t> bucketPoints;
+};
@@ -0,0 +1,160 @@
+#include "trigger_set.h"
+#include "physics_world.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t BodyChunkSize = 256;
+
+bool pairLess(const TriggerPair& a, const TriggerPair& b) {
+    if (a.body != b.body) {
+        return a.body < b.body;
+    }
+    if (a.trigger != b.trigger) {
+        return a.trigger < b.trigger;
+    }
+    return a.generation < b.generation;
+}
+
+bool overlaps(const TriggerDesc& desc, const RigidBody& body) {
+    if (desc.shape == TriggerShape::Box) {
+        glm::vec3 offset = body.position - glm::clamp(body.position, desc.a, desc.b);
+        return glm::dot(offset, offset) <= body.radius * body.radius;
+    }
+    glm::vec3 offset = body.position - desc.a;
+    float reach = body.radius + desc.radius;
+    return glm::dot(offset, offset) <= reach * reach;
+}
+
+} // namespace
+
+TriggerId TriggerSet::add(const TriggerDesc& desc) {
+    if (desc.shape == TriggerShape::Sphere && !(desc.radius > 0.0f)) {
+        throw std::runtime_error("TriggerSet: sphere radius must be positive");
+    }
+    uint32_t index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        index = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+    Slot& slot = slots[index];
+    slot.desc = desc;
+    if (desc.shape == TriggerShape::Box) {
+        slot.desc.a = glm::min(desc.a, desc.b);
+        slot.desc.b = glm::max(desc.a, desc.b);
+    }
+    slot.alive = true;
+    liveCount++;
+    gridDirty = true;
+    return {index, slot.generation};
+}
+
+bool TriggerSet::remove(TriggerId id) {
+    if (!get(id)) {
+        return false;
+    }
+    Slot& slot = slots[id.index];
+    slot.alive = false;
+    slot.generation++;
+    freeSlots.push_back(id.index);
+    liveCount--;
+    gridDirty = true;
+    return true;
+}
+
+const TriggerDesc* TriggerSet::get(TriggerId id) const {
+    if (id.index >= slots.size() || !slots[id.index].alive || slots[id.index].generation != id.generation) {
+        return nullptr;
+    }
+    return &slots[id.index].desc;
+}
+
+void TriggerSet::rebuildGrid() {
+    std::vector<glm::vec2> rectMin(slots.size(), glm::vec2(1.0f));
+    std::vector<glm::vec2> rectMax(slots.size(), glm::vec2(0.0f));
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (!slots[i].alive) {
+            continue;
+        }
+        const TriggerDesc& desc = slots[i].desc;
+        if (desc.shape == TriggerShape::Box) {
+            rectMin[i] = glm::vec2(desc.a.x, desc.a.z);
+            rectMax[i] = glm::vec2(desc.b.x, desc.b.z);
+        } else {
+            rectMin[i] = glm::vec2(desc.a.x - desc.radius, desc.a.z - desc.radius);
+            rectMax[i] = glm::vec2(desc.a.x + desc.radius, desc.a.z + desc.radius);
+        }
+    }
+    grid.build(rectMin, rectMax);
+    gridDirty = false;
+}
+
+void TriggerSet::update(const std::vector<RigidBody>& bodies, ThreadPool& pool, std::vector<TriggerEvent>& events) {
+    if (gridDirty) {
+        rebuildGrid();
+    }
+    events.clear();
+    nextPairs.clear();
+    tests = 0;
+
+    if (liveCount > 0) {
+        size_t chunkCount = (bodies.size() + BodyChunkSize - 1) / BodyChunkSize;
+        if (chunks.size() < chunkCount) {
+            chunks.resize(chunkCount);
+        }
+        pool.parallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++) {
+                BodyChunk& chunk = chunks[c];
+                chunk.pairs.clear();
+                chunk.tests = 0;
+                size_t last = std::min(bodies.size(), (c + 1) * BodyChunkSize);
+                for (size_t b = c * BodyChunkSize; b < last; b++) {
+                    const RigidBody& body = bodies[b];
+                    if (body.inverseMass == 0.0f) {
+                        continue;
+                    }
+                    glm::vec2 center(body.position.x, body.position.z);
+                    grid.query(center - glm::vec2(body.radius), center + glm::vec2(body.radius), chunk.candidates);
+                    for (uint32_t t : chunk.candidates) {
+                        const Slot& slot = slots[t];
+                        chunk.tests++;
+                        if (overlaps(slot.desc, body)) {
+                            chunk.pairs.push_back({static_cast<uint32_t>(b), t, slot.generation, slot.desc.tag});
+                        }
+                    }
+                }
+            }
+        });
+        for (size_t c = 0; c < chunkCount; c++) {
+            nextPairs.insert(nextPairs.end(), chunks[c].pairs.begin(), chunks[c].pairs.end());
+            tests += chunks[c].tests;
+        }
+    }
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < pairs.size() || j < nextPairs.size()) {
+        if (j == nextPairs.size() || (i < pairs.size() && pairLess(pairs[i], nextPairs[j]))) {
+            const TriggerPair& gone = pairs[i++];
+            events.push_back({TriggerEvent::Type::Exit, gone.tag, {gone.trigger, gone.generation}, gone.body});
+        } else if (i == pairs.size() || pairLess(nextPairs[j], pairs[i])) {
+            const TriggerPair& entered = nextPairs[j++];
+            events.push_back({TriggerEvent::Type::Enter, entered.tag, {entered.trigger, entered.generation},
+                              entered.body});
+        } else {
+            const TriggerPair& staying = nextPairs[j];
+            if (slots[staying.trigger].desc.reportStay) {
+                events.push_back({TriggerEvent::Type::Stay, staying.tag, {staying.trigger, staying.generation},
+                                  staying.body});
+            }
+            i++;
+            j++;
+        }
+    }
+    pairs.swap(nextPairs);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "rect_grid.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+struct RigidBody;
+
+enum class TriggerShape { Box, Sphere };
+
+struct TriggerDesc {
+    TriggerShape shape = TriggerShape::Box;
+    // Box corners, or the sphere's centre in `a`.
+    glm::vec3 a = glm::vec3(0.0f);
+    glm::vec3 b = glm::vec3(1.0f);
+    float radius = 0.5f;
+    // Free for gameplay: goal, checkpoint, hazard...
+    uint32_t tag = 0;
+    // Stay events every step a body remains inside, not just enter/exit.
+    bool reportStay = false;
+    // Applied to a body entering the volume (bounce pads).
+    glm::vec3 bounceImpulse = glm::vec3(0.0f);
+};
+
+// Slot plus generation: a handle to a removed trigger never matches the
+// trigger that reuses its slot.
+struct TriggerId {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool operator==(const TriggerId& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const TriggerId& other) const { return !(*this == other); }
+};
+
+struct TriggerEvent {
+    enum class Type : uint8_t { Enter, Stay, Exit };
+
+    Type type;
+    uint32_t tag;
+    TriggerId trigger;
+    uint32_t bodyId;
+};
+
+// A body overlapping a trigger at the end of a step. The tag is kept so
+// exits of removed triggers still report it.
+struct TriggerPair {
+    uint32_t body;
+    uint32_t trigger;
+    uint32_t generation;
+    uint32_t tag;
+};
+
+// Trigger volumes with overlap tracking. Triggers are indexed by a RectGrid,
+// so each body tests only the triggers around it. Overlaps are kept as a
+// list sorted by (body, trigger, generation), which is the order the
+// per-body queries produce them in. Each step's list is merge-walked
+// against the previous step's list to produce the events. Removing a
+// trigger bumps its slot's generation, so its old overlaps come out as
+// exits. Events go to a flat array that is reused every step; once
+// capacities have grown, updating does not allocate.
+class TriggerSet {
+public:
+    TriggerId add(const TriggerDesc& desc);
+    // Returns false for a stale handle.
+    bool remove(TriggerId id);
+    const TriggerDesc* get(TriggerId id) const;
+    uint32_t getCount() const { return liveCount; }
+
+    // Finds this step's overlaps and fills `events`, in (body, trigger) order.
+    void update(const std::vector<RigidBody>& bodies, ThreadPool& pool, std::vector<TriggerEvent>& events);
+
+    const std::vector<TriggerPair>& getPairs() const { return pairs; }
+    // For rollback: the overlaps the next update compares against.
+    void setPairs(const std::vector<TriggerPair>& saved) { pairs = saved; }
+    // Body-trigger overlap tests in the last update.
+    uint64_t getTests() const { return tests; }
+
+private:
+    struct Slot {
+        TriggerDesc desc;
+        uint32_t generation = 0;
+        bool alive = false;
+    };
+
+    // Per-chunk working memory; outputs are merged in chunk order.
+    struct BodyChunk {
+        std::vector<uint32_t> candidates;
+        std::vector<TriggerPair> pairs;
+        uint64_t tests = 0;
+    };
+
+    void rebuildGrid();
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    uint32_t liveCount = 0;
+    RectGrid grid;
+    bool gridDirty = false;
+    std::vector<BodyChunk> chunks;
+    std::vector<TriggerPair> pairs;
+    std::vector<TriggerPair> nextPairs;
+    uint64_t tests = 0;
+};
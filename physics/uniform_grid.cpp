@@ -0,0 +1,252 @@
+#include "uniform_grid.h"
+#include "grid_cells.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// Grids larger than this per triangle are mostly empty cells; the cell size
+// is grown until the grid fits.
+constexpr uint64_t MaxCellsPerTriangle = 4;
+// Triangles covering more cells than this get an exact per-cell overlap test
+// instead of claiming their whole bounding rectangle.
+constexpr uint32_t ExactTestCellCount = 4;
+
+struct Rect {
+    glm::vec2 min;
+    glm::vec2 max;
+};
+
+Rect triangleRect(const Triangle& tri) {
+    Rect rect;
+    rect.min = glm::min(glm::vec2(tri.v0.x, tri.v0.z), glm::min(glm::vec2(tri.v1.x, tri.v1.z), glm::vec2(tri.v2.x, tri.v2.z)));
+    rect.max = glm::max(glm::vec2(tri.v0.x, tri.v0.z), glm::max(glm::vec2(tri.v1.x, tri.v1.z), glm::vec2(tri.v2.x, tri.v2.z)));
+    return rect;
+}
+
+// Separating axis test of the triangle's XZ projection against a cell. The
+// cell axes are covered by the bounding rectangle, so only the three edge
+// normals remain. Walls project to segments; their edge normals still
+// separate correctly and zero-length edges never reject.
+bool triangleOverlapsCell(const glm::vec2 p[3], const glm::vec2& cellMin, const glm::vec2& cellMax) {
+    glm::vec2 center = (cellMin + cellMax) * 0.5f;
+    glm::vec2 half = (cellMax - cellMin) * 0.5f;
+    for (int i = 0; i < 3; i++) {
+        glm::vec2 edge = p[(i + 1) % 3] - p[i];
+        glm::vec2 n(-edge.y, edge.x);
+        float d0 = glm::dot(p[0], n);
+        float d1 = glm::dot(p[1], n);
+        float d2 = glm::dot(p[2], n);
+        float triMin = std::min(d0, std::min(d1, d2));
+        float triMax = std::max(d0, std::max(d1, d2));
+        float c = glm::dot(center, n);
+        float r = half.x * std::abs(n.x) + half.y * std::abs(n.y);
+        if (triMin > c + r || triMax < c - r) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Segment against the rectangle grown by radius (slab test). Corners are
+// treated as square, which is conservative by at most one cell per query.
+bool segmentOverlapsRect(const glm::vec2& from, const glm::vec2& delta, const glm::vec2& rectMin, const glm::vec2& rectMax) {
+    float tEnter = 0.0f;
+    float tExit = 1.0f;
+    for (int axis = 0; axis < 2; axis++) {
+        if (std::abs(delta[axis]) < 1e-12f) {
+            if (from[axis] < rectMin[axis] || from[axis] > rectMax[axis]) {
+                return false;
+            }
+            continue;
+        }
+        float inv = 1.0f / delta[axis];
+        float t0 = (rectMin[axis] - from[axis]) * inv;
+        float t1 = (rectMax[axis] - from[axis]) * inv;
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        tEnter = std::max(tEnter, t0);
+        tExit = std::min(tExit, t1);
+        if (tEnter > tExit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+float UniformGrid::suggestCellSize(const std::vector<Triangle>& triangles, float ballRadius) {
+    float minimum = std::max(2.0f * ballRadius, 1e-3f);
+    if (triangles.empty()) {
+        return minimum;
+    }
+    // Sample at most 64K triangles; the median is stable long before that.
+    size_t stride = std::max<size_t>(triangles.size() / 65536, 1);
+    std::vector<float> extents;
+    extents.reserve(triangles.size() / stride + 1);
+    for (size_t i = 0; i < triangles.size(); i += stride) {
+        Rect rect = triangleRect(triangles[i]);
+        glm::vec2 e = rect.max - rect.min;
+        extents.push_back(std::max(e.x, e.y));
+    }
+    auto middle = extents.begin() + extents.size() / 2;
+    std::nth_element(extents.begin(), middle, extents.end());
+    return std::max(*middle, minimum);
+}
+
+void UniformGrid::build(const std::vector<Triangle>& triangles, float requestedCellSize) {
+    if (!(requestedCellSize > 0.0f)) {
+        throw std::runtime_error("UniformGrid: cell size must be positive");
+    }
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    cellStart.clear();
+    cellTriangles.clear();
+    stats = UniformGridStats();
+    cellsX = cellsZ = 0;
+    if (triangles.empty()) {
+        return;
+    }
+    if (triangles.size() >= std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("UniformGrid: too many triangles");
+    }
+
+    std::vector<Rect> rects(triangles.size());
+    Rect level{glm::vec2(std::numeric_limits<float>::max()), glm::vec2(-std::numeric_limits<float>::max())};
+    for (size_t i = 0; i < triangles.size(); i++) {
+        rects[i] = triangleRect(triangles[i]);
+        level.min = glm::min(level.min, rects[i].min);
+        level.max = glm::max(level.max, rects[i].max);
+    }
+
+    glm::vec2 extent = level.max - level.min;
+    uint64_t maxCells = std::max<uint64_t>(triangles.size() * MaxCellsPerTriangle, 1);
+    cellSize = requestedCellSize;
+    fitGridCells(extent, maxCells, cellSize, cellsX, cellsZ);
+    inverseCellSize = 1.0f / cellSize;
+    origin = level.min;
+
+    auto forEachCell = [&](uint32_t index, auto&& visit) {
+        uint32_t x0, z0, x1, z1;
+        if (!cellRange(rects[index].min.x, rects[index].min.y, rects[index].max.x, rects[index].max.y, x0, z0, x1, z1)) {
+            return;
+        }
+        bool exact = (x1 - x0 + 1) * (z1 - z0 + 1) > ExactTestCellCount;
+        const Triangle& tri = triangles[index];
+        glm::vec2 p[3] = {glm::vec2(tri.v0.x, tri.v0.z), glm::vec2(tri.v1.x, tri.v1.z), glm::vec2(tri.v2.x, tri.v2.z)};
+        for (uint32_t z = z0; z <= z1; z++) {
+            for (uint32_t x = x0; x <= x1; x++) {
+                if (exact) {
+                    glm::vec2 cellMin = origin + glm::vec2(x, z) * cellSize;
+                    if (!triangleOverlapsCell(p, cellMin, cellMin + glm::vec2(cellSize))) {
+                        continue;
+                    }
+                }
+                visit(z * cellsX + x);
+            }
+        }
+    };
+
+    size_t cellCount = static_cast<size_t>(cellsX) * cellsZ;
+    buildGridCells("UniformGrid", static_cast<uint32_t>(triangles.size()), cellCount, forEachCell, cellStart,
+                   cellTriangles);
+    for (size_t c = 0; c < cellCount; c++) {
+        stats.maxPerCell = std::max(stats.maxPerCell, cellStart[c + 1] - cellStart[c]);
+    }
+
+    stats.cellsX = cellsX;
+    stats.cellsZ = cellsZ;
+    stats.references = cellTriangles.size();
+    stats.memoryBytes = (cellStart.size() + cellTriangles.size()) * sizeof(uint32_t);
+    stats.buildMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void UniformGrid::assign(const glm::vec2& gridOrigin, float gridCellSize, uint32_t gridCellsX, uint32_t gridCellsZ,
+                         const uint32_t* gridCellStart, const uint32_t* gridCellTriangles) {
+    if (!(gridCellSize > 0.0f)) {
+        throw std::runtime_error("UniformGrid: cell size must be positive");
+    }
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    size_t cellCount = static_cast<size_t>(gridCellsX) * gridCellsZ;
+    origin = gridOrigin;
+    cellSize = gridCellSize;
+    inverseCellSize = 1.0f / cellSize;
+    cellsX = gridCellsX;
+    cellsZ = gridCellsZ;
+    cellStart.assign(gridCellStart, gridCellStart + cellCount + 1);
+    cellTriangles.assign(gridCellTriangles, gridCellTriangles + cellStart[cellCount]);
+
+    stats = UniformGridStats();
+    for (size_t c = 0; c < cellCount; c++) {
+        stats.maxPerCell = std::max(stats.maxPerCell, cellStart[c + 1] - cellStart[c]);
+    }
+    stats.cellsX = cellsX;
+    stats.cellsZ = cellsZ;
+    stats.references = cellTriangles.size();
+    stats.memoryBytes = (cellStart.size() + cellTriangles.size()) * sizeof(uint32_t);
+    stats.buildMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+bool UniformGrid::cellRange(float minX, float minZ, float maxX, float maxZ,
+                            uint32_t& x0, uint32_t& z0, uint32_t& x1, uint32_t& z1) const {
+    return gridCellRange((glm::vec2(minX, minZ) - origin) * inverseCellSize,
+                         (glm::vec2(maxX, maxZ) - origin) * inverseCellSize, cellsX, cellsZ, x0, z0, x1, z1);
+}
+
+void UniformGrid::appendCell(uint32_t x, uint32_t z, std::vector<uint32_t>& out) const {
+    uint32_t cell = z * cellsX + x;
+    out.insert(out.end(), cellTriangles.begin() + cellStart[cell], cellTriangles.begin() + cellStart[cell + 1]);
+}
+
+void UniformGrid::query(const Aabb& box, std::vector<uint32_t>& out) const {
+    out.clear();
+    uint32_t x0, z0, x1, z1;
+    if (cellTriangles.empty() || !cellRange(box.min.x, box.min.z, box.max.x, box.max.z, x0, z0, x1, z1)) {
+        return;
+    }
+    for (uint32_t z = z0; z <= z1; z++) {
+        for (uint32_t x = x0; x <= x1; x++) {
+            appendCell(x, z, out);
+        }
+    }
+    if (x0 != x1 || z0 != z1) {
+        sortUniqueItems(out);
+    }
+}
+
+void UniformGrid::querySweptSphere(const glm::vec3& from, const glm::vec3& to, float radius, std::vector<uint32_t>& out) const {
+    out.clear();
+    uint32_t x0, z0, x1, z1;
+    if (cellTriangles.empty() ||
+        !cellRange(std::min(from.x, to.x) - radius, std::min(from.z, to.z) - radius,
+                   std::max(from.x, to.x) + radius, std::max(from.z, to.z) + radius, x0, z0, x1, z1)) {
+        return;
+    }
+    glm::vec2 start(from.x, from.z);
+    glm::vec2 delta = glm::vec2(to.x, to.z) - start;
+    // Short sweeps stay inside their bounding rectangle anyway; only long
+    // diagonal ones skip cells by testing the segment per cell.
+    bool exact = (x1 - x0 + 1) * (z1 - z0 + 1) > ExactTestCellCount;
+    for (uint32_t z = z0; z <= z1; z++) {
+        for (uint32_t x = x0; x <= x1; x++) {
+            if (exact) {
+                glm::vec2 cellMin = origin + glm::vec2(x, z) * cellSize;
+                if (!segmentOverlapsRect(start, delta, cellMin - glm::vec2(radius), cellMin + glm::vec2(cellSize + radius))) {
+                    continue;
+                }
+            }
+            appendCell(x, z, out);
+        }
+    }
+    if (x0 != x1 || z0 != z1) {
+        sortUniqueItems(out);
+    }
+}
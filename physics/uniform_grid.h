@@ -0,0 +1,61 @@
+#pragma once
+
+#include "bvh/aabb.h"
+#include "bvh/triangle_mesh.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+struct UniformGridStats {
+    double buildMs = 0.0;
+    uint32_t cellsX = 0;
+    uint32_t cellsZ = 0;
+    uint64_t references = 0;
+    uint32_t maxPerCell = 0;
+    size_t memoryBytes = 0;
+};
+
+// Static broadphase for maze levels. Mazes are wide and flat, so the grid
+// is 2D over XZ and every cell is a column spanning the level's full height.
+// Cell contents are stored CSR-style: cellStart[c]..cellStart[c + 1] indexes
+// into one flat triangle index array.
+class UniformGrid {
+public:
+    // Median horizontal triangle extent, at least twice the ball radius so a
+    // ball rarely overlaps more than 2x2 columns.
+    static float suggestCellSize(const std::vector<Triangle>& triangles, float ballRadius);
+
+    void build(const std::vector<Triangle>& triangles, float cellSize);
+    // Takes over a grid built earlier (e.g. stored in a level file): the
+    // arrays are copied as they are, cellStart holding cellsX * cellsZ + 1 entries.
+    void assign(const glm::vec2& origin, float cellSize, uint32_t cellsX, uint32_t cellsZ, const uint32_t* cellStart,
+                const uint32_t* cellTriangles);
+
+    // Candidate triangles whose columns overlap the box / the capsule swept
+    // by a sphere moving from `from` to `to`. Output is sorted and unique.
+    void query(const Aabb& box, std::vector<uint32_t>& out) const;
+    void querySweptSphere(const glm::vec3& from, const glm::vec3& to, float radius, std::vector<uint32_t>& out) const;
+
+    float getCellSize() const { return cellSize; }
+    const glm::vec2& getOrigin() const { return origin; }
+    uint32_t getCellsX() const { return cellsX; }
+    uint32_t getCellsZ() const { return cellsZ; }
+    const std::vector<uint32_t>& getCellStart() const { return cellStart; }
+    const std::vector<uint32_t>& getCellTriangles() const { return cellTriangles; }
+    const UniformGridStats& getStats() const { return stats; }
+    bool empty() const { return cellTriangles.empty(); }
+
+private:
+    bool cellRange(float minX, float minZ, float maxX, float maxZ,
+                   uint32_t& x0, uint32_t& z0, uint32_t& x1, uint32_t& z1) const;
+    void appendCell(uint32_t x, uint32_t z, std::vector<uint32_t>& out) const;
+
+    glm::vec2 origin = glm::vec2(0.0f);
+    float cellSize = 1.0f;
+    float inverseCellSize = 1.0f;
+    uint32_t cellsX = 0;
+    uint32_t cellsZ = 0;
+    std::vector<uint32_t> cellStart;
+    std::vector<uint32_t> cellTriangles;
+    UniformGridStats stats;
+};
@@ -0,0 +1,253 @@
+#include "wind_field.h"
+#include "core/simd.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint32_t NoCell = RectGrid::NoCell;
+constexpr size_t CellGrainSize = 16;
+
+// Hash of a lattice point, mapped to [-1, 1].
+float latticeValue(int32_t x, int32_t y, int32_t z, uint32_t seed) {
+    uint32_t h = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u ^
+                 static_cast<uint32_t>(z) * 83492791u ^ seed * 2654435761u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return static_cast<float>(h & 0xffffffu) * (2.0f / 16777215.0f) - 1.0f;
+}
+
+// Trilinear value noise with smoothstep weights.
+float valueNoise(const glm::vec3& p, uint32_t seed) {
+    glm::vec3 cell = glm::floor(p);
+    glm::vec3 f = p - cell;
+    glm::vec3 w = f * f * (glm::vec3(3.0f) - 2.0f * f);
+    int32_t x = static_cast<int32_t>(cell.x);
+    int32_t y = static_cast<int32_t>(cell.y);
+    int32_t z = static_cast<int32_t>(cell.z);
+    float corners[2][2];
+    for (int dz = 0; dz < 2; dz++) {
+        for (int dy = 0; dy < 2; dy++) {
+            float v0 = latticeValue(x, y + dy, z + dz, seed);
+            float v1 = latticeValue(x + 1, y + dy, z + dz, seed);
+            corners[dz][dy] = v0 + (v1 - v0) * w.x;
+        }
+    }
+    float v0 = corners[0][0] + (corners[0][1] - corners[0][0]) * w.y;
+    float v1 = corners[1][0] + (corners[1][1] - corners[1][0]) * w.y;
+    return v0 + (v1 - v0) * w.z;
+}
+
+glm::vec3 turbulenceAt(const WindZone& zone, const glm::vec3& point, float time) {
+    glm::vec3 q = (point - zone.direction * (zone.gustSpeed * time)) / zone.turbulenceScale;
+    glm::vec3 gust(valueNoise(q, 1u), valueNoise(q, 2u), valueNoise(q, 3u));
+    return gust * (zone.turbulence * zone.strength);
+}
+
+void zoneRect(const WindZone& zone, glm::vec2& rectMin, glm::vec2& rectMax) {
+    glm::vec3 lo = glm::min(zone.a, zone.b);
+    glm::vec3 hi = glm::max(zone.a, zone.b);
+    if (zone.shape == WindShape::Capsule) {
+        lo -= glm::vec3(zone.radius);
+        hi += glm::vec3(zone.radius);
+    }
+    rectMin = glm::vec2(lo.x, lo.z);
+    rectMax = glm::vec2(hi.x, hi.z);
+}
+
+} // namespace
+
+bool windZoneContains(const WindZone& zone, const glm::vec3& point) {
+    if (zone.shape == WindShape::Box) {
+        glm::vec3 lo = glm::min(zone.a, zone.b);
+        glm::vec3 hi = glm::max(zone.a, zone.b);
+        return point.x >= lo.x && point.x <= hi.x && point.y >= lo.y && point.y <= hi.y && point.z >= lo.z &&
+               point.z <= hi.z;
+    }
+    glm::vec3 axis = zone.b - zone.a;
+    float lengthSq = glm::dot(axis, axis);
+    glm::vec3 offset = point - zone.a;
+    float t = lengthSq > 0.0f ? std::clamp(glm::dot(offset, axis) / lengthSq, 0.0f, 1.0f) : 0.0f;
+    glm::vec3 d = offset - axis * t;
+    return glm::dot(d, d) <= zone.radius * zone.radius;
+}
+
+glm::vec3 windZoneForce(const WindZone& zone, const glm::vec3& point, float time) {
+    glm::vec3 force = zone.direction * zone.strength;
+    if (zone.turbulence > 0.0f) {
+        force += turbulenceAt(zone, point, time);
+    }
+    return force;
+}
+
+void WindField::build(const std::vector<WindZone>& input, float cellSize) {
+    zones = input;
+    for (auto& zone : zones) {
+        float length = glm::length(zone.direction);
+        if (!(length > 0.0f)) {
+            throw std::runtime_error("WindField: zone direction must be non-zero");
+        }
+        if (!(zone.turbulenceScale > 0.0f)) {
+            throw std::runtime_error("WindField: turbulence scale must be positive");
+        }
+        zone.direction /= length;
+        if (zone.shape == WindShape::Box) {
+            glm::vec3 lo = glm::min(zone.a, zone.b);
+            zone.b = glm::max(zone.a, zone.b);
+            zone.a = lo;
+        }
+    }
+    std::vector<glm::vec2> rectMin(zones.size());
+    std::vector<glm::vec2> rectMax(zones.size());
+    for (size_t i = 0; i < zones.size(); i++) {
+        zoneRect(zones[i], rectMin[i], rectMax[i]);
+    }
+    grid.build(rectMin, rectMax, cellSize);
+}
+
+glm::vec3 WindField::sample(const glm::vec3& point, float time) const {
+    glm::vec3 force(0.0f);
+    uint32_t cell = grid.cellOf(point);
+    if (cell == NoCell) {
+        return force;
+    }
+    for (const uint32_t* it = grid.cellBegin(cell); it != grid.cellEnd(cell); ++it) {
+        const WindZone& zone = zones[*it];
+        if (windZoneContains(zone, point)) {
+            force += zone.direction * zone.strength;
+            if (zone.turbulence > 0.0f) {
+                force += turbulenceAt(zone, point, time);
+            }
+        }
+    }
+    return force;
+}
+
+void WindField::sampleMany(const std::vector<glm::vec3>& points, float time, std::vector<glm::vec3>& forces,
+                           ThreadPool& pool) {
+    forces.assign(points.size(), glm::vec3(0.0f));
+    zoneTests = 0;
+    if (zones.empty()) {
+        return;
+    }
+
+    // Counting sort of the points by cell.
+    size_t cellCount = grid.getCellCount();
+    pointCells.resize(points.size());
+    pointStart.assign(cellCount + 1, 0);
+    for (size_t i = 0; i < points.size(); i++) {
+        pointCells[i] = grid.cellOf(points[i]);
+        if (pointCells[i] != NoCell) {
+            pointStart[pointCells[i] + 1]++;
+        }
+    }
+    for (size_t c = 1; c <= cellCount; c++) {
+        pointStart[c] += pointStart[c - 1];
+    }
+    size_t inside = pointStart[cellCount];
+    sortedPoints.resize(inside);
+    // Padded so the last batch can load a full vector.
+    sortedX.assign(inside + 8, 0.0f);
+    sortedY.assign(inside + 8, 0.0f);
+    sortedZ.assign(inside + 8, 0.0f);
+    for (size_t i = 0; i < points.size(); i++) {
+        if (pointCells[i] != NoCell) {
+            uint32_t slot = pointStart[pointCells[i]]++;
+            sortedPoints[slot] = static_cast<uint32_t>(i);
+            sortedX[slot] = points[i].x;
+            sortedY[slot] = points[i].y;
+            sortedZ[slot] = points[i].z;
+        }
+    }
+    // The scatter advanced every start to the next cell's; shift back.
+    for (size_t c = cellCount; c > 0; c--) {
+        pointStart[c] = pointStart[c - 1];
+    }
+    pointStart[0] = 0;
+
+    activeCells.clear();
+    for (uint32_t c = 0; c < cellCount; c++) {
+        uint32_t pointCount = pointStart[c + 1] - pointStart[c];
+        uint32_t zoneCount = grid.cellItemCount(c);
+        if (pointCount > 0 && zoneCount > 0) {
+            activeCells.push_back(c);
+            zoneTests += static_cast<uint64_t>(pointCount) * zoneCount;
+        }
+    }
+    // Every point belongs to one cell, so cells write disjoint forces.
+    pool.parallelFor(activeCells.size(), CellGrainSize, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            sampleCell(activeCells[k], time, forces);
+        }
+    });
+}
+
+void WindField::sampleCell(uint32_t cell, float time, std::vector<glm::vec3>& forces) const {
+    using V = simd::vfloat8;
+    static const float laneIndex[8] = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f};
+
+    uint32_t end = pointStart[cell + 1];
+    for (uint32_t first = pointStart[cell]; first < end; first += 8) {
+        int count = static_cast<int>(std::min<uint32_t>(8, end - first));
+        V px = V::load(&sortedX[first]);
+        V py = V::load(&sortedY[first]);
+        V pz = V::load(&sortedZ[first]);
+        V valid = V::load(laneIndex) < V(static_cast<float>(count));
+        V fx(0.0f), fy(0.0f), fz(0.0f);
+
+        for (const uint32_t* it = grid.cellBegin(cell); it != grid.cellEnd(cell); ++it) {
+            const WindZone& zone = zones[*it];
+            V inside;
+            if (zone.shape == WindShape::Box) {
+                inside = valid & (px >= V(zone.a.x)) & (px <= V(zone.b.x)) & (py >= V(zone.a.y)) &
+                         (py <= V(zone.b.y)) & (pz >= V(zone.a.z)) & (pz <= V(zone.b.z));
+            } else {
+                glm::vec3 axis = zone.b - zone.a;
+                float lengthSq = glm::dot(axis, axis);
+                float inverseLengthSq = lengthSq > 0.0f ? 1.0f / lengthSq : 0.0f;
+                V ox = px - V(zone.a.x), oy = py - V(zone.a.y), oz = pz - V(zone.a.z);
+                V along = simd::fmadd(ox, V(axis.x), simd::fmadd(oy, V(axis.y), oz * V(axis.z)));
+                V t = simd::min(simd::max(along * V(inverseLengthSq), V(0.0f)), V(1.0f));
+                V dx = ox - V(axis.x) * t, dy = oy - V(axis.y) * t, dz = oz - V(axis.z) * t;
+                V distanceSq = simd::fmadd(dx, dx, simd::fmadd(dy, dy, dz * dz));
+                inside = valid & (distanceSq <= V(zone.radius * zone.radius));
+            }
+            int mask = simd::movemask(inside);
+            if (!mask) {
+                continue;
+            }
+            glm::vec3 force = zone.direction * zone.strength;
+            fx = fx + (inside & V(force.x));
+            fy = fy + (inside & V(force.y));
+            fz = fz + (inside & V(force.z));
+            if (zone.turbulence > 0.0f) {
+                alignas(32) float lanes[3][8];
+                fx.store(lanes[0]);
+                fy.store(lanes[1]);
+                fz.store(lanes[2]);
+                while (mask) {
+                    int lane = simd::popLowestLane(mask);
+                    glm::vec3 point(sortedX[first + lane], sortedY[first + lane], sortedZ[first + lane]);
+                    glm::vec3 gust = turbulenceAt(zone, point, time);
+                    lanes[0][lane] += gust.x;
+                    lanes[1][lane] += gust.y;
+                    lanes[2][lane] += gust.z;
+                }
+                fx = V::load(lanes[0]);
+                fy = V::load(lanes[1]);
+                fz = V::load(lanes[2]);
+            }
+        }
+
+        alignas(32) float lanes[3][8];
+        fx.store(lanes[0]);
+        fy.store(lanes[1]);
+        fz.store(lanes[2]);
+        for (int lane = 0; lane < count; lane++) {
+            forces[sortedPoints[first + lane]] = glm::vec3(lanes[0][lane], lanes[1][lane], lanes[2][lane]);
+        }
+    }
+}
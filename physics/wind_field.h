@@ -0,0 +1,71 @@
+#pragma once
+
+#include "rect_grid.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+enum class WindShape { Box, Capsule };
+
+// Volume that pushes bodies inside it with a constant force, optionally
+// disturbed by procedural gusts.
+struct WindZone {
+    WindShape shape = WindShape::Box;
+    // Box corners, or the end points of the capsule's axis.
+    glm::vec3 a = glm::vec3(0.0f);
+    glm::vec3 b = glm::vec3(1.0f);
+    float radius = 0.5f;
+    glm::vec3 direction = glm::vec3(1.0f, 0.0f, 0.0f);
+    // Newtons, so heavier balls are pushed less.
+    float strength = 1.0f;
+    // Gusts add up to turbulence * strength in a direction that varies
+    // smoothly over turbulenceScale metres, drifting downwind at gustSpeed.
+    float turbulence = 0.0f;
+    float turbulenceScale = 1.0f;
+    float gustSpeed = 2.0f;
+};
+
+bool windZoneContains(const WindZone& zone, const glm::vec3& point);
+// Force of one zone at a point inside it.
+glm::vec3 windZoneForce(const WindZone& zone, const glm::vec3& point, float time);
+
+// Wind zones indexed by a RectGrid over their XZ bounds: a point only tests
+// the zones whose bounds overlap its column, so adding zones elsewhere
+// in the level costs nothing. Forces of overlapping zones add up, in zone
+// order.
+class WindField {
+public:
+    // A cell size of 0 picks half the median horizontal zone extent.
+    void build(const std::vector<WindZone>& zones, float cellSize = 0.0f);
+
+    glm::vec3 sample(const glm::vec3& point, float time) const;
+    // Forces at many points. Points are grouped by cell so that each zone of
+    // a cell is tested against 8 points per SIMD batch; cells are spread
+    // over the pool. Matches sample() up to rounding at zone boundaries.
+    void sampleMany(const std::vector<glm::vec3>& points, float time, std::vector<glm::vec3>& forces,
+                    ThreadPool& pool);
+
+    bool empty() const { return zones.empty(); }
+    const std::vector<WindZone>& getZones() const { return zones; }
+    float getCellSize() const { return grid.getCellSize(); }
+    // Point-zone pairs tested by the last sampleMany call.
+    uint64_t getZoneTests() const { return zoneTests; }
+
+private:
+    void sampleCell(uint32_t cell, float time, std::vector<glm::vec3>& forces) const;
+
+    std::vector<WindZone> zones;
+    RectGrid grid;
+
+    // sampleMany scratch: points sorted by cell, as SoA for the batches.
+    std::vector<uint32_t> pointCells;
+    std::vector<uint32_t> pointStart;
+    std::vector<uint32_t> sortedPoints;
+    std::vector<float> sortedX;
+    std::vector<float> sortedY;
+    std::vector<float> sortedZ;
+    std::vector<uint32_t> activeCells;
+    uint64_t zoneTests = 0;
+};
@@ -0,0 +1,204 @@
+#include "image_writer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> table;
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+    static const std::array<uint32_t, 256> table = makeCrcTable();
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void appendBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void writePngChunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& payload) {
+    std::vector<uint8_t> chunk;
+    appendBigEndian(chunk, static_cast<uint32_t>(payload.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), payload.begin(), payload.end());
+    appendBigEndian(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+    file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+}
+
+template <typename T>
+void appendLittleEndian(std::vector<uint8_t>& out, T value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void appendExrAttribute(std::vector<uint8_t>& out, const char* name, const char* type,
+                        const std::vector<uint8_t>& value) {
+    out.insert(out.end(), name, name + std::char_traits<char>::length(name) + 1);
+    out.insert(out.end(), type, type + std::char_traits<char>::length(type) + 1);
+    appendLittleEndian(out, static_cast<int32_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+} // namespace
+
+void writePng(const std::string& path, uint32_t width, uint32_t height, const std::vector<uint8_t>& rgb) {
+    if (rgb.size() != static_cast<size_t>(width) * height * 3) {
+        throw std::runtime_error("writePng: pixel buffer does not match image size");
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open image file: " + path);
+    }
+
+    const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    std::vector<uint8_t> header;
+    appendBigEndian(header, width);
+    appendBigEndian(header, height);
+    header.push_back(8);  // bit depth
+    header.push_back(2);  // truecolour
+    header.push_back(0);  // deflate
+    header.push_back(0);  // adaptive filtering
+    header.push_back(0);  // no interlace
+    writePngChunk(file, "IHDR", header);
+
+    // Raw scanlines, each prefixed with filter type 0.
+    size_t rowBytes = static_cast<size_t>(width) * 3;
+    std::vector<uint8_t> raw;
+    raw.reserve((rowBytes + 1) * height);
+    for (uint32_t y = 0; y < height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb.begin() + y * rowBytes, rgb.begin() + (y + 1) * rowBytes);
+    }
+
+    // zlib stream made of stored deflate blocks.
+    std::vector<uint8_t> zlib = {0x78, 0x01};
+    const size_t maxBlock = 65535;
+    for (size_t offset = 0; offset < raw.size() || offset == 0; offset += maxBlock) {
+        size_t size = std::min(maxBlock, raw.size() - offset);
+        bool last = offset + size >= raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(static_cast<uint8_t>(size));
+        zlib.push_back(static_cast<uint8_t>(size >> 8));
+        zlib.push_back(static_cast<uint8_t>(~size));
+        zlib.push_back(static_cast<uint8_t>(~size >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + size);
+        if (last) {
+            break;
+        }
+    }
+
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    appendBigEndian(zlib, (b << 16) | a);
+
+    writePngChunk(file, "IDAT", zlib);
+    writePngChunk(file, "IEND", {});
+}
+
+void writeExr(const std::string& path, uint32_t width, uint32_t height, const std::vector<glm::vec3>& pixels) {
+    if (pixels.size() != static_cast<size_t>(width) * height) {
+        throw std::runtime_error("writeExr: pixel buffer does not match image size");
+    }
+
+    std::vector<uint8_t> header = {0x76, 0x2f, 0x31, 0x01, 2, 0, 0, 0};
+
+    // Channels must be listed alphabetically; pixel type 2 is FLOAT.
+    std::vector<uint8_t> channels;
+    for (const char* name : {"B", "G", "R"}) {
+        channels.push_back(static_cast<uint8_t>(name[0]));
+        channels.push_back(0);
+        appendLittleEndian(channels, int32_t(2));
+        channels.insert(channels.end(), {0, 0, 0, 0});
+        appendLittleEndian(channels, int32_t(1));
+        appendLittleEndian(channels, int32_t(1));
+    }
+    channels.push_back(0);
+    appendExrAttribute(header, "channels", "chlist", channels);
+    appendExrAttribute(header, "compression", "compression", {0});
+
+    std::vector<uint8_t> window;
+    appendLittleEndian(window, int32_t(0));
+    appendLittleEndian(window, int32_t(0));
+    appendLittleEndian(window, static_cast<int32_t>(width) - 1);
+    appendLittleEndian(window, static_cast<int32_t>(height) - 1);
+    appendExrAttribute(header, "dataWindow", "box2i", window);
+    appendExrAttribute(header, "displayWindow", "box2i", window);
+    appendExrAttribute(header, "lineOrder", "lineOrder", {0});
+
+    std::vector<uint8_t> value;
+    appendLittleEndian(value, 1.0f);
+    appendExrAttribute(header, "pixelAspectRatio", "float", value);
+    value.clear();
+    appendLittleEndian(value, 0.0f);
+    appendLittleEndian(value, 0.0f);
+    appendExrAttribute(header, "screenWindowCenter", "v2f", value);
+    value.clear();
+    appendLittleEndian(value, 1.0f);
+    appendExrAttribute(header, "screenWindowWidth", "float", value);
+    header.push_back(0);
+
+    // One scanline per block: y, byte count, then the B, G and R rows.
+    uint32_t blockSize = 8 + width * 3 * sizeof(float);
+    uint64_t offset = header.size() + static_cast<uint64_t>(height) * sizeof(uint64_t);
+    for (uint32_t y = 0; y < height; y++) {
+        appendLittleEndian(header, offset + static_cast<uint64_t>(y) * blockSize);
+    }
+
+    std::vector<uint8_t> blocks;
+    blocks.reserve(static_cast<size_t>(blockSize) * height);
+    for (uint32_t y = 0; y < height; y++) {
+        appendLittleEndian(blocks, static_cast<int32_t>(y));
+        appendLittleEndian(blocks, static_cast<int32_t>(width * 3 * sizeof(float)));
+        for (int channel = 2; channel >= 0; channel--) {
+            for (uint32_t x = 0; x < width; x++) {
+                appendLittleEndian(blocks, pixels[static_cast<size_t>(y) * width + x][channel]);
+            }
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open image file: " + path);
+    }
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    file.write(reinterpret_cast<const char*>(blocks.data()), blocks.size());
+}
+
+std::vector<uint8_t> toneMapToSrgb(const std::vector<glm::vec3>& pixels) {
+    std::vector<uint8_t> rgb(pixels.size() * 3);
+    for (size_t i = 0; i < pixels.size(); i++) {
+        for (int c = 0; c < 3; c++) {
+            float v = std::max(pixels[i][c], 0.0f);
+            v = v / (1.0f + v);
+            v = v <= 0.0031308f ? 12.92f * v : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+            rgb[i * 3 + c] = static_cast<uint8_t>(std::min(v, 1.0f) * 255.0f + 0.5f);
+        }
+    }
+    return rgb;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Minimal dependency-free writers for the CPU renderer's output.
+// PNG is written as 8-bit RGB with stored (uncompressed) deflate blocks,
+// EXR as an uncompressed 32-bit float scanline image.
+void writePng(const std::string& path, uint32_t width, uint32_t height, const std::vector<uint8_t>& rgb);
+void writeExr(const std::string& path, uint32_t width, uint32_t height, const std::vector<glm::vec3>& pixels);
+
+// Reinhard tone mapping followed by the sRGB transfer curve.
+std::vector<uint8_t> toneMapToSrgb(const std::vector<glm::vec3>& pixels);
@@ -0,0 +1,245 @@
+#include "path_tracer.h"
+#include "image_writer.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+constexpr float Pi = 3.14159265358979f;
+constexpr float RayEpsilon = 1e-4f;
+
+uint32_t pcgHash(uint32_t value) {
+    uint32_t state = value * 747796405u + 2891336453u;
+    uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float randomFloat(uint32_t& state) {
+    state = pcgHash(state);
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+// Orthonormal basis around n (Duff et al. 2017).
+void buildBasis(const glm::vec3& n, glm::vec3& tangent, glm::vec3& bitangent) {
+    float sign = std::copysign(1.0f, n.z);
+    float a = -1.0f / (sign + n.z);
+    float b = n.x * n.y * a;
+    tangent = glm::vec3(1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x);
+    bitangent = glm::vec3(b, sign + n.y * n.y * a, -n.y);
+}
+
+glm::vec3 sampleCosineHemisphere(const glm::vec3& n, uint32_t& rngState) {
+    float r1 = randomFloat(rngState);
+    float r2 = randomFloat(rngState);
+    float phi = 2.0f * Pi * r1;
+    float r = std::sqrt(r2);
+
+    glm::vec3 tangent, bitangent;
+    buildBasis(n, tangent, bitangent);
+    return tangent * (r * std::cos(phi)) + bitangent * (r * std::sin(phi)) + n * std::sqrt(1.0f - r2);
+}
+
+} // namespace
+
+void PathTracerScene::addMesh(const TriangleMesh& source, const PathTracerMaterial& material) {
+    uint32_t materialId = static_cast<uint32_t>(materials.size());
+    materials.push_back(material);
+    mesh.append(source);
+    materialIds.insert(materialIds.end(), source.size(), materialId);
+}
+
+void PathTracerScene::build(ThreadPool& pool) {
+    BvhBuildSettings settings;
+    settings.maxLeafSize = 8;
+    bvh.build(mesh, pool, settings);
+    accel.build(bvh);
+}
+
+PathTracer::PathTracer(const PathTracerScene& scene, ThreadPool& pool, const PathTracerSettings& settings)
+    : scene(scene), pool(pool), settings(settings) {
+    this->settings.tileSize = std::max(this->settings.tileSize, 1u);
+    accumulation.resize(static_cast<size_t>(settings.width) * settings.height);
+}
+
+void PathTracer::setCamera(const glm::mat4& view, const glm::mat4& projection) {
+    inverseViewProjection = glm::inverse(projection * view);
+    cameraPosition = glm::vec3(glm::inverse(view)[3]);
+    resetAccumulation();
+}
+
+void PathTracer::resetAccumulation() {
+    std::fill(accumulation.begin(), accumulation.end(), glm::vec3(0.0f));
+    sampleCount = 0;
+    pathCount = 0;
+    renderMs = 0.0;
+}
+
+void PathTracer::renderPass() {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    uint32_t tileSize = settings.tileSize;
+    uint32_t tilesX = (settings.width + tileSize - 1) / tileSize;
+    uint32_t tilesY = (settings.height + tileSize - 1) / tileSize;
+    uint32_t passSeed = pcgHash(sampleCount + 1);
+
+    pool.parallelFor(static_cast<size_t>(tilesX) * tilesY, 1, [&](size_t first, size_t last) {
+        uint64_t paths = 0;
+        for (size_t tile = first; tile < last; tile++) {
+            uint32_t x0 = static_cast<uint32_t>(tile % tilesX) * tileSize;
+            uint32_t y0 = static_cast<uint32_t>(tile / tilesX) * tileSize;
+            uint32_t x1 = std::min(x0 + tileSize, settings.width);
+            uint32_t y1 = std::min(y0 + tileSize, settings.height);
+
+            for (uint32_t y = y0; y < y1; y++) {
+                for (uint32_t x = x0; x < x1; x++) {
+                    uint32_t pixel = y * settings.width + x;
+                    uint32_t rngState = pcgHash(pixel ^ passSeed);
+
+                    // Vulkan NDC: y grows downwards, matching image rows.
+                    float ndcX = 2.0f * (x + randomFloat(rngState)) / settings.width - 1.0f;
+                    float ndcY = 2.0f * (y + randomFloat(rngState)) / settings.height - 1.0f;
+                    glm::vec4 target = inverseViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+
+                    Ray ray;
+                    ray.origin = cameraPosition;
+                    ray.direction = glm::normalize(glm::vec3(target) / target.w - cameraPosition);
+                    accumulation[pixel] += tracePath(ray, rngState);
+                    paths++;
+                }
+            }
+        }
+        pathCount.fetch_add(paths, std::memory_order_relaxed);
+    });
+
+    sampleCount++;
+    renderMs += std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void PathTracer::render(uint32_t samplesPerPixel) {
+    for (uint32_t i = 0; i < samplesPerPixel; i++) {
+        renderPass();
+    }
+}
+
+glm::vec3 PathTracer::tracePath(Ray ray, uint32_t& rngState) const {
+    const Bvh8& accel = scene.getAccel();
+    glm::vec3 radiance(0.0f);
+    glm::vec3 throughput(1.0f);
+    bool specularBounce = true;
+
+    for (uint32_t bounce = 0; bounce <= settings.maxBounces; bounce++) {
+        RayHit hit;
+        bool found = accel.intersect(ray, hit);
+
+        // Diffuse bounces already account for the light through next event
+        // estimation; only camera and mirror paths may hit it directly.
+        if (specularBounce && hitLight(ray, found ? hit.t : ray.tMax)) {
+            radiance += throughput * scene.getLight().radiance;
+            break;
+        }
+        if (!found) {
+            radiance += throughput * scene.getSkyColor();
+            break;
+        }
+
+        const Triangle& tri = scene.getTriangle(hit.primitiveId);
+        const PathTracerMaterial& material = scene.getMaterial(hit.primitiveId);
+        glm::vec3 normal = glm::normalize(glm::cross(tri.v1 - tri.v0, tri.v2 - tri.v0));
+        if (glm::dot(normal, ray.direction) > 0.0f) {
+            normal = -normal;
+        }
+        glm::vec3 position = ray.origin + ray.direction * hit.t + normal * RayEpsilon;
+
+        glm::vec3 direction;
+        if (material.mirror > 0.0f && randomFloat(rngState) < material.mirror) {
+            direction = ray.direction - 2.0f * glm::dot(ray.direction, normal) * normal;
+            specularBounce = true;
+        } else {
+            radiance += throughput * material.albedo * (1.0f / Pi) * sampleLight(position, normal, rngState);
+            direction = sampleCosineHemisphere(normal, rngState);
+            specularBounce = false;
+        }
+        throughput *= material.albedo;
+
+        if (bounce >= 2) {
+            float survival = std::min(std::max(throughput.x, std::max(throughput.y, throughput.z)), 0.95f);
+            if (randomFloat(rngState) >= survival) {
+                break;
+            }
+            throughput /= survival;
+        }
+
+        ray = Ray();
+        ray.origin = position;
+        ray.direction = direction;
+    }
+    return radiance;
+}
+
+glm::vec3 PathTracer::sampleLight(const glm::vec3& position, const glm::vec3& normal, uint32_t& rngState) const {
+    const AreaLight& light = scene.getLight();
+    glm::vec3 lightPoint = light.corner + light.edgeU * randomFloat(rngState) + light.edgeV * randomFloat(rngState);
+    glm::vec3 toLight = lightPoint - position;
+    float distanceSquared = glm::dot(toLight, toLight);
+    float distance = std::sqrt(distanceSquared);
+    glm::vec3 direction = toLight / distance;
+
+    glm::vec3 areaNormal = glm::cross(light.edgeU, light.edgeV);
+    float area = glm::length(areaNormal);
+    float cosSurface = glm::dot(normal, direction);
+    float cosLight = -glm::dot(areaNormal / area, direction);
+    if (cosSurface <= 0.0f || cosLight <= 0.0f) {
+        return glm::vec3(0.0f);
+    }
+
+    Ray shadowRay;
+    shadowRay.origin = position;
+    shadowRay.direction = direction;
+    shadowRay.tMax = distance * (1.0f - 1e-3f);
+    if (scene.getAccel().occluded(shadowRay)) {
+        return glm::vec3(0.0f);
+    }
+    return light.radiance * (cosSurface * cosLight * area / distanceSquared);
+}
+
+bool PathTracer::hitLight(const Ray& ray, float maxT) const {
+    const AreaLight& light = scene.getLight();
+    glm::vec3 areaNormal = glm::cross(light.edgeU, light.edgeV);
+    float denom = glm::dot(areaNormal, ray.direction);
+    if (denom >= 0.0f) {
+        return false;
+    }
+
+    float t = glm::dot(light.corner - ray.origin, areaNormal) / denom;
+    if (t <= ray.tMin || t >= maxT) {
+        return false;
+    }
+
+    glm::vec3 local = ray.origin + ray.direction * t - light.corner;
+    float a = glm::dot(local, light.edgeU) / glm::dot(light.edgeU, light.edgeU);
+    float b = glm::dot(local, light.edgeV) / glm::dot(light.edgeV, light.edgeV);
+    return a >= 0.0f && a <= 1.0f && b >= 0.0f && b <= 1.0f;
+}
+
+std::vector<glm::vec3> PathTracer::resolve() const {
+    std::vector<glm::vec3> pixels(accumulation.size(), glm::vec3(0.0f));
+    if (sampleCount == 0) {
+        return pixels;
+    }
+    float scale = 1.0f / sampleCount;
+    for (size_t i = 0; i < pixels.size(); i++) {
+        pixels[i] = accumulation[i] * scale;
+    }
+    return pixels;
+}
+
+void PathTracer::savePng(const std::string& path) const {
+    writePng(path, settings.width, settings.height, toneMapToSrgb(resolve()));
+}
+
+void PathTracer::saveExr(const std::string& path) const {
+    writeExr(path, settings.width, settings.height, resolve());
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "bvh/bvh.h"
+#include "bvh/triangle_mesh.h"
+#include "bvh/wide_bvh.h"
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+struct PathTracerMaterial {
+    glm::vec3 albedo = glm::vec3(0.8f);
+    // Probability of a perfect mirror bounce instead of a diffuse one.
+    float mirror = 0.0f;
+};
+
+// Rectangular emitter corner + two edges; sampled for soft shadows.
+struct AreaLight {
+    glm::vec3 corner = glm::vec3(-1.0f, 6.0f, -1.0f);
+    glm::vec3 edgeU = glm::vec3(2.0f, 0.0f, 0.0f);
+    glm::vec3 edgeV = glm::vec3(0.0f, 0.0f, 2.0f);
+    glm::vec3 radiance = glm::vec3(12.0f);
+};
+
+class PathTracerScene {
+public:
+    void addMesh(const TriangleMesh& mesh, const PathTracerMaterial& material);
+    void setLight(const AreaLight& areaLight) { light = areaLight; }
+    void setSkyColor(const glm::vec3& color) { sky = color; }
+    void build(ThreadPool& pool);
+
+    const Bvh8& getAccel() const { return accel; }
+    const AreaLight& getLight() const { return light; }
+    const glm::vec3& getSkyColor() const { return sky; }
+    const Triangle& getTriangle(uint32_t id) const { return mesh.getTriangles()[id]; }
+    const PathTracerMaterial& getMaterial(uint32_t id) const { return materials[materialIds[id]]; }
+
+private:
+    TriangleMesh mesh;
+    std::vector<uint32_t> materialIds;
+    std::vector<PathTracerMaterial> materials;
+    AreaLight light;
+    glm::vec3 sky = glm::vec3(0.05f, 0.06f, 0.08f);
+    Bvh bvh;
+    Bvh8 accel;
+};
+
+struct PathTracerSettings {
+    uint32_t width = 800;
+    uint32_t height = 600;
+    uint32_t tileSize = 16;
+    uint32_t maxBounces = 6;
+};
+
+// Progressive tile-based path tracer. Every renderPass() adds one sample per
+// pixel; tiles are distributed over the thread pool and each pixel's random
+// sequence depends only on its coordinates and the pass index, so results
+// are identical for any thread count.
+class PathTracer {
+public:
+    PathTracer(const PathTracerScene& scene, ThreadPool& pool, const PathTracerSettings& settings = PathTracerSettings());
+
+    // Uses the same matrices as the rasteriser; resets accumulation.
+    void setCamera(const glm::mat4& view, const glm::mat4& projection);
+    void resetAccumulation();
+
+    void renderPass();
+    void render(uint32_t samplesPerPixel);
+
+    uint32_t getSampleCount() const { return sampleCount; }
+    uint64_t getPathCount() const { return pathCount.load(); }
+    double getRenderMs() const { return renderMs; }
+
+    std::vector<glm::vec3> resolve() const;
+    void savePng(const std::string& path) const;
+    void saveExr(const std::string& path) const;
+
+private:
+    glm::vec3 tracePath(Ray ray, uint32_t& rngState) const;
+    glm::vec3 sampleLight(const glm::vec3& position, const glm::vec3& normal, uint32_t& rngState) const;
+    bool hitLight(const Ray& ray, float maxT) const;
+
+    const PathTracerScene& scene;
+    ThreadPool& pool;
+    PathTracerSettings settings;
+
+    glm::mat4 inverseViewProjection = glm::mat4(1.0f);
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+
+    std::vector<glm::vec3> accumulation;
+    uint32_t sampleCount = 0;
+    std::atomic<uint64_t> pathCount{0};
+    double renderMs = 0.0;
+};
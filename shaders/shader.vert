@@ -3,6 +3,7 @@
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in mat4 inInstanceModel;
 
 layout(location = 0) out vec3 fragNormal;
 layout(location = 1) out vec3 fragPos;
@@ -14,9 +15,14 @@ layout(binding = 0) uniform UniformBufferObject {
     mat4 proj;
 } ubo;
 
+layout(push_constant) uniform PushConstants {
+    mat4 model;
+} push;
+
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
-    fragPos = vec3(ubo.model * vec4(inPosition, 1.0));
-    fragNormal = mat3(transpose(inverse(ubo.model))) * inNormal;
+    mat4 model = push.model * inInstanceModel;
+    gl_Position = ubo.proj * ubo.view * model * vec4(inPosition, 1.0);
+    fragPos = vec3(model * vec4(inPosition, 1.0));
+    fragNormal = mat3(transpose(inverse(model))) * inNormal;
     fragTexCoord = inTexCoord;
 }
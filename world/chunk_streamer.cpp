@@ -0,0 +1,262 @@
+#include "chunk_streamer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+uint64_t meshBytes(const MazeMeshChunk& mesh) {
+    return mesh.vertices.size() * sizeof(Vertex) + mesh.indices.size() * sizeof(uint32_t);
+}
+
+struct ChunkCandidate {
+    float distance;
+    uint64_t key;
+};
+
+} // namespace
+
+ChunkStreamer::ChunkStreamer(const MazeWorld& world, const MazeMeshSettings& meshSettings, ChunkUploader& uploader,
+                             ThreadPool& pool, const StreamingSettings& settings)
+    : world(world), meshSettings(meshSettings), uploader(uploader), pool(pool), settings(settings),
+      windowStart(Clock::now()), jobs(pool) {
+    this->meshSettings.chunkSize = world.getChunkSize();
+    if (settings.unloadRadius < settings.loadRadius) {
+        this->settings.unloadRadius = settings.loadRadius;
+    }
+}
+
+ChunkStreamer::~ChunkStreamer() {
+    clear();
+}
+
+float ChunkStreamer::distanceTo(uint32_t chunkX, uint32_t chunkZ, const glm::vec3& point) const {
+    float size = meshSettings.cellSize * world.getChunkSize();
+    float minX = meshSettings.origin.x + chunkX * size;
+    float minZ = meshSettings.origin.z + chunkZ * size;
+    float dx = std::max(std::max(minX - point.x, point.x - (minX + size)), 0.0f);
+    float dz = std::max(std::max(minZ - point.z, point.z - (minZ + size)), 0.0f);
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+MazeMeshChunk ChunkStreamer::buildChunk(uint32_t chunkX, uint32_t chunkZ) const {
+    // The mesher looks one column past the chunk on every side, so the
+    // neighbours are generated too; chunks are small enough that this is
+    // cheaper than caching them.
+    uint32_t x0 = chunkX > 0 ? chunkX - 1 : 0;
+    uint32_t z0 = chunkZ > 0 ? chunkZ - 1 : 0;
+    uint32_t x1 = std::min(chunkX + 2, world.getChunksX());
+    uint32_t z1 = std::min(chunkZ + 2, world.getChunksZ());
+    MazeGrid grid = world.generate(x0, z0, x1, z1);
+
+    MazeMeshSettings local = meshSettings;
+    float size = meshSettings.cellSize * world.getChunkSize();
+    local.origin += glm::vec3(x0 * size, 0.0f, z0 * size);
+    MazeMeshChunk mesh = buildMazeChunkMesh(grid, local, chunkX - x0, chunkZ - z0);
+    mesh.chunkX = chunkX;
+    mesh.chunkZ = chunkZ;
+    return mesh;
+}
+
+void ChunkStreamer::startJob(uint32_t chunkX, uint32_t chunkZ) {
+    chunks[keyOf(chunkX, chunkZ)].state = ChunkState::Pending;
+    stats.pendingChunks++;
+    jobs.run([this, chunkX, chunkZ]() {
+        try {
+            MazeMeshChunk mesh = buildChunk(chunkX, chunkZ);
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            finished.push_back(std::move(mesh));
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            if (!jobError) {
+                jobError = std::current_exception();
+            }
+            // Still report the chunk, empty, so it stops counting as in
+            // flight.
+            MazeMeshChunk failed;
+            failed.chunkX = chunkX;
+            failed.chunkZ = chunkZ;
+            finished.push_back(std::move(failed));
+        }
+    });
+}
+
+void ChunkStreamer::collectFinished() {
+    std::vector<MazeMeshChunk> done;
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        done.swap(finished);
+        std::swap(error, jobError);
+    }
+    for (MazeMeshChunk& mesh : done) {
+        stats.pendingChunks--;
+        auto it = chunks.find(keyOf(mesh.chunkX, mesh.chunkZ));
+        if (it == chunks.end()) {
+            continue;
+        }
+        if (it->second.state == ChunkState::Cancelled) {
+            chunks.erase(it);
+        } else if (it->second.state == ChunkState::Pending) {
+            it->second.state = ChunkState::Ready;
+            it->second.bytes = meshBytes(mesh);
+            it->second.mesh = std::move(mesh);
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ChunkStreamer::update(const glm::vec3& cameraPosition) {
+    Clock::time_point start = Clock::now();
+    // A pool of one thread has no workers to run the jobs.
+    if (pool.getThreadCount() == 1) {
+        pool.runPendingTask();
+    }
+    collectFinished();
+    stats.uploads = 0;
+    stats.evictions = 0;
+    stats.uploadedBytes = 0;
+    stats.missingChunks = 0;
+
+    // Evict first, so the slots freed go to the chunks coming in.
+    for (auto it = chunks.begin(); it != chunks.end();) {
+        uint32_t chunkX = static_cast<uint32_t>(it->first);
+        uint32_t chunkZ = static_cast<uint32_t>(it->first >> 32);
+        ChunkEntry& entry = it->second;
+        if (distanceTo(chunkX, chunkZ, cameraPosition) <= settings.unloadRadius) {
+            ++it;
+            continue;
+        }
+        if (entry.state == ChunkState::Pending || entry.state == ChunkState::Cancelled) {
+            // The job still runs; its mesh is dropped when it finishes.
+            entry.state = ChunkState::Cancelled;
+            ++it;
+            continue;
+        }
+        if (entry.state == ChunkState::Resident) {
+            if (entry.handle != NoHandle) {
+                uploader.release(entry.handle);
+            }
+            stats.residentBytes -= entry.bytes;
+            stats.residentChunks--;
+            stats.evictions++;
+            stats.totalEvictions++;
+        }
+        it = chunks.erase(it);
+    }
+
+    // Chunks in range, nearest first.
+    float chunkWorldSize = meshSettings.cellSize * world.getChunkSize();
+    glm::vec3 local = cameraPosition - meshSettings.origin;
+    auto chunkRange = [&](float low, float high, uint32_t count, uint32_t& first, uint32_t& last) {
+        float a = std::floor(low / chunkWorldSize);
+        float b = std::floor(high / chunkWorldSize);
+        if (b < 0.0f || a >= static_cast<float>(count)) {
+            return false;
+        }
+        first = a < 0.0f ? 0u : static_cast<uint32_t>(a);
+        last = std::min(static_cast<uint32_t>(b), count - 1);
+        return true;
+    };
+    uint32_t firstX, lastX, firstZ, lastZ;
+    std::vector<ChunkCandidate> wanted;
+    if (chunkRange(local.x - settings.loadRadius, local.x + settings.loadRadius, world.getChunksX(), firstX,
+                   lastX) &&
+        chunkRange(local.z - settings.loadRadius, local.z + settings.loadRadius, world.getChunksZ(), firstZ,
+                   lastZ)) {
+        for (uint32_t chunkZ = firstZ; chunkZ <= lastZ; chunkZ++) {
+            for (uint32_t chunkX = firstX; chunkX <= lastX; chunkX++) {
+                float distance = distanceTo(chunkX, chunkZ, cameraPosition);
+                if (distance > settings.loadRadius) {
+                    continue;
+                }
+                uint64_t key = keyOf(chunkX, chunkZ);
+                auto it = chunks.find(key);
+                if (it == chunks.end()) {
+                    wanted.push_back({distance, key});
+                } else if (it->second.state == ChunkState::Cancelled) {
+                    it->second.state = ChunkState::Pending;
+                }
+                if (it == chunks.end() || it->second.state != ChunkState::Resident) {
+                    stats.missingChunks++;
+                }
+            }
+        }
+    }
+    std::sort(wanted.begin(), wanted.end(),
+              [](const ChunkCandidate& a, const ChunkCandidate& b) { return a.distance < b.distance; });
+    for (const ChunkCandidate& candidate : wanted) {
+        if (stats.pendingChunks >= settings.maxInFlight) {
+            break;
+        }
+        startJob(static_cast<uint32_t>(candidate.key), static_cast<uint32_t>(candidate.key >> 32));
+    }
+
+    // Upload ready chunks, nearest first, within the byte budget.
+    std::vector<ChunkCandidate> ready;
+    for (const auto& item : chunks) {
+        if (item.second.state == ChunkState::Ready) {
+            uint32_t chunkX = static_cast<uint32_t>(item.first);
+            uint32_t chunkZ = static_cast<uint32_t>(item.first >> 32);
+            ready.push_back({distanceTo(chunkX, chunkZ, cameraPosition), item.first});
+        }
+    }
+    std::sort(ready.begin(), ready.end(),
+              [](const ChunkCandidate& a, const ChunkCandidate& b) { return a.distance < b.distance; });
+    stats.readyChunks = static_cast<uint32_t>(ready.size());
+    for (const ChunkCandidate& candidate : ready) {
+        ChunkEntry& entry = chunks[candidate.key];
+        if (stats.uploads > 0 && stats.uploadedBytes + entry.bytes > settings.uploadBudgetBytes) {
+            break;
+        }
+        if (!entry.mesh.indices.empty()) {
+            entry.handle = uploader.upload(std::move(entry.mesh));
+        }
+        entry.mesh = MazeMeshChunk();
+        entry.state = ChunkState::Resident;
+        stats.uploads++;
+        stats.readyChunks--;
+        stats.uploadedBytes += entry.bytes;
+        stats.residentBytes += entry.bytes;
+        stats.residentChunks++;
+    }
+    stats.totalUploadedBytes += stats.uploadedBytes;
+
+    Clock::time_point end = Clock::now();
+    windowBytes += stats.uploadedBytes;
+    double windowSeconds = std::chrono::duration<double>(end - windowStart).count();
+    if (windowSeconds >= 0.5) {
+        stats.uploadMBps = windowBytes / (1024.0 * 1024.0) / windowSeconds;
+        windowBytes = 0;
+        windowStart = end;
+    }
+    stats.updateMs = std::chrono::duration<double, std::milli>(end - start).count();
+    stats.maxUpdateMs = std::max(stats.maxUpdateMs, stats.updateMs);
+    if (stats.updateMs > settings.hitchMs) {
+        stats.hitchCount++;
+    }
+}
+
+void ChunkStreamer::clear() {
+    for (auto it = chunks.begin(); it != chunks.end();) {
+        ChunkEntry& entry = it->second;
+        if (entry.state == ChunkState::Pending || entry.state == ChunkState::Cancelled) {
+            entry.state = ChunkState::Cancelled;
+            ++it;
+            continue;
+        }
+        if (entry.state == ChunkState::Resident && entry.handle != NoHandle) {
+            uploader.release(entry.handle);
+        }
+        it = chunks.erase(it);
+    }
+    stats.residentChunks = 0;
+    stats.residentBytes = 0;
+    stats.readyChunks = 0;
+}
+
+bool ChunkStreamer::isResident(uint32_t chunkX, uint32_t chunkZ) const {
+    auto it = chunks.find(keyOf(chunkX, chunkZ));
+    return it != chunks.end() && it->second.state == ChunkState::Resident;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "core/thread_pool.h"
+#include "maze/maze_mesher.h"
+#include "maze/maze_world.h"
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// GPU side of chunk streaming, implemented by the renderer. Called on the
+// thread that calls ChunkStreamer::update.
+class ChunkUploader {
+public:
+    virtual ~ChunkUploader() = default;
+    // Creates the chunk's buffers and returns a handle for release. The
+    // mesh may be moved from.
+    virtual uint32_t upload(MazeMeshChunk&& mesh) = 0;
+    // The chunk left the streaming radius. Buffers may still be in use by
+    // frames in flight, so implementations defer the actual destruction.
+    virtual void release(uint32_t handle) = 0;
+};
+
+struct StreamingSettings {
+    // Chunks closer than this to the camera (on the floor plane) are
+    // streamed in; resident ones are evicted beyond unloadRadius. The gap
+    // keeps a camera on a chunk border from loading and evicting the same
+    // chunks every frame.
+    float loadRadius = 48.0f;
+    float unloadRadius = 64.0f;
+    // Vertex and index bytes uploaded per update. The nearest ready chunk
+    // is always uploaded, so a chunk bigger than the budget still streams.
+    size_t uploadBudgetBytes = 4u << 20;
+    // Chunks being generated and meshed at once.
+    uint32_t maxInFlight = 8;
+    // An update slower than this counts as a hitch.
+    double hitchMs = 4.0;
+};
+
+struct StreamingStats {
+    uint32_t residentChunks = 0;
+    // Jobs generating and meshing chunks.
+    uint32_t pendingChunks = 0;
+    uint32_t readyChunks = 0;
+    // Chunks inside the load radius that are not resident yet (visible
+    // pop-in).
+    uint32_t missingChunks = 0;
+    uint64_t residentBytes = 0;
+    uint32_t uploads = 0;
+    uint32_t evictions = 0;
+    uint64_t uploadedBytes = 0;
+    uint64_t totalUploadedBytes = 0;
+    uint64_t totalEvictions = 0;
+    // Upload bandwidth over the last half second.
+    double uploadMBps = 0.0;
+    double updateMs = 0.0;
+    double maxUpdateMs = 0.0;
+    uint64_t hitchCount = 0;
+};
+
+// Streams the chunks of a MazeWorld around the camera. Chunks coming into
+// range are generated (with their neighbours, which the mesher needs for
+// the walls on the chunk's borders) and greedy-meshed on the pool, then
+// handed to the uploader on the calling thread, nearest first and within
+// the per-update byte budget. Chunks out of range are released. Give the
+// streamer its own pool: jobs take around a millisecond, and threads that
+// wait on a shared pool run queued jobs while they wait.
+class ChunkStreamer {
+public:
+    ChunkStreamer(const MazeWorld& world, const MazeMeshSettings& meshSettings, ChunkUploader& uploader,
+                  ThreadPool& pool, const StreamingSettings& settings = StreamingSettings());
+    ~ChunkStreamer();
+
+    ChunkStreamer(const ChunkStreamer&) = delete;
+    ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+    // Once per frame with the camera position. Rethrows errors raised by
+    // the background jobs.
+    void update(const glm::vec3& cameraPosition);
+    // Releases every resident chunk and drops pending work.
+    void clear();
+
+    bool isResident(uint32_t chunkX, uint32_t chunkZ) const;
+    const StreamingStats& getStats() const { return stats; }
+    const StreamingSettings& getSettings() const { return settings; }
+
+private:
+    enum class ChunkState : uint8_t { Pending, Cancelled, Ready, Resident };
+
+    static constexpr uint32_t NoHandle = UINT32_MAX;
+
+    struct ChunkEntry {
+        ChunkState state = ChunkState::Pending;
+        // NoHandle for chunks with nothing to draw.
+        uint32_t handle = NoHandle;
+        uint64_t bytes = 0;
+        MazeMeshChunk mesh;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t keyOf(uint32_t chunkX, uint32_t chunkZ) const { return (static_cast<uint64_t>(chunkZ) << 32) | chunkX; }
+    float distanceTo(uint32_t chunkX, uint32_t chunkZ, const glm::vec3& point) const;
+    void startJob(uint32_t chunkX, uint32_t chunkZ);
+    MazeMeshChunk buildChunk(uint32_t chunkX, uint32_t chunkZ) const;
+    void collectFinished();
+
+    MazeWorld world;
+    MazeMeshSettings meshSettings;
+    ChunkUploader& uploader;
+    ThreadPool& pool;
+    StreamingSettings settings;
+    StreamingStats stats;
+
+    // Touched by the calling thread only.
+    std::unordered_map<uint64_t, ChunkEntry> chunks;
+    Clock::time_point windowStart;
+    uint64_t windowBytes = 0;
+
+    // Filled by the jobs.
+    std::mutex finishedMutex;
+    std::vector<MazeMeshChunk> finished;
+    std::exception_ptr jobError;
+
+    // Last, so in-flight jobs finish before anything they use is destroyed.
+    TaskGroup jobs;
+};